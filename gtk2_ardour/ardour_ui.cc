@@ -1469,7 +1469,14 @@ ARDOUR_UI::update_peak_thread_work ()
 	char buf[64];
 	const int c = SourceFactory::peak_work_queue_length ();
 	if (c > 0) {
-		snprintf (buf, sizeof (buf), _("PkBld: <span foreground=\"%s\">%d</span>"), c >= 2 ? X_("red") : X_("green"), c);
+		uint32_t done;
+		uint32_t total;
+		SourceFactory::peak_work_progress (done, total);
+		if (total > 0) {
+			snprintf (buf, sizeof (buf), _("PkBld: <span foreground=\"%s\">%d</span> (%u/%u)"), c >= 2 ? X_("red") : X_("green"), c, done, total);
+		} else {
+			snprintf (buf, sizeof (buf), _("PkBld: <span foreground=\"%s\">%d</span>"), c >= 2 ? X_("red") : X_("green"), c);
+		}
 		peak_thread_work_label.set_markup (buf);
 	} else {
 		peak_thread_work_label.set_markup (X_(""));
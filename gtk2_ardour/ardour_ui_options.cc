@@ -29,6 +29,7 @@
 #include "ardour/rc_configuration.h"
 #include "ardour/session.h"
 
+#include "canvas/canvas.h"
 #include "canvas/wave_view.h"
 
 #include "audio_clock.h"
@@ -426,6 +427,10 @@ ARDOUR_UI::parameter_changed (std::string p)
 	} else if (p == "waveform-cache-size") {
 		/* GUI option has units of megabytes; image cache uses units of bytes */
 		ArdourCanvas::WaveView::set_image_cache_size (UIConfiguration::instance().get_waveform_cache_size() * 1048576);
+	} else if (p == "waveform-render-threads") {
+		ArdourCanvas::WaveView::set_drawing_thread_count (UIConfiguration::instance().get_waveform_render_threads());
+	} else if (p == "canvas-frame-rate") {
+		ArdourCanvas::GtkCanvas::set_frame_rate (UIConfiguration::instance().get_canvas_frame_rate());
 	}
 }
 
@@ -73,6 +73,7 @@
 #include "ardour/profile.h"
 #include "ardour/route_group.h"
 #include "ardour/session_playlists.h"
+#include "ardour/source_factory.h"
 #include "ardour/tempo.h"
 #include "ardour/utils.h"
 
@@ -2099,11 +2100,12 @@ Editor::set_snap_to (SnapType st)
 	case SnapToBeatDiv4:
 	case SnapToBeatDiv3:
 	case SnapToBeatDiv2: {
-		ARDOUR::TempoMap::BBTPointList::const_iterator current_bbt_points_begin;
-		ARDOUR::TempoMap::BBTPointList::const_iterator current_bbt_points_end;
+		ARDOUR::TempoMap::BBTPointList grid;
 
-		compute_current_bbt_points (leftmost_frame, leftmost_frame + current_page_samples(),
-					    current_bbt_points_begin, current_bbt_points_end);
+		compute_current_bbt_points (leftmost_frame, leftmost_frame + current_page_samples(), grid);
+
+		ARDOUR::TempoMap::BBTPointList::const_iterator current_bbt_points_begin = grid.begin();
+		ARDOUR::TempoMap::BBTPointList::const_iterator current_bbt_points_end = grid.end();
 		compute_bbt_ruler_scale (leftmost_frame, leftmost_frame + current_page_samples(),
 					 current_bbt_points_begin, current_bbt_points_end);
 		update_tempo_based_rulers (current_bbt_points_begin, current_bbt_points_end);
@@ -3993,10 +3995,12 @@ Editor::set_show_measures (bool yn)
 				tempo_lines->show();
 			}
 
-			ARDOUR::TempoMap::BBTPointList::const_iterator begin;
-			ARDOUR::TempoMap::BBTPointList::const_iterator end;
+			ARDOUR::TempoMap::BBTPointList grid;
+
+			compute_current_bbt_points (leftmost_frame, leftmost_frame + current_page_samples(), grid);
 
-			compute_current_bbt_points (leftmost_frame, leftmost_frame + current_page_samples(), begin, end);
+			ARDOUR::TempoMap::BBTPointList::const_iterator begin = grid.begin();
+			ARDOUR::TempoMap::BBTPointList::const_iterator end = grid.end();
 			draw_measures (begin, end);
 		}
 
@@ -4634,11 +4638,12 @@ Editor::visual_changer (const VisualChange& vc)
 
 		compute_fixed_ruler_scale ();
 
-		ARDOUR::TempoMap::BBTPointList::const_iterator current_bbt_points_begin;
-		ARDOUR::TempoMap::BBTPointList::const_iterator current_bbt_points_end;
+		ARDOUR::TempoMap::BBTPointList grid;
+
+		compute_current_bbt_points (vc.time_origin, pending_visual_change.time_origin + current_page_samples(), grid);
 
-		compute_current_bbt_points (vc.time_origin, pending_visual_change.time_origin + current_page_samples(),
-					    current_bbt_points_begin, current_bbt_points_end);
+		ARDOUR::TempoMap::BBTPointList::const_iterator current_bbt_points_begin = grid.begin();
+		ARDOUR::TempoMap::BBTPointList::const_iterator current_bbt_points_end = grid.end();
 		compute_bbt_ruler_scale (vc.time_origin, pending_visual_change.time_origin + current_page_samples(),
 					 current_bbt_points_begin, current_bbt_points_end);
 		update_tempo_based_rulers (current_bbt_points_begin, current_bbt_points_end);
@@ -4664,9 +4669,63 @@ Editor::visual_changer (const VisualChange& vc)
 		update_video_timeline();
 	}
 
+	boost_visible_peak_builds ();
+
 	_summary->set_overlays_dirty ();
 }
 
+static void
+collect_region_sources (RegionView* rv, framepos_t start, framepos_t end, std::vector<boost::shared_ptr<AudioSource> >* sources)
+{
+	boost::shared_ptr<AudioRegion> ar = boost::dynamic_pointer_cast<AudioRegion> (rv->region());
+
+	if (!ar || ar->position() > end || ar->last_frame() < start) {
+		return;
+	}
+
+	for (uint32_t n = 0; n < ar->n_channels(); ++n) {
+		sources->push_back (ar->audio_source (n));
+	}
+}
+
+/** Move the sources of the regions that are on screen to the front of the
+ *  peak-building queue, so that what the user is looking at gets its
+ *  waveforms first.
+ */
+void
+Editor::boost_visible_peak_builds ()
+{
+	if (SourceFactory::peak_work_queue_length () == 0) {
+		return;
+	}
+
+	const double top = vertical_adjustment.get_value ();
+	const double bottom = top + _visible_canvas_height;
+	const framepos_t start = leftmost_frame;
+	const framepos_t end = leftmost_frame + current_page_samples ();
+
+	/* collect from the top of the screen down, so that the topmost
+	   track gets built first, and boost them all in one go.
+	*/
+
+	std::vector<boost::shared_ptr<AudioSource> > sources;
+
+	for (TrackViewList::iterator i = track_views.begin(); i != track_views.end(); ++i) {
+
+		if ((*i)->hidden() || !(*i)->view()) {
+			continue;
+		}
+
+		if ((*i)->y_position() > bottom || (*i)->y_position() + (*i)->effective_height() < top) {
+			continue;
+		}
+
+		(*i)->view()->foreach_regionview (sigc::bind (sigc::ptr_fun (collect_region_sources), start, end, &sources));
+	}
+
+	SourceFactory::boost_peak_priority (sources);
+}
+
 struct EditorOrderTimeAxisSorter {
     bool operator() (const TimeAxisView* a, const TimeAxisView* b) const {
 	    return a->order () < b->order ();
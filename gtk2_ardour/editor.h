@@ -1133,6 +1133,7 @@ class Editor : public PublicEditor, public PBD::ScopedConnectionList, public ARD
 	static int _idle_visual_changer (void *arg);
 	int idle_visual_changer ();
 	void visual_changer (const VisualChange&);
+	void boost_visible_peak_builds ();
 	void ensure_visual_change_idle_handler ();
 
 	/* track views */
@@ -1704,8 +1705,7 @@ class Editor : public PublicEditor, public PBD::ScopedConnectionList, public ARD
 	void draw_metric_marks (const ARDOUR::Metrics& metrics);
 
 	void compute_current_bbt_points (framepos_t left, framepos_t right,
-					 ARDOUR::TempoMap::BBTPointList::const_iterator& begin,
-					 ARDOUR::TempoMap::BBTPointList::const_iterator& end);
+					 ARDOUR::TempoMap::BBTPointList& grid);
 
 	void tempo_map_changed (const PBD::PropertyChange&);
 	void redisplay_tempo (bool immediate_redraw);
@@ -128,6 +128,10 @@ Editor::initialize_canvas ()
 
 	_trackview_group = new ArdourCanvas::Container (hv_scroll_group);
 	CANVAS_DEBUG_NAME (_trackview_group, "Canvas TrackViews");
+	/* track contents rarely change while the playhead moves across them,
+	   so draw them from a cached image.
+	*/
+	_trackview_group->set_render_cached (true);
 
 	// used as rubberband rect
 	rubberband_rect = new ArdourCanvas::Rectangle (hv_scroll_group, ArdourCanvas::Rect (0.0, 0.0, 0.0, 0.0));
@@ -143,6 +147,7 @@ Editor::initialize_canvas ()
 
 	_time_markers_group = new ArdourCanvas::Container (h_scroll_group);
 	CANVAS_DEBUG_NAME (_time_markers_group, "time bars");
+	_time_markers_group->set_render_cached (true);
 
 	cd_marker_group = new ArdourCanvas::Container (_time_markers_group, ArdourCanvas::Duple (0.0, 0.0));
 	CANVAS_DEBUG_NAME (cd_marker_group, "cd marker group");
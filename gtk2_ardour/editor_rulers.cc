@@ -1182,10 +1182,12 @@ Editor::metric_get_bbt (std::vector<ArdourCanvas::Ruler::Mark>& marks, gdouble l
 	bool helper_active = false;
 	ArdourCanvas::Ruler::Mark mark;
 
-	ARDOUR::TempoMap::BBTPointList::const_iterator begin;
-	ARDOUR::TempoMap::BBTPointList::const_iterator end;
+	ARDOUR::TempoMap::BBTPointList grid;
 
-	compute_current_bbt_points (lower, upper, begin, end);
+	compute_current_bbt_points (lower, upper, grid);
+
+	ARDOUR::TempoMap::BBTPointList::const_iterator begin = grid.begin();
+	ARDOUR::TempoMap::BBTPointList::const_iterator end = grid.end();
 
 	if (distance (begin, end) == 0) {
 		return;
@@ -114,10 +114,12 @@ Editor::tempo_map_changed (const PropertyChange& /*ignored*/)
 		tempo_lines->tempo_map_changed();
 	}
 
-	ARDOUR::TempoMap::BBTPointList::const_iterator begin;
-	ARDOUR::TempoMap::BBTPointList::const_iterator end;
+	ARDOUR::TempoMap::BBTPointList grid;
 
-	compute_current_bbt_points (leftmost_frame, leftmost_frame + current_page_samples(), begin, end);
+	compute_current_bbt_points (leftmost_frame, leftmost_frame + current_page_samples(), grid);
+
+	ARDOUR::TempoMap::BBTPointList::const_iterator begin = grid.begin();
+	ARDOUR::TempoMap::BBTPointList::const_iterator end = grid.end();
 	_session->tempo_map().apply_with_metrics (*this, &Editor::draw_metric_marks); // redraw metric markers
 	draw_measures (begin, end);
 	update_tempo_based_rulers (begin, end);
@@ -131,11 +133,12 @@ Editor::redisplay_tempo (bool immediate_redraw)
 	}
 
 	if (immediate_redraw) {
-		ARDOUR::TempoMap::BBTPointList::const_iterator current_bbt_points_begin;
-		ARDOUR::TempoMap::BBTPointList::const_iterator current_bbt_points_end;
+		ARDOUR::TempoMap::BBTPointList grid;
+
+		compute_current_bbt_points (leftmost_frame, leftmost_frame + current_page_samples(), grid);
 
-		compute_current_bbt_points (leftmost_frame, leftmost_frame + current_page_samples(),
-					    current_bbt_points_begin, current_bbt_points_end);
+		ARDOUR::TempoMap::BBTPointList::const_iterator current_bbt_points_begin = grid.begin();
+		ARDOUR::TempoMap::BBTPointList::const_iterator current_bbt_points_end = grid.end();
 		draw_measures (current_bbt_points_begin, current_bbt_points_end);
 		update_tempo_based_rulers (current_bbt_points_begin, current_bbt_points_end); // redraw rulers and measures
 
@@ -146,8 +149,7 @@ Editor::redisplay_tempo (bool immediate_redraw)
 
 void
 Editor::compute_current_bbt_points (framepos_t leftmost, framepos_t rightmost,
-				    ARDOUR::TempoMap::BBTPointList::const_iterator& begin,
-				    ARDOUR::TempoMap::BBTPointList::const_iterator& end)
+				    ARDOUR::TempoMap::BBTPointList& grid)
 {
 	if (!_session) {
 		return;
@@ -156,7 +158,7 @@ Editor::compute_current_bbt_points (framepos_t leftmost, framepos_t rightmost,
 	/* prevent negative values of leftmost from creeping into tempomap
 	 */
 
-	_session->tempo_map().get_grid (begin, end, max (leftmost, (framepos_t) 0), rightmost);
+	_session->tempo_map().get_grid (grid, max (leftmost, (framepos_t) 0), rightmost);
 }
 
 void
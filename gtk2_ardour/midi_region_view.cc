@@ -19,6 +19,7 @@
 
 #include <cmath>
 #include <algorithm>
+#include <map>
 #include <ostream>
 
 #include <gtkmm.h>
@@ -993,7 +994,7 @@ MidiRegionView::display_model(boost::shared_ptr<MidiModel> model)
 	_model = model;
 
 	content_connection.disconnect ();
-	_model->ContentsChanged.connect (content_connection, invalidator (*this), boost::bind (&MidiRegionView::redisplay_model, this), gui_context());
+	_model->ContentsChangedInRange.connect (content_connection, invalidator (*this), boost::bind (&MidiRegionView::redisplay_model_range, this, _1, _2), gui_context());
 	/* Don't signal as nobody else needs to know until selection has been altered. */
 	clear_events (false);
 
@@ -1151,6 +1152,17 @@ MidiRegionView::get_events (Events& e, Evoral::Sequence<Evoral::Beats>::NoteOper
 
 void
 MidiRegionView::redisplay_model()
+{
+	redisplay_model_range (Evoral::MinBeats, Evoral::MaxBeats);
+}
+
+/** Bring the canvas notes for model notes which start within [start, end]
+ *  up to date, adding and removing canvas notes as required.  Notes that
+ *  start elsewhere are left alone, so redisplaying after an edit costs only
+ *  as much as the notes that the edit touched.
+ */
+void
+MidiRegionView::redisplay_model_range (Evoral::Beats start, Evoral::Beats end)
 {
 	if (_active_notes) {
 		// Currently recording
@@ -1173,26 +1185,37 @@ MidiRegionView::redisplay_model()
 		return;
 	}
 
+	/* Canvas notes of removed or moved notes still point to those notes,
+	   whose start times are within the range, so this finds every canvas
+	   note that may need updating.  Looking them up by note keeps this
+	   linear even when an edit (e.g. quantize) has re-ordered the notes.
+	*/
+
+	typedef std::map<NoteType*, NoteBase*> CanvasNotes;
+	CanvasNotes in_range;
+
 	for (Events::iterator i = _events.begin(); i != _events.end(); ++i) {
-		(*i)->invalidate ();
+		const Evoral::Beats t = (*i)->note()->time();
+		if (t >= start && t <= end) {
+			(*i)->invalidate ();
+			in_range.insert (make_pair ((*i)->note().get(), *i));
+		}
 	}
 
 	MidiModel::ReadLock lock(_model->read_lock());
 
 	MidiModel::Notes& notes (_model->notes());
-	_optimization_iterator = _events.begin();
-
-	bool empty_when_starting = _events.empty();
 
-	for (MidiModel::Notes::iterator n = notes.begin(); n != notes.end(); ++n) {
+	for (MidiModel::Notes::iterator n = _model->note_lower_bound (start); n != notes.end() && (*n)->time() <= end; ++n) {
 
 		boost::shared_ptr<NoteType> note (*n);
-		NoteBase* cne;
+		CanvasNotes::iterator c = in_range.find (note.get());
+		NoteBase* cne = (c != in_range.end()) ? c->second : 0;
 		bool visible;
 
 		if (note_in_region_range (note, visible)) {
 
-			if (!empty_when_starting && (cne = find_canvas_note (note)) != 0) {
+			if (cne) {
 
 				cne->validate ();
 				update_note (cne);
@@ -1217,7 +1240,7 @@ MidiRegionView::redisplay_model()
 
 		} else {
 
-			if (!empty_when_starting && (cne = find_canvas_note (note)) != 0) {
+			if (cne) {
 				cne->validate ();
 				cne->hide ();
 			}
@@ -1226,7 +1249,7 @@ MidiRegionView::redisplay_model()
 
 	/* remove note items that are no longer valid */
 
-	if (!empty_when_starting) {
+	if (!in_range.empty()) {
 		for (Events::iterator i = _events.begin(); i != _events.end(); ) {
 			if (!(*i)->valid ()) {
 
@@ -1246,6 +1269,8 @@ MidiRegionView::redisplay_model()
 		}
 	}
 
+	_optimization_iterator = _events.end();
+
 	_patch_changes.clear();
 	_sys_exes.clear();
 
@@ -115,6 +115,7 @@ public:
 	void set_step_edit_cursor_width (Evoral::Beats beats);
 
 	void redisplay_model();
+	void redisplay_model_range (Evoral::Beats start, Evoral::Beats end);
 
 	GhostRegion* add_ghost (TimeAxisView&);
 
@@ -2874,6 +2874,44 @@ RCOptionEditor::RCOptionEditor ()
 		 _("Increasing the cache size uses more memory to store waveform images, which can improve graphical performance."));
 	add_option (S_("Preferences|GUI"), sics);
 
+	/* Waveform rendering threads */
+
+	ComboOption<uint32_t>* wrt = new ComboOption<uint32_t> (
+		"waveform-render-threads",
+		_("Waveform images are rendered using"),
+		sigc::mem_fun (UIConfiguration::instance(), &UIConfiguration::get_waveform_render_threads),
+		sigc::mem_fun (UIConfiguration::instance(), &UIConfiguration::set_waveform_render_threads)
+		);
+
+	wrt->add (0, _("all but one processor"));
+	for (uint32_t i = 1; i <= hwcpus; ++i) {
+		wrt->add (i, string_compose (_("%1 threads"), i));
+	}
+	Gtkmm2ext::UI::instance()->set_tip
+		(wrt->tip_widget(),
+		 _("More threads fill in waveforms sooner after zooming or scrolling a session with many tracks, at the cost of more CPU use while they are drawn."));
+	add_option (S_("Preferences|GUI"), wrt);
+
+	/* Canvas frame rate */
+
+	ComboOption<uint32_t>* cfr = new ComboOption<uint32_t> (
+		"canvas-frame-rate",
+		_("Redraw the editor canvas at most"),
+		sigc::mem_fun (UIConfiguration::instance(), &UIConfiguration::get_canvas_frame_rate),
+		sigc::mem_fun (UIConfiguration::instance(), &UIConfiguration::set_canvas_frame_rate)
+		);
+
+	cfr->add (0, _("whenever idle"));
+	cfr->add (30, _("30 times per second"));
+	cfr->add (50, _("50 times per second"));
+	cfr->add (60, _("60 times per second"));
+	cfr->add (75, _("75 times per second"));
+	cfr->add (120, _("120 times per second"));
+	Gtkmm2ext::UI::instance()->set_tip
+		(cfr->tip_widget(),
+		 _("Changes to the canvas are collected and drawn together at this rate. Lower rates use less CPU while the playhead moves or meters update."));
+	add_option (S_("Preferences|GUI"), cfr);
+
 	/* Lock GUI timeout */
 
 	Gtk::Adjustment *lts = manage (new Gtk::Adjustment(0, 0, 1000, 1, 10));
@@ -207,6 +207,18 @@ SessionOptionEditor::SessionOptionEditor (Session* s)
 
 	add_option (_("Media"), hf);
 
+	add_option (_("Media"), new OptionEditorHeading (_("Automation data")));
+
+	BoolOption* aef = new BoolOption (
+		"automation-event-files",
+		_("Store large automation lists in binary files"),
+		sigc::mem_fun (*_session_config, &SessionConfiguration::get_automation_event_files),
+		sigc::mem_fun (*_session_config, &SessionConfiguration::set_automation_event_files)
+		);
+	Gtkmm2ext::UI::instance()->set_tip (aef->tip_widget(),
+			_("Keeps the points of automation lists with many points in the session's automation folder instead of in the session file, which makes saving and loading faster. Files no longer used by any snapshot are removed by Session > Clean-up. Sessions saved this way can not be opened by older versions."));
+	add_option (_("Media"), aef);
+
 	add_option (_("Locations"), new OptionEditorHeading (_("File locations")));
 
         SearchPathOption* spo = new SearchPathOption ("audio-search-path", _("Search for audio files in:"),
@@ -74,4 +74,6 @@ UI_CONFIG_VARIABLE (bool, no_new_session_dialog, "no-new-session-dialog", false)
 UI_CONFIG_VARIABLE (bool, buggy_gradients, "buggy-gradients", false)
 UI_CONFIG_VARIABLE (bool, cairo_image_surface, "cairo-image-surface", false)
 UI_CONFIG_VARIABLE (uint64_t, waveform_cache_size, "waveform-cache-size", 100) /* units of megagbytes */
+UI_CONFIG_VARIABLE (uint32_t, waveform_render_threads, "waveform-render-threads", 0) /* 0: one less than the number of processors */
+UI_CONFIG_VARIABLE (uint32_t, canvas_frame_rate, "canvas-frame-rate", 60) /* 0: redraw as soon as idle */
 UI_CONFIG_VARIABLE (int32_t, recent_session_sort, "recent-session-sort", 0)
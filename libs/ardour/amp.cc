@@ -28,6 +28,7 @@
 #include "ardour/buffer_set.h"
 #include "ardour/midi_buffer.h"
 #include "ardour/rc_configuration.h"
+#include "ardour/runtime_functions.h"
 #include "ardour/session.h"
 
 #include "i18n.h"
@@ -213,13 +214,7 @@ Amp::apply_gain (BufferSet& bufs, framecnt_t sample_rate, framecnt_t nframes, ga
 	const double a = 156.825 / sample_rate; // 25 Hz LPF
 
 	for (BufferSet::audio_iterator i = bufs.audio_begin(); i != bufs.audio_end(); ++i) {
-		Sample* const buffer = i->data();
-		double lpf = initial;
-
-		for (pframes_t nx = 0; nx < nframes; ++nx) {
-			buffer[nx] *= lpf;
-			lpf += a * (target - lpf);
-		}
+		const double lpf = apply_gain_ramp_to_buffer (i->data(), nframes, initial, target, a);
 		if (i == bufs.audio_begin()) {
 			rv = lpf;
 		}
@@ -288,14 +283,41 @@ Amp::apply_gain (AudioBuffer& buf, framecnt_t sample_rate, framecnt_t nframes, g
 		return target;
 	}
 
-        Sample* const buffer = buf.data();
 	const double a = 156.825 / sample_rate; // 25 Hz LPF, see [other] Amp::apply_gain() above for details
 
-	double lpf = initial;
-        for (pframes_t nx = 0; nx < nframes; ++nx) {
-                buffer[nx] *= lpf;
-		lpf += a * (target - lpf);
-        }
+	const double lpf = apply_gain_ramp_to_buffer (buf.data(), nframes, initial, target, a);
+
+	if (fabs (lpf - target) < GAIN_COEFF_TINY) return target;
+	if (fabs (lpf) < GAIN_COEFF_TINY) return GAIN_COEFF_ZERO;
+	return lpf;
+}
+
+gain_t
+Amp::apply_gain (AudioBuffer& dst, AudioBuffer const& src, framecnt_t sample_rate, framecnt_t nframes, gain_t initial, gain_t target, gain_t scale)
+{
+        /* Mix the contents of @a src into @a dst with a (potentially) declicked
+	 * gain, further scaled by @a scale, in a single pass over the data,
+	 * rather than applying the gain to @a src first.  Returns the gain
+	 * reached, not including @a scale.  -- used by MonitorProcessor::run()
+	 */
+
+	assert (scale > 0);
+
+	if (nframes == 0) {
+		return initial;
+	}
+
+	if (initial == target) {
+		if (fabsf (target) >= GAIN_COEFF_SMALL) {
+			dst.accumulate_with_gain_from (src, nframes, target * scale);
+		}
+		return target;
+	}
+
+	const double a = 156.825 / sample_rate; // 25 Hz LPF, see [other] Amp::apply_gain() above for details
+
+	/* the ramp is linear in the gain, so scaling both ends scales every step */
+	const double lpf = mix_buffers_with_gain_ramp (dst.data(), src.data(), nframes, initial * scale, target * scale, a) / scale;
 
 	if (fabs (lpf - target) < GAIN_COEFF_TINY) return target;
 	if (fabs (lpf) < GAIN_COEFF_TINY) return GAIN_COEFF_ZERO;
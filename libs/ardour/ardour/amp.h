@@ -65,6 +65,7 @@ public:
 	static void apply_simple_gain(BufferSet& bufs, framecnt_t nframes, gain_t target, bool midi_amp = true);
 
 	static gain_t apply_gain (AudioBuffer& buf, framecnt_t sample_rate, framecnt_t nframes, gain_t initial, gain_t target);
+	static gain_t apply_gain (AudioBuffer& dst, AudioBuffer const& src, framecnt_t sample_rate, framecnt_t nframes, gain_t initial, gain_t target, gain_t scale);
 	static void apply_simple_gain(AudioBuffer& buf, framecnt_t nframes, gain_t target);
 
 	static void declick (BufferSet& bufs, framecnt_t nframes, int dir);
@@ -30,6 +30,8 @@
 
 #include <boost/utility.hpp>
 
+#include <glibmm/threads.h>
+
 #include "pbd/fastlog.h"
 #include "pbd/ringbufferNPT.h"
 #include "pbd/stateful.h"
@@ -126,6 +128,12 @@ class LIBARDOUR_API AudioDiskstream : public Diskstream
 		}
 	}
 
+	/** Give the calling thread its own working buffers for do_refill(),
+	 *  so that it can refill diskstreams at the same time as the butler.
+	 *  They are freed when the thread exits.
+	 */
+	static void allocate_thread_working_buffers ();
+
 
   protected:
 	friend class Session;
@@ -209,7 +217,8 @@ class LIBARDOUR_API AudioDiskstream : public Diskstream
 
 	/* The two central butler operations */
 	int do_flush (RunContext context, bool force = false);
-	int do_refill () { return _do_refill(_mixdown_buffer, _gain_buffer, 0); }
+	int do_refill ();
+	void prefetch ();
 
 
 	int read (Sample* buf, Sample* mixdown_buffer, float* gain_buffer,
@@ -252,6 +261,16 @@ class LIBARDOUR_API AudioDiskstream : public Diskstream
 	static Sample* _mixdown_buffer;
 	static gain_t* _gain_buffer;
 
+	struct WorkingBuffers {
+		WorkingBuffers ();
+		~WorkingBuffers ();
+		Sample* mixdown_buffer;
+		gain_t* gain_buffer;
+	};
+
+	static void release_thread_working_buffers (void*);
+	static Glib::Threads::Private<WorkingBuffers> _thread_working_buffers;
+
 	std::vector<boost::shared_ptr<AudioFileSource> > capturing_sources;
 
 	SerializedRCUManager<ChannelList> channels;
@@ -262,6 +281,7 @@ class LIBARDOUR_API AudioDiskstream : public Diskstream
  /* really */
   private:
 	int _do_refill (Sample *mixdown_buffer, float *gain_buffer, framecnt_t fill_level);
+	framecnt_t refill_read_size (framecnt_t total_space) const;
 
 	int add_channel_to (boost::shared_ptr<ChannelList>, uint32_t how_many);
 	int remove_channel_from (boost::shared_ptr<ChannelList>, uint32_t how_many);
@@ -115,6 +115,8 @@ class LIBARDOUR_API AudioRegion : public Region
 
 	virtual framecnt_t read_raw_internal (Sample*, framepos_t, framecnt_t, int channel) const;
 
+	void prefetch (framepos_t position, framecnt_t cnt, uint32_t chan_n = 0) const;
+
 	XMLNode& state ();
 	XMLNode& get_basic_state ();
 	int set_state (const XMLNode&, int version);
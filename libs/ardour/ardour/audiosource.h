@@ -57,6 +57,11 @@ class LIBARDOUR_API AudioSource : virtual public Source,
 	virtual framecnt_t available_peaks (double zoom) const;
 
 	virtual framecnt_t read (Sample *dst, framepos_t start, framecnt_t cnt, int channel=0) const;
+
+	/** Hint that [@param start, @param start + @param cnt) will be read soon.
+	 *  Implementations may start fetching it asynchronously, but must not block.
+	 */
+	virtual void prefetch (framepos_t /*start*/, framecnt_t /*cnt*/) const {}
 	virtual framecnt_t write (Sample *src, framecnt_t cnt);
 
 	virtual float sample_rate () const = 0;
@@ -72,6 +77,14 @@ class LIBARDOUR_API AudioSource : virtual public Source,
 			framepos_t start, framecnt_t cnt, double samples_per_visual_peak) const;
 
 	int  build_peaks ();
+
+	/** @return true if the peakfile is usable but its peak levels still
+	 *  have to be built from it, which setup is left to the peak-building
+	 *  threads so as not to hold up loading.
+	 */
+	bool peak_levels_missing () const { return g_atomic_int_get (const_cast<gint*>(&_peak_levels_missing)); }
+	int  build_missing_peak_levels ();
+
 	bool peaks_ready (boost::function<void()> callWhenReady, PBD::ScopedConnection** connection_created_if_not_ready, PBD::EventLoop* event_loop) const;
 
 	mutable PBD::Signal0<void>  PeaksReady;
@@ -112,12 +125,14 @@ class LIBARDOUR_API AudioSource : virtual public Source,
 
 	/* these collections of working buffers for supporting
 	   playlist's reading from potentially nested/recursive
-	   sources assume SINGLE THREADED reads by the butler
-	   thread, or a lock around calls that use them.
+	   sources are shared by all threads; each level's
+	   buffers are protected by the matching lock in
+	   _level_read_locks.
 	*/
 
 	static std::vector<boost::shared_array<Sample> > _mixdown_buffers;
 	static std::vector<boost::shared_array<gain_t> > _gain_buffers;
+	static std::vector<boost::shared_ptr<Glib::Threads::Mutex> > _level_read_locks;
 	static Glib::Threads::Mutex    _level_buffer_lock;
 
 	static void ensure_buffers_for_level (uint32_t, framecnt_t);
@@ -167,7 +182,42 @@ class LIBARDOUR_API AudioSource : virtual public Source,
 	mutable double _last_scale;
 	mutable off_t _last_map_off;
 	mutable size_t  _last_raw_map_length;
+	mutable framecnt_t _last_fpp;
 	mutable boost::scoped_array<PeakData> peak_cache;
+
+	/** A coarser level of peak data, built alongside the peakfile and kept
+	 *  in a file of its own next to it, so that zoomed-out views do not
+	 *  have to read and decimate the whole peakfile.
+	 */
+	struct PeakLevel {
+		PeakLevel () : fd (-1), valid_peaks (0), pending_index (-1) {}
+		int        fd;
+		gint       valid_peaks;   ///< number of peaks that can be read; use peak_level_bytes()
+		framepos_t pending_index; ///< index of the peak being accumulated, or -1
+		PeakData   pending;
+	};
+
+	static const uint32_t   n_peak_levels = 2;
+	static const framecnt_t peak_level_fpp[n_peak_levels];
+	PeakLevel _peak_levels[n_peak_levels];
+	gint      _peak_levels_missing;
+
+	/* the levels are written by peak-building threads while the GUI reads
+	   them, so the end of their valid data is only accessed atomically.
+	*/
+	off_t peak_level_bytes (uint32_t level) const {
+		return (off_t) g_atomic_int_get (const_cast<gint*>(&_peak_levels[level].valid_peaks)) * sizeof (PeakData);
+	}
+	void set_peak_level_bytes (uint32_t level, off_t bytes) {
+		g_atomic_int_set (&_peak_levels[level].valid_peaks, (gint) (bytes / sizeof (PeakData)));
+	}
+
+	std::string peak_level_path (uint32_t level) const;
+	bool check_peak_level (uint32_t level, time_t peakfile_mtime);
+	void open_peak_levels ();
+	void close_peak_levels ();
+	int  write_peak_levels (PeakData const * peaks, framecnt_t npeaks, framepos_t first_peak);
+	int  build_peak_levels_from_peakfile ();
 };
 
 }
@@ -80,7 +80,7 @@ public:
 	static const std::string xml_node_name;
 
 	int set_automation_xml_state (const XMLNode&, Evoral::Parameter default_param);
-	XMLNode& get_automation_xml_state();
+	XMLNode& get_automation_xml_state (bool full);
 
 	PBD::Signal0<void> AutomationStateChanged;
 
@@ -89,6 +89,8 @@ public:
 
 	void can_automate(Evoral::Parameter);
 
+	void find_next_ac_event (boost::shared_ptr<Evoral::Control>, double start, double end, Evoral::ControlEvent& ev) const;
+
 	virtual void automation_list_automation_state_changed (Evoral::Parameter, AutoState) {}
 
 	int load_automation (const std::string& path);
@@ -66,7 +66,7 @@ class LIBARDOUR_API AutomationList : public PBD::StatefulDestructible, public Ev
   public:
 	AutomationList (const Evoral::Parameter& id, const Evoral::ParameterDescriptor& desc);
 	AutomationList (const Evoral::Parameter& id);
-	AutomationList (const XMLNode&, Evoral::Parameter id);
+	AutomationList (const XMLNode&, Evoral::Parameter id, const std::string& event_file_dir = std::string ());
 	AutomationList (const AutomationList&);
 	AutomationList (const AutomationList&, double start, double end);
 	~AutomationList();
@@ -105,14 +105,27 @@ class LIBARDOUR_API AutomationList : public PBD::StatefulDestructible, public Ev
 
 	XMLNode& get_state ();
 	int set_state (const XMLNode &, int version);
-	XMLNode& state (bool full);
-	XMLNode& serialize_events ();
+	/** @param event_file_dir If not empty, the points of a large list are
+	 *  stored in a binary event file in this directory, named after its
+	 *  contents, instead of as text in the XML.  Only session saves pass
+	 *  this; states kept for undo must not depend on files.
+	 */
+	XMLNode& state (bool full, const std::string& event_file_dir = std::string ());
+	XMLNode& serialize_events (const std::string& event_file_dir = std::string ());
+
+	/** As set_state(), but reading any binary event files that @a node
+	 *  refers to from @a event_file_dir.
+	 */
+	int set_state (const XMLNode& node, int version, const std::string& event_file_dir);
 
 	bool operator!= (const AutomationList &) const;
 
   private:
 	void create_curve_if_necessary ();
-	int deserialize_events (const XMLNode&);
+	int deserialize_events (const XMLNode&, const std::string& event_file_dir);
+
+	int write_event_file (const std::string& dir, std::string& name);
+	int read_event_file (const std::string& dir, const std::string& name);
 
 	void maybe_signal_changed ();
 
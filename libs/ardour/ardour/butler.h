@@ -21,6 +21,7 @@
 #define __ardour_butler_h__
 
 #include <pthread.h>
+#include <vector>
 
 #include <glibmm/threads.h>
 
@@ -39,6 +40,8 @@
 
 namespace ARDOUR {
 
+class Track;
+
 /**
  *  One of the Butler's functions is to clean up (ie delete) unused CrossThreadPools.
  *  When a thread with a CrossThreadPool terminates, its CTP is added to pool_trash.
@@ -95,8 +98,43 @@ private:
 	void empty_pool_trash ();
 	void config_changed (std::string);
 
+	bool refill_tracks (RouteList const &);
+	void queue_flushes (boost::shared_ptr<RouteList>, std::vector<boost::shared_ptr<Track> >&);
 	bool flush_tracks_to_disk_normal (boost::shared_ptr<RouteList>, uint32_t& errors);
 
+	/* Disk I/O is shared out between the butler thread and a pool of
+	   helper threads.  Each batch is a list of tracks, all of which are
+	   to be either refilled or flushed; threads claim them in order.
+	   _io_jobs is only modified with _io_lock held and no helper busy.
+	*/
+
+	enum DiskJobType {
+		Refill,
+		Flush,
+		ForcedFlush
+	};
+
+	std::vector<pthread_t>                   _io_threads;
+	std::vector<boost::shared_ptr<Track> >   _io_jobs;
+	DiskJobType                              _io_job_type;
+	uint32_t                                 _io_batch;      ///< incremented for each new batch
+	uint32_t                                 _io_busy;       ///< number of helpers working on the current batch
+	bool                                     _io_quit;
+	gint                                     _io_next_job;
+	gint                                     _io_outstanding; ///< non-zero if some job has more work to do
+	gint                                     _io_errors;
+	Glib::Threads::Mutex                     _io_lock;
+	Glib::Threads::Cond                      _io_batch_ready;
+	Glib::Threads::Cond                      _io_batch_done;
+
+	void start_io_threads ();
+	void terminate_io_threads ();
+	static void* _io_thread_work (void *arg);
+	void*         io_thread_work ();
+
+	bool run_disk_jobs (std::vector<boost::shared_ptr<Track> >&, DiskJobType, uint32_t& errors);
+	void process_disk_jobs ();
+
 	/**
 	 * Add request to butler thread request queue
 	 */
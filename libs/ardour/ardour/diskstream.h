@@ -245,6 +245,11 @@ class LIBARDOUR_API Diskstream : public SessionObject, public PublicDiskstream
 	virtual int do_flush (RunContext context, bool force = false) = 0;
 	virtual int do_refill () = 0;
 
+	/** Tell the OS which data the next do_refill() is going to read, so that
+	 *  it can start fetching it in the background.  Must not block.
+	 */
+	virtual void prefetch () {}
+
 	/* XXX fix this redundancy ... */
 
 	virtual void playlist_changed (const PBD::PropertyChange&);
@@ -22,6 +22,7 @@
 
 #include <algorithm>
 #include <iostream>
+#include <cstring>
 
 #include "pbd/ringbufferNPT.h"
 
@@ -63,6 +64,37 @@ public:
 
 	inline uint32_t write(Time  time, Evoral::EventType  type, uint32_t  size, const uint8_t* buf);
 	inline bool     read (Time* time, Evoral::EventType* type, uint32_t* size,       uint8_t* buf);
+
+protected:
+	/** Copy @a size bytes from @a offset bytes into the (possibly wrapped)
+	 * region @a vec, as returned by get_read_vector().
+	 */
+	static inline void read_from_vector (const rw_vector& vec, size_t offset, uint8_t* dst, size_t size) {
+		if (offset + size <= vec.len[0]) {
+			memcpy (dst, vec.buf[0] + offset, size);
+		} else if (offset >= vec.len[0]) {
+			memcpy (dst, vec.buf[1] + (offset - vec.len[0]), size);
+		} else {
+			const size_t n = vec.len[0] - offset;
+			memcpy (dst, vec.buf[0] + offset, n);
+			memcpy (dst + n, vec.buf[1], size - n);
+		}
+	}
+
+	/** Copy @a size bytes to @a offset bytes into the (possibly wrapped)
+	 * region @a vec, as returned by get_write_vector().
+	 */
+	static inline void write_to_vector (const rw_vector& vec, size_t offset, const uint8_t* src, size_t size) {
+		if (offset + size <= vec.len[0]) {
+			memcpy (vec.buf[0] + offset, src, size);
+		} else if (offset >= vec.len[0]) {
+			memcpy (vec.buf[1] + (offset - vec.len[0]), src, size);
+		} else {
+			const size_t n = vec.len[0] - offset;
+			memcpy (vec.buf[0] + offset, src, n);
+			memcpy (vec.buf[1], src + n, size - n);
+		}
+	}
 };
 
 template<typename Time>
@@ -113,19 +145,34 @@ EventRingBuffer<Time>::read(Time* time, Evoral::EventType* type, uint32_t* size,
 	return true;
 }
 
+/** Write an event.  The prefix and the data are copied into the buffer
+ * before the write pointer is advanced, so a reader never sees a partial
+ * event.
+ */
 template<typename Time>
 inline uint32_t
 EventRingBuffer<Time>::write(Time time, Evoral::EventType type, uint32_t size, const uint8_t* buf)
 {
-	if (!buf || write_space() < (sizeof(Time) + sizeof(Evoral::EventType) + sizeof(uint32_t) + size)) {
+	const size_t prefix_size = sizeof(Time) + sizeof(Evoral::EventType) + sizeof(uint32_t);
+
+	if (!buf || write_space() < (prefix_size + size)) {
 		return 0;
-	} else {
-		PBD::RingBufferNPT<uint8_t>::write ((uint8_t*)&time, sizeof(Time));
-		PBD::RingBufferNPT<uint8_t>::write ((uint8_t*)&type, sizeof(Evoral::EventType));
-		PBD::RingBufferNPT<uint8_t>::write ((uint8_t*)&size, sizeof(uint32_t));
-		PBD::RingBufferNPT<uint8_t>::write (buf, size);
-		return size;
 	}
+
+	uint8_t prefix[prefix_size];
+	memcpy (prefix, &time, sizeof(Time));
+	memcpy (prefix + sizeof(Time), &type, sizeof(Evoral::EventType));
+	memcpy (prefix + sizeof(Time) + sizeof(Evoral::EventType), &size, sizeof(uint32_t));
+
+	PBD::RingBufferNPT<uint8_t>::rw_vector vec;
+	get_write_vector (&vec);
+
+	write_to_vector (vec, 0, prefix, prefix_size);
+	write_to_vector (vec, prefix_size, buf, size);
+
+	increment_write_ptr (prefix_size + size);
+
+	return size;
 }
 
 } // namespace ARDOUR
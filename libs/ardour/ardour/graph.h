@@ -31,6 +31,7 @@
 #include <glib.h>
 
 #include "pbd/semutils.h"
+#include "pbd/work_stealing_queue.h"
 
 #include "ardour/libardour_visibility.h"
 #include "ardour/types.h"
@@ -67,6 +68,7 @@ public:
 	void restart_cycle();
 
 	bool run_one();
+	GraphNode* wait_for_work ();
 	void helper_thread();
 	void main_thread();
 
@@ -98,9 +100,31 @@ private:
 
 	node_list_t _init_trigger_list[2];
 
-	std::vector<GraphNode *> _trigger_queue;
-	pthread_mutex_t          _trigger_mutex;
-
+	typedef PBD::WorkStealingQueue<GraphNode> WorkQueue;
+
+	/** State owned by one DSP thread: the queue of nodes that it has
+	 *  triggered, and which the other threads may steal from.
+	 */
+	struct ThreadSlot {
+		ThreadSlot (uint32_t i, guint size) : id (i), queue (size) {}
+		uint32_t  id;
+		WorkQueue queue;
+	};
+
+	std::vector<ThreadSlot*> _thread_slots;
+	/** The number of entries in _thread_slots that have been claimed by a thread */
+	volatile gint _claimed_thread_slots;
+	static Glib::Threads::Private<ThreadSlot> _thread_slot;
+
+	void create_thread_slots (uint32_t);
+	void drop_thread_slots ();
+	void claim_thread_slot ();
+	GraphNode* steal (ThreadSlot*);
+	bool work_available () const;
+	void wake_idle_threads (int);
+	bool reclaim_execution_token ();
+
+	/** Idle threads sleep on this once they have given up spinning */
 	PBD::ProcessSemaphore _execution_sem;
 
 	/** Signalled to start a run of the graph for a process callback */
@@ -115,6 +115,9 @@ class LIBARDOUR_API LV2Plugin : public ARDOUR::Plugin, public ARDOUR::Workee
 	bool parameter_is_input (uint32_t) const;
 	bool parameter_is_output (uint32_t) const;
 	bool parameter_is_toggled (uint32_t) const;
+	bool parameter_is_sample_accurate (uint32_t) const;
+
+	void set_parameter_buffer (uint32_t which, const float* buf);
 
 	boost::shared_ptr<ScalePoints>
 	get_scale_points(uint32_t port_index) const;
@@ -169,6 +172,9 @@ class LIBARDOUR_API LV2Plugin : public ARDOUR::Plugin, public ARDOUR::Workee
 	float*        _defaults;
 	LV2_Evbuf**   _ev_buffers;
 	LV2_Evbuf**   _atom_ev_buffers;
+	float**       _cv_buffers;  ///< Buffers for CV ports, NULL for other ports
+	pframes_t     _cv_buffer_size;  ///< Frames in each of _cv_buffers
+	const float** _cv_automation;  ///< Per-frame values for CV inputs, or NULL
 	float*        _bpm_control_port;  ///< Special input set by ardour
 	float*        _freewheel_control_port;  ///< Special input set by ardour
 	float*        _latency_control_port;  ///< Special output set by ardour
@@ -193,7 +199,8 @@ class LIBARDOUR_API LV2Plugin : public ARDOUR::Plugin, public ARDOUR::Workee
 		PORT_SEQUENCE = 1 << 5,  ///< New atom API event port
 		PORT_MIDI     = 1 << 6,  ///< Event port understands MIDI
 		PORT_POSITION = 1 << 7,  ///< Event port understands position
-		PORT_PATCHMSG = 1 << 8   ///< Event port supports patch:Message
+		PORT_PATCHMSG = 1 << 8,  ///< Event port supports patch:Message
+		PORT_CV       = 1 << 9   ///< CV (buffer of float), inputs are also controls
 	} PortFlag;
 
 	typedef unsigned PortFlags;
@@ -257,6 +264,7 @@ class LIBARDOUR_API LV2Plugin : public ARDOUR::Plugin, public ARDOUR::Workee
 
 	void init (const void* c_plugin, framecnt_t rate);
 	void allocate_atom_event_buffers ();
+	void allocate_cv_buffers (pframes_t);
 	void run (pframes_t nsamples);
 
 	void load_supported_properties(PropertyDescriptors& descs);
@@ -0,0 +1,74 @@
+/*
+    Copyright (C) 2015 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#ifndef __ardour_midi_cursor_h__
+#define __ardour_midi_cursor_h__
+
+#include <set>
+
+#include <boost/bind.hpp>
+#include <boost/utility.hpp>
+
+#include "pbd/signals.h"
+
+#include "evoral/Beats.hpp"
+#include "evoral/Sequence.hpp"
+
+#include "ardour/types.h"
+
+namespace ARDOUR {
+
+/** The read position of one reader of a MidiSource's model.
+ *
+ *  A source may be read by several regions (and playlists) at once, so
+ *  the iterator used to read it belongs to the reader rather than to the
+ *  source.  As long as a reader keeps reading contiguous ranges it
+ *  carries on from where it left off; otherwise, or when the source has
+ *  invalidated its readers, the source seeks.
+ */
+struct MidiCursor : public boost::noncopyable {
+	MidiCursor () : last_read_end (0) {}
+
+	/** Have this cursor invalidated whenever @a invalidated is emitted. */
+	void connect (PBD::Signal1<void, bool>& invalidated) {
+		connections.drop_connections ();
+		invalidated.connect_same_thread (connections, boost::bind (&MidiCursor::invalidate, this, _1));
+	}
+
+	/** @param preserve_notes true to remember the notes that were sounding,
+	 *  so that their note offs are still delivered if reading carries on
+	 *  from the same place.  The read position is kept in that case, so
+	 *  that the next contiguous read re-seeks without dropping them.
+	 */
+	void invalidate (bool preserve_notes) {
+		iter.invalidate (preserve_notes ? &active_notes : NULL);
+		if (!preserve_notes) {
+			last_read_end = 0;
+		}
+	}
+
+	Evoral::Sequence<Evoral::Beats>::const_iterator        iter;
+	std::set<Evoral::Sequence<Evoral::Beats>::WeakNotePtr> active_notes;
+	framepos_t                                             last_read_end;
+	PBD::ScopedConnectionList                              connections;
+};
+
+}
+
+#endif /* __ardour_midi_cursor_h__ */
@@ -74,6 +74,12 @@ public:
 		virtual int set_state (const XMLNode&, int version) = 0;
 		virtual XMLNode & get_state () = 0;
 
+		/** Get the range of the model that applying or undoing this command
+		 *  changes, covering everything it touches both before and after.
+		 *  start > end if it changes nothing.
+		 */
+		virtual void affected_range (TimeType& start, TimeType& end) const = 0;
+
 		boost::shared_ptr<MidiModel> model() const { return _model; }
 
 	protected:
@@ -102,6 +108,8 @@ public:
 		int set_state (const XMLNode&, int version);
 		XMLNode & get_state ();
 
+		void affected_range (TimeType& start, TimeType& end) const;
+
 		void add (const NotePtr note);
 		void remove (const NotePtr note);
 		void side_effect_remove (const NotePtr note);
@@ -167,6 +175,8 @@ public:
 		int set_state (const XMLNode&, int version);
 		XMLNode & get_state ();
 
+		void affected_range (TimeType& start, TimeType& end) const;
+
 		void remove (SysExPtr sysex);
 		void operator() ();
 		void undo ();
@@ -199,6 +209,8 @@ public:
 		int set_state (const XMLNode &, int version);
 		XMLNode & get_state ();
 
+		void affected_range (TimeType& start, TimeType& end) const;
+
 		void operator() ();
 		void undo ();
 
@@ -273,6 +285,12 @@ public:
 
 	PBD::Signal0<void> ContentsChanged;
 
+	/** Emitted straight after ContentsChanged with the range of the model
+	 *  that changed, so that views can update only that range.  Changes
+	 *  which are not confined to a range report MinBeats .. MaxBeats.
+	 */
+	PBD::Signal2<void, TimeType, TimeType> ContentsChangedInRange;
+
 	boost::shared_ptr<const MidiSource> midi_source ();
 	void set_midi_source (boost::shared_ptr<MidiSource>);
 
@@ -289,8 +307,6 @@ public:
 	void insert_silence_at_start (TimeType);
 	void transpose (TimeType, TimeType, int);
 
-	std::set<WeakNotePtr>& active_notes() { return _active_notes; }
-
 protected:
 	int resolve_overlaps_unlocked (const NotePtr, void* arg = 0);
 
@@ -318,14 +334,13 @@ private:
 	void automation_list_automation_state_changed (Evoral::Parameter, AutoState);
 
 	void control_list_marked_dirty ();
+	void contents_changed (TimeType start = Evoral::MinBeats, TimeType end = Evoral::MaxBeats);
 
 	PBD::ScopedConnectionList _midi_source_connections;
 
 	// We cannot use a boost::shared_ptr here to avoid a retain cycle
 	boost::weak_ptr<MidiSource> _midi_source;
 	InsertMergePolicy _insert_merge_policy;
-
-	std::set<WeakNotePtr> _active_notes;
 };
 
 } /* namespace ARDOUR */
@@ -25,8 +25,11 @@
 
 #include <boost/utility.hpp>
 
+#include <glibmm/threads.h>
+
 #include "ardour/ardour.h"
 #include "ardour/midi_model.h"
+#include "ardour/midi_cursor.h"
 #include "ardour/midi_state_tracker.h"
 #include "ardour/note_fixer.h"
 #include "ardour/playlist.h"
@@ -116,6 +119,7 @@ private:
 	typedef Evoral::Event<framepos_t>   Event;
 
 	struct RegionTracker : public boost::noncopyable {
+		MidiCursor       cursor;   ///< Cursor (iterator and read state)
 		MidiStateTracker tracker;  ///< Active note tracker
 		NoteFixer        fixer;    ///< Edit compensation
 	};
@@ -124,9 +128,15 @@ private:
 
 	void dump () const;
 
-	NoteTrackers _note_trackers;
-	NoteMode     _note_mode;
-	framepos_t   _read_end;
+	/** Protects _note_trackers and _read_end.  read() only holds a region
+	 *  read lock, and tracks that share this playlist may be refilled by
+	 *  different butler threads at the same time.  Always taken after
+	 *  the region lock.
+	 */
+	Glib::Threads::Mutex _note_trackers_lock;
+	NoteTrackers         _note_trackers;
+	NoteMode             _note_mode;
+	framepos_t           _read_end;
 };
 
 } /* namespace ARDOUR */
@@ -44,6 +44,7 @@ template<typename Time> class EventSink;
 namespace ARDOUR {
 
 class MidiChannelFilter;
+struct MidiCursor;
 class MidiFilter;
 class MidiModel;
 class MidiSource;
@@ -73,6 +74,7 @@ class LIBARDOUR_API MidiRegion : public Region
 	framecnt_t read_at (Evoral::EventSink<framepos_t>& dst,
 	                    framepos_t position,
 	                    framecnt_t dur,
+	                    MidiCursor& cursor,
 	                    uint32_t  chan_n = 0,
 	                    NoteMode  mode = Sustained,
 	                    MidiStateTracker* tracker = 0,
@@ -121,6 +123,7 @@ class LIBARDOUR_API MidiRegion : public Region
 	framecnt_t _read_at (const SourceList&, Evoral::EventSink<framepos_t>& dst,
 	                     framepos_t position,
 	                     framecnt_t dur,
+	                     MidiCursor& cursor,
 	                     uint32_t chan_n = 0,
 	                     NoteMode mode = Sustained,
 	                     MidiStateTracker* tracker = 0,
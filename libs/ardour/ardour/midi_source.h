@@ -21,6 +21,7 @@
 #define __ardour_midi_source_h__
 
 #include <string>
+#include <vector>
 #include <time.h>
 #include <glibmm/threads.h>
 #include <boost/enable_shared_from_this.hpp>
@@ -29,6 +30,7 @@
 #include "evoral/Sequence.hpp"
 #include "ardour/ardour.h"
 #include "ardour/buffer.h"
+#include "ardour/midi_cursor.h"
 #include "ardour/source.h"
 #include "ardour/beats_frames_converter.h"
 
@@ -69,6 +71,8 @@ class LIBARDOUR_API MidiSource : virtual public Source, public boost::enable_sha
 	 * \param source_start Start position of the SOURCE in this read context.
 	 * \param start Start of range to be read.
 	 * \param cnt Length of range to be read (in audio frames).
+	 * \param cursor The reader's position in the model, which is used to
+	 *        carry on from the last read if this one follows on from it.
 	 * \param tracker an optional pointer to MidiStateTracker object, for note on/off tracking.
 	 * \param filtered Parameters whose MIDI messages will not be returned.
 	 */
@@ -77,6 +81,7 @@ class LIBARDOUR_API MidiSource : virtual public Source, public boost::enable_sha
 	                              framepos_t                         source_start,
 	                              framepos_t                         start,
 	                              framecnt_t                         cnt,
+	                              MidiCursor&                        cursor,
 	                              MidiStateTracker*                  tracker,
 	                              MidiChannelFilter*                 filter,
 	                              const std::set<Evoral::Parameter>& filtered) const;
@@ -156,12 +161,10 @@ class LIBARDOUR_API MidiSource : virtual public Source, public boost::enable_sha
 	virtual void load_model(const Glib::Threads::Mutex::Lock& lock, bool force_reload=false) = 0;
 	virtual void destroy_model(const Glib::Threads::Mutex::Lock& lock) = 0;
 
-	/** Reset cached information (like iterators) when things have changed.
+	/** Reset cached information (like readers' iterators) when things have changed.
 	 * @param lock Source lock, which must be held by caller.
-	 * @param notes If non-NULL, currently active notes are added to this set.
 	 */
-	void invalidate(const Glib::Threads::Mutex::Lock&                       lock,
-	                std::set<Evoral::Sequence<Evoral::Beats>::WeakNotePtr>* notes=NULL);
+	void invalidate(const Glib::Threads::Mutex::Lock& lock);
 
 	void set_note_mode(const Glib::Threads::Mutex::Lock& lock, NoteMode mode);
 
@@ -181,6 +184,10 @@ class LIBARDOUR_API MidiSource : virtual public Source, public boost::enable_sha
 
 	/** Emitted when a different MidiModel is set */
 	PBD::Signal0<void> ModelChanged;
+	/** Emitted (with the source lock held) when readers' cursors must be
+	 *  invalidated; the argument is true if they should keep their active notes.
+	 */
+	PBD::Signal1<void, bool> Invalidated;
 	/** Emitted when a parameter's interpolation style is changed */
 	PBD::Signal2<void, Evoral::Parameter, Evoral::ControlList::InterpolationStyle> InterpolationChanged;
 	/** Emitted when a parameter's automation state is changed */
@@ -212,11 +219,7 @@ class LIBARDOUR_API MidiSource : virtual public Source, public boost::enable_sha
 	boost::shared_ptr<MidiModel> _model;
 	bool                         _writing;
 
-	mutable Evoral::Sequence<Evoral::Beats>::const_iterator _model_iter;
-	mutable bool                                            _model_iter_valid;
-
 	mutable Evoral::Beats _length_beats;
-	mutable framepos_t    _last_read_end;
 
 	/** The total duration of the current capture. */
 	framepos_t _capture_length;
@@ -235,6 +238,31 @@ class LIBARDOUR_API MidiSource : virtual public Source, public boost::enable_sha
 	 */
 	typedef std::map<Evoral::Parameter, AutoState> AutomationStateMap;
 	AutomationStateMap  _automation_state;
+
+  private:
+	typedef Evoral::Sequence<Evoral::Beats>::NotePtr     NotePtr;
+	typedef Evoral::Sequence<Evoral::Beats>::WeakNotePtr WeakNotePtr;
+
+	/** A point in the model to seek from: the start time of every
+	 *  seek_interval'th note, and the notes sounding at that time.
+	 */
+	struct SeekPoint {
+		Evoral::Beats        time;
+		std::vector<NotePtr> active;
+	};
+
+	struct SeekPointLater {
+		bool operator() (Evoral::Beats t, SeekPoint const & p) const { return t < p.time; }
+	};
+
+	static const size_t seek_interval = 64;
+
+	mutable std::vector<SeekPoint> _seek_index;
+	mutable bool                   _seek_index_valid;
+	mutable size_t                 _seek_index_notes; ///< number of notes in the model when the index was built
+
+	void build_seek_index () const;
+	void notes_active_at (Evoral::Beats t, std::set<WeakNotePtr>& notes) const;
 };
 
 }
@@ -34,6 +34,11 @@ class MidiSource;
 
 /** Tracks played notes, so they can be resolved in potential stuck note
  * situations (e.g. looping, transport stop, etc).
+ *
+ * Alongside the per-note voice counts, a bit is kept for every sounding
+ * note and for every channel with a sounding note, so resolving, resetting
+ * and dumping only visit the notes that are actually on rather than all
+ * 16*128 slots.
  */
 class LIBARDOUR_API MidiStateTracker
 {
@@ -51,7 +56,7 @@ public:
 	void reset ();
 	bool empty() const { return _on == 0; }
 	uint16_t on() const { return _on; }
-	bool active (uint8_t note, uint8_t channel) {
+	bool active (uint8_t note, uint8_t channel) const {
 		return _active_notes[(channel*128)+note] > 0;
 	}
 
@@ -61,7 +66,12 @@ public:
 	}
 
 private:
+	void set_active (uint8_t note, uint8_t chn);
+	void clear_active (uint8_t note, uint8_t chn);
+
 	uint8_t  _active_notes[128*16];
+	uint32_t _active_bits[16][4];  ///< one bit per sounding note, per channel
+	uint16_t _active_channels;     ///< one bit per channel with a sounding note
 	uint16_t _on;
 };
 
@@ -42,6 +42,7 @@
 
 #include "ardour/ardour.h"
 #include "ardour/region.h"
+#include "ardour/region_index.h"
 #include "ardour/session_object.h"
 #include "ardour/data_type.h"
 
@@ -271,6 +272,7 @@ public:
 
 	RegionListProperty   regions;  /* the current list of regions in the playlist */
 	std::set<boost::shared_ptr<Region> > all_regions; /* all regions ever added to this playlist */
+	mutable RegionIndex  _region_index; /* lookup index over regions; invalidate when they change */
 	PBD::ScopedConnectionList region_state_changed_connections;
 	DataType        _type;
 	int             _sort_id;
@@ -133,6 +133,18 @@ class LIBARDOUR_API Plugin : public PBD::StatefulDestructible, public Latent
 	virtual bool parameter_is_input(uint32_t) const = 0;
 	virtual bool parameter_is_output(uint32_t) const = 0;
 
+	/** @return true if parameter @a which can follow a buffer of per-frame
+	 *  values (see set_parameter_buffer()) rather than a single value per run.
+	 */
+	virtual bool parameter_is_sample_accurate (uint32_t /*which*/) const { return false; }
+
+	/** Have parameter @a which take its values from @a buf during the next
+	 *  connect_and_run(); buf[0] is the value for the first frame it runs.
+	 *  Passing 0 goes back to using the parameter's current value.
+	 *  Must be realtime safe.
+	 */
+	virtual void set_parameter_buffer (uint32_t /*which*/, const float* /*buf*/) {}
+
 	virtual boost::shared_ptr<ScalePoints> get_scale_points(uint32_t /*port_index*/) const {
 		return boost::shared_ptr<ScalePoints>();
 	}
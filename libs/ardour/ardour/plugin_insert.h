@@ -203,8 +203,31 @@ class LIBARDOUR_API PluginInsert : public Processor
 	Match _match;
 
 	void automation_run (BufferSet& bufs, framepos_t start, pframes_t nframes);
+	/** @param with_auto true to apply automation; the caller must then hold
+	 *  control_lock(), as automation_run() does, since it reads _control_buffers.
+	 */
 	void connect_and_run (BufferSet& bufs, pframes_t nframes, framecnt_t offset, bool with_auto, framepos_t now = 0);
 
+	/** A cycle's worth of automation for a parameter that all of our
+	 *  plugins can take per-frame (see Plugin::set_parameter_buffer()).
+	 */
+	struct ControlBuffer {
+		ControlBuffer (boost::shared_ptr<AutomationControl> c, float* d) : control (c), data (d), active (false) {}
+		boost::shared_ptr<AutomationControl> control;
+		float* data;
+		bool   active; ///< true if data holds automation for the current cycle
+	};
+
+	/** only changed, and only read by the process thread, with control_lock() held */
+	std::vector<ControlBuffer> _control_buffers;
+	pframes_t                  _control_buffer_size;
+
+	void allocate_control_buffers (pframes_t);
+	void free_control_buffers ();
+	void fill_control_buffers (framepos_t start, pframes_t nframes);
+	void release_control_buffers ();
+	bool find_next_split_event (double now, double end, Evoral::ControlEvent& next_event) const;
+
 	void create_automatable_parameters ();
 	void control_list_automation_state_changed (Evoral::Parameter, AutoState);
 	void set_parameter_state_2X (const XMLNode& node, int version);
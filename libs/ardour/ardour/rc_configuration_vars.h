@@ -90,6 +90,8 @@ CONFIG_VARIABLE (RemoteModel, remote_model, "remote-model", MixerOrdered)
 
 CONFIG_VARIABLE (uint32_t, minimum_disk_read_bytes,  "minimum-disk-read-bytes", ARDOUR::Diskstream::default_disk_read_chunk_frames() * sizeof (ARDOUR::Sample))
 CONFIG_VARIABLE (uint32_t, minimum_disk_write_bytes,  "minimum-disk-write-bytes", ARDOUR::Diskstream::default_disk_write_chunk_frames() * sizeof (ARDOUR::Sample))
+CONFIG_VARIABLE (uint32_t, butler_io_threads, "butler-io-threads", 1) /* threads refilling/flushing diskstreams, including the butler itself */
+CONFIG_VARIABLE (bool, disk_read_prefetch, "disk-read-prefetch", true) /* hint the OS about all of a refill pass's reads before making them */
 CONFIG_VARIABLE (float, midi_readahead,  "midi-readahead", 1.0)
 CONFIG_VARIABLE (BufferingPreset, buffering_preset, "buffering-preset", Medium)
 CONFIG_VARIABLE (float, audio_capture_buffer_seconds, "capture-buffer-seconds", 5.0)
@@ -235,6 +237,10 @@ CONFIG_VARIABLE (bool, use_lxvst, "use-lxvst", true)
 CONFIG_VARIABLE (bool, discover_vst_on_start, "discover-vst-on-start", false)
 CONFIG_VARIABLE (bool, verbose_plugin_scan, "verbose-plugin-scan", true)
 CONFIG_VARIABLE (int, vst_scan_timeout, "vst-scan-timeout", 600) /* deciseconds, per plugin, <= 0 no timeout */
+CONFIG_VARIABLE (uint32_t, lv2_worker_threads, "lv2-worker-threads", 2) /* threads shared by all LV2 plugins for their non-realtime work */
+CONFIG_VARIABLE (uint32_t, peak_build_threads, "peak-build-threads", 0) /* threads building missing peakfiles; 0 means one per core */
+CONFIG_VARIABLE (bool, sample_accurate_plugin_automation, "sample-accurate-plugin-automation", true) /* pass automation as per-frame buffers to plugins that can take them */
+CONFIG_VARIABLE (uint32_t, minimum_automation_fragment, "minimum-automation-fragment", 32) /* frames; the shortest run a cycle is split into at automation events */
 CONFIG_VARIABLE (bool, discover_audio_units, "discover-audio-units", false)
 
 /* custom user plugin paths */
@@ -0,0 +1,104 @@
+/*
+    Copyright (C) 2015 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#ifndef __libardour_region_index_h__
+#define __libardour_region_index_h__
+
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/weak_ptr.hpp>
+
+#include <glib.h>
+#include <glibmm/threads.h>
+
+#include "ardour/libardour_visibility.h"
+#include "ardour/types.h"
+
+namespace ARDOUR {
+
+/** An interval index over a playlist's region list, used to answer
+ *  `which regions overlap this range' queries in O(log n + k) rather
+ *  than by walking the whole list.
+ *
+ *  The index is an implicit, balanced interval tree laid out over an
+ *  array of the regions in list order (which Playlist keeps sorted by
+ *  position), where each node also records the greatest last frame
+ *  in its subtree.  It is rebuilt lazily on the first query after
+ *  invalidate() has been called, so bulk edits cost one rebuild.  If
+ *  the list is ever found not to be sorted by position the index
+ *  falls back to a linear scan.
+ *
+ *  Results are always in list order, and every candidate is checked
+ *  against the region's current bounds, so as long as invalidate() is
+ *  called whenever the list or a region's position or length changes,
+ *  a query gives exactly what a walk of the list would have given.
+ *
+ *  Entries hold weak pointers, so the index never keeps a removed
+ *  region alive.  Queries share a reader lock; only a rebuild takes
+ *  the writer lock.
+ */
+class LIBARDOUR_API RegionIndex
+{
+  public:
+	RegionIndex ();
+
+	/** Note that the region list, or the bounds of a region in it, has changed */
+	void invalidate ();
+
+	/** Append all regions in the list [@param b, @param e) which have some
+	 *  part within @param start to @param end (inclusive) to @param result.
+	 *  Caller must hold (at least) a read lock on the list.
+	 */
+	void regions_touched (RegionList::const_iterator b, RegionList::const_iterator e,
+	                      framepos_t start, framepos_t end, RegionList& result);
+
+	/** @return the number of regions in the list [@param b, @param e) which have
+	 *  some part within @param start to @param end (inclusive).
+	 *  Caller must hold (at least) a read lock on the list.
+	 */
+	uint32_t count_touched (RegionList::const_iterator b, RegionList::const_iterator e,
+	                        framepos_t start, framepos_t end);
+
+  private:
+	struct Entry {
+		boost::weak_ptr<Region> region;
+		framepos_t first;
+		framepos_t last;
+		/** greatest value of last in the subtree whose root is this entry */
+		framepos_t max_last;
+	};
+
+	std::vector<Entry>   _entries;
+	bool                 _sorted;
+	gint                 _dirty;
+	Glib::Threads::RWLock _lock;
+
+	uint32_t lookup (RegionList::const_iterator, RegionList::const_iterator,
+	                 framepos_t start, framepos_t end, RegionList* result);
+	void rebuild (RegionList::const_iterator, RegionList::const_iterator);
+	framepos_t build_subtree (size_t lo, size_t hi);
+	void find (size_t lo, size_t hi, framepos_t start, framepos_t end, RegionList* result, uint32_t& count) const;
+	void scan (RegionList::const_iterator, RegionList::const_iterator,
+	           framepos_t start, framepos_t end, RegionList* result, uint32_t& count) const;
+};
+
+} /* namespace */
+
+#endif /* __libardour_region_index_h__ */
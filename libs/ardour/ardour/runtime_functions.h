@@ -32,12 +32,26 @@ namespace ARDOUR {
 	typedef void  (*mix_buffers_no_gain_t)		(ARDOUR::Sample *, const ARDOUR::Sample *, pframes_t);
 	typedef void  (*copy_vector_t)			    (ARDOUR::Sample *, const ARDOUR::Sample *, pframes_t);
 
+	/* the 1-pole lowpass gain ramp used by Amp::apply_gain(): sample n
+	   is scaled by g(n), where g(0) = initial and
+	   g(n+1) = g(n) + coeff * (target - g(n)). Returns g(nframes). The
+	   gain is kept in double precision, as Amp always has.
+	*/
+	typedef double (*apply_gain_ramp_to_buffer_t)   (ARDOUR::Sample *, pframes_t, double initial, double target, double coeff);
+	/** mix with the same gain ramp, returning g(nframes) */
+	typedef double (*mix_buffers_with_gain_ramp_t)  (ARDOUR::Sample *, const ARDOUR::Sample *, pframes_t, double initial, double target, double coeff);
+	/** mix with gain, returning the larger of current and the absolute peak of the mixed result */
+	typedef float  (*mix_buffers_with_peak_t)       (ARDOUR::Sample *, const ARDOUR::Sample *, pframes_t, float gain, float current);
+
 	LIBARDOUR_API extern compute_peak_t		compute_peak;
 	LIBARDOUR_API extern find_peaks_t               find_peaks;
 	LIBARDOUR_API extern apply_gain_to_buffer_t	apply_gain_to_buffer;
 	LIBARDOUR_API extern mix_buffers_with_gain_t	mix_buffers_with_gain;
 	LIBARDOUR_API extern mix_buffers_no_gain_t	mix_buffers_no_gain;
 	LIBARDOUR_API extern copy_vector_t			copy_vector;
+	LIBARDOUR_API extern apply_gain_ramp_to_buffer_t	apply_gain_ramp_to_buffer;
+	LIBARDOUR_API extern mix_buffers_with_gain_ramp_t	mix_buffers_with_gain_ramp;
+	LIBARDOUR_API extern mix_buffers_with_peak_t	mix_buffers_with_peak;
 }
 
 #endif /* __ardour_runtime_functions_h__ */
@@ -63,6 +63,7 @@
 #include "ardour/location.h"
 #include "ardour/interpolation.h"
 #include "ardour/route_graph.h"
+#include "ardour/tempo.h"
 
 
 class XMLTree;
@@ -1686,6 +1687,11 @@ class LIBARDOUR_API Session : public PBD::StatefulDestructible, public PBD::Scop
 	framecnt_t              click_emphasis_length;
 	mutable Glib::Threads::RWLock    click_lock;
 
+	/** the beats that fall within the current cycle, only used by click();
+	    its capacity is reserved up front so that it never allocates there */
+	TempoMap::BBTPointList  _click_points;
+	static const size_t     max_click_points = 64;
+
 	static const Sample     default_click[];
 	static const framecnt_t default_click_length;
 	static const Sample     default_click_emphasis[];
@@ -1734,6 +1740,7 @@ class LIBARDOUR_API Session : public PBD::StatefulDestructible, public PBD::Scop
 
 	int find_all_sources (std::string path, std::set<std::string>& result);
 	int find_all_sources_across_snapshots (std::set<std::string>& result, bool exclude_this_snapshot);
+	int cleanup_automation_event_files (CleanupReport&);
 
 	typedef std::set<boost::shared_ptr<PBD::Controllable> > Controllables;
 	Glib::Threads::Mutex controllables_lock;
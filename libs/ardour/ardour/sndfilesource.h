@@ -22,6 +22,8 @@
 
 #include <sndfile.h>
 
+#include <boost/shared_ptr.hpp>
+
 #include "ardour/audiofilesource.h"
 #include "ardour/broadcast_info.h"
 
@@ -70,6 +72,8 @@ class LIBARDOUR_API SndFileSource : public AudioFileSource {
 
 	bool clamped_at_unity () const;
 
+	void prefetch (framepos_t start, framecnt_t cnt) const;
+
 	static void setup_standard_crossfades (Session const &, framecnt_t sample_rate);
 	static const Source::Flag default_writable_flags;
 
@@ -95,6 +99,24 @@ class LIBARDOUR_API SndFileSource : public AudioFileSource {
 	int setup_broadcast_info (framepos_t when, struct tm&, time_t);
 	void file_closed ();
 
+	/* reading multichannel files */
+
+	class BlockCache;
+	/** Decoded data shared with the other sources that read channels of the same file */
+	boost::shared_ptr<BlockCache> _block_cache;
+
+	framecnt_t read_via_block_cache (Sample *dst, framepos_t start, framecnt_t cnt) const;
+
+	/* read-ahead hints; only possible for uncompressed files, where
+	   we can work out where a given frame lives in the file.
+	*/
+
+	int        _prefetch_fd;          ///< owned by _sndfile, -1 if we can't prefetch
+	off_t      _prefetch_data_offset;
+	framecnt_t _prefetch_frame_bytes;
+
+	void setup_prefetch (int fd);
+
 	/* destructive */
 
 	static framecnt_t xfade_frames;
@@ -21,6 +21,7 @@
 #define __ardour_source_factory_h__
 
 #include <string>
+#include <vector>
 #include <stdint.h>
 #include <boost/shared_ptr.hpp>
 
@@ -69,6 +70,8 @@ class LIBARDOUR_API SourceFactory {
 	static std::list< boost::weak_ptr<AudioSource> > files_with_peaks;
 
 	static int peak_work_queue_length ();
+	static void peak_work_progress (uint32_t& done, uint32_t& total);
+	static void boost_peak_priority (std::vector<boost::shared_ptr<AudioSource> > const&);
 	static int setup_peakfile (boost::shared_ptr<Source>, bool async);
 };
 
@@ -242,8 +242,12 @@ class LIBARDOUR_API TempoMap : public PBD::StatefulDestructible
 		(obj.*method)(metrics);
 	}
 
-	void get_grid (BBTPointList::const_iterator&, BBTPointList::const_iterator&,
-	               framepos_t start, framepos_t end);
+	/** Fill @a points with the bars and beats between @a start and @a end
+	 *  (inclusive).  The points are computed on demand, so ask only for
+	 *  the range that is needed.
+	 *  @param max_points if non-zero, stop after this many points.
+	 */
+	void get_grid (BBTPointList& points, framepos_t start, framepos_t end, size_t max_points = 0);
 
 	/* TEMPO- AND METER-SENSITIVE FUNCTIONS
 
@@ -258,8 +262,7 @@ class LIBARDOUR_API TempoMap : public PBD::StatefulDestructible
 	void bbt_time (framepos_t when, Timecode::BBT_Time&);
 
 	/* realtime safe variant of ::bbt_time(), will throw
-	   std::logic_error if the map is not large enough
-	   to provide an answer.
+	   std::logic_error if the map could not be locked.
 	*/
 	void       bbt_time_rt (framepos_t when, Timecode::BBT_Time&);
 	framepos_t frame_time (const Timecode::BBT_Time&);
@@ -339,25 +342,48 @@ class LIBARDOUR_API TempoMap : public PBD::StatefulDestructible
 	static Tempo    _default_tempo;
 	static Meter    _default_meter;
 
-	Metrics                       metrics;
-	framecnt_t                    _frame_rate;
-	mutable Glib::Threads::RWLock lock;
-	BBTPointList                  _map;
+	/** A stretch of the map in which beats are evenly spaced.  A new
+	 *  segment starts at the beat where each tempo or meter change takes
+	 *  effect, so any beat can be computed from the segment it is in
+	 *  rather than stored.  Beats are numbered from 0 at 1|1|0.
+	 */
+	struct Segment {
+		double              frame;         ///< exact position of the first beat
+		double              beat_frames;   ///< length of each beat
+		int64_t             beat;          ///< number of the first beat
+		uint32_t            bar;           ///< bar of the first beat
+		uint32_t            bar_beat;      ///< beat within the bar of the first beat, from 1
+		uint32_t            beats_per_bar;
+		const MeterSection* meter;
+		const TempoSection* tempo;
+
+		framepos_t frame_of (int64_t b) const {
+			return llrint (frame + (b - beat) * beat_frames);
+		}
+	};
+
+	typedef std::vector<Segment> Segments;
+
+	struct SegmentBeatLess;
+	struct SegmentFrameLess;
+	struct SegmentBBTLess;
+
+	Metrics                          metrics;
+	framecnt_t                       _frame_rate;
+	mutable Glib::Threads::RWLock    lock;
+	Segments                         _segments;
+	std::vector<const TempoSection*> _tempos;
 
-	void recompute_map (bool reassign_tempo_bbt, framepos_t end = -1);
-	void extend_map (framepos_t end);
-	void require_map_to (framepos_t pos);
-	void require_map_to (const Timecode::BBT_Time&);
-	void _extend_map (TempoSection* tempo, MeterSection* meter,
-	                  Metrics::iterator next_metric,
-	                  Timecode::BBT_Time current, framepos_t current_frame, framepos_t end);
+	void recompute_map (bool reassign_tempo_bbt);
 
-	BBTPointList::const_iterator bbt_before_or_at (framepos_t);
-	BBTPointList::const_iterator bbt_before_or_at (const Timecode::BBT_Time&);
-	BBTPointList::const_iterator bbt_after_or_at (framepos_t);
+	Segments::const_iterator segment_for_beat (int64_t beat) const;
+	BBTPoint point_at (int64_t beat) const;
+	int64_t  beat_before_or_at (framepos_t) const;
+	int64_t  beat_before_or_at (const Timecode::BBT_Time&) const;
+	int64_t  beat_after_or_at (framepos_t) const;
 
 	framepos_t round_to_type (framepos_t fr, RoundMode dir, BBTPointType);
-	void bbt_time (framepos_t, Timecode::BBT_Time&, const BBTPointList::const_iterator&);
+	void bbt_time (framepos_t, Timecode::BBT_Time&, int64_t beat);
 	framecnt_t bbt_duration_at_unlocked (const Timecode::BBT_Time& when, const Timecode::BBT_Time& bbt, int dir);
 
 	const MeterSection& first_meter() const;
@@ -128,6 +128,7 @@ class LIBARDOUR_API Track : public Route, public PublicDiskstream
 	float playback_buffer_load () const;
 	float capture_buffer_load () const;
 	int do_refill ();
+	void prefetch ();
 	int do_flush (RunContext, bool force = false);
 	void set_pending_overwrite (bool);
 	int seek (framepos_t, bool complete_refill = false);
@@ -22,15 +22,17 @@
 
 #include <stdint.h>
 
+#include <glib.h>
 #include <glibmm/threads.h>
 
 #include "pbd/ringbuffer.h"
-#include "pbd/semaphore.h"
 
 #include "ardour/libardour_visibility.h"
 
 namespace ARDOUR {
 
+class WorkerPool;
+
 /**
    An object that needs to schedule non-RT work in the audio thread.
 */
@@ -50,7 +52,13 @@ public:
 };
 
 /**
-   A worker thread for non-realtime tasks scheduled in the audio thread.
+   A queue of non-realtime work scheduled by one Workee in the audio thread.
+
+   Workers do not own a thread: all of them are serviced by a small shared
+   pool of threads, which exists for as long as any Worker does.  The
+   request and response rings stay per-Worker, so the audio thread never
+   takes a lock, and each Worker is serviced by at most one pool thread at
+   a time, so a Workee's work() calls are never concurrent.
 */
 class LIBARDOUR_API Worker
 {
@@ -76,7 +84,15 @@ public:
 	void emit_responses();
 
 private:
-	void run();
+	friend class WorkerPool;
+
+	/**
+	   Run all of the requests that are currently queued (pool thread).
+	   @param buf scratch buffer, grown as required
+	   @param buf_size size of @a buf
+	*/
+	void run(void*& buf, size_t& buf_size);
+
 	/**
 	   Peek in RB, get size and check if a block of 'size' is available.
 
@@ -92,10 +108,19 @@ private:
 	RingBuffer<uint8_t>*   _requests;
 	RingBuffer<uint8_t>*   _responses;
 	uint8_t*               _response;
-	PBD::Semaphore         _sem;
 	bool                   _exit;
-	Glib::Threads::Thread* _thread;
-
+	WorkerPool*            _pool;
+
+	/** 1 while this Worker is waiting for, or being serviced by, a pool thread */
+	gint                   _queued;
+	/** number of pool threads in run(); more than one only briefly, while
+	    a thread that has handed us back is leaving run() */
+	gint                   _servicing;
+	/** protects the last change of _servicing, which is signalled on _idle */
+	Glib::Threads::Mutex   _servicing_lock;
+	Glib::Threads::Cond    _idle;
+	/** next Worker in the pool's list of Workers with pending requests */
+	Worker*                _next_queued;
 };
 
 } // namespace ARDOUR
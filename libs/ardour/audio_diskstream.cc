@@ -65,6 +65,7 @@ using namespace PBD;
 
 Sample* AudioDiskstream::_mixdown_buffer       = 0;
 gain_t* AudioDiskstream::_gain_buffer          = 0;
+Glib::Threads::Private<AudioDiskstream::WorkingBuffers> AudioDiskstream::_thread_working_buffers (AudioDiskstream::release_thread_working_buffers);
 
 AudioDiskstream::AudioDiskstream (Session &sess, const string &name, Diskstream::Flag flag)
 	: Diskstream(sess, name, flag)
@@ -151,6 +152,45 @@ AudioDiskstream::free_working_buffers()
 	_gain_buffer          = 0;
 }
 
+AudioDiskstream::WorkingBuffers::WorkingBuffers ()
+	: mixdown_buffer (new Sample[2*1048576])
+	, gain_buffer (new gain_t[2*1048576])
+{
+}
+
+AudioDiskstream::WorkingBuffers::~WorkingBuffers ()
+{
+	delete [] mixdown_buffer;
+	delete [] gain_buffer;
+}
+
+void
+AudioDiskstream::release_thread_working_buffers (void* arg)
+{
+	delete (WorkingBuffers*) arg;
+}
+
+void
+AudioDiskstream::allocate_thread_working_buffers ()
+{
+	if (!_thread_working_buffers.get ()) {
+		_thread_working_buffers.set (new WorkingBuffers);
+	}
+}
+
+int
+AudioDiskstream::do_refill ()
+{
+	WorkingBuffers* wb = _thread_working_buffers.get ();
+
+	if (wb) {
+		return _do_refill (wb->mixdown_buffer, wb->gain_buffer, 0);
+	}
+
+	/* the butler thread uses the shared buffers */
+	return _do_refill (_mixdown_buffer, _gain_buffer, 0);
+}
+
 void
 AudioDiskstream::non_realtime_input_change ()
 {
@@ -1245,23 +1285,7 @@ AudioDiskstream::_do_refill (Sample* mixdown_buffer, float* gain_buffer, framecn
 	}
 
 	framepos_t file_frame_tmp = 0;
-
-	/* total_space is in samples. We want to optimize read sizes in various sizes using bytes */
-
-	const size_t bits_per_sample = format_data_width (_session.config.get_native_file_data_format());
-	size_t total_bytes = total_space * bits_per_sample / 8;
-
-	/* chunk size range is 256kB to 4MB. Bigger is faster in terms of MB/sec, but bigger chunk size always takes longer
-	 */
-	size_t byte_size_for_read = max ((size_t) (256 * 1024), min ((size_t) (4 * 1048576), total_bytes));
-
-	/* find nearest (lower) multiple of 16384 */
-
-	byte_size_for_read = (byte_size_for_read / 16384) * 16384;
-
-	/* now back to samples */
-
-	framecnt_t samples_to_read = byte_size_for_read / (bits_per_sample / 8);
+	framecnt_t samples_to_read = refill_read_size (total_space);
 
 	//cerr << name() << " will read " << byte_size_for_read << " out of total bytes " << total_bytes << " in buffer of "
 	// << c->front()->playback_buf->bufsize() * bits_per_sample / 8 << " bps = " << bits_per_sample << endl;
@@ -1363,6 +1387,94 @@ AudioDiskstream::_do_refill (Sample* mixdown_buffer, float* gain_buffer, framecn
 	return ret;
 }
 
+/** @return the number of samples per channel that _do_refill() will try to
+ *  read when there are @param total_space samples of room in the playback buffers.
+ */
+framecnt_t
+AudioDiskstream::refill_read_size (framecnt_t total_space) const
+{
+	/* total_space is in samples. We want to optimize read sizes in various sizes using bytes */
+
+	const size_t bits_per_sample = format_data_width (_session.config.get_native_file_data_format());
+	size_t total_bytes = total_space * bits_per_sample / 8;
+
+	/* chunk size range is 256kB to 4MB. Bigger is faster in terms of MB/sec, but bigger chunk size always takes longer
+	 */
+	size_t byte_size_for_read = max ((size_t) (256 * 1024), min ((size_t) (4 * 1048576), total_bytes));
+
+	/* find nearest (lower) multiple of 16384 */
+
+	byte_size_for_read = (byte_size_for_read / 16384) * 16384;
+
+	/* now back to samples */
+
+	return byte_size_for_read / (bits_per_sample / 8);
+}
+
+/** Ask the sources behind our playlist to start fetching the data that the
+ *  next refill will read.  This only issues hints, so the butler can call it
+ *  for every track before refilling any of them and let the OS queue up all
+ *  the reads at once.
+ */
+void
+AudioDiskstream::prefetch ()
+{
+	boost::shared_ptr<ChannelList> c = channels.reader();
+
+	if ((_session.state_of_the_state() & Session::Loading) || c->empty()) {
+		return;
+	}
+
+	boost::shared_ptr<AudioPlaylist> pl = audio_playlist ();
+
+	if (!pl) {
+		return;
+	}
+
+	framecnt_t const total_space = c->front()->playback_buf->write_space ();
+
+	if (total_space < disk_read_chunk_frames) {
+		/* _do_refill() won't read anything either */
+		return;
+	}
+
+	bool const reversed = (_visible_speed * _session.transport_speed()) < 0.0f;
+	framecnt_t cnt = min (total_space, refill_read_size (total_space));
+	framepos_t start = file_frame;
+
+	if (reversed) {
+		cnt = min (cnt, start);
+		start -= cnt;
+	} else {
+		if (start == max_framepos) {
+			return;
+		}
+
+		cnt = min (cnt, max_framepos - start);
+
+		Location* loc = loop_location;
+
+		if (loc) {
+			framepos_t const loop_start = loc->start();
+			framepos_t const loop_end = loc->end();
+
+			if (start >= loop_end && loop_end > loop_start) {
+				start = loop_start + ((start - loop_start) % (loop_end - loop_start));
+			}
+
+			cnt = min (cnt, loop_end - start);
+		}
+	}
+
+	if (cnt <= 0) {
+		return;
+	}
+
+	for (uint32_t n = 0; n < c->size(); ++n) {
+		pl->prefetch (start, cnt, n);
+	}
+}
+
 /** Flush pending data to disk.
  *
  * Important note: this function will write *AT MOST* disk_write_chunk_frames
@@ -256,6 +256,25 @@ AudioPlaylist::read (Sample *buf, Sample *mixdown_buffer, float *gain_buffer, fr
 	return cnt;
 }
 
+/** Hint to the sources of the regions under [@param start, @param start + @param cnt)
+ *  that channel @param chan_n is about to be read.
+ */
+void
+AudioPlaylist::prefetch (framepos_t start, framecnt_t cnt, uint32_t chan_n)
+{
+	Playlist::RegionReadLock rl (this);
+
+	boost::shared_ptr<RegionList> all = regions_touched_locked (start, start + cnt - 1);
+
+	for (RegionList::iterator i = all->begin(); i != all->end(); ++i) {
+		boost::shared_ptr<AudioRegion> ar = boost::dynamic_pointer_cast<AudioRegion> (*i);
+
+		if (ar && !ar->muted()) {
+			ar->prefetch (start, cnt, chan_n);
+		}
+	}
+}
+
 void
 AudioPlaylist::dump () const
 {
@@ -298,6 +317,7 @@ AudioPlaylist::destroy_region (boost::shared_ptr<Region> region)
 
 			if ((*i) == region) {
 				regions.erase (i);
+				_region_index.invalidate ();
 				changed = true;
 			}
 
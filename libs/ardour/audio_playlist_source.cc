@@ -145,6 +145,8 @@ AudioPlaylistSource::read_unlocked (Sample* dst, framepos_t start, framecnt_t cn
 		to_zero = 0;
 	}
 
+	boost::shared_ptr<Glib::Threads::Mutex> read_lock;
+
 	{
 		/* Don't need to hold the lock for the actual read, and
 		   actually, we cannot, but we do want to interlock
@@ -154,9 +156,17 @@ AudioPlaylistSource::read_unlocked (Sample* dst, framepos_t start, framecnt_t cn
 		Glib::Threads::Mutex::Lock lm (_level_buffer_lock);
 		sbuf = _mixdown_buffers[_level-1];
 		gbuf = _gain_buffers[_level-1];
+		read_lock = _level_read_locks[_level-1];
 	}
 
-	boost::dynamic_pointer_cast<AudioPlaylist>(_playlist)->read (dst, sbuf.get(), gbuf.get(), start+_playlist_offset, to_read, _playlist_channel);
+	{
+		/* the butler may refill several diskstreams at once, so
+		   serialize use of this level's buffers. Nested sources
+		   only ever take the lock for a deeper level.
+		*/
+		Glib::Threads::Mutex::Lock lm (*read_lock);
+		boost::dynamic_pointer_cast<AudioPlaylist>(_playlist)->read (dst, sbuf.get(), gbuf.get(), start+_playlist_offset, to_read, _playlist_channel);
+	}
 
 	if (to_zero) {
 		memset (dst+to_read, 0, sizeof (Sample) * to_zero);
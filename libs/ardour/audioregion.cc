@@ -768,6 +768,35 @@ AudioRegion::read_from_sources (SourceList const & srcs, framecnt_t limit, Sampl
 	return to_read;
 }
 
+/** Pass on a hint that the part of this region within [@param position, @param position + @param cnt)
+ *  (in session frames) is about to be read by read_at() for channel @param chan_n.
+ */
+void
+AudioRegion::prefetch (framepos_t position, framecnt_t cnt, uint32_t chan_n) const
+{
+	if (n_channels() == 0) {
+		return;
+	}
+
+	framepos_t const from = max (position, _position.val());
+	framepos_t const to = min (position + cnt, _position.val() + _length.val());
+
+	if (from >= to) {
+		return;
+	}
+
+	uint32_t channel = chan_n;
+
+	if (chan_n >= n_channels()) {
+		if (!Config->get_replicate_missing_region_channels()) {
+			return;
+		}
+		channel = chan_n % n_channels();
+	}
+
+	audio_source (channel)->prefetch (_start + (from - _position), to - from);
+}
+
 XMLNode&
 AudioRegion::get_basic_state ()
 {
@@ -27,6 +27,7 @@
 #include <fcntl.h>
 #include <float.h>
 #include <cerrno>
+#include <cstring>
 #include <ctime>
 #include <cmath>
 #include <iomanip>
@@ -69,6 +70,7 @@ using namespace PBD;
 Glib::Threads::Mutex AudioSource::_level_buffer_lock;
 vector<boost::shared_array<Sample> > AudioSource::_mixdown_buffers;
 vector<boost::shared_array<gain_t> > AudioSource::_gain_buffers;
+vector<boost::shared_ptr<Glib::Threads::Mutex> > AudioSource::_level_read_locks;
 bool AudioSource::_build_missing_peakfiles = false;
 
 /** true if we want peakfiles (e.g. if we are displaying a GUI) */
@@ -76,6 +78,21 @@ bool AudioSource::_build_peakfiles = false;
 
 #define _FPP 256
 
+/* each level holds one peak for every 16 of the level below */
+const framecnt_t AudioSource::peak_level_fpp[AudioSource::n_peak_levels] = { 4096, 65536 };
+
+/** Peak level files start with this header, which is followed by the
+ *  PeakData for the level, laid out just as in the peakfile itself.
+ */
+struct PeakLevelHeader {
+	char     magic[8];
+	uint32_t version;
+	uint32_t fpp;
+};
+
+static const char     peak_level_magic[8] = { 'A', 'R', 'D', 'P', 'E', 'A', 'K', 'S' };
+static const uint32_t peak_level_version = 1;
+
 AudioSource::AudioSource (Session& s, const string& name)
 	: Source (s, DataType::AUDIO, name)
 	, _length (0)
@@ -89,6 +106,8 @@ AudioSource::AudioSource (Session& s, const string& name)
 	, _last_scale (0.0)
 	, _last_map_off (0)
 	, _last_raw_map_length (0)
+	, _last_fpp (0)
+	, _peak_levels_missing (0)
 {
 }
 
@@ -105,6 +124,8 @@ AudioSource::AudioSource (Session& s, const XMLNode& node)
 	, _last_scale (0.0)
 	, _last_map_off (0)
 	, _last_raw_map_length (0)
+	, _last_fpp (0)
+	, _peak_levels_missing (0)
 {
 	if (set_state (node, Stateful::loading_state_version)) {
 		throw failed_constructor();
@@ -124,6 +145,8 @@ AudioSource::~AudioSource ()
 		_peakfile_fd = -1;
 	}
 
+	close_peak_levels ();
+
 	delete [] peak_leftovers;
 }
 
@@ -230,8 +253,21 @@ AudioSource::rename_peakfile (string newpath)
 		}
 	}
 
+	vector<string> old_level_paths;
+	for (uint32_t l = 0; l < n_peak_levels; ++l) {
+		old_level_paths.push_back (peak_level_path (l));
+	}
+
 	_peakpath = newpath;
 
+	for (uint32_t l = 0; l < n_peak_levels; ++l) {
+		/* the levels can always be rebuilt from the peakfile, so just drop them if they cannot be moved */
+		if (Glib::file_test (old_level_paths[l], Glib::FILE_TEST_EXISTS) && g_rename (old_level_paths[l].c_str(), peak_level_path (l).c_str()) != 0) {
+			::g_unlink (old_level_paths[l].c_str());
+			set_peak_level_bytes (l, 0);
+		}
+	}
+
 	return 0;
 }
 
@@ -307,6 +343,25 @@ AudioSource::initialize_peakfile (const string& audio_path, const bool in_sessio
 
 	if (!empty() && !_peaks_built && _build_missing_peakfiles && _build_peakfiles) {
 		build_peaks_from_scratch ();
+	} else if (_peaks_built) {
+
+		/* peakfiles written before there were peak levels (or whose
+		   levels are stale) just need their levels built, which only
+		   takes a pass over the peakfile. That is left to the peak-building
+		   threads (see SourceFactory); until then, reads use the peakfile.
+		*/
+
+		bool levels_ok = true;
+
+		for (uint32_t l = 0; l < n_peak_levels; ++l) {
+			if (!check_peak_level (l, statbuf.st_mtime)) {
+				levels_ok = false;
+			}
+		}
+
+		if (!levels_ok) {
+			g_atomic_int_set (&_peak_levels_missing, 1);
+		}
 	}
 
 	return 0;
@@ -397,10 +452,33 @@ AudioSource::read_peaks_with_fpp (PeakData *peaks, framecnt_t npeaks, framepos_t
 		}
 	}
 
-	ScopedFileDescriptor sfd (g_open (_peakpath.c_str(), O_RDONLY, 0444));
+	/* read from the coarsest peak level that is no coarser than what the
+	   caller wants, if it covers the range.
+	*/
+
+	string peakpath = _peakpath;
+	off_t  header = 0;
+
+	if (samples_per_file_peak == _FPP) {
+		for (int l = n_peak_levels - 1; l >= 0; --l) {
+			const framecnt_t level_fpp = peak_level_fpp[l];
+			const off_t      needed = (off_t) ceil (min (start + cnt, _length) / (double) level_fpp) * sizeof (PeakData);
+
+			if (samples_per_visual_peak >= level_fpp && peak_level_bytes (l) >= needed) {
+				DEBUG_TRACE (DEBUG::Peaks, string_compose ("reading peaks from level with %1 fpp\n", level_fpp));
+				peakpath = peak_level_path (l);
+				header = sizeof (PeakLevelHeader);
+				samples_per_file_peak = level_fpp;
+				expected_peaks = (cnt / (double) samples_per_file_peak);
+				break;
+			}
+		}
+	}
+
+	ScopedFileDescriptor sfd (g_open (peakpath.c_str(), O_RDONLY, 0444));
 
 	if (sfd < 0) {
-		error << string_compose (_("Cannot open peakfile @ %1 for reading (%2)"), _peakpath, strerror (errno)) << endmsg;
+		error << string_compose (_("Cannot open peakfile @ %1 for reading (%2)"), peakpath, strerror (errno)) << endmsg;
 		return -1;
 	}
 
@@ -453,12 +531,12 @@ AudioSource::read_peaks_with_fpp (PeakData *peaks, framecnt_t npeaks, framepos_t
 
 		DEBUG_TRACE (DEBUG::Peaks, "DIRECT PEAKS\n");
 
-		off_t  map_off =  first_peak_byte;
+		off_t  map_off =  header + first_peak_byte;
 		off_t  read_map_off = map_off & ~(bufsize - 1);
 		off_t  map_delta = map_off - read_map_off;
 		size_t map_length = bytes_to_read + map_delta;
 
-		if (_first_run  || (_last_scale != samples_per_visual_peak) || (_last_map_off != map_off) || (_last_raw_map_length  < bytes_to_read)) {
+		if (_first_run  || (_last_scale != samples_per_visual_peak) || (_last_map_off != map_off) || (_last_raw_map_length  < bytes_to_read) || (_last_fpp != samples_per_file_peak)) {
 			peak_cache.reset (new PeakData[npeaks]);
 			char* addr;
 #ifdef PLATFORM_WINDOWS
@@ -469,13 +547,13 @@ AudioSource::read_peaks_with_fpp (PeakData *peaks, framecnt_t npeaks, framepos_t
 
 			map_handle = CreateFileMapping(file_handle, NULL, PAGE_READONLY, 0, 0, NULL);
 			if (map_handle == NULL) {
-				error << string_compose (_("map failed - could not create file mapping for peakfile %1."), _peakpath) << endmsg;
+				error << string_compose (_("map failed - could not create file mapping for peakfile %1."), peakpath) << endmsg;
 				return -1;
 			}
 
 			view_handle = MapViewOfFile(map_handle, FILE_MAP_READ, 0, read_map_off, map_length);
 			if (view_handle == NULL) {
-				error << string_compose (_("map failed - could not map peakfile %1."), _peakpath) << endmsg;
+				error << string_compose (_("map failed - could not map peakfile %1."), peakpath) << endmsg;
 				return -1;
 			}
 
@@ -486,13 +564,13 @@ AudioSource::read_peaks_with_fpp (PeakData *peaks, framecnt_t npeaks, framepos_t
 			err_flag = UnmapViewOfFile (view_handle);
 			err_flag = CloseHandle(map_handle);
 			if(!err_flag) {
-				error << string_compose (_("unmap failed - could not unmap peakfile %1."), _peakpath) << endmsg;
+				error << string_compose (_("unmap failed - could not unmap peakfile %1."), peakpath) << endmsg;
 				return -1;
 			}
 #else
 			addr = (char*) mmap (0, map_length, PROT_READ, MAP_PRIVATE, sfd, read_map_off);
 			if (addr ==  MAP_FAILED) {
-				error << string_compose (_("map failed - could not mmap peakfile %1."), _peakpath) << endmsg;
+				error << string_compose (_("map failed - could not mmap peakfile %1."), peakpath) << endmsg;
 				return -1;
 			}
 
@@ -507,6 +585,7 @@ AudioSource::read_peaks_with_fpp (PeakData *peaks, framecnt_t npeaks, framepos_t
 			_last_scale = samples_per_visual_peak;
 			_last_map_off = map_off;
 			_last_raw_map_length = bytes_to_read;
+			_last_fpp = samples_per_file_peak;
 		}
 
 		memcpy ((void*)peaks, (void*)peak_cache.get(), npeaks * sizeof(PeakData));
@@ -545,13 +624,13 @@ AudioSource::read_peaks_with_fpp (PeakData *peaks, framecnt_t npeaks, framepos_t
 
 		/* open ... close during out: handling */
 
-		off_t  map_off =  (uint32_t) (ceil (start / (double) samples_per_file_peak)) * sizeof(PeakData);
+		off_t  map_off =  header + (uint32_t) (ceil (start / (double) samples_per_file_peak)) * sizeof(PeakData);
 		off_t  read_map_off = map_off & ~(bufsize - 1);
 		off_t  map_delta = map_off - read_map_off;
 		size_t raw_map_length = chunksize * sizeof(PeakData);
 		size_t map_length = (chunksize * sizeof(PeakData)) + map_delta;
 
-		if (_first_run || (_last_scale != samples_per_visual_peak) || (_last_map_off != map_off) || (_last_raw_map_length < raw_map_length)) {
+		if (_first_run || (_last_scale != samples_per_visual_peak) || (_last_map_off != map_off) || (_last_raw_map_length < raw_map_length) || (_last_fpp != samples_per_file_peak)) {
 			peak_cache.reset (new PeakData[npeaks]);
 			boost::scoped_array<PeakData> staging (new PeakData[chunksize]);
 
@@ -564,13 +643,13 @@ AudioSource::read_peaks_with_fpp (PeakData *peaks, framecnt_t npeaks, framepos_t
 
 			map_handle = CreateFileMapping(file_handle, NULL, PAGE_READONLY, 0, 0, NULL);
 			if (map_handle == NULL) {
-				error << string_compose (_("map failed - could not create file mapping for peakfile %1."), _peakpath) << endmsg;
+				error << string_compose (_("map failed - could not create file mapping for peakfile %1."), peakpath) << endmsg;
 				return -1;
 			}
 
 			view_handle = MapViewOfFile(map_handle, FILE_MAP_READ, 0, read_map_off, map_length);
 			if (view_handle == NULL) {
-				error << string_compose (_("map failed - could not map peakfile %1."), _peakpath) << endmsg;
+				error << string_compose (_("map failed - could not map peakfile %1."), peakpath) << endmsg;
 				return -1;
 			}
 
@@ -581,13 +660,13 @@ AudioSource::read_peaks_with_fpp (PeakData *peaks, framecnt_t npeaks, framepos_t
 			err_flag = UnmapViewOfFile (view_handle);
 			err_flag = CloseHandle(map_handle);
 			if(!err_flag) {
-				error << string_compose (_("unmap failed - could not unmap peakfile %1."), _peakpath) << endmsg;
+				error << string_compose (_("unmap failed - could not unmap peakfile %1."), peakpath) << endmsg;
 				return -1;
 			}
 #else
 			addr = (char*) mmap (0, map_length, PROT_READ, MAP_PRIVATE, sfd, read_map_off);
 			if (addr ==  MAP_FAILED) {
-				error << string_compose (_("map failed - could not mmap peakfile %1."), _peakpath) << endmsg;
+				error << string_compose (_("map failed - could not mmap peakfile %1."), peakpath) << endmsg;
 				return -1;
 			}
 
@@ -623,6 +702,7 @@ AudioSource::read_peaks_with_fpp (PeakData *peaks, framecnt_t npeaks, framepos_t
 			_last_scale = samples_per_visual_peak;
 			_last_map_off = map_off;
 			_last_raw_map_length = raw_map_length;
+			_last_fpp = samples_per_file_peak;
 		}
 
 		memcpy ((void*)peaks, (void*)peak_cache.get(), npeaks * sizeof(PeakData));
@@ -783,6 +863,10 @@ AudioSource::build_peaks_from_scratch ()
 	if (ret) {
 		DEBUG_TRACE (DEBUG::Peaks, string_compose("Could not write peak data, attempting to remove peakfile %1\n", _peakpath));
 		::g_unlink (_peakpath.c_str());
+		for (uint32_t l = 0; l < n_peak_levels; ++l) {
+			::g_unlink (peak_level_path (l).c_str());
+			set_peak_level_bytes (l, 0);
+		}
 	}
 
 	return ret;
@@ -796,8 +880,13 @@ AudioSource::close_peakfile ()
 		close (_peakfile_fd);
 		_peakfile_fd = -1;
 	}
+	close_peak_levels ();
 	if (!_peakpath.empty()) {
 		::g_unlink (_peakpath.c_str());
+		for (uint32_t l = 0; l < n_peak_levels; ++l) {
+			::g_unlink (peak_level_path (l).c_str());
+			set_peak_level_bytes (l, 0);
+		}
 	}
 	_peaks_built = false;
 	return 0;
@@ -814,6 +903,9 @@ AudioSource::prepare_for_peakfile_writes ()
 		error << string_compose(_("AudioSource: cannot open _peakpath (c) \"%1\" (%2)"), _peakpath, strerror (errno)) << endmsg;
 		return -1;
 	}
+
+	open_peak_levels ();
+
 	return 0;
 }
 
@@ -825,6 +917,7 @@ AudioSource::done_with_peakfile_writes (bool done)
 			close (_peakfile_fd);
 			_peakfile_fd = -1;
 		}
+		close_peak_levels ();
 		return;
 	}
 
@@ -840,6 +933,8 @@ AudioSource::done_with_peakfile_writes (bool done)
 
 	close (_peakfile_fd);
 	_peakfile_fd = -1;
+
+	close_peak_levels ();
 }
 
 /** @param first_frame Offset from the source start of the first frame to
@@ -901,6 +996,10 @@ AudioSource::compute_and_write_peaks (Sample* buf, framecnt_t first_frame, frame
 
 			_peak_byte_max = max (_peak_byte_max, (off_t) (byte + sizeof(PeakData)));
 
+			if (fpp == _FPP && write_peak_levels (&x, 1, peak_leftover_frame / fpp)) {
+				return -1;
+			}
+
 			{
 				Glib::Threads::Mutex::Lock lm (_peaks_ready_lock);
 				PeakRangeReady (peak_leftover_frame, peak_leftover_cnt); /* EMIT SIGNAL */
@@ -1027,6 +1126,10 @@ AudioSource::compute_and_write_peaks (Sample* buf, framecnt_t first_frame, frame
 
 	_peak_byte_max = max (_peak_byte_max, (off_t) (first_peak_byte + bytes_to_write));
 
+	if (fpp == _FPP && peaks_computed && write_peak_levels (peakbuf.get(), peaks_computed, first_frame / fpp)) {
+		return -1;
+	}
+
 	if (frames_done) {
 		Glib::Threads::Mutex::Lock lm (_peaks_ready_lock);
 		PeakRangeReady (first_frame, frames_done); /* EMIT SIGNAL */
@@ -1058,6 +1161,264 @@ AudioSource::truncate_peakfile ()
 						 _peakpath, _peak_byte_max, errno) << endmsg;
 		}
 	}
+
+	for (uint32_t l = 0; l < n_peak_levels; ++l) {
+		PeakLevel& lvl (_peak_levels[l]);
+		if (lvl.fd >= 0 && lseek (lvl.fd, 0, SEEK_END) > (off_t) sizeof (PeakLevelHeader) + peak_level_bytes (l)) {
+			if (ftruncate (lvl.fd, sizeof (PeakLevelHeader) + peak_level_bytes (l))) {
+				/* the level is still usable as far as its valid peaks go */
+			}
+		}
+	}
+}
+
+std::string
+AudioSource::peak_level_path (uint32_t level) const
+{
+	return string_compose ("%1.%2", _peakpath, peak_level_fpp[level]);
+}
+
+/** Check that the file for peak level @a level belongs with the peakfile,
+ *  and if so, note how much of it we can use.
+ */
+bool
+AudioSource::check_peak_level (uint32_t level, time_t peakfile_mtime)
+{
+	const string path = peak_level_path (level);
+	GStatBuf statbuf;
+	PeakLevelHeader h;
+
+	set_peak_level_bytes (level, 0);
+
+	if (g_stat (path.c_str(), &statbuf) || statbuf.st_size < (off_t) sizeof (PeakLevelHeader)) {
+		return false;
+	}
+
+	/* the levels are written along with the peakfile, so one much older
+	   than the peakfile was left behind when the peakfile was rebuilt.
+	*/
+
+	if (peakfile_mtime > statbuf.st_mtime && (peakfile_mtime - statbuf.st_mtime > 6)) {
+		return false;
+	}
+
+	{
+		ScopedFileDescriptor sfd (g_open (path.c_str(), O_RDONLY, 0444));
+
+		if (sfd < 0 || ::read (sfd, &h, sizeof (h)) != sizeof (h)) {
+			return false;
+		}
+	}
+
+	if (memcmp (h.magic, peak_level_magic, sizeof (h.magic)) || h.version != peak_level_version || h.fpp != peak_level_fpp[level]) {
+		DEBUG_TRACE (DEBUG::Peaks, string_compose ("Peak level %1 has an unknown format\n", path));
+		return false;
+	}
+
+	const off_t data = statbuf.st_size - sizeof (PeakLevelHeader);
+	const off_t needed = ((_peak_byte_max / sizeof (PeakData)) / (peak_level_fpp[level] / _FPP)) * sizeof (PeakData);
+
+	if (data < needed) {
+		return false;
+	}
+
+	set_peak_level_bytes (level, data);
+	return true;
+}
+
+/** Open the peak level files for writing, starting any that are missing or
+ *  have an unknown format.  Levels are optional, so failures are not fatal.
+ */
+void
+AudioSource::open_peak_levels ()
+{
+	for (uint32_t l = 0; l < n_peak_levels; ++l) {
+
+		PeakLevel& lvl (_peak_levels[l]);
+
+		if (lvl.fd >= 0) {
+			continue;
+		}
+
+		const string path = peak_level_path (l);
+
+		if ((lvl.fd = g_open (path.c_str(), O_CREAT|O_RDWR, 0664)) < 0) {
+			warning << string_compose(_("AudioSource: cannot open peak level file \"%1\" (%2)"), path, strerror (errno)) << endmsg;
+			set_peak_level_bytes (l, 0);
+			continue;
+		}
+
+		lvl.pending_index = -1;
+
+		PeakLevelHeader h;
+
+		if (::read (lvl.fd, &h, sizeof (h)) != sizeof (h) ||
+		    memcmp (h.magic, peak_level_magic, sizeof (h.magic)) || h.version != peak_level_version || h.fpp != peak_level_fpp[l]) {
+
+			memcpy (h.magic, peak_level_magic, sizeof (h.magic));
+			h.version = peak_level_version;
+			h.fpp = peak_level_fpp[l];
+
+			set_peak_level_bytes (l, 0);
+
+			if (ftruncate (lvl.fd, 0) || lseek (lvl.fd, 0, SEEK_SET) != 0 || ::write (lvl.fd, &h, sizeof (h)) != sizeof (h)) {
+				warning << string_compose(_("AudioSource: cannot write peak level file \"%1\" (%2)"), path, strerror (errno)) << endmsg;
+				close (lvl.fd);
+				lvl.fd = -1;
+			}
+		}
+	}
+}
+
+void
+AudioSource::close_peak_levels ()
+{
+	for (uint32_t l = 0; l < n_peak_levels; ++l) {
+		if (_peak_levels[l].fd >= 0) {
+			close (_peak_levels[l].fd);
+			_peak_levels[l].fd = -1;
+		}
+		_peak_levels[l].pending_index = -1;
+	}
+}
+
+/** Fold @a npeaks consecutive peakfile peaks, the first of which has index
+ *  @a first_peak, into each of the peak levels.  A level's peak is written
+ *  out even while it is only partly accumulated, so the level files are
+ *  always as up to date as the peakfile (e.g. during capture).
+ */
+int
+AudioSource::write_peak_levels (PeakData const * peaks, framecnt_t npeaks, framepos_t first_peak)
+{
+	vector<PeakData> out;
+
+	for (uint32_t l = 0; l < n_peak_levels; ++l) {
+
+		PeakLevel& lvl (_peak_levels[l]);
+
+		if (lvl.fd < 0) {
+			continue;
+		}
+
+		const framecnt_t ratio = peak_level_fpp[l] / _FPP;
+		const framepos_t first = first_peak / ratio;
+
+		if (lvl.pending_index != first) {
+
+			/* not carrying on from where we left off: start this
+			   level's peak from whatever has already been written for it.
+			*/
+
+			lvl.pending_index = first;
+			lvl.pending.min = FLT_MAX;
+			lvl.pending.max = -FLT_MAX;
+
+			const off_t byte = sizeof (PeakLevelHeader) + first * sizeof (PeakData);
+
+			if ((first_peak % ratio) && (first + 1) * (off_t) sizeof (PeakData) <= peak_level_bytes (l)) {
+				PeakData stored;
+				if (lseek (lvl.fd, byte, SEEK_SET) == byte && ::read (lvl.fd, &stored, sizeof (stored)) == sizeof (stored)) {
+					lvl.pending = stored;
+				}
+			}
+		}
+
+		out.clear ();
+
+		for (framecnt_t n = 0; n < npeaks; ++n) {
+			const framepos_t index = (first_peak + n) / ratio;
+
+			if (index != lvl.pending_index) {
+				out.push_back (lvl.pending);
+				lvl.pending_index = index;
+				lvl.pending = peaks[n];
+			} else {
+				lvl.pending.max = max (lvl.pending.max, peaks[n].max);
+				lvl.pending.min = min (lvl.pending.min, peaks[n].min);
+			}
+		}
+
+		out.push_back (lvl.pending);
+
+		const off_t   byte = sizeof (PeakLevelHeader) + first * sizeof (PeakData);
+		const ssize_t bytes_to_write = out.size() * sizeof (PeakData);
+
+		if (lseek (lvl.fd, byte, SEEK_SET) != byte || ::write (lvl.fd, &out[0], bytes_to_write) != bytes_to_write) {
+			error << string_compose(_("%1: could not write peak level data (%2)"), _name, strerror (errno)) << endmsg;
+			return -1;
+		}
+
+		set_peak_level_bytes (l, max (peak_level_bytes (l), (off_t) (first * sizeof (PeakData) + bytes_to_write)));
+	}
+
+	return 0;
+}
+
+/** Build the peak levels if initialize_peakfile() found that they were
+ *  missing; called from a peak-building thread.
+ */
+int
+AudioSource::build_missing_peak_levels ()
+{
+	if (!g_atomic_int_compare_and_exchange (&_peak_levels_missing, 1, 0)) {
+		return 0;
+	}
+
+	return build_peak_levels_from_peakfile ();
+}
+
+/** Build the peak levels from an existing peakfile. */
+int
+AudioSource::build_peak_levels_from_peakfile ()
+{
+	const framecnt_t chunk = 16384; // peaks per read
+
+	Glib::Threads::Mutex::Lock lp (_lock);
+
+	DEBUG_TRACE (DEBUG::Peaks, string_compose ("Building peak levels from %1\n", _peakpath));
+
+	ScopedFileDescriptor sfd (g_open (_peakpath.c_str(), O_RDONLY, 0444));
+
+	if (sfd < 0) {
+		return -1;
+	}
+
+	/* start the levels afresh */
+
+	for (uint32_t l = 0; l < n_peak_levels; ++l) {
+		::g_unlink (peak_level_path (l).c_str());
+		set_peak_level_bytes (l, 0);
+	}
+
+	open_peak_levels ();
+
+	boost::scoped_array<PeakData> buf (new PeakData[chunk]);
+	const framecnt_t total = _peak_byte_max / sizeof (PeakData);
+	framepos_t first = 0;
+	int ret = 0;
+
+	while (first < total) {
+		const framecnt_t n = min (chunk, total - first);
+		const ssize_t bytes = n * sizeof (PeakData);
+
+		if (::read (sfd, buf.get(), bytes) != bytes || write_peak_levels (buf.get(), n, first)) {
+			ret = -1;
+			break;
+		}
+
+		first += n;
+	}
+
+	close_peak_levels ();
+
+	if (ret) {
+		for (uint32_t l = 0; l < n_peak_levels; ++l) {
+			::g_unlink (peak_level_path (l).c_str());
+			set_peak_level_bytes (l, 0);
+		}
+	}
+
+	return ret;
 }
 
 framecnt_t
@@ -1127,9 +1488,11 @@ AudioSource::ensure_buffers_for_level_locked (uint32_t level, framecnt_t frame_r
 
 	_mixdown_buffers.clear ();
 	_gain_buffers.clear ();
+	_level_read_locks.clear ();
 
 	for (uint32_t n = 0; n < limit; ++n) {
 		_mixdown_buffers.push_back (boost::shared_array<Sample> (new Sample[nframes]));
 		_gain_buffers.push_back (boost::shared_array<gain_t> (new gain_t[nframes]));
+		_level_read_locks.push_back (boost::shared_ptr<Glib::Threads::Mutex> (new Glib::Threads::Mutex));
 	}
 }
@@ -238,11 +238,11 @@ Automatable::set_automation_xml_state (const XMLNode& node, Evoral::Parameter le
 			boost::shared_ptr<AutomationControl> existing = automation_control (param);
 
 			if (existing) {
-                                existing->alist()->set_state (**niter, 3000);
+                                existing->alist()->set_state (**niter, 3000, _a_session.automation_dir ());
 			} else {
                                 boost::shared_ptr<Evoral::Control> newcontrol = control_factory(param);
 				add_control (newcontrol);
-                                boost::shared_ptr<AutomationList> al (new AutomationList(**niter, param));
+                                boost::shared_ptr<AutomationList> al (new AutomationList(**niter, param, _a_session.automation_dir ()));
 				newcontrol->set_list(al);
 			}
 
@@ -254,8 +254,12 @@ Automatable::set_automation_xml_state (const XMLNode& node, Evoral::Parameter le
 	return 0;
 }
 
+/** @param full true for session state, false for a template.  Templates are
+ *  used by other sessions, so only session state may refer to event files
+ *  in this session's automation folder.
+ */
 XMLNode&
-Automatable::get_automation_xml_state ()
+Automatable::get_automation_xml_state (bool full)
 {
 	Glib::Threads::Mutex::Lock lm (control_lock());
 	XMLNode* node = new XMLNode (Automatable::xml_node_name);
@@ -264,10 +268,16 @@ Automatable::get_automation_xml_state ()
 		return *node;
 	}
 
+	std::string event_file_dir;
+
+	if (full && _a_session.config.get_automation_event_files ()) {
+		event_file_dir = _a_session.automation_dir ();
+	}
+
 	for (Controls::iterator li = controls().begin(); li != controls().end(); ++li) {
 		boost::shared_ptr<AutomationList> l = boost::dynamic_pointer_cast<AutomationList>(li->second->list());
 		if (l && !l->empty()) {
-			node->add_child_nocopy (l->get_state ());
+			node->add_child_nocopy (l->state (true, event_file_dir));
 		}
 	}
 
@@ -517,26 +527,35 @@ Automatable::find_next_event (double now, double end, Evoral::ControlEvent& next
 			continue;
 		}
 
-		Evoral::ControlList::const_iterator i;
-		boost::shared_ptr<const Evoral::ControlList> alist (li->second->list());
-		Evoral::ControlEvent cp (now, 0.0f);
-		if (!alist) {
-			continue;
-		}
+		find_next_ac_event (li->second, now, end, next_event);
+	}
 
-		for (i = lower_bound (alist->begin(), alist->end(), &cp, Evoral::ControlList::time_comparator);
-		     i != alist->end() && (*i)->when < end; ++i) {
-			if ((*i)->when > now) {
-				break;
-			}
-		}
+	return next_event.when != std::numeric_limits<double>::max();
+}
 
-		if (i != alist->end() && (*i)->when < end) {
-			if ((*i)->when < next_event.when) {
-				next_event.when = (*i)->when;
-			}
+/** Move @a next_event back to the first event of @a c's list in (now, end), if
+ *  it has one earlier than @a next_event.
+ */
+void
+Automatable::find_next_ac_event (boost::shared_ptr<Evoral::Control> c, double now, double end, Evoral::ControlEvent& next_event) const
+{
+	Evoral::ControlList::const_iterator i;
+	boost::shared_ptr<const Evoral::ControlList> alist (c->list());
+	Evoral::ControlEvent cp (now, 0.0f);
+	if (!alist) {
+		return;
+	}
+
+	for (i = lower_bound (alist->begin(), alist->end(), &cp, Evoral::ControlList::time_comparator);
+	     i != alist->end() && (*i)->when < end; ++i) {
+		if ((*i)->when > now) {
+			break;
 		}
 	}
 
-	return next_event.when != std::numeric_limits<double>::max();
+	if (i != alist->end() && (*i)->when < end) {
+		if ((*i)->when < next_event.when) {
+			next_event.when = (*i)->when;
+		}
+	}
 }
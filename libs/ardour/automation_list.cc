@@ -18,11 +18,19 @@
 */
 
 #include <set>
+#include <vector>
+#include <cerrno>
 #include <climits>
+#include <cstring>
 #include <float.h>
 #include <cmath>
 #include <sstream>
 #include <algorithm>
+
+#include <glib/gstdio.h>
+#include <glibmm/fileutils.h>
+#include <glibmm/miscutils.h>
+
 #include "ardour/automation_list.h"
 #include "ardour/event_type_map.h"
 #include "ardour/parameter_descriptor.h"
@@ -38,6 +46,17 @@ using namespace PBD;
 
 PBD::Signal1<void,AutomationList *> AutomationList::AutomationListCreated;
 
+/* Lists with fewer points than this are always stored in the XML, where
+   they remain readable and do not cost a file each.
+*/
+static const size_t event_file_min_points = 256;
+
+/* An event file is this magic, followed by (when, value) pairs of
+   little-endian IEEE 754 doubles.
+*/
+static const char   event_file_magic[8] = { 'A', 'R', 'D', 'E', 'V', 'T', '0', '1' };
+static const size_t event_file_point_size = 2 * sizeof (uint64_t);
+
 #if 0
 static void dumpit (const AutomationList& al, string prefix = "")
 {
@@ -104,14 +123,14 @@ AutomationList::AutomationList (const AutomationList& other, double start, doubl
 /** @param id is used for legacy sessions where the type is not present
  * in or below the AutomationList node.  It is used if @param id is non-null.
  */
-AutomationList::AutomationList (const XMLNode& node, Evoral::Parameter id)
+AutomationList::AutomationList (const XMLNode& node, Evoral::Parameter id, const std::string& event_file_dir)
 	: ControlList(id, ARDOUR::ParameterDescriptor(id))
 {
 	g_atomic_int_set (&_touching, 0);
 	_state = Off;
 	_style = Absolute;
 
-	set_state (node, Stateful::loading_state_version);
+	set_state (node, Stateful::loading_state_version, event_file_dir);
 
 	if (id) {
 		_parameter = id;
@@ -250,7 +269,7 @@ AutomationList::get_state ()
 }
 
 XMLNode&
-AutomationList::state (bool full)
+AutomationList::state (bool full, const std::string& event_file_dir)
 {
 	XMLNode* root = new XMLNode (X_("AutomationList"));
 	char buf[64];
@@ -290,16 +309,26 @@ AutomationList::state (bool full)
 	root->add_property ("style", auto_style_to_string (_style));
 
 	if (!_events.empty()) {
-		root->add_child_nocopy (serialize_events());
+		root->add_child_nocopy (serialize_events (event_file_dir));
 	}
 
 	return *root;
 }
 
 XMLNode&
-AutomationList::serialize_events ()
+AutomationList::serialize_events (const std::string& event_file_dir)
 {
 	XMLNode* node = new XMLNode (X_("events"));
+
+	if (!event_file_dir.empty() && _events.size() >= event_file_min_points) {
+		std::string name;
+		if (write_event_file (event_file_dir, name) == 0) {
+			node->add_property (X_("file"), name);
+			return *node;
+		}
+		/* fall back to storing the points in the XML */
+	}
+
 	stringstream str;
 
 	str.precision(15);  //10 digits is enough digits for 24 hours at 96kHz
@@ -322,8 +351,14 @@ AutomationList::serialize_events ()
 }
 
 int
-AutomationList::deserialize_events (const XMLNode& node)
+AutomationList::deserialize_events (const XMLNode& node, const std::string& event_file_dir)
 {
+	const XMLProperty* prop;
+
+	if ((prop = node.property (X_("file"))) != 0) {
+		return read_event_file (event_file_dir, prop->value());
+	}
+
 	if (node.children().empty()) {
 		return -1;
 	}
@@ -369,8 +404,142 @@ AutomationList::deserialize_events (const XMLNode& node)
 	return 0;
 }
 
+static inline void
+double_to_le (double d, uint8_t* p)
+{
+	uint64_t v;
+	memcpy (&v, &d, sizeof (v));
+	for (int i = 0; i < 8; ++i) {
+		p[i] = (uint8_t) (v >> (8 * i));
+	}
+}
+
+static inline double
+le_to_double (const uint8_t* p)
+{
+	uint64_t v = 0;
+	for (int i = 0; i < 8; ++i) {
+		v |= (uint64_t) p[i] << (8 * i);
+	}
+	double d;
+	memcpy (&d, &v, sizeof (d));
+	return d;
+}
+
+/** Store our points in a binary event file in @param dir.
+ *  The file is named after a hash of its contents, so snapshots that share
+ *  points share a file, and an existing file never needs to be rewritten.
+ *  @param name Filled in with the name of the file, relative to @a dir.
+ *  @return 0 on success.
+ */
+int
+AutomationList::write_event_file (const std::string& dir, std::string& name)
+{
+	std::vector<uint8_t> data (sizeof (event_file_magic) + _events.size() * event_file_point_size);
+	uint8_t* p = &data[0];
+
+	memcpy (p, event_file_magic, sizeof (event_file_magic));
+	p += sizeof (event_file_magic);
+
+	for (iterator i = _events.begin(); i != _events.end(); ++i) {
+		double_to_le ((*i)->when, p);
+		double_to_le ((*i)->value, p + 8);
+		p += event_file_point_size;
+	}
+
+	/* 64 bit FNV-1a */
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	for (std::vector<uint8_t>::const_iterator i = data.begin(); i != data.end(); ++i) {
+		hash = (hash ^ *i) * 0x100000001b3ULL;
+	}
+
+	char buf[32];
+	snprintf (buf, sizeof (buf), "%08x%08x.events", (uint32_t) (hash >> 32), (uint32_t) hash);
+	name = buf;
+
+	const std::string path = Glib::build_filename (dir, name);
+
+	if (Glib::file_test (path, Glib::FILE_TEST_EXISTS)) {
+		return 0;
+	}
+
+	if (g_mkdir_with_parents (dir.c_str(), 0755) < 0) {
+		error << string_compose (_("cannot create automation folder \"%1\" (%2)"), dir, strerror (errno)) << endmsg;
+		return -1;
+	}
+
+	/* write to a temporary file first, so that a failed write never
+	   leaves a truncated file under a valid name.
+	*/
+
+	const std::string tmp_path = path + X_(".tmp");
+	FILE* out = g_fopen (tmp_path.c_str(), "wb");
+
+	if (!out) {
+		error << string_compose (_("cannot open %1 to store automation data (%2)"), tmp_path, strerror (errno)) << endmsg;
+		return -1;
+	}
+
+	const bool ok = (fwrite (&data[0], 1, data.size(), out) == data.size());
+
+	if (fclose (out) != 0 || !ok || g_rename (tmp_path.c_str(), path.c_str()) != 0) {
+		error << string_compose (_("cannot write automation data to %1 (%2)"), path, strerror (errno)) << endmsg;
+		g_unlink (tmp_path.c_str());
+		return -1;
+	}
+
+	return 0;
+}
+
+/** Replace our points with those stored in the event file @param name in @param dir */
+int
+AutomationList::read_event_file (const std::string& dir, const std::string& name)
+{
+	if (dir.empty()) {
+		error << string_compose (_("automation data is stored in %1, which is only available within its session"), name) << endmsg;
+		return -1;
+	}
+
+	const std::string path = Glib::build_filename (dir, name);
+	gchar*            contents;
+	gsize             length;
+
+	if (!g_file_get_contents (path.c_str(), &contents, &length, NULL)) {
+		error << string_compose (_("cannot read automation data from %1"), path) << endmsg;
+		return -1;
+	}
+
+	if (length < sizeof (event_file_magic) || memcmp (contents, event_file_magic, sizeof (event_file_magic)) ||
+	    (length - sizeof (event_file_magic)) % event_file_point_size) {
+		error << string_compose (_("automation data in %1 is corrupt, all points ignored"), path) << endmsg;
+		g_free (contents);
+		return -1;
+	}
+
+	ControlList::freeze ();
+	clear ();
+
+	for (const uint8_t* p = (const uint8_t*) contents + sizeof (event_file_magic); p < (const uint8_t*) contents + length; p += event_file_point_size) {
+		fast_simple_add (le_to_double (p), le_to_double (p + 8));
+	}
+
+	g_free (contents);
+
+	mark_dirty ();
+	maybe_signal_changed ();
+	thaw ();
+
+	return 0;
+}
+
 int
 AutomationList::set_state (const XMLNode& node, int version)
+{
+	return set_state (node, version, std::string ());
+}
+
+int
+AutomationList::set_state (const XMLNode& node, int version, const std::string& event_file_dir)
 {
 	LocaleGuard lg (X_("C"));
 	XMLNodeList nlist = node.children();
@@ -380,14 +549,14 @@ AutomationList::set_state (const XMLNode& node, int version)
 
 	if (node.name() == X_("events")) {
 		/* partial state setting*/
-		return deserialize_events (node);
+		return deserialize_events (node, event_file_dir);
 	}
 
 	if (node.name() == X_("Envelope") || node.name() == X_("FadeOut") || node.name() == X_("FadeIn")) {
 
 		if ((nsos = node.child (X_("AutomationList")))) {
 			/* new school in old school clothing */
-			return set_state (*nsos, version);
+			return set_state (*nsos, version, event_file_dir);
 		}
 
 		/* old school */
@@ -483,7 +652,7 @@ AutomationList::set_state (const XMLNode& node, int version)
 
 	for (niter = nlist.begin(); niter != nlist.end(); ++niter) {
 		if ((*niter)->name() == X_("events")) {
-			deserialize_events (*(*niter));
+			deserialize_events (*(*niter), event_file_dir);
 			have_events = true;
 		}
 	}
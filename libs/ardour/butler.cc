@@ -25,9 +25,12 @@
 #include <poll.h>
 #endif
 
+#include <algorithm>
+
 #include "pbd/error.h"
 #include "pbd/pthread_utils.h"
 #include "ardour/debug.h"
+#include "ardour/audio_diskstream.h"
 #include "ardour/butler.h"
 #include "ardour/io.h"
 #include "ardour/midi_diskstream.h"
@@ -49,6 +52,13 @@ Butler::Butler(Session& s)
 	, audio_dstream_playback_buffer_size(0)
 	, midi_dstream_buffer_size(0)
 	, pool_trash(16)
+	, _io_job_type (Refill)
+	, _io_batch (0)
+	, _io_busy (0)
+	, _io_quit (false)
+	, _io_next_job (0)
+	, _io_outstanding (0)
+	, _io_errors (0)
 	, _xthread (true)
 {
 	g_atomic_int_set(&should_do_transport_work, 0);
@@ -130,6 +140,8 @@ Butler::start_thread()
 	//pthread_detach (thread);
 	have_thread = true;
 
+	start_io_threads ();
+
 	// we are ready to request buffer adjustments
 	_session.adjust_capture_buffering ();
 	_session.adjust_playback_buffering ();
@@ -146,6 +158,282 @@ Butler::terminate_thread ()
 		queue_request (Request::Quit);
 		pthread_join (thread, &status);
 	}
+
+	terminate_io_threads ();
+}
+
+/** Start the helper threads that share disk I/O with the butler thread */
+void
+Butler::start_io_threads ()
+{
+	/* the butler thread itself does I/O too */
+	uint32_t const n = std::max (Config->get_butler_io_threads(), (uint32_t) 1) - 1;
+
+	_io_quit = false;
+
+	for (uint32_t i = 0; i < n; ++i) {
+		pthread_t t;
+		if (pthread_create_and_store ("disk butler io", &t, _io_thread_work, this)) {
+			error << _("Session: could not create butler I/O thread") << endmsg;
+			break;
+		}
+		_io_threads.push_back (t);
+	}
+}
+
+void
+Butler::terminate_io_threads ()
+{
+	{
+		Glib::Threads::Mutex::Lock lm (_io_lock);
+		_io_quit = true;
+		_io_batch_ready.broadcast ();
+	}
+
+	for (std::vector<pthread_t>::iterator i = _io_threads.begin(); i != _io_threads.end(); ++i) {
+		void* status;
+		pthread_join (*i, &status);
+	}
+
+	_io_threads.clear ();
+}
+
+void *
+Butler::_io_thread_work (void* arg)
+{
+	SessionEvent::create_per_thread_pool ("butler io events", 64);
+	pthread_set_name (X_("butler io"));
+	return ((Butler *) arg)->io_thread_work ();
+}
+
+void *
+Butler::io_thread_work ()
+{
+	/* the butler thread's refill buffers are not ours to use */
+	AudioDiskstream::allocate_thread_working_buffers ();
+
+	Glib::Threads::Mutex::Lock lm (_io_lock);
+	uint32_t batch = _io_batch;
+
+	while (true) {
+
+		while (!_io_quit && _io_batch == batch) {
+			_io_batch_ready.wait (_io_lock);
+		}
+
+		if (_io_quit) {
+			break;
+		}
+
+		batch = _io_batch;
+		++_io_busy;
+		lm.release ();
+
+		process_disk_jobs ();
+
+		lm.acquire ();
+		if (--_io_busy == 0) {
+			_io_batch_done.broadcast ();
+		}
+	}
+
+	return 0;
+}
+
+/** Hand out @param jobs to the butler and its I/O threads, and wait
+ *  for them all to be done.  Unless the jobs are forced flushes,
+ *  this stops early if transport work is requested or the butler is
+ *  asked to stop; jobs that have already started are allowed to finish.
+ *
+ *  @return true if there is more disk work to do.
+ */
+bool
+Butler::run_disk_jobs (std::vector<boost::shared_ptr<Track> >& jobs, DiskJobType type, uint32_t& errors)
+{
+	if (jobs.empty ()) {
+		return false;
+	}
+
+	{
+		Glib::Threads::Mutex::Lock lm (_io_lock);
+
+		/* a helper that woke up too late for the last batch may still
+		   be looking at it; wait until it has given up.
+		*/
+		while (_io_busy) {
+			_io_batch_done.wait (_io_lock);
+		}
+
+		_io_jobs.swap (jobs);
+		_io_job_type = type;
+		g_atomic_int_set (&_io_next_job, 0);
+		g_atomic_int_set (&_io_outstanding, 0);
+		g_atomic_int_set (&_io_errors, 0);
+		++_io_batch;
+		_io_batch_ready.broadcast ();
+	}
+
+	process_disk_jobs ();
+
+	bool outstanding;
+
+	{
+		Glib::Threads::Mutex::Lock lm (_io_lock);
+
+		while (_io_busy) {
+			_io_batch_done.wait (_io_lock);
+		}
+
+		gint const started = std::min (g_atomic_int_get (&_io_next_job), (gint) _io_jobs.size ());
+
+		outstanding = g_atomic_int_get (&_io_outstanding);
+
+		if (started > 0 && started < (gint) _io_jobs.size ()) {
+			/* we didn't get to all the streams */
+			outstanding = true;
+		}
+
+		errors += g_atomic_int_get (&_io_errors);
+
+		/* drop our references to the tracks; any thread that wakes up
+		   late for this batch will find nothing to do.
+		*/
+		_io_jobs.clear ();
+		jobs.clear ();
+	}
+
+	return outstanding;
+}
+
+/** Called by the butler and its I/O threads to run jobs from the current batch until there are none left */
+void
+Butler::process_disk_jobs ()
+{
+	while (true) {
+
+		if (_io_job_type != ForcedFlush && (transport_work_requested () || !should_run)) {
+			break;
+		}
+
+		gint const n = g_atomic_int_add (&_io_next_job, 1);
+
+		if (n >= (gint) _io_jobs.size ()) {
+			break;
+		}
+
+		boost::shared_ptr<Track> tr = _io_jobs[n];
+
+		if (_io_job_type == Refill) {
+
+			DEBUG_TRACE (DEBUG::Butler, string_compose ("butler refills %1, playback load = %2\n", tr->name(), tr->playback_buffer_load()));
+			switch (tr->do_refill ()) {
+			case 0:
+				DEBUG_TRACE (DEBUG::Butler, string_compose ("\ttrack refill done %1\n", tr->name()));
+				break;
+
+			case 1:
+				DEBUG_TRACE (DEBUG::Butler, string_compose ("\ttrack refill unfinished %1\n", tr->name()));
+				g_atomic_int_set (&_io_outstanding, 1);
+				break;
+
+			default:
+				error << string_compose(_("Butler read ahead failure on dstream %1"), tr->name()) << endmsg;
+				std::cerr << string_compose(_("Butler read ahead failure on dstream %1"), tr->name()) << std::endl;
+				break;
+			}
+
+		} else {
+
+			DEBUG_TRACE (DEBUG::Butler, string_compose ("butler flushes track %1 capture load %2\n", tr->name(), tr->capture_buffer_load()));
+			switch (tr->do_flush (ButlerContext, _io_job_type == ForcedFlush)) {
+			case 0:
+				DEBUG_TRACE (DEBUG::Butler, string_compose ("\tflush complete for %1\n", tr->name()));
+				break;
+
+			case 1:
+				DEBUG_TRACE (DEBUG::Butler, string_compose ("\tflush not finished for %1\n", tr->name()));
+				g_atomic_int_set (&_io_outstanding, 1);
+				break;
+
+			default:
+				g_atomic_int_inc (&_io_errors);
+				error << string_compose(_("Butler write-behind failure on dstream %1"), tr->name()) << endmsg;
+				std::cerr << string_compose(_("Butler write-behind failure on dstream %1"), tr->name()) << std::endl;
+				/* don't stop - try to flush all streams in case they
+				   are split across disks.
+				*/
+			}
+		}
+	}
+}
+
+typedef std::pair<float, boost::shared_ptr<Track> > TrackLoad;
+
+static bool
+track_load_less (TrackLoad const & a, TrackLoad const & b)
+{
+	return a.first < b.first;
+}
+
+/** Sort @param tracks by increasing value of @param load.  Loads are
+ *  sampled once per track, since they change while we are sorting.
+ */
+static void
+sort_by_load (std::vector<boost::shared_ptr<Track> >& tracks, float (Track::*load)() const)
+{
+	std::vector<TrackLoad> loads;
+
+	for (std::vector<boost::shared_ptr<Track> >::const_iterator i = tracks.begin(); i != tracks.end(); ++i) {
+		loads.push_back (std::make_pair (((**i).*load) (), *i));
+	}
+
+	std::stable_sort (loads.begin(), loads.end(), track_load_less);
+
+	for (size_t n = 0; n < loads.size(); ++n) {
+		tracks[n] = loads[n].second;
+	}
+}
+
+/** Refill the playback buffers of active tracks in @param rl, emptiest first.
+ *  @return true if there is more disk work to do.
+ */
+bool
+Butler::refill_tracks (RouteList const & rl)
+{
+	std::vector<boost::shared_ptr<Track> > jobs;
+
+	for (RouteList::const_iterator i = rl.begin(); i != rl.end(); ++i) {
+
+		boost::shared_ptr<Track> tr = boost::dynamic_pointer_cast<Track> (*i);
+
+		if (!tr) {
+			continue;
+		}
+
+		boost::shared_ptr<IO> io = tr->input ();
+
+		if (io && !io->active()) {
+			/* don't read inactive tracks */
+			DEBUG_TRACE (DEBUG::Butler, string_compose ("butler skips inactive track %1\n", tr->name()));
+			continue;
+		}
+
+		jobs.push_back (tr);
+	}
+
+	sort_by_load (jobs, &Track::playback_buffer_load);
+
+	if (Config->get_disk_read_prefetch ()) {
+		/* let the OS queue up every read this pass is about to make,
+		   rather than see them one at a time.
+		*/
+		for (std::vector<boost::shared_ptr<Track> >::iterator i = jobs.begin(); i != jobs.end(); ++i) {
+			(*i)->prefetch ();
+		}
+	}
+
+	uint32_t errors = 0;
+	return run_disk_jobs (jobs, Refill, errors);
 }
 
 void *
@@ -162,7 +450,6 @@ Butler::thread_work ()
 	uint32_t err = 0;
 
 	bool disk_work_outstanding = false;
-	RouteList::iterator i;
 
 	while (true) {
 		DEBUG_TRACE (DEBUG::Butler, string_compose ("%1 butler main loop, disk work outstanding ? %2 @ %3\n", DEBUG_THREAD_SELF, disk_work_outstanding, g_get_monotonic_time()));
@@ -224,42 +511,7 @@ Butler::thread_work ()
 		RouteList rl_with_auditioner = *rl;
 		rl_with_auditioner.push_back (_session.the_auditioner());
 
-		for (i = rl_with_auditioner.begin(); !transport_work_requested() && should_run && i != rl_with_auditioner.end(); ++i) {
-
-			boost::shared_ptr<Track> tr = boost::dynamic_pointer_cast<Track> (*i);
-
-			if (!tr) {
-				continue;
-			}
-
-			boost::shared_ptr<IO> io = tr->input ();
-
-			if (io && !io->active()) {
-				/* don't read inactive tracks */
-				DEBUG_TRACE (DEBUG::Butler, string_compose ("butler skips inactive track %1\n", tr->name()));
-				continue;
-			}
-			DEBUG_TRACE (DEBUG::Butler, string_compose ("butler refills %1, playback load = %2\n", tr->name(), tr->playback_buffer_load()));
-			switch (tr->do_refill ()) {
-			case 0:
-				DEBUG_TRACE (DEBUG::Butler, string_compose ("\ttrack refill done %1\n", tr->name()));
-				break;
-
-			case 1:
-				DEBUG_TRACE (DEBUG::Butler, string_compose ("\ttrack refill unfinished %1\n", tr->name()));
-				disk_work_outstanding = true;
-				break;
-
-			default:
-				error << string_compose(_("Butler read ahead failure on dstream %1"), (*i)->name()) << endmsg;
-                                std::cerr << string_compose(_("Butler read ahead failure on dstream %1"), (*i)->name()) << std::endl;
-				break;
-			}
-
-		}
-
-		if (i != rl_with_auditioner.begin() && i != rl_with_auditioner.end()) {
-			/* we didn't get to all the streams */
+		if (refill_tracks (rl_with_auditioner)) {
 			disk_work_outstanding = true;
 		}
 
@@ -307,98 +559,43 @@ Butler::thread_work ()
 	return (0);
 }
 
-bool
-Butler::flush_tracks_to_disk_normal (boost::shared_ptr<RouteList> rl, uint32_t& errors)
+/** Fill @param jobs with all tracks in @param rl, those with the fullest capture buffers first */
+void
+Butler::queue_flushes (boost::shared_ptr<RouteList> rl, std::vector<boost::shared_ptr<Track> >& jobs)
 {
-	bool disk_work_outstanding = false;
-
-	for (RouteList::iterator i = rl->begin(); !transport_work_requested() && should_run && i != rl->end(); ++i) {
-
-		// cerr << "write behind for " << (*i)->name () << endl;
+	for (RouteList::iterator i = rl->begin(); i != rl->end(); ++i) {
 
 		boost::shared_ptr<Track> tr = boost::dynamic_pointer_cast<Track> (*i);
 
-		if (!tr) {
-			continue;
-		}
-
 		/* note that we still try to flush diskstreams attached to inactive routes
 		 */
 
-		int ret;
-
-		DEBUG_TRACE (DEBUG::Butler, string_compose ("butler flushes track %1 capture load %2\n", tr->name(), tr->capture_buffer_load()));
-		ret = tr->do_flush (ButlerContext, false);
-		switch (ret) {
-		case 0:
-			DEBUG_TRACE (DEBUG::Butler, string_compose ("\tflush complete for %1\n", tr->name()));
-			break;
-
-		case 1:
-			DEBUG_TRACE (DEBUG::Butler, string_compose ("\tflush not finished for %1\n", tr->name()));
-			disk_work_outstanding = true;
-			break;
-
-		default:
-			errors++;
-			error << string_compose(_("Butler write-behind failure on dstream %1"), (*i)->name()) << endmsg;
-			std::cerr << string_compose(_("Butler write-behind failure on dstream %1"), (*i)->name()) << std::endl;
-			/* don't break - try to flush all streams in case they
-			   are split across disks.
-			*/
+		if (tr) {
+			jobs.push_back (tr);
 		}
 	}
 
-	return disk_work_outstanding;
+	sort_by_load (jobs, &Track::capture_buffer_load);
 }
 
 bool
-Butler::flush_tracks_to_disk_after_locate (boost::shared_ptr<RouteList> rl, uint32_t& errors)
+Butler::flush_tracks_to_disk_normal (boost::shared_ptr<RouteList> rl, uint32_t& errors)
 {
-	bool disk_work_outstanding = false;
+	std::vector<boost::shared_ptr<Track> > jobs;
+	queue_flushes (rl, jobs);
+	return run_disk_jobs (jobs, Flush, errors);
+}
 
+bool
+Butler::flush_tracks_to_disk_after_locate (boost::shared_ptr<RouteList> rl, uint32_t& errors)
+{
 	/* almost the same as the "normal" version except that we do not test
 	 * for transport_work_requested() and we force flushes.
 	 */
 
-	for (RouteList::iterator i = rl->begin(); i != rl->end(); ++i) {
-
-		// cerr << "write behind for " << (*i)->name () << endl;
-
-		boost::shared_ptr<Track> tr = boost::dynamic_pointer_cast<Track> (*i);
-
-		if (!tr) {
-			continue;
-		}
-
-		/* note that we still try to flush diskstreams attached to inactive routes
-		 */
-
-		int ret;
-
-		DEBUG_TRACE (DEBUG::Butler, string_compose ("butler flushes track %1 capture load %2\n", tr->name(), tr->capture_buffer_load()));
-		ret = tr->do_flush (ButlerContext, true);
-		switch (ret) {
-		case 0:
-			DEBUG_TRACE (DEBUG::Butler, string_compose ("\tflush complete for %1\n", tr->name()));
-			break;
-
-		case 1:
-			DEBUG_TRACE (DEBUG::Butler, string_compose ("\tflush not finished for %1\n", tr->name()));
-			disk_work_outstanding = true;
-			break;
-
-		default:
-			errors++;
-			error << string_compose(_("Butler write-behind failure on dstream %1"), (*i)->name()) << endmsg;
-			std::cerr << string_compose(_("Butler write-behind failure on dstream %1"), (*i)->name()) << std::endl;
-			/* don't break - try to flush all streams in case they
-			   are split across disks.
-			*/
-		}
-	}
-
-	return disk_work_outstanding;
+	std::vector<boost::shared_ptr<Track> > jobs;
+	queue_flushes (rl, jobs);
+	return run_disk_jobs (jobs, ForcedFlush, errors);
 }
 
 void
@@ -135,6 +135,9 @@ apply_gain_to_buffer_t  ARDOUR::apply_gain_to_buffer = 0;
 mix_buffers_with_gain_t ARDOUR::mix_buffers_with_gain = 0;
 mix_buffers_no_gain_t   ARDOUR::mix_buffers_no_gain = 0;
 copy_vector_t			ARDOUR::copy_vector = 0;
+apply_gain_ramp_to_buffer_t  ARDOUR::apply_gain_ramp_to_buffer = 0;
+mix_buffers_with_gain_ramp_t ARDOUR::mix_buffers_with_gain_ramp = 0;
+mix_buffers_with_peak_t      ARDOUR::mix_buffers_with_peak = 0;
 
 PBD::Signal1<void,std::string> ARDOUR::BootMessage;
 PBD::Signal3<void,std::string,std::string,bool> ARDOUR::PluginScanMessage;
@@ -166,6 +169,41 @@ setup_hardware_optimization (bool try_optimization)
 
 #if defined (ARCH_X86) && defined (BUILD_SSE_OPTIMIZATIONS)
 
+		if (fpu->has_avx512f()) {
+
+			info << "Using AVX-512 optimized routines" << endmsg;
+
+			// AVX-512F SET
+			compute_peak               = x86_avx512f_compute_peak;
+			find_peaks                 = x86_avx512f_find_peaks;
+			apply_gain_to_buffer       = x86_avx512f_apply_gain_to_buffer;
+			mix_buffers_with_gain      = x86_avx512f_mix_buffers_with_gain;
+			mix_buffers_no_gain        = x86_avx512f_mix_buffers_no_gain;
+			copy_vector                = x86_avx512f_copy_vector;
+			apply_gain_ramp_to_buffer  = x86_avx512f_apply_gain_ramp_to_buffer;
+			mix_buffers_with_gain_ramp = x86_avx512f_mix_buffers_with_gain_ramp;
+			mix_buffers_with_peak      = x86_avx512f_mix_buffers_with_peak;
+
+			generic_mix_functions = false;
+
+		} else if (fpu->has_avx2() && fpu->has_fma()) {
+
+			info << "Using AVX2 optimized routines" << endmsg;
+
+			// AVX2 + FMA SET
+			compute_peak               = x86_avx2_compute_peak;
+			find_peaks                 = x86_avx2_find_peaks;
+			apply_gain_to_buffer       = x86_avx2_apply_gain_to_buffer;
+			mix_buffers_with_gain      = x86_avx2_mix_buffers_with_gain;
+			mix_buffers_no_gain        = x86_avx2_mix_buffers_no_gain;
+			copy_vector                = x86_avx2_copy_vector;
+			apply_gain_ramp_to_buffer  = x86_avx2_apply_gain_ramp_to_buffer;
+			mix_buffers_with_gain_ramp = x86_avx2_mix_buffers_with_gain_ramp;
+			mix_buffers_with_peak      = x86_avx2_mix_buffers_with_peak;
+
+			generic_mix_functions = false;
+
+		} else
 #ifdef PLATFORM_WINDOWS
 		/* We have AVX-optimized code for Windows */
 
@@ -184,6 +222,9 @@ setup_hardware_optimization (bool try_optimization)
 			mix_buffers_with_gain = x86_sse_avx_mix_buffers_with_gain;
 			mix_buffers_no_gain   = x86_sse_avx_mix_buffers_no_gain;
 			copy_vector           = x86_sse_avx_copy_vector;
+			apply_gain_ramp_to_buffer  = default_apply_gain_ramp_to_buffer;
+			mix_buffers_with_gain_ramp = default_mix_buffers_with_gain_ramp;
+			mix_buffers_with_peak      = default_mix_buffers_with_peak;
 
 			generic_mix_functions = false;
 
@@ -198,6 +239,9 @@ setup_hardware_optimization (bool try_optimization)
 			mix_buffers_with_gain = x86_sse_mix_buffers_with_gain;
 			mix_buffers_no_gain   = x86_sse_mix_buffers_no_gain;
 			copy_vector           = default_copy_vector;
+			apply_gain_ramp_to_buffer  = default_apply_gain_ramp_to_buffer;
+			mix_buffers_with_gain_ramp = default_mix_buffers_with_gain_ramp;
+			mix_buffers_with_peak      = default_mix_buffers_with_peak;
 
 			generic_mix_functions = false;
 
@@ -216,6 +260,9 @@ setup_hardware_optimization (bool try_optimization)
 			mix_buffers_with_gain  = veclib_mix_buffers_with_gain;
 			mix_buffers_no_gain    = veclib_mix_buffers_no_gain;
 			copy_vector            = default_copy_vector;
+			apply_gain_ramp_to_buffer  = default_apply_gain_ramp_to_buffer;
+			mix_buffers_with_gain_ramp = default_mix_buffers_with_gain_ramp;
+			mix_buffers_with_peak      = default_mix_buffers_with_peak;
 
 			generic_mix_functions = false;
 
@@ -236,6 +283,9 @@ setup_hardware_optimization (bool try_optimization)
 		mix_buffers_with_gain = default_mix_buffers_with_gain;
 		mix_buffers_no_gain   = default_mix_buffers_no_gain;
 		copy_vector           = default_copy_vector;
+		apply_gain_ramp_to_buffer  = default_apply_gain_ramp_to_buffer;
+		mix_buffers_with_gain_ramp = default_mix_buffers_with_gain_ramp;
+		mix_buffers_with_peak      = default_mix_buffers_with_peak;
 
 		info << "No H/W specific optimizations in use" << endmsg;
 	}
@@ -22,6 +22,7 @@
 
 #include "pbd/compose.h"
 #include "pbd/debug_rt_alloc.h"
+#include "pbd/error.h"
 #include "pbd/pthread_utils.h"
 
 #include "ardour/debug.h"
@@ -51,21 +52,43 @@ int alloc_allowed ()
 }
 #endif
 
+/* Each DSP thread's work queue must be able to hold every node in the
+ * graph, since it never grows once the threads are running.
+ */
+static const guint work_queue_size = 8192;
+
+/* How many times an idle DSP thread looks for work to steal before it
+ * goes to sleep on the execution semaphore.  Spinning avoids the cost of
+ * a semaphore round-trip when new nodes become runnable shortly after a
+ * thread runs out of work, which is the common case within a cycle.
+ */
+static const int idle_spin_iterations = 2048;
+
+static inline void
+spin_pause ()
+{
+#if defined(__i386__) || defined(__x86_64__)
+	__asm__ __volatile__ ("pause" ::: "memory");
+#endif
+}
+
+static void
+release_thread_slot (void*)
+{
+	/* thread slots are owned by the Graph, not the thread */
+}
+
+Glib::Threads::Private<Graph::ThreadSlot> Graph::_thread_slot (release_thread_slot);
+
 Graph::Graph (Session & session)
         : SessionHandleRef (session)
         , _threads_active (false)
+	, _claimed_thread_slots (0)
 	, _execution_sem ("graph_execution", 0)
 	, _callback_start_sem ("graph_start", 0)
 	, _callback_done_sem ("graph_done", 0)
 	, _cleanup_sem ("graph_cleanup", 0)
 {
-        pthread_mutex_init( &_trigger_mutex, NULL);
-
-	/* XXX: rather hacky `fix' to stop _trigger_queue.push_back() allocating
-	   memory in the RT thread.
-	*/
-	_trigger_queue.reserve (8192);
-
         _execution_tokens = 0;
 
         _current_chain = 0;
@@ -117,6 +140,8 @@ Graph::reset_thread_list ()
                 drop_threads ();
         }
 
+        create_thread_slots (num_threads);
+
         _threads_active = true;
 
 	if (AudioEngine::instance()->create_process_thread (boost::bind (&Graph::main_thread, this)) != 0) {
@@ -140,7 +165,40 @@ Graph::session_going_away()
         _nodes_rt[1].clear();
         _init_trigger_list[0].clear();
         _init_trigger_list[1].clear();
-        _trigger_queue.clear();
+        drop_thread_slots ();
+}
+
+/** Create one work queue for each of the DSP threads that we are about to start.
+ *  Must only be called while no DSP threads are running.
+ */
+void
+Graph::create_thread_slots (uint32_t num_threads)
+{
+        drop_thread_slots ();
+
+        for (uint32_t i = 0; i < num_threads; ++i) {
+                _thread_slots.push_back (new ThreadSlot (i, work_queue_size));
+        }
+}
+
+void
+Graph::drop_thread_slots ()
+{
+        for (vector<ThreadSlot*>::iterator i = _thread_slots.begin(); i != _thread_slots.end(); ++i) {
+                delete *i;
+        }
+        _thread_slots.clear ();
+        g_atomic_int_set (&_claimed_thread_slots, 0);
+}
+
+/** Called by each DSP thread as it starts, to take ownership of a work queue */
+void
+Graph::claim_thread_slot ()
+{
+        gint const n = g_atomic_int_add (&_claimed_thread_slots, 1);
+
+        assert (n < (gint) _thread_slots.size());
+        _thread_slot.set (_thread_slots[n]);
 }
 
 void
@@ -149,21 +207,21 @@ Graph::drop_threads ()
         Glib::Threads::Mutex::Lock ls (_swap_mutex);
         _threads_active = false;
 
-        uint32_t thread_count = AudioEngine::instance()->process_thread_count ();
-
-        for (unsigned int i=0; i < thread_count; i++) {
-		pthread_mutex_lock (&_trigger_mutex);
-		_execution_sem.signal ();
-		pthread_mutex_unlock (&_trigger_mutex);
-        }
+        /* Spinning threads will notice _threads_active on their own; wake
+           all of those that have gone to sleep.
+        */
+        wake_idle_threads (AudioEngine::instance()->process_thread_count ());
 
-	pthread_mutex_lock (&_trigger_mutex);
         _callback_start_sem.signal ();
-	pthread_mutex_unlock (&_trigger_mutex);
 
 	AudioEngine::instance()->join_process_threads ();
 
 	_execution_tokens = 0;
+
+        for (vector<ThreadSlot*>::iterator i = _thread_slots.begin(); i != _thread_slots.end(); ++i) {
+                (*i)->queue.reset ();
+        }
+        g_atomic_int_set (&_claimed_thread_slots, 0);
 }
 
 void
@@ -216,21 +274,104 @@ Graph::prep()
         }
         _finished_refcount = _init_finished_refcount[chain];
 
-	/* Trigger the initial nodes for processing, which are the ones at the `input' end */
-	pthread_mutex_lock (&_trigger_mutex);
+	/* Trigger the initial nodes for processing, which are the ones at the `input' end.
+	   They all go onto this thread's queue; idle threads will steal them from there.
+	*/
         for (i=_init_trigger_list[chain].begin(); i!=_init_trigger_list[chain].end(); i++) {
-		/* don't use ::trigger here, as we have already locked the mutex */
-                _trigger_queue.push_back (i->get ());
+                trigger (i->get ());
         }
-	pthread_mutex_unlock (&_trigger_mutex);
 }
 
+/** Queue a node for processing.  Must only be called from one of our DSP
+ *  threads, since the node goes onto that thread's own work queue.
+ */
 void
 Graph::trigger (GraphNode* n)
 {
-	pthread_mutex_lock (&_trigger_mutex);
-        _trigger_queue.push_back (n);
-	pthread_mutex_unlock (&_trigger_mutex);
+        ThreadSlot* slot = _thread_slot.get ();
+        assert (slot);
+
+        /* If our queue is empty we will run this node ourselves as soon as we
+           are done with the current one, so there is no point in waking
+           anybody else up for it.
+        */
+        bool const others_needed = !slot->queue.empty ();
+
+        if (!slot->queue.push (n)) {
+                /* cannot happen unless the graph has more than work_queue_size nodes */
+                fatal << string_compose (_("Graph work queue overflow (%1 nodes)"), slot->queue.capacity()) << endmsg;
+                abort(); /*NOTREACHED*/
+        }
+
+        if (others_needed) {
+                wake_idle_threads (1);
+        }
+}
+
+/** Wake up to @param n threads that are sleeping on the execution semaphore */
+void
+Graph::wake_idle_threads (int n)
+{
+        while (n > 0) {
+                gint const et = g_atomic_int_get (&_execution_tokens);
+                if (et <= 0) {
+                        return;
+                }
+                if (g_atomic_int_compare_and_exchange (&_execution_tokens, et, et - 1)) {
+                        DEBUG_TRACE(DEBUG::ProcessThreads, string_compose ("%1 signals a sleeping thread\n", pthread_name()));
+                        _execution_sem.signal ();
+                        --n;
+                }
+        }
+}
+
+/** Try to take back an execution token that we have just added.
+ *  @return true if we did so, false if somebody has already decided
+ *  to wake us (in which case the semaphore has been, or is about to
+ *  be, signalled for us).
+ */
+bool
+Graph::reclaim_execution_token ()
+{
+        while (true) {
+                gint const et = g_atomic_int_get (&_execution_tokens);
+                if (et <= 0) {
+                        return false;
+                }
+                if (g_atomic_int_compare_and_exchange (&_execution_tokens, et, et - 1)) {
+                        return true;
+                }
+        }
+}
+
+/** Try to take a node from the queue of some other DSP thread.
+ *  @return the stolen node, or 0 if there was nothing to steal.
+ */
+GraphNode*
+Graph::steal (ThreadSlot* self)
+{
+        uint32_t const n = _thread_slots.size ();
+
+        for (uint32_t i = 1; i < n; ++i) {
+                ThreadSlot* victim = _thread_slots[(self->id + i) % n];
+                GraphNode* node = victim->queue.steal ();
+                if (node) {
+                        return node;
+                }
+        }
+
+        return 0;
+}
+
+bool
+Graph::work_available () const
+{
+        for (vector<ThreadSlot*>::const_iterator i = _thread_slots.begin(); i != _thread_slots.end(); ++i) {
+                if (!(*i)->queue.empty ()) {
+                        return true;
+                }
+        }
+        return false;
 }
 
 /** Called when a node at the `output' end of the chain (ie one that has no-one to feed)
@@ -354,55 +495,70 @@ Graph::rechain (boost::shared_ptr<RouteList> routelist, GraphEdges const & edges
 bool
 Graph::run_one()
 {
-        GraphNode* to_run;
+        /* Most recently triggered nodes first: they are likely to
+           be fed by data that is still in this core's cache.
+        */
+        GraphNode* to_run = _thread_slot.get()->queue.pop ();
 
-        pthread_mutex_lock (&_trigger_mutex);
-        if (_trigger_queue.size()) {
-                to_run = _trigger_queue.back();
-                _trigger_queue.pop_back();
-        } else {
-                to_run = 0;
+        if (to_run == 0) {
+                to_run = wait_for_work ();
+                if (to_run == 0) {
+                        return true;
+                }
         }
 
-	/* the number of threads that are asleep */
-	int et = _execution_tokens;
-	/* the number of nodes that need to be run */
-	int ts = _trigger_queue.size();
+        to_run->process();
+        to_run->finish (_current_chain);
+
+        DEBUG_TRACE(DEBUG::ProcessThreads, string_compose ("%1 has finished run_one()\n", pthread_name()));
+
+        return !_threads_active;
+}
 
-	/* hence how many threads to wake up */
-        int wakeup = min (et, ts);
-	/* update the number of threads that will still be sleeping */
-        _execution_tokens -= wakeup;
+/** Called by a DSP thread that has run out of work of its own.  Steal
+ *  nodes from the other threads' queues, spinning for a while before
+ *  going to sleep if there are none.
+ *  @return a node to run, or 0 if the threads are being shut down.
+ */
+GraphNode*
+Graph::wait_for_work ()
+{
+        ThreadSlot* self = _thread_slot.get ();
+        GraphNode* node;
 
-        DEBUG_TRACE(DEBUG::ProcessThreads, string_compose ("%1 signals %2\n", pthread_name(), wakeup));
+        while (_threads_active) {
 
-        for (int i = 0; i < wakeup; i++) {
-                _execution_sem.signal ();
-        }
+                for (int spin = 0; spin < idle_spin_iterations; ++spin) {
+                        if ((node = self->queue.pop ()) != 0 || (node = steal (self)) != 0) {
+                                return node;
+                        }
+                        if (!_threads_active) {
+                                return 0;
+                        }
+                        spin_pause ();
+                }
+
+                /* Announce that we are about to sleep, then look once
+                   more: either we see work that was queued in the
+                   meantime, or whoever queued it sees our token and
+                   wakes us.
+                */
+                g_atomic_int_inc (&_execution_tokens);
 
-        while (to_run == 0) {
-                _execution_tokens += 1;
-                pthread_mutex_unlock (&_trigger_mutex);
-                DEBUG_TRACE (DEBUG::ProcessThreads, string_compose ("%1 goes to sleep\n", pthread_name()));
-                _execution_sem.wait ();
                 if (!_threads_active) {
-                        return true;
+                        return 0;
                 }
-                DEBUG_TRACE (DEBUG::ProcessThreads, string_compose ("%1 is awake\n", pthread_name()));
-                pthread_mutex_lock (&_trigger_mutex);
-                if (_trigger_queue.size()) {
-                        to_run = _trigger_queue.back();
-                        _trigger_queue.pop_back();
-                }
-        }
-        pthread_mutex_unlock (&_trigger_mutex);
 
-        to_run->process();
-        to_run->finish (_current_chain);
+                if (work_available () && reclaim_execution_token ()) {
+                        continue;
+                }
 
-        DEBUG_TRACE(DEBUG::ProcessThreads, string_compose ("%1 has finished run_one()\n", pthread_name()));
+                DEBUG_TRACE (DEBUG::ProcessThreads, string_compose ("%1 goes to sleep\n", pthread_name()));
+                _execution_sem.wait ();
+                DEBUG_TRACE (DEBUG::ProcessThreads, string_compose ("%1 is awake\n", pthread_name()));
+        }
 
-        return !_threads_active;
+        return 0;
 }
 
 void
@@ -412,6 +568,8 @@ Graph::helper_thread()
 	ProcessThread* pt = new ProcessThread ();
 	resume_rt_malloc_checks ();
 
+        claim_thread_slot ();
+
         pt->get_buffers();
 
         while(1) {
@@ -431,6 +589,8 @@ Graph::main_thread()
 	ProcessThread* pt = new ProcessThread ();
 	resume_rt_malloc_checks ();
 
+        claim_thread_slot ();
+
         pt->get_buffers();
 
   again:
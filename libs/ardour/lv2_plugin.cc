@@ -17,6 +17,7 @@
     Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 */
 
+#include <algorithm>
 #include <string>
 #include <vector>
 #include <limits>
@@ -126,6 +127,7 @@ public:
 	LilvNode* ext_logarithmic;
 	LilvNode* ext_notOnGUI;
 	LilvNode* lv2_AudioPort;
+	LilvNode* lv2_CVPort;
 	LilvNode* lv2_ControlPort;
 	LilvNode* lv2_InputPort;
 	LilvNode* lv2_OutputPort;
@@ -315,6 +317,9 @@ LV2Plugin::init(const void* c_plugin, framecnt_t rate)
 	_shadow_data            = 0;
 	_atom_ev_buffers        = 0;
 	_ev_buffers             = 0;
+	_cv_buffers             = 0;
+	_cv_buffer_size         = 0;
+	_cv_automation          = 0;
 	_bpm_control_port       = 0;
 	_freewheel_control_port = 0;
 	_latency_control_port   = 0;
@@ -506,6 +511,12 @@ LV2Plugin::init(const void* c_plugin, framecnt_t rate)
 			flags |= PORT_CONTROL;
 		} else if (lilv_port_is_a(_impl->plugin, port, _world.lv2_AudioPort)) {
 			flags |= PORT_AUDIO;
+		} else if (lilv_port_is_a(_impl->plugin, port, _world.lv2_CVPort)) {
+			flags |= PORT_CV;
+			if (flags & PORT_INPUT) {
+				/* automatable like a control port, but takes a value per frame */
+				flags |= PORT_CONTROL;
+			}
 		} else if (lilv_port_is_a(_impl->plugin, port, _world.ev_EventPort)) {
 			flags |= PORT_EVENT;
 			flags |= PORT_MIDI;  // We assume old event API ports are for MIDI
@@ -556,6 +567,13 @@ LV2Plugin::init(const void* c_plugin, framecnt_t rate)
 	_defaults     = new float[num_ports];
 	_ev_buffers   = new LV2_Evbuf*[num_ports];
 	memset(_ev_buffers, 0, sizeof(LV2_Evbuf*) * num_ports);
+	_cv_buffers    = new float*[num_ports];
+	_cv_automation = new const float*[num_ports];
+	for (uint32_t i = 0; i < num_ports; ++i) {
+		_cv_buffers[i]    = NULL;
+		_cv_automation[i] = NULL;
+	}
+	allocate_cv_buffers (std::max (_session.get_block_size(), _engine.samples_per_cycle()));
 
 	const bool     latent        = lilv_plugin_has_latency(plugin);
 	const uint32_t latency_index = (latent)
@@ -587,7 +605,11 @@ LV2Plugin::init(const void* c_plugin, framecnt_t rate)
 			}
 			lilv_node_free(def);
 
-			lilv_instance_connect_port(_impl->instance, i, &_control_data[i]);
+			if (_port_flags[i] & PORT_CV) {
+				lilv_instance_connect_port(_impl->instance, i, _cv_buffers[i]);
+			} else {
+				lilv_instance_connect_port(_impl->instance, i, &_control_data[i]);
+			}
 
 			if (latent && i == latency_index) {
 				_latency_control_port  = &_control_data[i];
@@ -602,6 +624,9 @@ LV2Plugin::init(const void* c_plugin, framecnt_t rate)
 			}
 		} else {
 			_defaults[i] = 0.0f;
+			if (_port_flags[i] & PORT_CV) {
+				lilv_instance_connect_port(_impl->instance, i, _cv_buffers[i]);
+			}
 		}
 	}
 
@@ -672,13 +697,39 @@ LV2Plugin::set_block_size (pframes_t nframes)
 		_impl->opts_iface->set (_impl->instance->lv2_handle, &block_size_option);
 	}
 #endif
+	/* the engine does not run us while the block size changes */
+	if (nframes > _cv_buffer_size) {
+		allocate_cv_buffers (nframes);
+	}
 	return 0;
 }
 
+/** (Re)allocate the buffers of all CV ports to hold @a nframes frames, and
+ *  connect them.  Not realtime safe.
+ */
+void
+LV2Plugin::allocate_cv_buffers (pframes_t nframes)
+{
+	for (uint32_t i = 0; i < num_ports(); ++i) {
+		if (!(_port_flags[i] & PORT_CV)) {
+			continue;
+		}
+		delete [] _cv_buffers[i];
+		_cv_buffers[i] = new float[nframes];
+		std::fill (_cv_buffers[i], _cv_buffers[i] + nframes, 0.0f);
+		lilv_instance_connect_port(_impl->instance, i, _cv_buffers[i]);
+	}
+	_cv_buffer_size = nframes;
+}
+
 LV2Plugin::~LV2Plugin ()
 {
 	DEBUG_TRACE(DEBUG::LV2, string_compose("%1 destroy\n", name()));
 
+	/* wait for any work in progress before the instance goes away */
+	delete _worker;
+	_worker = 0;
+
 	deactivate();
 	cleanup();
 
@@ -694,7 +745,6 @@ LV2Plugin::~LV2Plugin ()
 
 	delete _to_ui;
 	delete _from_ui;
-	delete _worker;
 
 	if (_atom_ev_buffers) {
 		LV2_Evbuf**  b = _atom_ev_buffers;
@@ -705,10 +755,18 @@ LV2Plugin::~LV2Plugin ()
 		free(_atom_ev_buffers);
 	}
 
+	if (_cv_buffers) {
+		for (uint32_t i = 0; i < num_ports(); ++i) {
+			delete [] _cv_buffers[i];
+		}
+	}
+
 	delete [] _control_data;
 	delete [] _shadow_data;
 	delete [] _defaults;
 	delete [] _ev_buffers;
+	delete [] _cv_buffers;
+	delete [] _cv_automation;
 }
 
 bool
@@ -2098,6 +2156,18 @@ LV2Plugin::connect_and_run(BufferSet& bufs,
 			}
 
 			buf = lv2_evbuf_get_buffer(_ev_buffers[port_index]);
+		} else if (flags & PORT_CV) {
+			assert(nframes <= _cv_buffer_size);
+			if ((flags & PORT_INPUT) && _cv_automation[port_index]) {
+				buf = const_cast<float*>(_cv_automation[port_index]);
+			} else {
+				if (flags & PORT_INPUT) {
+					std::fill(_cv_buffers[port_index],
+					          _cv_buffers[port_index] + std::min(nframes, _cv_buffer_size),
+					          _shadow_data[port_index]);
+				}
+				buf = _cv_buffers[port_index];
+			}
 		} else {
 			continue;  // Control port, leave buffer alone
 		}
@@ -2265,6 +2335,21 @@ LV2Plugin::parameter_is_input(uint32_t param) const
 	return _port_flags[param] & PORT_INPUT;
 }
 
+bool
+LV2Plugin::parameter_is_sample_accurate(uint32_t param) const
+{
+	assert(param < _port_flags.size());
+	return (_port_flags[param] & PORT_CV) && (_port_flags[param] & PORT_INPUT);
+}
+
+void
+LV2Plugin::set_parameter_buffer(uint32_t which, const float* buf)
+{
+	if (which < _port_flags.size() && (_port_flags[which] & PORT_CV)) {
+		_cv_automation[which] = buf;
+	}
+}
+
 void
 LV2Plugin::print_parameter(uint32_t param, char* buf, uint32_t len) const
 {
@@ -2346,6 +2431,10 @@ LV2Plugin::latency_compute_run()
 
 	memset(buffer, 0, sizeof(float) * bufsize);
 
+	if ((pframes_t) bufsize > _cv_buffer_size) {
+		allocate_cv_buffers (bufsize);
+	}
+
 	// FIXME: Ensure plugins can handle in-place processing
 
 	port_index = 0;
@@ -2359,6 +2448,12 @@ LV2Plugin::latency_compute_run()
 				lilv_instance_connect_port(_impl->instance, port_index, buffer);
 				out_index++;
 			}
+		} else if (_port_flags[port_index] & PORT_CV) {
+			if (parameter_is_input(port_index)) {
+				std::fill(_cv_buffers[port_index], _cv_buffers[port_index] + bufsize,
+				          _shadow_data[port_index]);
+			}
+			lilv_instance_connect_port(_impl->instance, port_index, _cv_buffers[port_index]);
 		}
 		port_index++;
 	}
@@ -2407,6 +2502,7 @@ LV2World::LV2World()
 	ext_logarithmic    = lilv_new_uri(world, LV2_PORT_PROPS__logarithmic);
 	ext_notOnGUI       = lilv_new_uri(world, LV2_PORT_PROPS__notOnGUI);
 	lv2_AudioPort      = lilv_new_uri(world, LILV_URI_AUDIO_PORT);
+	lv2_CVPort         = lilv_new_uri(world, LV2_CORE__CVPort);
 	lv2_ControlPort    = lilv_new_uri(world, LILV_URI_CONTROL_PORT);
 	lv2_InputPort      = lilv_new_uri(world, LILV_URI_INPUT_PORT);
 	lv2_OutputPort     = lilv_new_uri(world, LILV_URI_OUTPUT_PORT);
@@ -2477,6 +2573,7 @@ LV2World::~LV2World()
 	lilv_node_free(lv2_OutputPort);
 	lilv_node_free(lv2_InputPort);
 	lilv_node_free(lv2_ControlPort);
+	lilv_node_free(lv2_CVPort);
 	lilv_node_free(lv2_AudioPort);
 	lilv_node_free(ext_notOnGUI);
 	lilv_node_free(ext_logarithmic);
@@ -20,6 +20,7 @@
 
 #include <algorithm>
 #include <iostream>
+#include <map>
 #include <set>
 #include <stdexcept>
 #include <stdint.h>
@@ -46,6 +47,14 @@ using namespace std;
 using namespace ARDOUR;
 using namespace PBD;
 
+/** Extend [start, end] to include [s, e] */
+static void
+extend_range (Evoral::Beats& start, Evoral::Beats& end, Evoral::Beats s, Evoral::Beats e)
+{
+	start = std::min (start, s);
+	end   = std::max (end, e);
+}
+
 MidiModel::MidiModel (boost::shared_ptr<MidiSource> s)
 	: AutomatableSequence<TimeType>(s->session())
 {
@@ -330,7 +339,10 @@ MidiModel::NoteDiffCommand::operator() ()
 		}
 	}
 
-	_model->ContentsChanged(); /* EMIT SIGNAL */
+	TimeType start;
+	TimeType end;
+	affected_range (start, end);
+	_model->contents_changed (start, end);
 }
 
 void
@@ -440,7 +452,65 @@ MidiModel::NoteDiffCommand::undo ()
 		}
 	}
 
-	_model->ContentsChanged(); /* EMIT SIGNAL */
+	TimeType start;
+	TimeType end;
+	affected_range (start, end);
+	_model->contents_changed (start, end);
+}
+
+void
+MidiModel::NoteDiffCommand::affected_range (TimeType& start, TimeType& end) const
+{
+	start = Evoral::MaxBeats;
+	end   = Evoral::MinBeats;
+
+	for (NoteList::const_iterator i = _added_notes.begin(); i != _added_notes.end(); ++i) {
+		extend_range (start, end, (*i)->time(), (*i)->end_time());
+	}
+
+	for (NoteList::const_iterator i = _removed_notes.begin(); i != _removed_notes.end(); ++i) {
+		extend_range (start, end, (*i)->time(), (*i)->end_time());
+	}
+
+	for (set<NotePtr>::const_iterator i = side_effect_removals.begin(); i != side_effect_removals.end(); ++i) {
+		extend_range (start, end, (*i)->time(), (*i)->end_time());
+	}
+
+	/* a note may have several changes, so find the latest start and the
+	   longest length each changed note has had to cover all of its extents.
+	*/
+
+	typedef map<NotePtr, pair<TimeType, TimeType> > Extents;
+	Extents extents;
+
+	for (ChangeList::const_iterator i = _changes.begin(); i != _changes.end(); ++i) {
+
+		if (!i->note) {
+			/* never applied, so we cannot tell where it is */
+			start = Evoral::MinBeats;
+			end   = Evoral::MaxBeats;
+			return;
+		}
+
+		pair<TimeType, TimeType>& e (extents.insert (make_pair (i->note, make_pair (i->note->time(), i->note->length()))).first->second);
+
+		switch (i->property) {
+		case StartTime:
+			extend_range (start, end, i->old_value.get_beats(), i->old_value.get_beats());
+			extend_range (start, end, i->new_value.get_beats(), i->new_value.get_beats());
+			e.first = std::max (e.first, std::max (i->old_value.get_beats(), i->new_value.get_beats()));
+			break;
+		case Length:
+			e.second = std::max (e.second, std::max (i->old_value.get_beats(), i->new_value.get_beats()));
+			break;
+		default:
+			break;
+		}
+	}
+
+	for (Extents::const_iterator i = extents.begin(); i != extents.end(); ++i) {
+		extend_range (start, end, i->first->time(), i->second.first + i->second.second);
+	}
 }
 
 XMLNode&
@@ -546,7 +616,7 @@ MidiModel::NoteDiffCommand::unmarshal_note (XMLNode *xml_note)
 		velocity = 127;
 	}
 
-	NotePtr note_ptr(new Evoral::Note<TimeType>(channel, time, length, note, velocity));
+	NotePtr note_ptr = MidiModel::new_note (channel, time, length, note, velocity);
 	note_ptr->set_id (id);
 
 	return note_ptr;
@@ -804,7 +874,10 @@ MidiModel::SysExDiffCommand::operator() ()
 		}
 	}
 
-	_model->ContentsChanged (); /* EMIT SIGNAL */
+	TimeType start;
+	TimeType end;
+	affected_range (start, end);
+	_model->contents_changed (start, end);
 }
 
 void
@@ -836,7 +909,26 @@ MidiModel::SysExDiffCommand::undo ()
 
 	}
 
-	_model->ContentsChanged(); /* EMIT SIGNAL */
+	TimeType start;
+	TimeType end;
+	affected_range (start, end);
+	_model->contents_changed (start, end);
+}
+
+void
+MidiModel::SysExDiffCommand::affected_range (TimeType& start, TimeType& end) const
+{
+	start = Evoral::MaxBeats;
+	end   = Evoral::MinBeats;
+
+	for (list<SysExPtr>::const_iterator i = _removed.begin(); i != _removed.end(); ++i) {
+		extend_range (start, end, (*i)->time(), (*i)->time());
+	}
+
+	for (ChangeList::const_iterator i = _changes.begin(); i != _changes.end(); ++i) {
+		extend_range (start, end, i->old_time, i->old_time);
+		extend_range (start, end, i->new_time, i->new_time);
+	}
 }
 
 void
@@ -1086,7 +1178,10 @@ MidiModel::PatchChangeDiffCommand::operator() ()
 		}
 	}
 
-	_model->ContentsChanged (); /* EMIT SIGNAL */
+	TimeType start;
+	TimeType end;
+	affected_range (start, end);
+	_model->contents_changed (start, end);
 }
 
 void
@@ -1144,7 +1239,10 @@ MidiModel::PatchChangeDiffCommand::undo ()
 
 	}
 
-	_model->ContentsChanged (); /* EMIT SIGNAL */
+	TimeType start;
+	TimeType end;
+	affected_range (start, end);
+	_model->contents_changed (start, end);
 }
 
 XMLNode &
@@ -1185,6 +1283,34 @@ MidiModel::PatchChangeDiffCommand::marshal_patch_change (constPatchChangePtr p)
 	return *n;
 }
 
+void
+MidiModel::PatchChangeDiffCommand::affected_range (TimeType& start, TimeType& end) const
+{
+	start = Evoral::MaxBeats;
+	end   = Evoral::MinBeats;
+
+	for (list<PatchChangePtr>::const_iterator i = _added.begin(); i != _added.end(); ++i) {
+		extend_range (start, end, (*i)->time(), (*i)->time());
+	}
+
+	for (list<PatchChangePtr>::const_iterator i = _removed.begin(); i != _removed.end(); ++i) {
+		extend_range (start, end, (*i)->time(), (*i)->time());
+	}
+
+	for (ChangeList::const_iterator i = _changes.begin(); i != _changes.end(); ++i) {
+		if (i->property == Time) {
+			extend_range (start, end, i->old_time, i->old_time);
+			extend_range (start, end, i->new_time, i->new_time);
+		} else if (i->patch) {
+			extend_range (start, end, i->patch->time(), i->patch->time());
+		} else {
+			start = Evoral::MinBeats;
+			end   = Evoral::MaxBeats;
+			return;
+		}
+	}
+}
+
 XMLNode&
 MidiModel::PatchChangeDiffCommand::marshal_change (const Change& c)
 {
@@ -1453,10 +1579,9 @@ MidiModel::sync_to_source (const Glib::Threads::Mutex::Lock& source_lock)
 		return false;
 	}
 
-	/* Invalidate and store active notes, which will be picked up by the iterator
-	   on the next roll if time progresses linearly. */
-	ms->invalidate(source_lock,
-	               ms->session().transport_rolling() ? &_active_notes : NULL);
+	/* Invalidate readers' iterators; they keep their active notes, which
+	   will be picked up on the next roll if time progresses linearly. */
+	ms->invalidate(source_lock);
 
 	ms->mark_streaming_midi_write_started (source_lock, note_mode());
 
@@ -1552,7 +1677,7 @@ MidiModel::find_note (NotePtr other)
 	Notes::iterator l = notes().lower_bound(other);
 
 	if (l != notes().end()) {
-		for (; (*l)->time() == other->time(); ++l) {
+		for (; l != notes().end() && (*l)->time() == other->time(); ++l) {
 			/* NB: compare note contents, not note pointers.
 			   If "other" was a ptr to a note already in
 			   the model, we wouldn't be looking for it,
@@ -1570,17 +1695,7 @@ MidiModel::find_note (NotePtr other)
 Evoral::Sequence<MidiModel::TimeType>::NotePtr
 MidiModel::find_note (gint note_id)
 {
-	/* used only for looking up notes when reloading history from disk,
-	   so we don't care about performance *too* much.
-	*/
-
-	for (Notes::iterator l = notes().begin(); l != notes().end(); ++l) {
-		if ((*l)->id() == note_id) {
-			return *l;
-		}
-	}
-
-	return NotePtr();
+	return note_by_id (note_id);
 }
 
 MidiModel::PatchChangePtr
@@ -1621,12 +1736,12 @@ MidiModel::edit_lock()
 	Glib::Threads::Mutex::Lock*   source_lock = 0;
 
 	if (ms) {
-		/* Take source lock and invalidate iterator to release its lock on model.
-		   Add currently active notes to _active_notes so we can restore them
-		   if playback resumes at the same point after the edit. */
+		/* Take source lock and invalidate readers' iterators to release their
+		   locks on the model.  Readers keep their currently active notes so
+		   they can restore them if playback resumes at the same point after
+		   the edit. */
 		source_lock = new Glib::Threads::Mutex::Lock(ms->mutex());
-		ms->invalidate(*source_lock,
-		               ms->session().transport_rolling() ? &_active_notes : NULL);
+		ms->invalidate(*source_lock);
 	}
 
 	return WriteLock(new WriteLockImpl(source_lock, _lock, _control_lock));
@@ -1647,7 +1762,6 @@ MidiModel::resolve_overlaps_unlocked (const NotePtr note, void* arg)
 	TimeType ea  = note->end_time();
 
 	const Pitches& p (pitches (note->channel()));
-	NotePtr search_note(new Note<TimeType>(0, TimeType(), TimeType(), note->note()));
 	set<NotePtr> to_be_deleted;
 	bool set_note_length = false;
 	bool set_note_time = false;
@@ -1656,7 +1770,8 @@ MidiModel::resolve_overlaps_unlocked (const NotePtr note, void* arg)
 
 	DEBUG_TRACE (DEBUG::Sequence, string_compose ("%1 checking overlaps for note %2 @ %3\n", this, (int)note->note(), note->time()));
 
-	for (Pitches::const_iterator i = p.lower_bound (search_note);
+	/* the pitch index is ordered by note number only, so the note itself is the search key */
+	for (Pitches::const_iterator i = p.lower_bound (note);
 	     i != p.end() && (*i)->note() == note->note(); ++i) {
 
 		TimeType sb = (*i)->time();
@@ -2028,5 +2143,12 @@ MidiModel::control_list_marked_dirty ()
 {
 	AutomatableSequence<Evoral::Beats>::control_list_marked_dirty ();
 
+	contents_changed ();
+}
+
+void
+MidiModel::contents_changed (TimeType start, TimeType end)
+{
 	ContentsChanged (); /* EMIT SIGNAL */
+	ContentsChangedInRange (start, end); /* EMIT SIGNAL */
 }
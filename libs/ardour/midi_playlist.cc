@@ -116,6 +116,7 @@ MidiPlaylist::read (Evoral::EventSink<framepos_t>& dst,
 	typedef pair<MidiStateTracker*,framepos_t> TrackerInfo;
 
 	Playlist::RegionReadLock rl (this);
+	Glib::Threads::Mutex::Lock tl (_note_trackers_lock);
 
 	DEBUG_TRACE (DEBUG::MidiPlaylistIO,
 	             string_compose ("---- MidiPlaylist::read %1 .. %2 (%3 trackers) ----\n",
@@ -190,7 +191,7 @@ MidiPlaylist::read (Evoral::EventSink<framepos_t>& dst,
 		}
 
 		/* Read from region into target. */
-		mr->read_at (tgt, start, dur, chan_n, _note_mode, &tracker->tracker, filter);
+		mr->read_at (tgt, start, dur, tracker->cursor, chan_n, _note_mode, &tracker->tracker, filter);
 		DEBUG_TRACE (DEBUG::MidiPlaylistIO,
 		             string_compose ("\tPost-read: %1 active notes\n", tracker->tracker.on()));
 
@@ -247,6 +248,7 @@ MidiPlaylist::region_edited(boost::shared_ptr<Region>         region,
 
 	/* Take write lock to prevent concurrency with read(). */
 	Playlist::RegionWriteLock lock(this);
+	Glib::Threads::Mutex::Lock tl (_note_trackers_lock);
 
 	NoteTrackers::iterator t = _note_trackers.find(mr.get());
 	if (t == _note_trackers.end()) {
@@ -256,13 +258,14 @@ MidiPlaylist::region_edited(boost::shared_ptr<Region>         region,
 	/* Queue any necessary edit compensation events. */
 	t->second->fixer.prepare(
 		_session.tempo_map(), cmd, mr->position() - mr->start(),
-		_read_end, mr->midi_source()->model()->active_notes());
+		_read_end, t->second->cursor.active_notes);
 }
 
 void
 MidiPlaylist::reset_note_trackers ()
 {
 	Playlist::RegionWriteLock rl (this, false);
+	Glib::Threads::Mutex::Lock tl (_note_trackers_lock);
 
 	DEBUG_TRACE (DEBUG::MidiTrackers, string_compose ("%1 reset all note trackers\n", name()));
 	_note_trackers.clear ();
@@ -272,6 +275,7 @@ void
 MidiPlaylist::resolve_note_trackers (Evoral::EventSink<framepos_t>& dst, framepos_t time)
 {
 	Playlist::RegionWriteLock rl (this, false);
+	Glib::Threads::Mutex::Lock tl (_note_trackers_lock);
 
 	for (NoteTrackers::iterator n = _note_trackers.begin(); n != _note_trackers.end(); ++n) {
 		n->second->tracker.resolve_notes(dst, time);
@@ -284,6 +288,7 @@ void
 MidiPlaylist::remove_dependents (boost::shared_ptr<Region> region)
 {
 	/* MIDI regions have no dependents (crossfades) but we might be tracking notes */
+	Glib::Threads::Mutex::Lock tl (_note_trackers_lock);
 	_note_trackers.erase(region.get());
 }
 
@@ -347,6 +352,7 @@ MidiPlaylist::destroy_region (boost::shared_ptr<Region> region)
 
 			if ((*i) == region) {
 				regions.erase (i);
+				_region_index.invalidate ();
 				changed = true;
 			}
 
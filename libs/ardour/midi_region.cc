@@ -233,18 +233,20 @@ framecnt_t
 MidiRegion::read_at (Evoral::EventSink<framepos_t>& out,
                      framepos_t                     position,
                      framecnt_t                     dur,
+                     MidiCursor&                    cursor,
                      uint32_t                       chan_n,
                      NoteMode                       mode,
                      MidiStateTracker*              tracker,
                      MidiChannelFilter*             filter) const
 {
-	return _read_at (_sources, out, position, dur, chan_n, mode, tracker, filter);
+	return _read_at (_sources, out, position, dur, cursor, chan_n, mode, tracker, filter);
 }
 
 framecnt_t
 MidiRegion::master_read_at (MidiRingBuffer<framepos_t>& out, framepos_t position, framecnt_t dur, uint32_t chan_n, NoteMode mode) const
 {
-	return _read_at (_master_sources, out, position, dur, chan_n, mode); /* no tracker */
+	MidiCursor cursor; /* one-off read, so no cursor to carry on with */
+	return _read_at (_master_sources, out, position, dur, cursor, chan_n, mode); /* no tracker */
 }
 
 framecnt_t
@@ -252,6 +254,7 @@ MidiRegion::_read_at (const SourceList&              /*srcs*/,
                       Evoral::EventSink<framepos_t>& dst,
                       framepos_t                     position,
                       framecnt_t                     dur,
+                      MidiCursor&                    cursor,
                       uint32_t                       chan_n,
                       NoteMode                       mode,
                       MidiStateTracker*              tracker,
@@ -307,6 +310,7 @@ MidiRegion::_read_at (const SourceList&              /*srcs*/,
 			_position - _start, // start position of the source in session frames
 			_start + internal_offset, // where to start reading in the source
 			to_read, // read duration in frames
+			cursor,
 			tracker,
 			filter,
 			_filtered_parameters
@@ -434,9 +438,8 @@ MidiRegion::model_automation_state_changed (Evoral::Parameter const & p)
 		_filtered_parameters.insert (p);
 	}
 
-	/* the source will have an iterator into the model, and that iterator will have been set up
-	   for a given set of filtered_parameters, so now that we've changed that list we must invalidate
-	   the iterator.
+	/* readers of the source will have iterators into the model, set up for a given set of
+	   filtered_parameters, so now that we've changed that list we must invalidate them.
 	*/
 	Glib::Threads::Mutex::Lock lm (midi_source(0)->mutex(), Glib::Threads::TRY_LOCK);
 	if (lm.locked()) {
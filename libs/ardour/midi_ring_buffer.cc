@@ -34,34 +34,34 @@ namespace ARDOUR {
  *
  * Timestamps of events returned are relative to start (i.e. event with stamp 0
  * occurred at start), with offset added.
+ *
+ * The events are parsed in place and copied straight into @a dst, and the
+ * read pointer is only advanced once, after the last event that was read.
  */
 template<typename T>
 size_t
 MidiRingBuffer<T>::read(MidiBuffer& dst, framepos_t start, framepos_t end, framecnt_t offset, bool stop_on_overflow_in_dst)
 {
-	if (this->read_space() == 0) {
-		return 0;
-	}
+	typename RingBufferNPT<uint8_t>::rw_vector vec;
+	this->get_read_vector (&vec);
 
+	const size_t      avail = vec.len[0] + vec.len[1];
+	const size_t      prefix_size = sizeof(T) + sizeof(Evoral::EventType) + sizeof(uint32_t);
+	size_t            consumed = 0;
+	size_t            count = 0;
 	T                 ev_time;
 	uint32_t          ev_size;
-	size_t            count = 0;
-	const size_t      prefix_size = sizeof(T) + sizeof(Evoral::EventType) + sizeof(uint32_t);
 
-	while (this->read_space() >= prefix_size) {
+	while (avail - consumed >= prefix_size) {
 
-		uint8_t peekbuf[prefix_size];
+		uint8_t prefix[prefix_size];
+		this->read_from_vector (vec, consumed, prefix, prefix_size);
 
-		/* this cannot fail, because we've already verified that there
-		   is prefix_space to read
-		*/
-		this->peek (peekbuf, prefix_size);
+		ev_time = *(reinterpret_cast<T*>((uintptr_t)prefix));
+		ev_size = *(reinterpret_cast<uint32_t*>((uintptr_t)(prefix + sizeof(T) + sizeof (Evoral::EventType))));
 
-		ev_time = *(reinterpret_cast<T*>((uintptr_t)peekbuf));
-		ev_size = *(reinterpret_cast<uint32_t*>((uintptr_t)(peekbuf + sizeof(T) + sizeof (Evoral::EventType))));
-
-		if (this->read_space() < ev_size) {
-			break;;
+		if (avail - consumed - prefix_size < ev_size) {
+			break;
 		}
 
 		if (ev_time >= end) {
@@ -77,30 +77,23 @@ MidiRingBuffer<T>::read(MidiBuffer& dst, framepos_t start, framepos_t end, frame
 		ev_time -= start;
 		ev_time += offset;
 
-		/* we're good to go ahead and read the data now but since we
-		 * have the prefix data already, just skip over that
-		 */
-		this->increment_read_ptr (prefix_size);
-
-		uint8_t status;
-		bool r = this->peek (&status, sizeof(uint8_t));
-		assert (r); // If this failed, buffer is corrupt, all hope is lost
-
 		/* lets see if we are going to be able to write this event into dst.
 		 */
 		uint8_t* write_loc = dst.reserve (ev_time, ev_size);
 		if (write_loc == 0) {
 			if (stop_on_overflow_in_dst) {
+				/* leave this event in the ring for the next cycle */
 				DEBUG_TRACE (DEBUG::MidiDiskstreamIO, string_compose ("MidiRingBuffer: overflow in destination MIDI buffer, stopped after %1 events\n", count));
 				break;
 			}
 			error << "MRB: Unable to reserve space in buffer, event skipped" << endmsg;
-			this->increment_read_ptr (ev_size); // Advance read pointer to next event
+			consumed += prefix_size + ev_size; // Advance to next event
 			continue;
 		}
 
 		// write MIDI buffer contents
-		bool success = read_contents (ev_size, write_loc);
+		this->read_from_vector (vec, consumed + prefix_size, write_loc, ev_size);
+		consumed += prefix_size + ev_size;
 
 #ifndef NDEBUG
 		if (DEBUG_ENABLED (DEBUG::MidiDiskstreamIO)) {
@@ -117,12 +110,12 @@ MidiRingBuffer<T>::read(MidiBuffer& dst, framepos_t start, framepos_t end, frame
 		}
 #endif
 
-		if (success) {
-			_tracker.track(write_loc);
-			++count;
-		} else {
-			cerr << "WARNING: error reading event contents from MIDI ring" << endl;
-		}
+		_tracker.track(write_loc);
+		++count;
+	}
+
+	if (consumed) {
+		this->increment_read_ptr (consumed);
 	}
 
 	return count;
@@ -132,37 +125,32 @@ template<typename T>
 size_t
 MidiRingBuffer<T>::skip_to(framepos_t start)
 {
-	if (this->read_space() == 0) {
-		return 0;
-	}
+	typename RingBufferNPT<uint8_t>::rw_vector vec;
+	this->get_read_vector (&vec);
 
+	const size_t      avail = vec.len[0] + vec.len[1];
+	const size_t      prefix_size = sizeof(T) + sizeof(Evoral::EventType) + sizeof(uint32_t);
+	size_t            consumed = 0;
+	size_t            count = 0;
 	T                 ev_time;
 	uint32_t          ev_size;
-	size_t            count = 0;
-	const size_t      prefix_size = sizeof(T) + sizeof(Evoral::EventType) + sizeof(uint32_t);
 
-	while (this->read_space() >= prefix_size) {
+	while (avail - consumed >= prefix_size) {
 
-		uint8_t peekbuf[prefix_size];
-		this->peek (peekbuf, prefix_size);
+		uint8_t prefix[prefix_size];
+		this->read_from_vector (vec, consumed, prefix, prefix_size);
 
-		ev_time = *(reinterpret_cast<T*>((uintptr_t)peekbuf));
-		ev_size = *(reinterpret_cast<uint32_t*>((uintptr_t)(peekbuf + sizeof(T) + sizeof (Evoral::EventType))));
+		ev_time = *(reinterpret_cast<T*>((uintptr_t)prefix));
+		ev_size = *(reinterpret_cast<uint32_t*>((uintptr_t)(prefix + sizeof(T) + sizeof (Evoral::EventType))));
 
 		if (ev_time >= start) {
-			return count;
+			break;
 		}
 
-		if (this->read_space() < ev_size) {
-			continue;
+		if (avail - consumed - prefix_size < ev_size) {
+			break;
 		}
 
-		this->increment_read_ptr (prefix_size);
-
-		uint8_t status;
-		bool r = this->peek (&status, sizeof(uint8_t));
-		assert (r); // If this failed, buffer is corrupt, all hope is lost
-
 		++count;
 
 		/* TODO investigate and think:
@@ -177,17 +165,20 @@ MidiRingBuffer<T>::skip_to(framepos_t start)
 		 * but there may be more to this.
 		 */
 
-		if (ev_size >= 8) {
-			this->increment_read_ptr (ev_size);
-		} else {
+		if (ev_size < 8) {
 			// we only track note on/off, 8 bytes are plenty.
 			uint8_t write_loc[8];
-			bool success = read_contents (ev_size, write_loc);
-			if (success) {
-				_tracker.track(write_loc);
-			}
+			this->read_from_vector (vec, consumed + prefix_size, write_loc, ev_size);
+			_tracker.track(write_loc);
 		}
+
+		consumed += prefix_size + ev_size;
 	}
+
+	if (consumed) {
+		this->increment_read_ptr (consumed);
+	}
+
 	return count;
 }
 
@@ -26,6 +26,7 @@
 #include <cmath>
 #include <iomanip>
 #include <algorithm>
+#include <map>
 
 #include <glibmm/fileutils.h>
 #include <glibmm/miscutils.h>
@@ -60,22 +61,22 @@ PBD::Signal1<void,MidiSource*> MidiSource::MidiSourceCreated;
 MidiSource::MidiSource (Session& s, string name, Source::Flag flags)
 	: Source(s, DataType::MIDI, name, flags)
 	, _writing(false)
-	, _model_iter_valid(false)
 	, _length_beats(0.0)
-	, _last_read_end(0)
 	, _capture_length(0)
 	, _capture_loop_length(0)
+	, _seek_index_valid(false)
+	, _seek_index_notes(0)
 {
 }
 
 MidiSource::MidiSource (Session& s, const XMLNode& node)
 	: Source(s, node)
 	, _writing(false)
-	, _model_iter_valid(false)
 	, _length_beats(0.0)
-	, _last_read_end(0)
 	, _capture_length(0)
 	, _capture_loop_length(0)
+	, _seek_index_valid(false)
+	, _seek_index_notes(0)
 {
 	if (set_state (node, Stateful::loading_state_version)) {
 		throw failed_constructor();
@@ -178,10 +179,87 @@ MidiSource::update_length (framecnt_t)
 }
 
 void
-MidiSource::invalidate (const Lock& lock, std::set<Evoral::Sequence<Evoral::Beats>::WeakNotePtr>* notes)
+MidiSource::invalidate (const Lock& lock)
 {
-	_model_iter_valid = false;
-	_model_iter.invalidate(notes);
+	_seek_index_valid = false;
+	Invalidated (_session.transport_rolling ()); /* EMIT SIGNAL */
+}
+
+/** Build the index used to find the notes sounding at a given time without
+ *  walking the whole model.
+ */
+void
+MidiSource::build_seek_index () const
+{
+	typedef Evoral::Sequence<Evoral::Beats>::Notes Notes;
+
+	/* notes which may still be sounding, by end time */
+	std::multimap<Evoral::Beats, NotePtr> sounding;
+	const Notes& notes (_model->notes());
+	size_t n = 0;
+
+	_seek_index.clear ();
+
+	for (Notes::const_iterator i = notes.begin(); i != notes.end(); ++i, ++n) {
+
+		const Evoral::Beats t = (*i)->time();
+
+		if ((n % seek_interval) == 0) {
+
+			sounding.erase (sounding.begin(), sounding.lower_bound (t));
+
+			SeekPoint p;
+			p.time = t;
+			for (std::multimap<Evoral::Beats, NotePtr>::const_iterator a = sounding.begin(); a != sounding.end(); ++a) {
+				if (a->second->time() < t) {
+					p.active.push_back (a->second);
+				}
+			}
+			_seek_index.push_back (p);
+		}
+
+		sounding.insert (std::make_pair ((*i)->end_time(), *i));
+	}
+
+	_seek_index_notes = notes.size ();
+	_seek_index_valid = true;
+
+	DEBUG_TRACE (DEBUG::MidiSourceIO, string_compose ("%1: built seek index with %2 points for %3 notes\n",
+	                                                  _name, _seek_index.size(), _seek_index_notes));
+}
+
+/** Add the notes which begin before @a t and end at or after it to @a notes. */
+void
+MidiSource::notes_active_at (Evoral::Beats t, std::set<WeakNotePtr>& notes) const
+{
+	typedef Evoral::Sequence<Evoral::Beats>::Notes Notes;
+
+	if (!_seek_index_valid || _seek_index_notes != _model->notes().size()) {
+		build_seek_index ();
+	}
+
+	/* the last seek point at or before t */
+	std::vector<SeekPoint>::const_iterator p = std::upper_bound (_seek_index.begin(), _seek_index.end(), t, SeekPointLater());
+
+	if (p == _seek_index.begin()) {
+		return;
+	}
+
+	--p;
+
+	for (std::vector<NotePtr>::const_iterator a = p->active.begin(); a != p->active.end(); ++a) {
+		if ((*a)->end_time() >= t) {
+			notes.insert (*a);
+		}
+	}
+
+	/* and those which began between the seek point and t */
+
+	for (Notes::const_iterator i = _model->note_lower_bound (p->time); i != _model->notes().end() && (*i)->time() < t; ++i) {
+		if ((*i)->end_time() >= t) {
+			notes.insert (*i);
+		}
+	}
 }
 
 framecnt_t
@@ -190,6 +268,7 @@ MidiSource::midi_read (const Lock&                        lm,
                        framepos_t                         source_start,
                        framepos_t                         start,
                        framecnt_t                         cnt,
+                       MidiCursor&                        cursor,
                        MidiStateTracker*                  tracker,
                        MidiChannelFilter*                 filter,
                        const std::set<Evoral::Parameter>& filtered) const
@@ -201,62 +280,39 @@ MidiSource::midi_read (const Lock&                        lm,
 	                             source_start, start, cnt, tracker, name()));
 
 	if (_model) {
-		// Find appropriate model iterator
-		Evoral::Sequence<Evoral::Beats>::const_iterator& i = _model_iter;
-		const bool linear_read = _last_read_end != 0 && start == _last_read_end;
-		if (!linear_read || !_model_iter_valid) {
-#if 0
-			// Cached iterator is invalid, search for the first event past start
-			i = _model->begin(converter.from(start), false, filtered,
-			                  linear_read ? &_model->active_notes() : NULL);
-			_model_iter_valid = true;
+		/* A source may be read by several regions at once, so the
+		   iterator lives in the reader's cursor, and we only need to seek
+		   when this reader does not carry on from its last read.
+
+		   The model's notes only hold note ons, so the iterator's note
+		   offs come from its active notes; when seeking, those are the
+		   notes sounding at the seek point (see
+		   http://tracker.ardour.org/view.php?id=6541) plus any the cursor
+		   kept when it was last invalidated.
+		*/
+		Evoral::Sequence<Evoral::Beats>::const_iterator& i = cursor.iter;
+		const bool linear_read = cursor.last_read_end != 0 && start == cursor.last_read_end;
+
+		if (!linear_read || !i.valid()) {
+			const Evoral::Beats t = converter.from (start);
+
 			if (!linear_read) {
-				_model->active_notes().clear();
+				cursor.active_notes.clear ();
 			}
-#else
-			/* hot-fix http://tracker.ardour.org/view.php?id=6541
-			 * "parallel playback of linked midi regions -> no note-offs"
-			 *
-			 * A midi source can be used by multiple tracks simultaneously,
-			 * in which case midi_read() may be called from different tracks for
-			 * overlapping time-ranges.
-			 *
-			 * However there is only a single iterator for a given midi-source.
-			 * This results in every midi_read() performing a seek.
-			 *
-			 * If seeking is performed with
-			 *    _model->begin(converter.from(start),...)
-			 * the model is used for seeking. That method seeks to the first
-			 * *note-on* event after 'start'.
-			 *
-			 * _model->begin(converter.from(  ) ,..) eventually calls
-			 * Sequence<Time>::const_iterator() in libs/evoral/src/Sequence.cpp
-			 * which looks up the note-event via seq.note_lower_bound(t);
-			 * but the sequence 'seq' only contains note-on events(!).
-			 * note-off events are implicit in Sequence<Time>::operator++()
-			 * via _active_notes.pop(); and not part of seq.
-			 *
-			 * see also http://tracker.ardour.org/view.php?id=6287#c16671
-			 *
-			 * The linear search below assures that reading starts at the first
-			 * event for the given time, regardless of its event-type.
-			 *
-			 * The performance of this approach is O(N), while the previous
-			 * implementation is O(log(N)). This needs to be optimized:
-			 * The model-iterator or event-sequence needs to be re-designed in
-			 * some way (maybe keep an iterator per playlist).
-			 */
-			for (i = _model->begin(); i != _model->end(); ++i) {
-				const framecnt_t time_frames = converter.to(i->time());
-				if (time_frames >= start) {
-					break;
-				}
+
+			notes_active_at (t, cursor.active_notes);
+
+			cursor.connect (Invalidated);
+			i = _model->begin (t, false, filtered, &cursor.active_notes);
+			cursor.active_notes.clear ();
+
+			/* skip anything that rounds to before start */
+			while (i != _model->end() && converter.to (i->time()) < start) {
+				++i;
 			}
-			_model_iter_valid = true;
-#endif
 		}
 
-		_last_read_end = start + cnt;
+		cursor.last_read_end = start + cnt;
 
 		// Copy events in [start, start + cnt) into dst
 		for (; i != _model->end(); ++i) {
@@ -301,7 +357,6 @@ MidiSource::midi_write (const Lock&                 lm,
 	const framecnt_t ret = write_unlocked (lm, source, source_start, cnt);
 
 	if (cnt == max_framecnt) {
-		_last_read_end = 0;
 		invalidate(lm);
 	} else {
 		_capture_length += cnt;
@@ -20,6 +20,7 @@
 #include <iostream>
 
 #include "pbd/compose.h"
+#include "pbd/ffs.h"
 #include "pbd/stacktrace.h"
 
 #include "evoral/EventSink.hpp"
@@ -34,23 +35,58 @@ using namespace ARDOUR;
 
 
 MidiStateTracker::MidiStateTracker ()
+	: _active_channels (0)
+	, _on (0)
 {
-	reset ();
+	memset (_active_notes, 0, sizeof (_active_notes));
+	memset (_active_bits, 0, sizeof (_active_bits));
 }
 
 void
 MidiStateTracker::reset ()
 {
 	DEBUG_TRACE (PBD::DEBUG::MidiTrackers, string_compose ("%1: reset\n", this));
-	memset (_active_notes, 0, sizeof (_active_notes));
+
+	/* only the counts of sounding notes can be non-zero */
+	for (uint16_t channels = _active_channels; channels; channels &= channels - 1) {
+		const int channel = PBD::ffs (channels) - 1;
+		for (int word = 0; word < 4; ++word) {
+			for (uint32_t bits = _active_bits[channel][word]; bits; bits &= bits - 1) {
+				_active_notes[(word << 5) + PBD::ffs (bits) - 1 + 128 * channel] = 0;
+			}
+			_active_bits[channel][word] = 0;
+		}
+	}
+
+	_active_channels = 0;
 	_on = 0;
 }
 
+inline void
+MidiStateTracker::set_active (uint8_t note, uint8_t chn)
+{
+	_active_bits[chn][note >> 5] |= (1U << (note & 0x1f));
+	_active_channels |= (1 << chn);
+}
+
+inline void
+MidiStateTracker::clear_active (uint8_t note, uint8_t chn)
+{
+	uint32_t* const bits = _active_bits[chn];
+
+	bits[note >> 5] &= ~(1U << (note & 0x1f));
+
+	if (!(bits[0] | bits[1] | bits[2] | bits[3])) {
+		_active_channels &= ~(1 << chn);
+	}
+}
+
 void
 MidiStateTracker::add (uint8_t note, uint8_t chn)
 {
 	if (_active_notes[note+128 * chn] == 0) {
 		++_on;
+		set_active (note, chn);
 	}
 	++_active_notes[note + 128 * chn];
 
@@ -72,6 +108,7 @@ MidiStateTracker::remove (uint8_t note, uint8_t chn)
 	case 1:
 		--_on;
 		_active_notes [note + 128 * chn] = 0;
+		clear_active (note, chn);
 		break;
 	default:
 		--_active_notes [note + 128 * chn];
@@ -118,22 +155,32 @@ MidiStateTracker::resolve_notes (MidiBuffer &dst, framepos_t time)
 		return;
 	}
 
-	for (int channel = 0; channel < 16; ++channel) {
-		for (int note = 0; note < 128; ++note) {
-			while (_active_notes[note + 128 * channel]) {
-				uint8_t buffer[3] = { ((uint8_t) (MIDI_CMD_NOTE_OFF | channel)), uint8_t (note), 0 };
-				Evoral::MIDIEvent<MidiBuffer::TimeType> noteoff
-					(MIDI_CMD_NOTE_OFF, time, 3, buffer, false);
-				/* note that we do not care about failure from
-				   push_back() ... should we warn someone ?
-				*/
-				dst.push_back (noteoff);
-				_active_notes[note + 128 * channel]--;
-				DEBUG_TRACE (PBD::DEBUG::MidiTrackers, string_compose ("%1: MB-resolved note %2/%3 at %4\n",
-										       this, (int) note, (int) channel, time));
+	for (uint16_t channels = _active_channels; channels; channels &= channels - 1) {
+		const int channel = PBD::ffs (channels) - 1;
+		for (int word = 0; word < 4; ++word) {
+			for (uint32_t bits = _active_bits[channel][word]; bits; bits &= bits - 1) {
+				const int note = (word << 5) + PBD::ffs (bits) - 1;
+				while (_active_notes[note + 128 * channel]) {
+					/* write straight into the buffer: the note off is
+					   known to be valid, so push_back()'s checks are
+					   not needed. Note that we do not care about the
+					   buffer being full ... should we warn someone ?
+					*/
+					uint8_t* const ev = dst.reserve (time, 3);
+					if (ev) {
+						ev[0] = MIDI_CMD_NOTE_OFF | channel;
+						ev[1] = note;
+						ev[2] = 0;
+					}
+					_active_notes[note + 128 * channel]--;
+					DEBUG_TRACE (PBD::DEBUG::MidiTrackers, string_compose ("%1: MB-resolved note %2/%3 at %4\n",
+											       this, (int) note, (int) channel, time));
+				}
 			}
+			_active_bits[channel][word] = 0;
 		}
 	}
+	_active_channels = 0;
 	_on = 0;
 }
 
@@ -148,22 +195,28 @@ MidiStateTracker::resolve_notes (Evoral::EventSink<framepos_t> &dst, framepos_t
 		return;
 	}
 
-	for (int channel = 0; channel < 16; ++channel) {
-		for (int note = 0; note < 128; ++note) {
-			while (_active_notes[note + 128 * channel]) {
-				buf[0] = MIDI_CMD_NOTE_OFF|channel;
-				buf[1] = note;
-				buf[2] = 0;
-				/* note that we do not care about failure from
-				   write() ... should we warn someone ?
-				*/
-				dst.write (time, midi_parameter_type (buf[0]), 3, buf);
-				_active_notes[note + 128 * channel]--;
-				DEBUG_TRACE (PBD::DEBUG::MidiTrackers, string_compose ("%1: EVS-resolved note %2/%3 at %4\n",
-										       this, (int) note, (int) channel, time));
+	for (uint16_t channels = _active_channels; channels; channels &= channels - 1) {
+		const int channel = PBD::ffs (channels) - 1;
+		for (int word = 0; word < 4; ++word) {
+			for (uint32_t bits = _active_bits[channel][word]; bits; bits &= bits - 1) {
+				const int note = (word << 5) + PBD::ffs (bits) - 1;
+				while (_active_notes[note + 128 * channel]) {
+					buf[0] = MIDI_CMD_NOTE_OFF|channel;
+					buf[1] = note;
+					buf[2] = 0;
+					/* note that we do not care about failure from
+					   write() ... should we warn someone ?
+					*/
+					dst.write (time, midi_parameter_type (buf[0]), 3, buf);
+					_active_notes[note + 128 * channel]--;
+					DEBUG_TRACE (PBD::DEBUG::MidiTrackers, string_compose ("%1: EVS-resolved note %2/%3 at %4\n",
+											       this, (int) note, (int) channel, time));
+				}
 			}
+			_active_bits[channel][word] = 0;
 		}
 	}
+	_active_channels = 0;
 	_on = 0;
 }
 
@@ -178,23 +231,29 @@ MidiStateTracker::resolve_notes (MidiSource& src, const MidiSource::Lock& lock,
 
 	/* NOTE: the src must be locked */
 
-	for (int channel = 0; channel < 16; ++channel) {
-		for (int note = 0; note < 128; ++note) {
-			while (_active_notes[note + 128 * channel]) {
-				Evoral::MIDIEvent<Evoral::Beats> ev ((MIDI_CMD_NOTE_OFF|channel), time, 3, 0, true);
-				ev.set_type (MIDI_CMD_NOTE_OFF);
-				ev.set_channel (channel);
-				ev.set_note (note);
-				ev.set_velocity (0);
-				src.append_event_beats (lock, ev);
-				DEBUG_TRACE (PBD::DEBUG::MidiTrackers, string_compose ("%1: MS-resolved note %2/%3 at %4\n",
-										       this, (int) note, (int) channel, time));
-				_active_notes[note + 128 * channel]--;
-				/* don't stack events up at the same time */
-				time += Evoral::Beats::tick();
+	for (uint16_t channels = _active_channels; channels; channels &= channels - 1) {
+		const int channel = PBD::ffs (channels) - 1;
+		for (int word = 0; word < 4; ++word) {
+			for (uint32_t bits = _active_bits[channel][word]; bits; bits &= bits - 1) {
+				const int note = (word << 5) + PBD::ffs (bits) - 1;
+				while (_active_notes[note + 128 * channel]) {
+					Evoral::MIDIEvent<Evoral::Beats> ev ((MIDI_CMD_NOTE_OFF|channel), time, 3, 0, true);
+					ev.set_type (MIDI_CMD_NOTE_OFF);
+					ev.set_channel (channel);
+					ev.set_note (note);
+					ev.set_velocity (0);
+					src.append_event_beats (lock, ev);
+					DEBUG_TRACE (PBD::DEBUG::MidiTrackers, string_compose ("%1: MS-resolved note %2/%3 at %4\n",
+											       this, (int) note, (int) channel, time));
+					_active_notes[note + 128 * channel]--;
+					/* don't stack events up at the same time */
+					time += Evoral::Beats::tick();
+				}
 			}
+			_active_bits[channel][word] = 0;
 		}
 	}
+	_active_channels = 0;
 	_on = 0;
 }
 
@@ -202,9 +261,11 @@ void
 MidiStateTracker::dump (ostream& o)
 {
 	o << "******\n";
-	for (int c = 0; c < 16; ++c) {
-		for (int x = 0; x < 128; ++x) {
-			if (_active_notes[c * 128 + x]) {
+	for (uint16_t channels = _active_channels; channels; channels &= channels - 1) {
+		const int c = PBD::ffs (channels) - 1;
+		for (int word = 0; word < 4; ++word) {
+			for (uint32_t bits = _active_bits[c][word]; bits; bits &= bits - 1) {
+				const int x = (word << 5) + PBD::ffs (bits) - 1;
 				o << "Channel " << c+1 << " Note " << x << " is on ("
 				  << (int) _active_notes[c*128+x] <<  "times)\n";
 			}
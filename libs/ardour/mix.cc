@@ -142,6 +142,43 @@ default_copy_vector (ARDOUR::Sample * dst, const ARDOUR::Sample * src, pframes_t
 	memcpy(dst, src, nframes*sizeof(ARDOUR::Sample));
 }
 
+double
+default_apply_gain_ramp_to_buffer (ARDOUR::Sample * buf, pframes_t nframes, double initial, double target, double coeff)
+{
+	double g = initial;
+
+	for (pframes_t i = 0; i < nframes; i++) {
+		buf[i] *= g;
+		g += coeff * (target - g);
+	}
+
+	return g;
+}
+
+double
+default_mix_buffers_with_gain_ramp (ARDOUR::Sample * dst, const ARDOUR::Sample * src, pframes_t nframes, double initial, double target, double coeff)
+{
+	double g = initial;
+
+	for (pframes_t i = 0; i < nframes; i++) {
+		dst[i] += src[i] * g;
+		g += coeff * (target - g);
+	}
+
+	return g;
+}
+
+float
+default_mix_buffers_with_peak (ARDOUR::Sample * dst, const ARDOUR::Sample * src, pframes_t nframes, float gain, float current)
+{
+	for (pframes_t i = 0; i < nframes; i++) {
+		dst[i] += src[i] * gain;
+		current = f_max (current, fabsf (dst[i]));
+	}
+
+	return current;
+}
+
 #if defined (__APPLE__) && defined (BUILD_VECLIB_OPTIMIZATIONS)
 #include <Accelerate/Accelerate.h>
 
@@ -17,6 +17,8 @@
 
 */
 
+#include <algorithm>
+
 #include "pbd/convert.h"
 #include "pbd/error.h"
 #include "pbd/locale_guard.h"
@@ -283,6 +285,11 @@ MonitorProcessor::run (BufferSet& bufs, framepos_t /*start_frame*/, framepos_t /
                 solo_boost = GAIN_COEFF_UNITY;
         }
 
+        /* when mono-izing, every channel but the first is mixed into the
+           first, scaled by the number of channels, as its gain is applied.
+        */
+        const gain_t mono_scale = 1.f / (float) std::max (bufs.count().n_audio(), (uint32_t) 1);
+
         for (BufferSet::audio_iterator b = bufs.audio_begin(); b != bufs.audio_end(); ++b) {
 
                 /* don't double-scale by both track dim and global dim coefficients */
@@ -299,44 +306,31 @@ MonitorProcessor::run (BufferSet& bufs, framepos_t /*start_frame*/, framepos_t /
                         }
                 }
 
-                if (target_gain != _channels[chn]->current_gain || target_gain != GAIN_COEFF_UNITY) {
+                if (_mono && chn > 0) {
 
-                        _channels[chn]->current_gain = Amp::apply_gain (*b, _session.nominal_frame_rate(), nframes, _channels[chn]->current_gain, target_gain);
-                }
+                        /* mix into the first channel, which was scaled when we were there */
 
-                ++chn;
-        }
+                        _channels[chn]->current_gain = Amp::apply_gain (bufs.get_audio (0), *b, _session.nominal_frame_rate(), nframes, _channels[chn]->current_gain, target_gain, mono_scale);
 
-        if (_mono) {
-                DEBUG_TRACE (DEBUG::Monitor, "mono-izing\n");
-
-                /* chn is now the number of channels, use as a scaling factor when mixing
-                 */
-                gain_t scale = 1.f / (float)chn;
-                BufferSet::audio_iterator b = bufs.audio_begin();
-                AudioBuffer& ab (*b);
-                Sample* buf = ab.data();
+                } else if (target_gain != _channels[chn]->current_gain || target_gain != GAIN_COEFF_UNITY) {
 
-                /* scale the first channel */
+                        _channels[chn]->current_gain = Amp::apply_gain (*b, _session.nominal_frame_rate(), nframes, _channels[chn]->current_gain, target_gain);
+                }
 
-                for (pframes_t n = 0; n < nframes; ++n) {
-                        buf[n] *= scale;
+                if (_mono && chn == 0) {
+                        DEBUG_TRACE (DEBUG::Monitor, "mono-izing\n");
+                        Amp::apply_simple_gain (*b, nframes, mono_scale);
                 }
 
-                /* add every other channel into the first channel's buffer */
+                ++chn;
+        }
 
-                ++b;
-                for (; b != bufs.audio_end(); ++b) {
-                        AudioBuffer& ob (*b);
-                        Sample* obuf = ob.data ();
-                        for (pframes_t n = 0; n < nframes; ++n) {
-                                buf[n] += obuf[n] * scale;
-                        }
-                }
+        if (_mono) {
 
                 /* copy the first channel to every other channel's buffer */
 
-                b = bufs.audio_begin();
+                Sample* buf = bufs.get_audio (0).data ();
+                BufferSet::audio_iterator b = bufs.audio_begin();
                 ++b;
                 for (; b != bufs.audio_end(); ++b) {
                         AudioBuffer& ob (*b);
@@ -185,7 +185,7 @@ Pannable::get_state ()
 }
 
 XMLNode&
-Pannable::state (bool /*full*/)
+Pannable::state (bool full)
 {
 	XMLNode* node = new XMLNode (X_("Pannable"));
 
@@ -195,7 +195,7 @@ Pannable::state (bool /*full*/)
 	node->add_child_nocopy (pan_frontback_control->get_state());
 	node->add_child_nocopy (pan_lfe_control->get_state());
 
-	node->add_child_nocopy (get_automation_xml_state ());
+	node->add_child_nocopy (get_automation_xml_state (full));
 
 	return *node;
 }
@@ -751,6 +751,7 @@ Playlist::flush_notifications (bool from_undo)
 
 	 regions.insert (upper_bound (regions.begin(), regions.end(), region, cmp), region);
 	 all_regions.insert (region);
+	 _region_index.invalidate ();
 
 	 possibly_splice_unlocked (position, region->length(), region);
 
@@ -811,6 +812,7 @@ Playlist::flush_notifications (bool from_undo)
 			 framecnt_t distance = (*i)->length();
 
 			 regions.erase (i);
+			 _region_index.invalidate ();
 
 			 possibly_splice_unlocked (pos, -distance);
 
@@ -1560,6 +1562,7 @@ Playlist::region_bounds_changed (const PropertyChange& what_changed, boost::shar
 
 		 regions.erase (i);
 		 regions.insert (upper_bound (regions.begin(), regions.end(), region, cmp), region);
+		 _region_index.invalidate ();
 	 }
 
 	 if (what_changed.contains (Properties::position) || what_changed.contains (Properties::length)) {
@@ -1600,6 +1603,13 @@ Playlist::region_bounds_changed (const PropertyChange& what_changed, boost::shar
 		 return;
 	 }
 
+	 if (what_changed.contains (Properties::position) || what_changed.contains (Properties::length)) {
+		 /* do this even if we are going to ignore the change below, since
+		    the region's bounds have changed whether we like it or not.
+		 */
+		 _region_index.invalidate ();
+	 }
+
 	 /* this makes a virtual call to the right kind of playlist ... */
 
 	 region_changed (what_changed, region);
@@ -1660,6 +1670,7 @@ Playlist::region_bounds_changed (const PropertyChange& what_changed, boost::shar
 	 RegionWriteLock rl (this);
 	 regions.clear ();
 	 all_regions.clear ();
+	 _region_index.invalidate ();
  }
 
  void
@@ -1687,6 +1698,7 @@ Playlist::region_bounds_changed (const PropertyChange& what_changed, boost::shar
 		 }
 
 		 regions.clear ();
+		 _region_index.invalidate ();
 
 		 for (set<boost::shared_ptr<Region> >::iterator s = pending_removes.begin(); s != pending_removes.end(); ++s) {
 			 remove_dependents (*s);
@@ -1721,15 +1733,7 @@ Playlist::regions_at (framepos_t frame)
  Playlist::count_regions_at (framepos_t frame) const
  {
 	 RegionReadLock rlock (const_cast<Playlist*>(this));
-	 uint32_t cnt = 0;
-
-	 for (RegionList::const_iterator i = regions.begin(); i != regions.end(); ++i) {
-		 if ((*i)->covers (frame)) {
-			 cnt++;
-		 }
-	 }
-
-	 return cnt;
+	 return _region_index.count_touched (regions.begin(), regions.end(), frame, frame);
  }
 
  boost::shared_ptr<Region>
@@ -1785,13 +1789,7 @@ Playlist::find_regions_at (framepos_t frame)
 	/* Caller must hold lock */
 
 	boost::shared_ptr<RegionList> rlist (new RegionList);
-
-	for (RegionList::iterator i = regions.begin(); i != regions.end(); ++i) {
-		if ((*i)->covers (frame)) {
-			rlist->push_back (*i);
-		}
-	}
-
+	_region_index.regions_touched (regions.begin(), regions.end(), frame, frame, *rlist);
 	return rlist;
 }
 
@@ -1801,7 +1799,11 @@ Playlist::regions_with_start_within (Evoral::Range<framepos_t> range)
 	RegionReadLock rlock (this);
 	boost::shared_ptr<RegionList> rlist (new RegionList);
 
-	for (RegionList::iterator i = regions.begin(); i != regions.end(); ++i) {
+	/* any region that starts within the range also touches it */
+	RegionList touched;
+	_region_index.regions_touched (regions.begin(), regions.end(), range.from, range.to, touched);
+
+	for (RegionList::iterator i = touched.begin(); i != touched.end(); ++i) {
 		if ((*i)->first_frame() >= range.from && (*i)->first_frame() <= range.to) {
 			rlist->push_back (*i);
 		}
@@ -1816,7 +1818,11 @@ Playlist::regions_with_end_within (Evoral::Range<framepos_t> range)
 	RegionReadLock rlock (this);
 	boost::shared_ptr<RegionList> rlist (new RegionList);
 
-	for (RegionList::iterator i = regions.begin(); i != regions.end(); ++i) {
+	/* any region that ends within the range also touches it */
+	RegionList touched;
+	_region_index.regions_touched (regions.begin(), regions.end(), range.from, range.to, touched);
+
+	for (RegionList::iterator i = touched.begin(); i != touched.end(); ++i) {
 		if ((*i)->last_frame() >= range.from && (*i)->last_frame() <= range.to) {
 			rlist->push_back (*i);
 		}
@@ -1840,13 +1846,7 @@ boost::shared_ptr<RegionList>
 Playlist::regions_touched_locked (framepos_t start, framepos_t end)
 {
 	boost::shared_ptr<RegionList> rlist (new RegionList);
-
-	for (RegionList::iterator i = regions.begin(); i != regions.end(); ++i) {
-		if ((*i)->coverage (start, end) != Evoral::OverlapNone) {
-			rlist->push_back (*i);
-		}
-	}
-
+	_region_index.regions_touched (regions.begin(), regions.end(), start, end, *rlist);
 	return rlist;
 }
 
@@ -2745,6 +2745,7 @@ Playlist::shuffle (boost::shared_ptr<Region> region, int dir)
 						regions.erase (i); // removes the region from the list */
 						next++;
 						regions.insert (next, region); // adds it back after next
+						_region_index.invalidate ();
 
 						moved = true;
 					}
@@ -2785,6 +2786,7 @@ Playlist::shuffle (boost::shared_ptr<Region> region, int dir)
 
 						regions.erase (i); // remove region
 						regions.insert (prev, region); // insert region before prev
+						_region_index.invalidate ();
 
 						moved = true;
 					}
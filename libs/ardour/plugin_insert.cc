@@ -21,6 +21,7 @@
 #include "libardour-config.h"
 #endif
 
+#include <limits>
 #include <string>
 
 #include "pbd/failed_constructor.h"
@@ -35,6 +36,7 @@
 #include "ardour/ladspa_plugin.h"
 #include "ardour/plugin.h"
 #include "ardour/plugin_insert.h"
+#include "ardour/rc_configuration.h"
 
 #ifdef LV2_SUPPORT
 #include "ardour/lv2_plugin.h"
@@ -67,6 +69,7 @@ PluginInsert::PluginInsert (Session& s, boost::shared_ptr<Plugin> plug)
 	: Processor (s, (plug ? plug->name() : string ("toBeRenamed")))
 	, _signal_analysis_collected_nframes(0)
 	, _signal_analysis_collect_nframes_max(0)
+	, _control_buffer_size (0)
 {
 	/* the first is the master */
 
@@ -114,6 +117,7 @@ PluginInsert::set_count (uint32_t num)
 
 PluginInsert::~PluginInsert ()
 {
+	free_control_buffers ();
 }
 
 void
@@ -263,6 +267,49 @@ PluginInsert::create_automatable_parameters ()
 			}
 		}
 	}
+
+	Glib::Threads::Mutex::Lock lm (control_lock ());
+	allocate_control_buffers (_session.get_block_size ());
+}
+
+void
+PluginInsert::allocate_control_buffers (pframes_t nframes)
+{
+	free_control_buffers ();
+
+	for (Controls::iterator li = controls().begin(); li != controls().end(); ++li) {
+
+		if (li->first.type() != PluginAutomation) {
+			continue;
+		}
+
+		bool sample_accurate = true;
+
+		for (Plugins::iterator i = _plugins.begin(); i != _plugins.end(); ++i) {
+			if (!(*i)->parameter_is_sample_accurate (li->first.id())) {
+				sample_accurate = false;
+				break;
+			}
+		}
+
+		if (sample_accurate) {
+			boost::shared_ptr<AutomationControl> c = boost::dynamic_pointer_cast<AutomationControl> (li->second);
+			_control_buffers.push_back (ControlBuffer (c, new float[nframes]));
+		}
+	}
+
+	_control_buffer_size = nframes;
+}
+
+void
+PluginInsert::free_control_buffers ()
+{
+	for (vector<ControlBuffer>::iterator b = _control_buffers.begin(); b != _control_buffers.end(); ++b) {
+		delete [] b->data;
+	}
+
+	_control_buffers.clear ();
+	_control_buffer_size = 0;
 }
 
 void
@@ -295,6 +342,16 @@ PluginInsert::set_block_size (pframes_t nframes)
 			ret = -1;
 		}
 	}
+
+	/* the process thread only uses the control buffers with control_lock()
+	   held (see automation_run()), and gives up on them for the cycle if it
+	   cannot take it, so they can be reallocated safely here.
+	*/
+	if (nframes > _control_buffer_size) {
+		Glib::Threads::Mutex::Lock lm (control_lock ());
+		allocate_control_buffers (nframes);
+	}
+
 	return ret;
 }
 
@@ -383,6 +440,14 @@ PluginInsert::connect_and_run (BufferSet& bufs, pframes_t nframes, framecnt_t of
 
 			}
 		}
+
+		for (vector<ControlBuffer>::iterator b = _control_buffers.begin(); b != _control_buffers.end(); ++b) {
+			if (b->active) {
+				for (Plugins::iterator i = _plugins.begin(); i != _plugins.end(); ++i) {
+					(*i)->set_parameter_buffer (b->control->parameter().id(), b->data + offset);
+				}
+			}
+		}
 	}
 
 	if (collect_signal_nframes > 0) {
@@ -556,17 +621,34 @@ PluginInsert::automation_run (BufferSet& bufs, framepos_t start, pframes_t nfram
 		return;
 	}
 
-	if (!find_next_event (now, end, next_event) || requires_fixed_sized_buffers()) {
+	/* parameters that can follow a buffer get the whole cycle's automation at
+	   once, so only the events of the others need to split the cycle.
+	*/
+
+	if (Config->get_sample_accurate_plugin_automation()) {
+		fill_control_buffers (now, nframes);
+	}
+
+	if (!find_next_split_event (now, end, next_event) || requires_fixed_sized_buffers()) {
 
 		/* no events have a time within the relevant range */
 
 		connect_and_run (bufs, nframes, offset, true, now);
+		release_control_buffers ();
 		return;
 	}
 
+	/* never split the cycle into pieces so small that the per-run overhead
+	   of the plugin swamps its actual work; events closer together than this
+	   take effect at the start of the next fragment.
+	*/
+
+	framecnt_t const min_fragment = max ((framecnt_t) Config->get_minimum_automation_fragment(), (framecnt_t) 1);
+
 	while (nframes) {
 
-		framecnt_t cnt = min (((framecnt_t) ceil (next_event.when) - now), (framecnt_t) nframes);
+		framecnt_t cnt = max (((framecnt_t) ceil (next_event.when) - now), min_fragment);
+		cnt = min (cnt, (framecnt_t) nframes);
 
 		connect_and_run (bufs, cnt, offset, true, now);
 
@@ -574,7 +656,7 @@ PluginInsert::automation_run (BufferSet& bufs, framepos_t start, pframes_t nfram
 		offset += cnt;
 		now += cnt;
 
-		if (!find_next_event (now, end, next_event)) {
+		if (!find_next_split_event (now, end, next_event)) {
 			break;
 		}
 	}
@@ -584,6 +666,68 @@ PluginInsert::automation_run (BufferSet& bufs, framepos_t start, pframes_t nfram
 	if (nframes) {
 		connect_and_run (bufs, nframes, offset, true, now);
 	}
+
+	release_control_buffers ();
+}
+
+/** Evaluate the automation of our sample-accurate parameters for a cycle */
+void
+PluginInsert::fill_control_buffers (framepos_t start, pframes_t nframes)
+{
+	if (nframes > _control_buffer_size) {
+		return;
+	}
+
+	for (vector<ControlBuffer>::iterator b = _control_buffers.begin(); b != _control_buffers.end(); ++b) {
+		b->active = b->control->list() && b->control->automation_playback()
+			&& b->control->list()->rt_safe_eval_vector (start, 1.0, b->data, nframes);
+	}
+}
+
+void
+PluginInsert::release_control_buffers ()
+{
+	for (vector<ControlBuffer>::iterator b = _control_buffers.begin(); b != _control_buffers.end(); ++b) {
+		if (b->active) {
+			for (Plugins::iterator i = _plugins.begin(); i != _plugins.end(); ++i) {
+				(*i)->set_parameter_buffer (b->control->parameter().id(), 0);
+			}
+			b->active = false;
+		}
+	}
+}
+
+/** As find_next_event(), but ignoring parameters whose automation is
+ *  already in a control buffer for this cycle.
+ */
+bool
+PluginInsert::find_next_split_event (double now, double end, Evoral::ControlEvent& next_event) const
+{
+	next_event.when = std::numeric_limits<double>::max();
+
+	for (Controls::const_iterator li = _controls.begin(); li != _controls.end(); ++li) {
+		boost::shared_ptr<AutomationControl> c
+			= boost::dynamic_pointer_cast<AutomationControl>(li->second);
+
+		if (!c || !c->automation_playback()) {
+			continue;
+		}
+
+		bool buffered = false;
+
+		for (vector<ControlBuffer>::const_iterator b = _control_buffers.begin(); b != _control_buffers.end(); ++b) {
+			if (b->active && b->control == c) {
+				buffered = true;
+				break;
+			}
+		}
+
+		if (!buffered) {
+			find_next_ac_event (li->second, now, end, next_event);
+		}
+	}
+
+	return next_event.when != std::numeric_limits<double>::max();
 }
 
 float
@@ -121,7 +121,7 @@ Processor::state (bool full_state)
 	}
 
 	if (full_state) {
-		XMLNode& automation = Automatable::get_automation_xml_state();
+		XMLNode& automation = Automatable::get_automation_xml_state (full_state);
 		if (!automation.children().empty() || !automation.properties().empty()) {
 			node->add_child_nocopy (automation);
 		}
@@ -0,0 +1,170 @@
+/*
+    Copyright (C) 2015 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#include <algorithm>
+
+#include "ardour/region.h"
+#include "ardour/region_index.h"
+
+using namespace std;
+using namespace ARDOUR;
+
+RegionIndex::RegionIndex ()
+	: _sorted (false)
+	, _dirty (1)
+{
+}
+
+void
+RegionIndex::invalidate ()
+{
+	g_atomic_int_set (&_dirty, 1);
+}
+
+void
+RegionIndex::regions_touched (RegionList::const_iterator b, RegionList::const_iterator e,
+                              framepos_t start, framepos_t end, RegionList& result)
+{
+	lookup (b, e, start, end, &result);
+}
+
+uint32_t
+RegionIndex::count_touched (RegionList::const_iterator b, RegionList::const_iterator e,
+                            framepos_t start, framepos_t end)
+{
+	return lookup (b, e, start, end, 0);
+}
+
+uint32_t
+RegionIndex::lookup (RegionList::const_iterator b, RegionList::const_iterator e,
+                     framepos_t start, framepos_t end, RegionList* result)
+{
+	uint32_t count = 0;
+
+	if (g_atomic_int_get (&_dirty)) {
+		Glib::Threads::RWLock::WriterLock lm (_lock);
+		/* another reader may have rebuilt it while we waited */
+		if (g_atomic_int_compare_and_exchange (&_dirty, 1, 0)) {
+			rebuild (b, e);
+		}
+	}
+
+	Glib::Threads::RWLock::ReaderLock lm (_lock);
+
+	if (_sorted) {
+		find (0, _entries.size(), start, end, result, count);
+	} else {
+		scan (b, e, start, end, result, count);
+	}
+
+	return count;
+}
+
+void
+RegionIndex::rebuild (RegionList::const_iterator b, RegionList::const_iterator e)
+{
+	_entries.clear ();
+	_sorted = true;
+
+	for (RegionList::const_iterator i = b; i != e; ++i) {
+		Entry entry;
+		entry.region = *i;
+		entry.first = (*i)->first_frame ();
+		entry.last = (*i)->last_frame ();
+		entry.max_last = entry.last;
+
+		if (!_entries.empty() && entry.first < _entries.back().first) {
+			_sorted = false;
+		}
+
+		_entries.push_back (entry);
+	}
+
+	if (_sorted) {
+		build_subtree (0, _entries.size());
+	} else {
+		_entries.clear ();
+	}
+}
+
+/** Fill in max_last for the subtree covering entries [lo, hi), whose root is the middle entry.
+ *  @return max_last of the root.
+ */
+framepos_t
+RegionIndex::build_subtree (size_t lo, size_t hi)
+{
+	if (lo >= hi) {
+		return INT64_MIN;
+	}
+
+	size_t const mid = lo + (hi - lo) / 2;
+	Entry& e = _entries[mid];
+
+	e.max_last = max (e.last, max (build_subtree (lo, mid), build_subtree (mid + 1, hi)));
+	return e.max_last;
+}
+
+void
+RegionIndex::find (size_t lo, size_t hi, framepos_t start, framepos_t end, RegionList* result, uint32_t& count) const
+{
+	while (lo < hi) {
+
+		size_t const mid = lo + (hi - lo) / 2;
+		Entry const & e = _entries[mid];
+
+		if (e.max_last < start) {
+			/* nothing in this subtree reaches as far as start */
+			return;
+		}
+
+		find (lo, mid, start, end, result, count);
+
+		if (e.first > end) {
+			/* this entry and everything after it starts after end */
+			return;
+		}
+
+		if (e.last >= start) {
+			boost::shared_ptr<Region> region = e.region.lock ();
+			if (region && region->coverage (start, end) != Evoral::OverlapNone) {
+				if (result) {
+					result->push_back (region);
+				}
+				++count;
+			}
+		}
+
+		/* carry on with the right subtree */
+		lo = mid + 1;
+	}
+}
+
+void
+RegionIndex::scan (RegionList::const_iterator b, RegionList::const_iterator e,
+                   framepos_t start, framepos_t end, RegionList* result, uint32_t& count) const
+{
+	for (RegionList::const_iterator i = b; i != e; ++i) {
+		if ((*i)->coverage (start, end) != Evoral::OverlapNone) {
+			if (result) {
+				result->push_back (*i);
+			}
+			++count;
+		}
+	}
+}
@@ -2288,7 +2288,7 @@ Route::state(bool full_state)
 	node->add_child_nocopy (_mute_master->get_state ());
 
 	if (full_state) {
-		node->add_child_nocopy (Automatable::get_automation_xml_state ());
+		node->add_child_nocopy (Automatable::get_automation_xml_state (full_state));
 	}
 
 	XMLNode* remote_control_node = new XMLNode (X_("RemoteControl"));
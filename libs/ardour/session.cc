@@ -302,6 +302,8 @@ Session::Session (AudioEngine &eng,
 	pthread_mutex_init (&_rt_emit_mutex, 0);
 	pthread_cond_init (&_rt_emit_cond, 0);
 
+	_click_points.reserve (max_click_points);
+
 	pre_engine_init (fullpath);
 
 	if (_is_new) {
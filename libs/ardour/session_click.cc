@@ -42,8 +42,6 @@ Pool Click::pool ("click", sizeof (Click), 1024);
 void
 Session::click (framepos_t start, framecnt_t nframes)
 {
-	TempoMap::BBTPointList::const_iterator points_begin;
-	TempoMap::BBTPointList::const_iterator points_end;
 	Sample *buf;
 	framecnt_t click_distance;
 
@@ -72,13 +70,14 @@ Session::click (framepos_t start, framecnt_t nframes)
 	BufferSet& bufs = get_scratch_buffers(ChanCount(DataType::AUDIO, 1));
 	buf = bufs.get_audio(0).data();
 
-	_tempo_map->get_grid (points_begin, points_end, start, end);
+	/* no cycle holds anywhere near this many beats, but never grow the list here */
+	_tempo_map->get_grid (_click_points, start, end, _click_points.capacity());
 
-	if (distance (points_begin, points_end) == 0) {
+	if (_click_points.empty()) {
 		goto run_clicks;
 	}
 
-	for (TempoMap::BBTPointList::const_iterator i = points_begin; i != points_end; ++i) {
+	for (TempoMap::BBTPointList::const_iterator i = _click_points.begin(); i != _click_points.end(); ++i) {
 		switch ((*i).beat) {
 		case 1:
 			if (click_emphasis_data && Config->get_use_click_emphasis () == true) {
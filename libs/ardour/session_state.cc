@@ -3191,6 +3191,7 @@ Session::cleanup_sources (CleanupReport& rep)
 	*/
 
 	save_state ("");
+	cleanup_automation_event_files (rep);
 	ret = 0;
 
   out:
@@ -3199,6 +3200,101 @@ Session::cleanup_sources (CleanupReport& rep)
 	return ret;
 }
 
+static bool
+accept_all_state_and_pending_files (const string& path, void* arg)
+{
+	if (accept_all_state_files (path, arg)) {
+		return true;
+	}
+
+	std::string const pending_ext (pending_suffix);
+	return (path.length() >= pending_ext.length() &&
+		0 == path.compare (path.length() - pending_ext.length(), pending_ext.length(), pending_ext));
+}
+
+static bool
+accept_all_event_files (const string& path, void* /*arg*/)
+{
+	if (!Glib::file_test (path, Glib::FILE_TEST_IS_REGULAR)) {
+		return false;
+	}
+
+	std::string const event_ext (X_(".events"));
+	return (path.length() >= event_ext.length() &&
+		0 == path.compare (path.length() - event_ext.length(), event_ext.length(), event_ext));
+}
+
+static void
+find_event_file_references (const XMLNode& node, set<string>& result)
+{
+	if (node.name() == X_("events")) {
+		const XMLProperty* prop;
+		if ((prop = node.property (X_("file"))) != 0) {
+			result.insert (prop->value());
+		}
+		return;
+	}
+
+	const XMLNodeList& children (node.children());
+
+	for (XMLNodeConstIterator i = children.begin(); i != children.end(); ++i) {
+		find_event_file_references (**i, result);
+	}
+}
+
+/** Remove the binary automation event files that no snapshot of this session
+ *  (including any pending state) refers to.  The undo history never refers
+ *  to event files.
+ */
+int
+Session::cleanup_automation_event_files (CleanupReport& rep)
+{
+	vector<string> state_files;
+	vector<string> event_files;
+	set<string> used;
+
+	find_files_matching_filter (event_files, automation_dir (), accept_all_event_files, (void *) 0, true, true);
+
+	if (event_files.empty()) {
+		return 0;
+	}
+
+	find_files_matching_filter (state_files, _session_dir->root_path(), accept_all_state_and_pending_files, (void *) 0, true, true);
+
+	for (vector<string>::iterator i = state_files.begin(); i != state_files.end(); ++i) {
+
+		XMLTree tree;
+
+		if (!tree.read (*i)) {
+			/* we cannot tell what this one refers to, so keep everything */
+			error << string_compose (_("Could not understand session file %1; automation data not cleaned up"), *i) << endmsg;
+			return -1;
+		}
+
+		find_event_file_references (*tree.root(), used);
+	}
+
+	for (vector<string>::iterator x = event_files.begin(); x != event_files.end(); ++x) {
+
+		if (used.find (Glib::path_get_basename (*x)) != used.end()) {
+			continue;
+		}
+
+		GStatBuf statbuf;
+		g_stat ((*x).c_str(), &statbuf);
+
+		if (::g_unlink ((*x).c_str()) != 0) {
+			error << string_compose (_("cannot remove unused automation data %1 (%2)"), *x, strerror (errno)) << endmsg;
+			continue;
+		}
+
+		rep.paths.push_back (*x);
+		rep.space += statbuf.st_size;
+	}
+
+	return 0;
+}
+
 int
 Session::cleanup_trash_sources (CleanupReport& rep)
 {
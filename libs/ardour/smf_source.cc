@@ -188,6 +188,8 @@ SMFSource::SMFSource (Session& s, const XMLNode& node, bool must_exist)
 SMFSource::~SMFSource ()
 {
 	if (removable()) {
+		/* drop any mapping of the file first, or it can not be removed on Windows */
+		Evoral::SMF::close ();
 		::g_unlink (_path.c_str());
 	}
 }
@@ -642,6 +644,11 @@ SMFSource::load_model (const Glib::Threads::Mutex::Lock& lock, bool force_reload
 	gint event_id;
 	bool have_event_id;
 
+	/* Events of a single track are already in time order and go straight
+	   into the model; those of several tracks have to be merged first.
+	*/
+	const bool single_track = (num_tracks() == 1);
+
 	// TODO simplify event allocation
 	std::list< std::pair< Evoral::Event<Evoral::Beats>*, gint > > eventlist;
 
@@ -684,11 +691,15 @@ SMFSource::load_model (const Glib::Threads::Mutex::Lock& lock, bool force_reload
 							delta_t, time, size, ss , event_type, event_id, name()));
 #endif
 
-				eventlist.push_back(make_pair (
-							new Evoral::Event<Evoral::Beats> (
-								event_type, event_time,
-								size, buf, true)
-							, event_id));
+				if (single_track) {
+					_model->append (Evoral::Event<Evoral::Beats> (event_type, event_time, size, buf, false), event_id);
+				} else {
+					eventlist.push_back(make_pair (
+								new Evoral::Event<Evoral::Beats> (
+									event_type, event_time,
+									size, buf, true)
+								, event_id));
+				}
 
 				// Set size to max capacity to minimize allocs in read_event
 				scratch_size = std::max(size, scratch_size);
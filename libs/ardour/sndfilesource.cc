@@ -25,7 +25,11 @@
 #include <cerrno>
 #include <climits>
 #include <cstdarg>
+#include <list>
+#include <map>
+#include <vector>
 #include <fcntl.h>
+#include <unistd.h>
 
 #include <sys/stat.h>
 
@@ -35,6 +39,9 @@
 #include <glibmm/convert.h>
 #include <glibmm/fileutils.h>
 #include <glibmm/miscutils.h>
+#include <glibmm/threads.h>
+
+#include <boost/weak_ptr.hpp>
 
 #include "ardour/sndfilesource.h"
 #include "ardour/sndfile_helpers.h"
@@ -57,6 +64,175 @@ const Source::Flag SndFileSource::default_writable_flags = Source::Flag (
 		Source::RemovableIfEmpty |
 		Source::CanRename );
 
+/** Recently decoded blocks of a multichannel file, each de-interleaved
+ *  into one contiguous run of samples per channel.
+ *
+ *  A multichannel file that is used as several sources (one per channel)
+ *  is normally read by all of them for the same range in the same butler
+ *  pass.  The first of them to read a range decodes every channel into
+ *  a block, and the others copy their channel out of it, so that the
+ *  file is read and decoded once rather than once per channel.
+ *
+ *  Channel sources do not always read the same range at the same time
+ *  (regions with different offsets into one file, varispeed, or a butler
+ *  pass over several regions of the file), so a few blocks are kept, and
+ *  the least recently used one is decoded into when none of them holds
+ *  a range.  With more than max_blocks different read positions in use
+ *  at once the blocks will evict each other, and each read decodes the
+ *  file again, as it would without the cache.
+ *
+ *  Only used for files that are not writable, so the cached data can
+ *  never be stale.
+ */
+class SndFileSource::BlockCache
+{
+  public:
+	BlockCache (uint32_t chans)
+		: channels (chans)
+	{}
+
+	/** @return the cache for the file at @param path, creating it if required */
+	static boost::shared_ptr<BlockCache> get (std::string const & path, uint32_t channels);
+
+	struct Block {
+		Block ()
+			: start (0)
+			, length (0)
+			, capacity (0)
+		{}
+
+		bool covers (framepos_t s, framecnt_t cnt) const {
+			return s >= start && s + cnt <= start + length;
+		}
+
+		Sample* channel_data (uint32_t chn) {
+			return &data[chn * capacity];
+		}
+
+		void ensure_capacity (framecnt_t frames, uint32_t channels) {
+			if (frames > capacity) {
+				capacity = frames;
+				data.resize (capacity * channels);
+			}
+		}
+
+		framepos_t           start;    ///< first frame in the block
+		framecnt_t           length;   ///< number of valid frames in the block
+		framecnt_t           capacity; ///< frames of space per channel
+		std::vector<Sample>  data;
+	};
+
+	/** @return the block that holds @param cnt frames from @param s,
+	 *  which becomes the most recently used, or 0.
+	 */
+	Block* find (framepos_t s, framecnt_t cnt) {
+		for (std::list<Block>::iterator b = blocks.begin(); b != blocks.end(); ++b) {
+			if (b->covers (s, cnt)) {
+				blocks.splice (blocks.begin(), blocks, b);
+				return &blocks.front ();
+			}
+		}
+		return 0;
+	}
+
+	/** @return an empty block to decode into; the least recently used
+	 *  one once there are max_blocks.
+	 */
+	Block& recycle () {
+		if (blocks.size() < max_blocks) {
+			blocks.push_front (Block ());
+		} else {
+			blocks.splice (blocks.begin(), blocks, --blocks.end());
+		}
+		blocks.front().length = 0;
+		return blocks.front ();
+	}
+
+	static const size_t max_blocks = 4;
+
+	Glib::Threads::Mutex lock;
+	uint32_t const       channels;
+
+  private:
+	std::list<Block> blocks; ///< most recently used first
+
+	typedef std::map<std::string, boost::weak_ptr<BlockCache> > Caches;
+	static Caches caches;
+	static Glib::Threads::Mutex caches_lock;
+};
+
+SndFileSource::BlockCache::Caches SndFileSource::BlockCache::caches;
+Glib::Threads::Mutex SndFileSource::BlockCache::caches_lock;
+
+boost::shared_ptr<SndFileSource::BlockCache>
+SndFileSource::BlockCache::get (std::string const & path, uint32_t channels)
+{
+	Glib::Threads::Mutex::Lock lm (caches_lock);
+
+	Caches::iterator i = caches.find (path);
+
+	if (i != caches.end()) {
+		boost::shared_ptr<BlockCache> c = i->second.lock ();
+		if (c && c->channels == channels) {
+			return c;
+		}
+	}
+
+	/* take the opportunity to forget about files that nobody is reading any more */
+
+	for (Caches::iterator x = caches.begin(); x != caches.end(); ) {
+		if (x->second.expired ()) {
+			caches.erase (x++);
+		} else {
+			++x;
+		}
+	}
+
+	boost::shared_ptr<BlockCache> c (new BlockCache (channels));
+	caches[path] = c;
+	return c;
+}
+
+/** Split @param nframes frames of @param channels channel interleaved
+ *  data from @param src into one run per channel, each @param stride
+ *  samples apart, starting at @param dst.
+ */
+static void
+deinterleave (Sample const * src, Sample* dst, uint32_t channels, framecnt_t nframes, framecnt_t stride)
+{
+	switch (channels) {
+	case 2: {
+		Sample* l = dst;
+		Sample* r = dst + stride;
+		for (framecnt_t n = 0; n < nframes; ++n) {
+			l[n] = src[2*n];
+			r[n] = src[2*n+1];
+		}
+		break;
+	}
+
+	default: {
+		/* Work through the interleaved data in blocks that fit in
+		   the cache, writing each channel's part of the block in one
+		   sequential run; this lets the compiler vectorize the inner
+		   loop and keeps the strided reads from thrashing.
+		*/
+		framecnt_t const block = 256;
+		for (framecnt_t b = 0; b < nframes; b += block) {
+			framecnt_t const n = min (block, nframes - b);
+			Sample const * in = src + b * channels;
+			for (uint32_t c = 0; c < channels; ++c) {
+				Sample* out = dst + c * stride + b;
+				for (framecnt_t f = 0; f < n; ++f) {
+					out[f] = in[f * channels + c];
+				}
+			}
+		}
+		break;
+	}
+	}
+}
+
 SndFileSource::SndFileSource (Session& s, const XMLNode& node)
 	: Source(s, node)
 	, AudioFileSource (s, node)
@@ -241,6 +417,10 @@ SndFileSource::init_sndfile ()
 
 	memset (&_info, 0, sizeof(_info));
 
+	_prefetch_fd = -1;
+	_prefetch_data_offset = 0;
+	_prefetch_frame_bytes = 0;
+
 	if (destructive()) {
 		xfade_buf = new Sample[xfade_frames];
 		_timeline_position = header_position_offset;
@@ -256,6 +436,8 @@ SndFileSource::close ()
 		sf_close (_sndfile);
 		_sndfile = 0;
 	}
+	_prefetch_fd = -1;
+	_block_cache.reset ();
 }
 
 int
@@ -313,6 +495,12 @@ SndFileSource::open ()
 
 	_length = _info.frames;
 
+	if (_info.channels > 1 && !writable()) {
+		_block_cache = BlockCache::get (_path, _info.channels);
+	}
+
+	setup_prefetch (fd);
+
 #ifdef HAVE_RF64_RIFF
 	if (_file_is_new && _length == 0 && writable()) {
 		if (_flags & RF64_RIFF) {
@@ -397,6 +585,95 @@ SndFileSource::sample_rate () const
 	return _info.samplerate;
 }
 
+void
+SndFileSource::setup_prefetch (int fd)
+{
+	_prefetch_fd = -1;
+
+#ifdef POSIX_FADV_WILLNEED
+	if (writable()) {
+		return;
+	}
+
+	framecnt_t sample_bytes;
+
+	switch (_info.format & SF_FORMAT_SUBMASK) {
+	case SF_FORMAT_PCM_S8:
+	case SF_FORMAT_PCM_U8:
+		sample_bytes = 1;
+		break;
+	case SF_FORMAT_PCM_16:
+		sample_bytes = 2;
+		break;
+	case SF_FORMAT_PCM_24:
+		sample_bytes = 3;
+		break;
+	case SF_FORMAT_PCM_32:
+	case SF_FORMAT_FLOAT:
+		sample_bytes = 4;
+		break;
+	case SF_FORMAT_DOUBLE:
+		sample_bytes = 8;
+		break;
+	default:
+		/* compressed: no fixed mapping from frames to file offsets */
+		return;
+	}
+
+	if (_info.frames < 2) {
+		return;
+	}
+
+	/* libsndfile doesn't tell us where the audio data starts, and it may
+	   be followed by other chunks, so ask the file descriptor where
+	   libsndfile puts it to read the first two frames. If they are not
+	   one frame apart, we don't know how the data is laid out.
+	*/
+
+	framecnt_t const frame_bytes = sample_bytes * _info.channels;
+
+	if (sf_seek (_sndfile, 0, SEEK_SET|SFM_READ) != 0) {
+		return;
+	}
+
+	off_t const first = lseek (fd, 0, SEEK_CUR);
+
+	if (sf_seek (_sndfile, 1, SEEK_SET|SFM_READ) != 1) {
+		return;
+	}
+
+	off_t const second = lseek (fd, 0, SEEK_CUR);
+
+	sf_seek (_sndfile, 0, SEEK_SET|SFM_READ);
+
+	if (first < 0 || second - first != frame_bytes) {
+		return;
+	}
+
+	_prefetch_frame_bytes = frame_bytes;
+	_prefetch_data_offset = first;
+	_prefetch_fd = fd;
+#endif
+}
+
+void
+SndFileSource::prefetch (framepos_t start, framecnt_t cnt) const
+{
+#ifdef POSIX_FADV_WILLNEED
+	/* never wait for a reader; this is only a hint */
+	Glib::Threads::Mutex::Lock lm (_lock, Glib::Threads::TRY_LOCK);
+
+	if (!lm.locked() || _prefetch_fd < 0 || start >= _length || cnt <= 0) {
+		return;
+	}
+
+	cnt = min (cnt, _length - start);
+
+	posix_fadvise (_prefetch_fd, _prefetch_data_offset + (off_t) start * _prefetch_frame_bytes,
+	               (off_t) cnt * _prefetch_frame_bytes, POSIX_FADV_WILLNEED);
+#endif
+}
+
 framecnt_t
 SndFileSource::read_unlocked (Sample *dst, framepos_t start, framecnt_t cnt) const
 {
@@ -444,6 +721,10 @@ SndFileSource::read_unlocked (Sample *dst, framepos_t start, framecnt_t cnt) con
 		memset (dst+file_cnt, 0, sizeof (Sample) * delta);
 	}
 
+	if (file_cnt && _block_cache) {
+		return read_via_block_cache (dst, start, file_cnt);
+	}
+
 	if (file_cnt) {
 
 		if (sf_seek (_sndfile, (sf_count_t) start, SEEK_SET|SFM_READ) != (sf_count_t) start) {
@@ -482,6 +763,55 @@ SndFileSource::read_unlocked (Sample *dst, framepos_t start, framecnt_t cnt) con
 	return nread;
 }
 
+/** Read @param cnt frames of our channel, all of which lie within the file,
+ *  using (and if necessary filling) the block cache shared by all the
+ *  sources for this file.
+ */
+framecnt_t
+SndFileSource::read_via_block_cache (Sample *dst, framepos_t start, framecnt_t cnt) const
+{
+	BlockCache& bc (*_block_cache);
+	Glib::Threads::Mutex::Lock lm (bc.lock);
+
+	BlockCache::Block* block = bc.find (start, cnt);
+
+	if (!block) {
+
+		/* Nobody has decoded this range lately, so read it for all channels */
+
+		if (sf_seek (_sndfile, (sf_count_t) start, SEEK_SET|SFM_READ) != (sf_count_t) start) {
+			char errbuf[256];
+			sf_error_str (0, errbuf, sizeof (errbuf) - 1);
+			error << string_compose(_("SndFileSource: could not seek to frame %1 within %2 (%3)"), start, _name.val().substr (1), errbuf) << endmsg;
+			return 0;
+		}
+
+		framecnt_t const real_cnt = cnt * _info.channels;
+		Sample* interleave_buf = get_interleave_buffer (real_cnt);
+		framecnt_t const nread = sf_read_float (_sndfile, interleave_buf, real_cnt) / _info.channels;
+
+		if (nread != cnt) {
+			char errbuf[256];
+			sf_error_str (0, errbuf, sizeof (errbuf) - 1);
+			error << string_compose(_("SndFileSource: @ %1 could not read %2 within %3 (%4) (len = %5, ret was %6)"), start, cnt, _name.val().substr (1), errbuf, _length, nread) << endl;
+		}
+
+		block = &bc.recycle ();
+		block->ensure_capacity (cnt, _info.channels);
+		deinterleave (interleave_buf, block->channel_data (0), _info.channels, max (nread, (framecnt_t) 0), block->capacity);
+		block->start = start;
+		block->length = max (nread, (framecnt_t) 0);
+	}
+
+	framecnt_t const n = min (cnt, block->start + block->length - start);
+
+	if (n > 0) {
+		memcpy (dst, block->channel_data (_channel) + (start - block->start), sizeof (Sample) * n);
+	}
+
+	return max (n, (framecnt_t) 0);
+}
+
 framecnt_t
 SndFileSource::write_unlocked (Sample *data, framecnt_t cnt)
 {
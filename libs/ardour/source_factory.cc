@@ -22,7 +22,11 @@
 #include "libardour-config.h"
 #endif
 
+#include <algorithm>
+#include <map>
+
 #include "pbd/boost_debug.h"
+#include "pbd/cpus.h"
 #include "pbd/error.h"
 #include "pbd/convert.h"
 #include "pbd/pthread_utils.h"
@@ -32,6 +36,7 @@
 #include "ardour/audio_playlist_source.h"
 #include "ardour/midi_playlist.h"
 #include "ardour/midi_playlist_source.h"
+#include "ardour/rc_configuration.h"
 #include "ardour/source.h"
 #include "ardour/source_factory.h"
 #include "ardour/sndfilesource.h"
@@ -57,6 +62,13 @@ std::list<boost::weak_ptr<AudioSource> > SourceFactory::files_with_peaks;
 
 static int active_threads = 0;
 
+/* progress through the current batch of queued sources; reset whenever
+   the queue drains, so that progress always refers to the work that is
+   still outstanding plus whatever was finished since it started.
+*/
+static uint32_t peaks_queued = 0;
+static uint32_t peaks_done = 0;
+
 static void
 peak_thread_work ()
 {
@@ -84,9 +96,23 @@ peak_thread_work ()
 			continue;
 		}
 
-		as->setup_peakfile ();
+		/* a source whose peakfile was set up synchronously is only
+		   queued to have its peak levels built.
+		*/
+
+		if (!as->peak_levels_missing ()) {
+			as->setup_peakfile ();
+		}
+
+		as->build_missing_peak_levels ();
+
 		SourceFactory::peak_building_lock.lock ();
 		--active_threads;
+		++peaks_done;
+		if (active_threads == 0 && SourceFactory::files_with_peaks.empty()) {
+			peaks_done = 0;
+			peaks_queued = 0;
+		}
 		SourceFactory::peak_building_lock.unlock ();
 	}
 }
@@ -99,10 +125,74 @@ SourceFactory::peak_work_queue_length ()
 	return SourceFactory::files_with_peaks.size () + active_threads;
 }
 
+void
+SourceFactory::peak_work_progress (uint32_t& done, uint32_t& total)
+{
+	Glib::Threads::Mutex::Lock lm (peak_building_lock);
+	done = peaks_done;
+	total = peaks_queued;
+}
+
+/** Move those of @a sources that are waiting in the peak-building queue to
+ *  its front, in the order given, so that sources the user can see are
+ *  built before the rest. This takes the queue lock once and walks the
+ *  queue once, however many sources are passed.
+ */
+void
+SourceFactory::boost_peak_priority (std::vector<boost::shared_ptr<AudioSource> > const& sources)
+{
+	typedef std::list<boost::weak_ptr<AudioSource> > Queue;
+
+	if (sources.empty()) {
+		return;
+	}
+
+	/* rank of each source; the first mention wins */
+	std::map<AudioSource const*, size_t> rank;
+
+	for (size_t n = 0; n < sources.size(); ++n) {
+		rank.insert (std::make_pair (sources[n].get(), n));
+	}
+
+	Glib::Threads::Mutex::Lock lm (peak_building_lock);
+
+	std::vector<Queue::iterator> found (sources.size(), files_with_peaks.end());
+
+	for (Queue::iterator i = files_with_peaks.begin(); i != files_with_peaks.end(); ++i) {
+		boost::shared_ptr<AudioSource> as (i->lock());
+		std::map<AudioSource const*, size_t>::const_iterator r;
+		if (as && (r = rank.find (as.get())) != rank.end() && found[r->second] == files_with_peaks.end()) {
+			found[r->second] = i;
+		}
+	}
+
+	/* splicing keeps the iterators valid, so put the lowest ranked
+	   at the front first and let the others go in front of it.
+	*/
+
+	for (size_t n = found.size(); n > 0; --n) {
+		if (found[n-1] != files_with_peaks.end()) {
+			files_with_peaks.splice (files_with_peaks.begin(), files_with_peaks, found[n-1]);
+		}
+	}
+}
+
 void
 SourceFactory::init ()
 {
-	for (int n = 0; n < 2; ++n) {
+	/* peak building is mostly reading and reducing audio, so it scales with
+	   the cores we have until the disk becomes the limit.
+	*/
+
+	uint32_t n_threads = Config->get_peak_build_threads ();
+
+	if (n_threads == 0) {
+		n_threads = hardware_concurrency ();
+	}
+
+	n_threads = std::max (n_threads, (uint32_t) 1);
+
+	for (uint32_t n = 0; n < n_threads; ++n) {
 		Glib::Threads::Thread::create (sigc::ptr_fun (::peak_thread_work));
 	}
 }
@@ -119,6 +209,7 @@ SourceFactory::setup_peakfile (boost::shared_ptr<Source> s, bool async)
 
 			Glib::Threads::Mutex::Lock lm (peak_building_lock);
 			files_with_peaks.push_back (boost::weak_ptr<AudioSource> (as));
+			++peaks_queued;
 			PeaksToBuild.broadcast ();
 
 		} else {
@@ -127,6 +218,13 @@ SourceFactory::setup_peakfile (boost::shared_ptr<Source> s, bool async)
 				error << string_compose("SourceFactory: could not set up peakfile for %1", as->name()) << endmsg;
 				return -1;
 			}
+
+			if (as->peak_levels_missing ()) {
+				Glib::Threads::Mutex::Lock lm (peak_building_lock);
+				files_with_peaks.push_back (boost::weak_ptr<AudioSource> (as));
+				++peaks_queued;
+				PeaksToBuild.broadcast ();
+			}
 		}
 	}
 
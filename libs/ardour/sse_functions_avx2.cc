@@ -0,0 +1,271 @@
+/*
+    Copyright (C) 2015 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+/* This file is compiled with -mavx2 -mfma, and its functions must only be
+   called after FPU::has_avx2() and FPU::has_fma() have returned true.
+
+   Buffers are not required to be aligned; unaligned loads cost nothing
+   extra on AVX2-capable hardware when the data is in fact aligned.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <immintrin.h>
+
+#include "ardour/mix.h"
+
+static inline float
+hmax (__m256 v)
+{
+	__m128 m = _mm_max_ps (_mm256_castps256_ps128 (v), _mm256_extractf128_ps (v, 1));
+	m = _mm_max_ps (m, _mm_movehl_ps (m, m));
+	m = _mm_max_ss (m, _mm_shuffle_ps (m, m, 1));
+	return _mm_cvtss_f32 (m);
+}
+
+static inline float
+hmin (__m256 v)
+{
+	__m128 m = _mm_min_ps (_mm256_castps256_ps128 (v), _mm256_extractf128_ps (v, 1));
+	m = _mm_min_ps (m, _mm_movehl_ps (m, m));
+	m = _mm_min_ss (m, _mm_shuffle_ps (m, m, 1));
+	return _mm_cvtss_f32 (m);
+}
+
+static inline __m256
+vabs (__m256 v)
+{
+	return _mm256_andnot_ps (_mm256_set1_ps (-0.0f), v);
+}
+
+float
+x86_avx2_compute_peak (const float * buf, uint32_t nframes, float current)
+{
+	__m256 vmax0 = _mm256_set1_ps (current);
+	__m256 vmax1 = vmax0;
+	uint32_t i = 0;
+
+	for (; i + 16 <= nframes; i += 16) {
+		vmax0 = _mm256_max_ps (vmax0, vabs (_mm256_loadu_ps (buf + i)));
+		vmax1 = _mm256_max_ps (vmax1, vabs (_mm256_loadu_ps (buf + i + 8)));
+	}
+
+	current = hmax (_mm256_max_ps (vmax0, vmax1));
+
+	for (; i < nframes; ++i) {
+		current = std::max (current, fabsf (buf[i]));
+	}
+
+	return current;
+}
+
+void
+x86_avx2_find_peaks (const float * buf, uint32_t nframes, float *minf, float *maxf)
+{
+	__m256 vmin = _mm256_set1_ps (*minf);
+	__m256 vmax = _mm256_set1_ps (*maxf);
+	uint32_t i = 0;
+
+	for (; i + 8 <= nframes; i += 8) {
+		__m256 const x = _mm256_loadu_ps (buf + i);
+		vmin = _mm256_min_ps (vmin, x);
+		vmax = _mm256_max_ps (vmax, x);
+	}
+
+	float a = hmax (vmax);
+	float b = hmin (vmin);
+
+	for (; i < nframes; ++i) {
+		a = std::max (buf[i], a);
+		b = std::min (buf[i], b);
+	}
+
+	*maxf = a;
+	*minf = b;
+}
+
+void
+x86_avx2_apply_gain_to_buffer (float * buf, uint32_t nframes, float gain)
+{
+	__m256 const g = _mm256_set1_ps (gain);
+	uint32_t i = 0;
+
+	for (; i + 8 <= nframes; i += 8) {
+		_mm256_storeu_ps (buf + i, _mm256_mul_ps (_mm256_loadu_ps (buf + i), g));
+	}
+
+	for (; i < nframes; ++i) {
+		buf[i] *= gain;
+	}
+}
+
+void
+x86_avx2_mix_buffers_with_gain (float * dst, const float * src, uint32_t nframes, float gain)
+{
+	__m256 const g = _mm256_set1_ps (gain);
+	uint32_t i = 0;
+
+	for (; i + 8 <= nframes; i += 8) {
+		_mm256_storeu_ps (dst + i, _mm256_fmadd_ps (_mm256_loadu_ps (src + i), g, _mm256_loadu_ps (dst + i)));
+	}
+
+	for (; i < nframes; ++i) {
+		dst[i] += src[i] * gain;
+	}
+}
+
+void
+x86_avx2_mix_buffers_no_gain (float * dst, const float * src, uint32_t nframes)
+{
+	uint32_t i = 0;
+
+	for (; i + 8 <= nframes; i += 8) {
+		_mm256_storeu_ps (dst + i, _mm256_add_ps (_mm256_loadu_ps (src + i), _mm256_loadu_ps (dst + i)));
+	}
+
+	for (; i < nframes; ++i) {
+		dst[i] += src[i];
+	}
+}
+
+void
+x86_avx2_copy_vector (float * dst, const float * src, uint32_t nframes)
+{
+	/* libc already picks the best copy for this CPU */
+	memcpy (dst, src, nframes * sizeof (float));
+}
+
+/* Gain ramp: lane k holds g(n+k) - target, and since
+ * g(n) - target = (initial - target) * (1 - coeff)^n, each lane
+ * advances by 8 samples by scaling by (1 - coeff)^8. The ramp is
+ * kept in double precision (two vectors of 4 lanes), as in the scalar
+ * code, so that long ramps land where they always have; only the gain
+ * applied to each sample is rounded to float.
+ */
+
+static inline void
+ramp_setup (double initial, double target, double coeff, __m256d& dist_lo, __m256d& dist_hi, __m256d& step)
+{
+	double d[8];
+	double g = initial;
+
+	for (int k = 0; k < 8; ++k) {
+		d[k] = g - target;
+		g += coeff * (target - g);
+	}
+
+	dist_lo = _mm256_loadu_pd (d);
+	dist_hi = _mm256_loadu_pd (d + 4);
+
+	double r = 1.0 - coeff;
+	r *= r; /* ^2 */
+	r *= r; /* ^4 */
+	r *= r; /* ^8 */
+	step = _mm256_set1_pd (r);
+}
+
+double
+x86_avx2_apply_gain_ramp_to_buffer (float * buf, uint32_t nframes, double initial, double target, double coeff)
+{
+	uint32_t i = 0;
+	double g = initial;
+
+	if (nframes >= 8) {
+		__m256d const t = _mm256_set1_pd (target);
+		__m256d dist_lo;
+		__m256d dist_hi;
+		__m256d step;
+
+		ramp_setup (initial, target, coeff, dist_lo, dist_hi, step);
+
+		for (; i + 8 <= nframes; i += 8) {
+			__m256 const gain = _mm256_insertf128_ps (_mm256_castps128_ps256 (_mm256_cvtpd_ps (_mm256_add_pd (t, dist_lo))),
+			                                          _mm256_cvtpd_ps (_mm256_add_pd (t, dist_hi)), 1);
+			_mm256_storeu_ps (buf + i, _mm256_mul_ps (_mm256_loadu_ps (buf + i), gain));
+			dist_lo = _mm256_mul_pd (dist_lo, step);
+			dist_hi = _mm256_mul_pd (dist_hi, step);
+		}
+
+		g = target + _mm_cvtsd_f64 (_mm256_castpd256_pd128 (dist_lo));
+	}
+
+	for (; i < nframes; ++i) {
+		buf[i] *= g;
+		g += coeff * (target - g);
+	}
+
+	return g;
+}
+
+double
+x86_avx2_mix_buffers_with_gain_ramp (float * dst, const float * src, uint32_t nframes, double initial, double target, double coeff)
+{
+	uint32_t i = 0;
+	double g = initial;
+
+	if (nframes >= 8) {
+		__m256d const t = _mm256_set1_pd (target);
+		__m256d dist_lo;
+		__m256d dist_hi;
+		__m256d step;
+
+		ramp_setup (initial, target, coeff, dist_lo, dist_hi, step);
+
+		for (; i + 8 <= nframes; i += 8) {
+			__m256 const gain = _mm256_insertf128_ps (_mm256_castps128_ps256 (_mm256_cvtpd_ps (_mm256_add_pd (t, dist_lo))),
+			                                          _mm256_cvtpd_ps (_mm256_add_pd (t, dist_hi)), 1);
+			_mm256_storeu_ps (dst + i, _mm256_fmadd_ps (_mm256_loadu_ps (src + i), gain, _mm256_loadu_ps (dst + i)));
+			dist_lo = _mm256_mul_pd (dist_lo, step);
+			dist_hi = _mm256_mul_pd (dist_hi, step);
+		}
+
+		g = target + _mm_cvtsd_f64 (_mm256_castpd256_pd128 (dist_lo));
+	}
+
+	for (; i < nframes; ++i) {
+		dst[i] += src[i] * g;
+		g += coeff * (target - g);
+	}
+
+	return g;
+}
+
+float
+x86_avx2_mix_buffers_with_peak (float * dst, const float * src, uint32_t nframes, float gain, float current)
+{
+	__m256 const g = _mm256_set1_ps (gain);
+	__m256 vmax = _mm256_set1_ps (current);
+	uint32_t i = 0;
+
+	for (; i + 8 <= nframes; i += 8) {
+		__m256 const x = _mm256_fmadd_ps (_mm256_loadu_ps (src + i), g, _mm256_loadu_ps (dst + i));
+		_mm256_storeu_ps (dst + i, x);
+		vmax = _mm256_max_ps (vmax, vabs (x));
+	}
+
+	current = hmax (vmax);
+
+	for (; i < nframes; ++i) {
+		dst[i] += src[i] * gain;
+		current = std::max (current, fabsf (dst[i]));
+	}
+
+	return current;
+}
@@ -0,0 +1,261 @@
+/*
+    Copyright (C) 2015 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+/* This file is compiled with -mavx512f, and its functions must only be
+   called after FPU::has_avx512f() has returned true.
+
+   The tail of each buffer is handled with masked loads and stores, so
+   there are no scalar loops here.
+*/
+
+#include <cstring>
+#include <immintrin.h>
+
+#include "ardour/mix.h"
+
+static inline __mmask16
+tail_mask (uint32_t n)
+{
+	return (__mmask16) ((1U << n) - 1);
+}
+
+static inline __m512
+vabs (__m512 v)
+{
+	return _mm512_castsi512_ps (_mm512_and_si512 (_mm512_castps_si512 (v), _mm512_set1_epi32 (0x7fffffff)));
+}
+
+float
+x86_avx512f_compute_peak (const float * buf, uint32_t nframes, float current)
+{
+	__m512 vmax = _mm512_set1_ps (current);
+	uint32_t i = 0;
+
+	for (; i + 16 <= nframes; i += 16) {
+		vmax = _mm512_max_ps (vmax, vabs (_mm512_loadu_ps (buf + i)));
+	}
+
+	if (i < nframes) {
+		__mmask16 const m = tail_mask (nframes - i);
+		vmax = _mm512_mask_max_ps (vmax, m, vmax, vabs (_mm512_maskz_loadu_ps (m, buf + i)));
+	}
+
+	return _mm512_reduce_max_ps (vmax);
+}
+
+void
+x86_avx512f_find_peaks (const float * buf, uint32_t nframes, float *minf, float *maxf)
+{
+	__m512 vmin = _mm512_set1_ps (*minf);
+	__m512 vmax = _mm512_set1_ps (*maxf);
+	uint32_t i = 0;
+
+	for (; i + 16 <= nframes; i += 16) {
+		__m512 const x = _mm512_loadu_ps (buf + i);
+		vmin = _mm512_min_ps (vmin, x);
+		vmax = _mm512_max_ps (vmax, x);
+	}
+
+	if (i < nframes) {
+		__mmask16 const m = tail_mask (nframes - i);
+		__m512 const x = _mm512_maskz_loadu_ps (m, buf + i);
+		vmin = _mm512_mask_min_ps (vmin, m, vmin, x);
+		vmax = _mm512_mask_max_ps (vmax, m, vmax, x);
+	}
+
+	*maxf = _mm512_reduce_max_ps (vmax);
+	*minf = _mm512_reduce_min_ps (vmin);
+}
+
+void
+x86_avx512f_apply_gain_to_buffer (float * buf, uint32_t nframes, float gain)
+{
+	__m512 const g = _mm512_set1_ps (gain);
+	uint32_t i = 0;
+
+	for (; i + 16 <= nframes; i += 16) {
+		_mm512_storeu_ps (buf + i, _mm512_mul_ps (_mm512_loadu_ps (buf + i), g));
+	}
+
+	if (i < nframes) {
+		__mmask16 const m = tail_mask (nframes - i);
+		_mm512_mask_storeu_ps (buf + i, m, _mm512_mul_ps (_mm512_maskz_loadu_ps (m, buf + i), g));
+	}
+}
+
+void
+x86_avx512f_mix_buffers_with_gain (float * dst, const float * src, uint32_t nframes, float gain)
+{
+	__m512 const g = _mm512_set1_ps (gain);
+	uint32_t i = 0;
+
+	for (; i + 16 <= nframes; i += 16) {
+		_mm512_storeu_ps (dst + i, _mm512_fmadd_ps (_mm512_loadu_ps (src + i), g, _mm512_loadu_ps (dst + i)));
+	}
+
+	if (i < nframes) {
+		__mmask16 const m = tail_mask (nframes - i);
+		_mm512_mask_storeu_ps (dst + i, m, _mm512_fmadd_ps (_mm512_maskz_loadu_ps (m, src + i), g, _mm512_maskz_loadu_ps (m, dst + i)));
+	}
+}
+
+void
+x86_avx512f_mix_buffers_no_gain (float * dst, const float * src, uint32_t nframes)
+{
+	uint32_t i = 0;
+
+	for (; i + 16 <= nframes; i += 16) {
+		_mm512_storeu_ps (dst + i, _mm512_add_ps (_mm512_loadu_ps (src + i), _mm512_loadu_ps (dst + i)));
+	}
+
+	if (i < nframes) {
+		__mmask16 const m = tail_mask (nframes - i);
+		_mm512_mask_storeu_ps (dst + i, m, _mm512_add_ps (_mm512_maskz_loadu_ps (m, src + i), _mm512_maskz_loadu_ps (m, dst + i)));
+	}
+}
+
+void
+x86_avx512f_copy_vector (float * dst, const float * src, uint32_t nframes)
+{
+	/* libc already picks the best copy for this CPU */
+	memcpy (dst, src, nframes * sizeof (float));
+}
+
+/* Gain ramp: see sse_functions_avx2.cc; here the ramp is kept in two
+ * vectors of 8 doubles, and each lane advances by 16 samples at a time.
+ */
+
+static inline void
+ramp_setup (double initial, double target, double coeff, __m512d& dist_lo, __m512d& dist_hi, __m512d& step)
+{
+	double d[16];
+	double g = initial;
+
+	for (int k = 0; k < 16; ++k) {
+		d[k] = g - target;
+		g += coeff * (target - g);
+	}
+
+	dist_lo = _mm512_loadu_pd (d);
+	dist_hi = _mm512_loadu_pd (d + 8);
+
+	double r = 1.0 - coeff;
+	r *= r; /* ^2 */
+	r *= r; /* ^4 */
+	r *= r; /* ^8 */
+	r *= r; /* ^16 */
+	step = _mm512_set1_pd (r);
+}
+
+static inline __m512
+ramp_gain (__m512d t, __m512d dist_lo, __m512d dist_hi)
+{
+	__m256 const lo = _mm512_cvtpd_ps (_mm512_add_pd (t, dist_lo));
+	__m256 const hi = _mm512_cvtpd_ps (_mm512_add_pd (t, dist_hi));
+	return _mm512_castpd_ps (_mm512_insertf64x4 (_mm512_castps_pd (_mm512_castps256_ps512 (lo)), _mm256_castps_pd (hi), 1));
+}
+
+double
+x86_avx512f_apply_gain_ramp_to_buffer (float * buf, uint32_t nframes, double initial, double target, double coeff)
+{
+	__m512d const t = _mm512_set1_pd (target);
+	__m512d dist_lo;
+	__m512d dist_hi;
+	__m512d step;
+	uint32_t i = 0;
+
+	ramp_setup (initial, target, coeff, dist_lo, dist_hi, step);
+
+	for (; i + 16 <= nframes; i += 16) {
+		_mm512_storeu_ps (buf + i, _mm512_mul_ps (_mm512_loadu_ps (buf + i), ramp_gain (t, dist_lo, dist_hi)));
+		dist_lo = _mm512_mul_pd (dist_lo, step);
+		dist_hi = _mm512_mul_pd (dist_hi, step);
+	}
+
+	if (i < nframes) {
+		uint32_t const rest = nframes - i;
+		__mmask16 const m = tail_mask (rest);
+		_mm512_mask_storeu_ps (buf + i, m, _mm512_mul_ps (_mm512_maskz_loadu_ps (m, buf + i), ramp_gain (t, dist_lo, dist_hi)));
+
+		/* the gain for the sample after the last one we wrote */
+		double d[16];
+		_mm512_storeu_pd (d, dist_lo);
+		_mm512_storeu_pd (d + 8, dist_hi);
+		double const g = target + d[rest - 1];
+		return g + coeff * (target - g);
+	}
+
+	return target + _mm_cvtsd_f64 (_mm512_castpd512_pd128 (dist_lo));
+}
+
+double
+x86_avx512f_mix_buffers_with_gain_ramp (float * dst, const float * src, uint32_t nframes, double initial, double target, double coeff)
+{
+	__m512d const t = _mm512_set1_pd (target);
+	__m512d dist_lo;
+	__m512d dist_hi;
+	__m512d step;
+	uint32_t i = 0;
+
+	ramp_setup (initial, target, coeff, dist_lo, dist_hi, step);
+
+	for (; i + 16 <= nframes; i += 16) {
+		_mm512_storeu_ps (dst + i, _mm512_fmadd_ps (_mm512_loadu_ps (src + i), ramp_gain (t, dist_lo, dist_hi), _mm512_loadu_ps (dst + i)));
+		dist_lo = _mm512_mul_pd (dist_lo, step);
+		dist_hi = _mm512_mul_pd (dist_hi, step);
+	}
+
+	if (i < nframes) {
+		uint32_t const rest = nframes - i;
+		__mmask16 const m = tail_mask (rest);
+		_mm512_mask_storeu_ps (dst + i, m, _mm512_fmadd_ps (_mm512_maskz_loadu_ps (m, src + i), ramp_gain (t, dist_lo, dist_hi), _mm512_maskz_loadu_ps (m, dst + i)));
+
+		/* the gain for the sample after the last one we wrote */
+		double d[16];
+		_mm512_storeu_pd (d, dist_lo);
+		_mm512_storeu_pd (d + 8, dist_hi);
+		double const g = target + d[rest - 1];
+		return g + coeff * (target - g);
+	}
+
+	return target + _mm_cvtsd_f64 (_mm512_castpd512_pd128 (dist_lo));
+}
+
+float
+x86_avx512f_mix_buffers_with_peak (float * dst, const float * src, uint32_t nframes, float gain, float current)
+{
+	__m512 const g = _mm512_set1_ps (gain);
+	__m512 vmax = _mm512_set1_ps (current);
+	uint32_t i = 0;
+
+	for (; i + 16 <= nframes; i += 16) {
+		__m512 const x = _mm512_fmadd_ps (_mm512_loadu_ps (src + i), g, _mm512_loadu_ps (dst + i));
+		_mm512_storeu_ps (dst + i, x);
+		vmax = _mm512_max_ps (vmax, vabs (x));
+	}
+
+	if (i < nframes) {
+		__mmask16 const m = tail_mask (nframes - i);
+		__m512 const x = _mm512_fmadd_ps (_mm512_maskz_loadu_ps (m, src + i), g, _mm512_maskz_loadu_ps (m, dst + i));
+		_mm512_mask_storeu_ps (dst + i, m, x);
+		vmax = _mm512_mask_max_ps (vmax, m, vmax, vabs (x));
+	}
+
+	return _mm512_reduce_max_ps (vmax);
+}
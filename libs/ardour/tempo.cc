@@ -294,6 +294,8 @@ TempoMap::TempoMap (framecnt_t fr)
 
 	metrics.push_back (t);
 	metrics.push_back (m);
+
+	recompute_map (false);
 }
 
 TempoMap::~TempoMap ()
@@ -766,64 +768,26 @@ TempoMap::first_tempo ()
 	return *t;
 }
 
-void
-TempoMap::require_map_to (framepos_t pos)
-{
-	Glib::Threads::RWLock::WriterLock lm (lock);
-
-	if (_map.empty() || _map.back().frame < pos) {
-		extend_map (pos);
-	}
-}
-
-void
-TempoMap::require_map_to (const BBT_Time& bbt)
+/** @return the number of beats in each bar of @a meter */
+static uint32_t
+beats_per_bar (const Meter& meter)
 {
-	Glib::Threads::RWLock::WriterLock lm (lock);
-
-	/* since we have no idea where BBT is if its off the map, see the last
-	 * point in the map is past BBT, and if not add an arbitrary amount of
-	 * time until it is.
-	 */
-
-	int additional_minutes = 1;
-
-	while (1) {
-		if (!_map.empty() && _map.back().bar >= (bbt.bars + 1)) {
-			break;
-		}
-		/* add some more distance, using bigger steps each time */
-		extend_map (_map.back().frame + (_frame_rate * 60 * additional_minutes));
-		additional_minutes *= 2;
-	}
+	/* a bar ends once the beat count passes divisions_per_bar(), which
+	   need not be a whole number.
+	*/
+	return max ((uint32_t) 1, (uint32_t) floor (meter.divisions_per_bar()));
 }
 
 void
-TempoMap::recompute_map (bool reassign_tempo_bbt, framepos_t end)
+TempoMap::recompute_map (bool reassign_tempo_bbt)
 {
 	/* CALLER MUST HOLD WRITE LOCK */
 
 	MeterSection* meter = 0;
 	TempoSection* tempo = 0;
-	double current_frame;
-	BBT_Time current;
 	Metrics::iterator next_metric;
 
-	if (end < 0) {
-
-		/* we will actually stop once we hit
-		   the last metric.
-		*/
-		end = max_framepos;
-
-	} else {
-		if (!_map.empty ()) {
-			/* never allow the map to be shortened */
-			end = max (end, _map.back().frame);
-		}
-	}
-
-	DEBUG_TRACE (DEBUG::TempoMath, string_compose ("recomputing tempo map, zero to %1\n", end));
+	DEBUG_TRACE (DEBUG::TempoMath, "recomputing tempo map\n");
 
 	for (Metrics::iterator i = metrics.begin(); i != metrics.end(); ++i) {
 		MeterSection* ms;
@@ -848,15 +812,9 @@ TempoMap::recompute_map (bool reassign_tempo_bbt, framepos_t end)
 	assert(tempo);
 
 	/* assumes that the first meter & tempo are at frame zero */
-	current_frame = 0;
 	meter->set_frame (0);
 	tempo->set_frame (0);
 
-	/* assumes that the first meter & tempo are at 1|1|0 */
-	current.bars = 1;
-	current.beats = 1;
-	current.ticks = 0;
-
 	if (reassign_tempo_bbt) {
 
 		MeterSection* rmeter = meter;
@@ -887,225 +845,265 @@ TempoMap::recompute_map (bool reassign_tempo_bbt, framepos_t end)
 
 	DEBUG_TRACE (DEBUG::TempoMath, string_compose ("start with meter = %1 tempo = %2\n", *((Meter*)meter), *((Tempo*)tempo)));
 
+	_segments.clear ();
+	_tempos.clear ();
+
+	/* assumes that the first meter & tempo are at 1|1|0 */
+
+	Segment seg;
+
+	seg.frame = 0;
+	seg.beat = 0;
+	seg.bar = 1;
+	seg.bar_beat = 1;
+	seg.meter = meter;
+	seg.tempo = tempo;
+	seg.beats_per_bar = beats_per_bar (*meter);
+	seg.beat_frames = meter->frames_per_grid (*tempo, _frame_rate);
+
 	next_metric = metrics.begin();
 	++next_metric; // skip meter (or tempo)
 	++next_metric; // skip tempo (or meter)
 
-	_map.clear ();
+	for (; next_metric != metrics.end(); ++next_metric) {
 
-	DEBUG_TRACE (DEBUG::TempoMath, string_compose ("Add first bar at 1|1 @ %2\n", current.bars, current_frame));
-	_map.push_back (BBTPoint (*meter, *tempo,(framepos_t) llrint(current_frame), 1, 1));
+		const BBT_Time start ((*next_metric)->start());
 
-	if (end == 0) {
-		/* silly call from Session::process() during startup
+		/* find the first beat at or after the start of the metric, which
+		 * is where it takes effect; a metric that falls between beats
+		 * (or in the past) takes effect at the next one.
 		 */
-		return;
-	}
 
-	_extend_map (tempo, meter, next_metric, current, current_frame, end);
-}
+		uint32_t bar = start.bars;
+		uint32_t bar_beat = max (start.beats, (uint32_t) 1) + (start.ticks > 0 ? 1 : 0);
 
-void
-TempoMap::extend_map (framepos_t end)
-{
-	/* CALLER MUST HOLD WRITE LOCK */
+		if (bar_beat > seg.beats_per_bar) {
+			bar++;
+			bar_beat = 1;
+		}
 
-	if (_map.empty()) {
-		recompute_map (false, end);
-		return;
-	}
+		int64_t k = ((int64_t) bar - seg.bar) * seg.beats_per_bar + ((int64_t) bar_beat - seg.bar_beat);
 
-	BBTPointList::const_iterator i = _map.end();
-	Metrics::iterator next_metric;
+		if (k < 0 || (k == 0 && (_segments.empty() || start != BBT_Time (seg.bar, seg.bar_beat, 0)))) {
+			k = 1;
+		}
 
-	--i;
+		if (k > 0) {
+			/* start a new segment at that beat */
+			const int64_t pos = (int64_t) seg.bar_beat - 1 + k;
 
-	BBT_Time last_metric_start;
+			_segments.push_back (seg);
 
-	if ((*i).tempo->frame() > (*i).meter->frame()) {
-		last_metric_start = (*i).tempo->start();
-	} else {
-		last_metric_start = (*i).meter->start();
-	}
+			seg.frame += k * seg.beat_frames;
+			seg.beat += k;
+			seg.bar += pos / seg.beats_per_bar;
+			seg.bar_beat = pos % seg.beats_per_bar + 1;
+		}
 
-	/* find the metric immediately after the tempo + meter sections for the
-	 * last point in the map
-	 */
+		TempoSection* ts;
+		MeterSection* ms;
 
-	for (next_metric = metrics.begin(); next_metric != metrics.end(); ++next_metric) {
-		if ((*next_metric)->start() > last_metric_start) {
-			break;
-		}
-	}
+		if ((ts = dynamic_cast<TempoSection*> (*next_metric)) != 0) {
 
-	/* we cast away const here because this is the one place where we need
-	 * to actually modify the frame time of each metric section.
-	 */
+			seg.tempo = ts;
 
-	_extend_map (const_cast<TempoSection*> ((*i).tempo),
-		     const_cast<MeterSection*> ((*i).meter),
-		     next_metric, BBT_Time ((*i).bar, (*i).beat, 0), (*i).frame, end);
-}
+			/* new tempo section: if its on a beat, it just changes
+			 * the beat length from here on.
+			 *
+			 * if its not on the beat, we have to compute the
+			 * duration of the beat it is within, which will be
+			 * different from the preceding and following ones since
+			 * it takes part of its duration from the preceding tempo
+			 * and part from this new tempo.
+			 */
 
-void
-TempoMap::_extend_map (TempoSection* tempo, MeterSection* meter,
-		       Metrics::iterator next_metric,
-		       BBT_Time current, framepos_t current_frame, framepos_t end)
-{
-	/* CALLER MUST HOLD WRITE LOCK */
+			if (ts->start().ticks != 0) {
 
-	TempoSection* ts;
-	MeterSection* ms;
-	double beat_frames;
-	double current_frame_exact;
-	framepos_t bar_start_frame;
+				const Segment& prev (_segments.back());
+				const double next_beat_frames = ts->frames_per_beat (_frame_rate);
 
-	DEBUG_TRACE (DEBUG::TempoMath, string_compose ("Extend map to %1 from %2 = %3\n", end, current, current_frame));
+				/* back up to previous beat, and the start of the bar it is in */
 
-	if (current.beats == 1) {
-		bar_start_frame = current_frame;
-	} else {
-		bar_start_frame = 0;
-	}
+				const double prev_beat_exact = seg.frame - prev.beat_frames;
+				const framepos_t prev_beat_frame = llrint (prev_beat_exact);
+				const int64_t bar_start = (seg.bar_beat > 1) ? seg.beat - (seg.bar_beat - 1) : seg.beat - prev.beats_per_bar;
+				const framepos_t bar_start_frame = segment_for_beat (bar_start)->frame_of (bar_start);
+
+				DEBUG_TRACE (DEBUG::TempoMath, string_compose ("bumped into non-beat-aligned tempo metric at %1 = %2, adjust next beat using %3\n",
+				                                               ts->start(), prev_beat_frame, ts->bar_offset()));
+
+				/* set tempo section location based on offset
+				 * from last bar start
+				 */
+				ts->set_frame (bar_start_frame + llrint ((ts->bar_offset() * seg.meter->divisions_per_bar() * prev.beat_frames)));
+
+				/* advance to the location of the new (adjusted)
+				 * beat. do this by figuring out the offset within
+				 * the beat that would have been there without the
+				 * tempo change. then stretch the beat accordingly.
+				 */
+
+				const double offset_within_old_beat = (ts->frame() - prev_beat_frame) / prev.beat_frames;
+
+				seg.frame = prev_beat_exact + (offset_within_old_beat * prev.beat_frames) + ((1.0 - offset_within_old_beat) * next_beat_frames);
+
+				DEBUG_TRACE (DEBUG::TempoMath, string_compose ("Adjusted last beat to %1\n", llrint (seg.frame)));
+
+			} else {
+
+				DEBUG_TRACE (DEBUG::TempoMath, string_compose ("bumped into beat-aligned tempo metric at %1 = %2\n",
+				                                               ts->start(), llrint (seg.frame)));
+				ts->set_frame (llrint (seg.frame));
+			}
 
-	beat_frames = meter->frames_per_grid (*tempo,_frame_rate);
-	current_frame_exact = current_frame;
+		} else if ((ms = dynamic_cast<MeterSection*>(*next_metric)) != 0) {
 
-	while (current_frame < end) {
+			/* new meter section: always defines the start of a bar. */
 
-		current.beats++;
-		current_frame_exact += beat_frames;
-		current_frame = llrint(current_frame_exact);
+			DEBUG_TRACE (DEBUG::TempoMath, string_compose ("bumped into meter section at %1 vs %2|%3 (%4)\n",
+			                                               ms->start(), seg.bar, seg.bar_beat, llrint (seg.frame)));
 
-		if (current.beats > meter->divisions_per_bar()) {
-			current.bars++;
-			current.beats = 1;
+			assert (seg.bar_beat == 1);
+
+			seg.meter = ms;
+			seg.beats_per_bar = beats_per_bar (*ms);
+			ms->set_frame (llrint (seg.frame));
 		}
 
-		if (next_metric != metrics.end()) {
+		seg.beat_frames = seg.meter->frames_per_grid (*seg.tempo, _frame_rate);
 
-			/* no operator >= so invert operator < */
+		DEBUG_TRACE (DEBUG::TempoMath, string_compose ("New metric with beat frames = %1 dpb %2 meter %3 tempo %4\n",
+		                                               seg.beat_frames, seg.meter->divisions_per_bar(), *((Meter*)seg.meter), *((Tempo*)seg.tempo)));
+	}
 
-			DEBUG_TRACE (DEBUG::TempoMath, string_compose ("now at %1 next metric @ %2\n", current, (*next_metric)->start()));
+	/* the last segment goes on forever */
+	_segments.push_back (seg);
 
-			if (!(current < (*next_metric)->start())) {
+	for (Metrics::const_iterator i = metrics.begin(); i != metrics.end(); ++i) {
+		const TempoSection* ts;
+		if ((ts = dynamic_cast<const TempoSection*> (*i)) != 0) {
+			_tempos.push_back (ts);
+		}
+	}
+}
 
-		set_metrics:
-				if (((ts = dynamic_cast<TempoSection*> (*next_metric)) != 0)) {
+struct TempoMap::SegmentBeatLess {
+	bool operator() (int64_t beat, const Segment& s) const { return beat < s.beat; }
+};
 
-					tempo = ts;
+TempoMap::Segments::const_iterator
+TempoMap::segment_for_beat (int64_t beat) const
+{
+	/* CALLER MUST HOLD READ LOCK */
 
-					/* new tempo section: if its on a beat,
-					 * we don't have to do anything other
-					 * than recompute various distances,
-					 * done further below as we transition
-					 * the next metric section.
-					 *
-					 * if its not on the beat, we have to
-					 * compute the duration of the beat it
-					 * is within, which will be different
-					 * from the preceding following ones
-					 * since it takes part of its duration
-					 * from the preceding tempo and part
-					 * from this new tempo.
-					 */
+	Segments::const_iterator s = upper_bound (_segments.begin(), _segments.end(), beat, SegmentBeatLess());
 
-					if (tempo->start().ticks != 0) {
+	if (s == _segments.begin()) {
+		return _segments.end();
+	}
 
-						double next_beat_frames = tempo->frames_per_beat (_frame_rate);
+	return --s;
+}
 
-						DEBUG_TRACE (DEBUG::TempoMath, string_compose ("bumped into non-beat-aligned tempo metric at %1 = %2, adjust next beat using %3\n",
-						                                               tempo->start(), current_frame, tempo->bar_offset()));
+TempoMap::BBTPoint
+TempoMap::point_at (int64_t beat) const
+{
+	/* CALLER MUST HOLD READ LOCK */
 
-						/* back up to previous beat */
-						current_frame_exact -= beat_frames;
-						current_frame = llrint(current_frame_exact);
+	beat = max (beat, (int64_t) 0);
 
-						/* set tempo section location
-						 * based on offset from last
-						 * bar start
-						 */
-						tempo->set_frame (bar_start_frame +
-						                  llrint ((ts->bar_offset() * meter->divisions_per_bar() * beat_frames)));
+	const Segment& s (*segment_for_beat (beat));
+	const int64_t pos = (int64_t) s.bar_beat - 1 + (beat - s.beat);
 
-						/* advance to the location of
-						 * the new (adjusted) beat. do
-						 * this by figuring out the
-						 * offset within the beat that
-						 * would have been there
-						 * without the tempo
-						 * change. then stretch the
-						 * beat accordingly.
-						 */
+	return BBTPoint (*s.meter, *s.tempo, s.frame_of (beat),
+	                 s.bar + pos / s.beats_per_bar, pos % s.beats_per_bar + 1);
+}
 
-						double offset_within_old_beat = (tempo->frame() - current_frame) / beat_frames;
+struct TempoMap::SegmentFrameLess {
+	bool operator() (framepos_t pos, const Segment& s) const { return pos < llrint (s.frame); }
+};
 
-						current_frame_exact += (offset_within_old_beat * beat_frames) + ((1.0 - offset_within_old_beat) * next_beat_frames);
-						current_frame = llrint(current_frame_exact);
+int64_t
+TempoMap::beat_before_or_at (framepos_t pos) const
+{
+	/* CALLER MUST HOLD READ LOCK */
 
-						/* next metric doesn't have to
-						 * match this precisely to
-						 * merit a reloop ...
-						 */
-						DEBUG_TRACE (DEBUG::TempoMath, string_compose ("Adjusted last beat to %1\n", current_frame));
+	if (pos < 0) {
+		/* not really correct, but we should catch pos < 0 at a higher
+		   level
+		*/
+		return 0;
+	}
 
-					} else {
+	Segments::const_iterator next = upper_bound (_segments.begin(), _segments.end(), pos, SegmentFrameLess());
+	Segments::const_iterator s = next;
+	--s;
 
-						DEBUG_TRACE (DEBUG::TempoMath, string_compose ("bumped into beat-aligned tempo metric at %1 = %2\n",
-						                                               tempo->start(), current_frame));
-						tempo->set_frame (current_frame);
-					}
+	/* the number of beats in this segment, or -1 for the last one */
+	const int64_t len = (next == _segments.end()) ? -1 : next->beat - s->beat;
 
-				} else if ((ms = dynamic_cast<MeterSection*>(*next_metric)) != 0) {
+	/* estimate, then correct for rounding */
+	int64_t k = (int64_t) floor ((pos - s->frame) / s->beat_frames);
 
-					meter = ms;
+	if (len >= 0) {
+		k = min (k, len - 1);
+	}
+	k = max (k, (int64_t) 0);
 
-					/* new meter section: always defines the
-					 * start of a bar.
-					 */
+	while ((len < 0 || k + 1 < len) && s->frame_of (s->beat + k + 1) <= pos) {
+		++k;
+	}
+	while (k > 0 && s->frame_of (s->beat + k) > pos) {
+		--k;
+	}
 
-					DEBUG_TRACE (DEBUG::TempoMath, string_compose ("bumped into meter section at %1 vs %2 (%3)\n",
-					                                               meter->start(), current, current_frame));
+	return s->beat + k;
+}
 
-					assert (current.beats == 1);
+struct TempoMap::SegmentBBTLess {
+	bool operator() (const BBT_Time& bbt, const Segment& s) const {
+		return bbt.bars < s.bar || (bbt.bars == s.bar && bbt.beats < s.bar_beat);
+	}
+};
 
-					meter->set_frame (current_frame);
-				}
+int64_t
+TempoMap::beat_before_or_at (const BBT_Time& bbt) const
+{
+	/* CALLER MUST HOLD READ LOCK */
 
-				beat_frames = meter->frames_per_grid (*tempo, _frame_rate);
+	Segments::const_iterator next = upper_bound (_segments.begin(), _segments.end(), bbt, SegmentBBTLess());
 
-				DEBUG_TRACE (DEBUG::TempoMath, string_compose ("New metric with beat frames = %1 dpb %2 meter %3 tempo %4\n",
-				                                               beat_frames, meter->divisions_per_bar(), *((Meter*)meter), *((Tempo*)tempo)));
+	if (next == _segments.begin()) {
+		return 0;
+	}
 
-				++next_metric;
+	Segments::const_iterator s = next;
+	--s;
 
-				if (next_metric != metrics.end() && ((*next_metric)->start() == current)) {
-					/* same position so go back and set this one up before advancing
-					 */
-					goto set_metrics;
-				}
+	/* beats past the end of the bar mean its last beat */
+	const uint32_t bar_beat = min (max (bbt.beats, (uint32_t) 1), s->beats_per_bar);
 
-			}
-		}
+	int64_t k = ((int64_t) bbt.bars - s->bar) * s->beats_per_bar + ((int64_t) bar_beat - s->bar_beat);
 
-		if (current.beats == 1) {
-			DEBUG_TRACE (DEBUG::TempoMath, string_compose ("Add Bar at %1|1 @ %2\n", current.bars, current_frame));
-			_map.push_back (BBTPoint (*meter, *tempo, current_frame, current.bars, 1));
-			bar_start_frame = current_frame;
-		} else {
-			DEBUG_TRACE (DEBUG::TempoMath, string_compose ("Add Beat at %1|%2 @ %3\n", current.bars, current.beats, current_frame));
-			_map.push_back (BBTPoint (*meter, *tempo, current_frame, current.bars, current.beats));
-		}
+	if (next != _segments.end()) {
+		k = min (k, next->beat - s->beat - 1);
+	}
 
-		if (next_metric == metrics.end()) {
-			/* no more metrics - we've timestamped them all, stop here */
-			if (end == max_framepos) {
-				DEBUG_TRACE (DEBUG::TempoMath, string_compose ("stop extending map now that we've reach the end @ %1|%2 = %3\n",
-				                                               current.bars, current.beats, current_frame));
-				break;
-			}
-		}
+	return s->beat + max (k, (int64_t) 0);
+}
+
+int64_t
+TempoMap::beat_after_or_at (framepos_t pos) const
+{
+	/* CALLER MUST HOLD READ LOCK */
+
+	const int64_t b = beat_before_or_at (pos);
+
+	if (point_at (b).frame < pos) {
+		return b + 1;
 	}
+
+	return b;
 }
 
 TempoMetric
@@ -1167,8 +1165,6 @@ TempoMap::metric_at (BBT_Time bbt) const
 void
 TempoMap::bbt_time (framepos_t frame, BBT_Time& bbt)
 {
-	require_map_to (frame);
-
 	Glib::Threads::RWLock::ReaderLock lm (lock);
 
 	if (frame < 0) {
@@ -1179,7 +1175,7 @@ TempoMap::bbt_time (framepos_t frame, BBT_Time& bbt)
 		return;
 	}
 
-	return bbt_time (frame, bbt, bbt_before_or_at (frame));
+	return bbt_time (frame, bbt, beat_before_or_at (frame));
 }
 
 void
@@ -1191,25 +1187,23 @@ TempoMap::bbt_time_rt (framepos_t frame, BBT_Time& bbt)
 		throw std::logic_error ("TempoMap::bbt_time_rt() could not lock tempo map");
 	}
 
-	if (_map.empty() || _map.back().frame < frame) {
-		throw std::logic_error (string_compose ("map not long enough to reach %1", frame));
-	}
-
-	return bbt_time (frame, bbt, bbt_before_or_at (frame));
+	return bbt_time (frame, bbt, beat_before_or_at (frame));
 }
 
 void
-TempoMap::bbt_time (framepos_t frame, BBT_Time& bbt, const BBTPointList::const_iterator& i)
+TempoMap::bbt_time (framepos_t frame, BBT_Time& bbt, int64_t beat)
 {
 	/* CALLER MUST HOLD READ LOCK */
 
-	bbt.bars = (*i).bar;
-	bbt.beats = (*i).beat;
+	const BBTPoint p (point_at (beat));
+
+	bbt.bars = p.bar;
+	bbt.beats = p.beat;
 
-	if ((*i).frame == frame) {
+	if (p.frame == frame) {
 		bbt.ticks = 0;
 	} else {
-		bbt.ticks = llrint (((frame - (*i).frame) / (*i).tempo->frames_per_beat(_frame_rate)) *
+		bbt.ticks = llrint (((frame - p.frame) / p.tempo->frames_per_beat(_frame_rate)) *
 		                    BBT_Time::ticks_per_beat);
 	}
 }
@@ -1226,18 +1220,16 @@ TempoMap::frame_time (const BBT_Time& bbt)
 		throw std::logic_error ("beats are counted from one");
 	}
 
-	require_map_to (bbt);
-
 	Glib::Threads::RWLock::ReaderLock lm (lock);
 
-	BBTPointList::const_iterator s = bbt_before_or_at (BBT_Time (1, 1, 0));
-	BBTPointList::const_iterator e = bbt_before_or_at (BBT_Time (bbt.bars, bbt.beats, 0));
+	const BBTPoint s (point_at (beat_before_or_at (BBT_Time (1, 1, 0))));
+	const BBTPoint e (point_at (beat_before_or_at (BBT_Time (bbt.bars, bbt.beats, 0))));
 
 	if (bbt.ticks != 0) {
-		return ((*e).frame - (*s).frame) +
-			llrint ((*e).tempo->frames_per_beat (_frame_rate) * (bbt.ticks/BBT_Time::ticks_per_beat));
+		return (e.frame - s.frame) +
+			llrint (e.tempo->frames_per_beat (_frame_rate) * (bbt.ticks/BBT_Time::ticks_per_beat));
 	} else {
-		return ((*e).frame - (*s).frame);
+		return (e.frame - s.frame);
 	}
 }
 
@@ -1259,35 +1251,30 @@ TempoMap::bbt_duration_at_unlocked (const BBT_Time& when, const BBT_Time& bbt, i
 	}
 
 	/* round back to the previous precise beat */
-	BBTPointList::const_iterator wi = bbt_before_or_at (BBT_Time (when.bars, when.beats, 0));
-	BBTPointList::const_iterator start (wi);
-
-	assert (wi != _map.end());
+	const int64_t start = beat_before_or_at (BBT_Time (when.bars, when.beats, 0));
+	int64_t wi = start;
 
 	uint32_t bars = 0;
-	uint32_t beats = 0;
 
-	while (wi != _map.end() && bars < bbt.bars) {
+	while (bars < bbt.bars) {
 		++wi;
-		if ((*wi).is_bar()) {
+		if (point_at (wi).is_bar()) {
 			++bars;
 		}
 	}
-	assert (wi != _map.end());
 
-	while (wi != _map.end() && beats < bbt.beats) {
-		++wi;
-		++beats;
-	}
-	assert (wi != _map.end());
+	wi += bbt.beats;
+
+	const BBTPoint s (point_at (start));
+	const BBTPoint w (point_at (wi));
 
 	/* add any additional frames related to ticks in the added value */
 
 	if (bbt.ticks != 0) {
-		return ((*wi).frame - (*start).frame) +
-			(*wi).tempo->frames_per_beat (_frame_rate) * (bbt.ticks/BBT_Time::ticks_per_beat);
+		return (w.frame - s.frame) +
+			w.tempo->frames_per_beat (_frame_rate) * (bbt.ticks/BBT_Time::ticks_per_beat);
 	} else {
-		return ((*wi).frame - (*start).frame);
+		return (w.frame - s.frame);
 	}
 }
 
@@ -1306,17 +1293,15 @@ TempoMap::round_to_beat (framepos_t fr, RoundMode dir)
 framepos_t
 TempoMap::round_to_beat_subdivision (framepos_t fr, int sub_num, RoundMode dir)
 {
-	require_map_to (fr);
-
 	Glib::Threads::RWLock::ReaderLock lm (lock);
-	BBTPointList::const_iterator i = bbt_before_or_at (fr);
+	int64_t i = beat_before_or_at (fr);
 	BBT_Time the_beat;
 	uint32_t ticks_one_subdivisions_worth;
 
 	bbt_time (fr, the_beat, i);
 
 	DEBUG_TRACE (DEBUG::SnapBBT, string_compose ("round %1 to nearest 1/%2 beat, before-or-at = %3 @ %4|%5 precise = %6\n",
-						     fr, sub_num, (*i).frame, (*i).bar, (*i).beat, the_beat));
+						     fr, sub_num, point_at (i).frame, point_at (i).bar, point_at (i).beat, the_beat));
 
 	ticks_one_subdivisions_worth = (uint32_t)BBT_Time::ticks_per_beat / sub_num;
 
@@ -1340,9 +1325,7 @@ TempoMap::round_to_beat_subdivision (framepos_t fr, int sub_num, RoundMode dir)
 		}
 
 		if (the_beat.ticks > BBT_Time::ticks_per_beat) {
-			assert (i != _map.end());
 			++i;
-			assert (i != _map.end());
 			the_beat.ticks -= BBT_Time::ticks_per_beat;
 		}
 
@@ -1360,7 +1343,7 @@ TempoMap::round_to_beat_subdivision (framepos_t fr, int sub_num, RoundMode dir)
 		}
 
 		if (the_beat.ticks < difference) {
-			if (i == _map.begin()) {
+			if (i == 0) {
 				/* can't go backwards from wherever pos is, so just return it */
 				return fr;
 			}
@@ -1386,9 +1369,7 @@ TempoMap::round_to_beat_subdivision (framepos_t fr, int sub_num, RoundMode dir)
 			DEBUG_TRACE (DEBUG::SnapBBT, string_compose ("moved forward to %1\n", the_beat.ticks));
 
 			if (the_beat.ticks > BBT_Time::ticks_per_beat) {
-				assert (i != _map.end());
 				++i;
-				assert (i != _map.end());
 				the_beat.ticks -= BBT_Time::ticks_per_beat;
 				DEBUG_TRACE (DEBUG::SnapBBT, string_compose ("fold beat to %1\n", the_beat));
 			}
@@ -1398,7 +1379,7 @@ TempoMap::round_to_beat_subdivision (framepos_t fr, int sub_num, RoundMode dir)
 			/* closer to previous subdivision, so shift backward */
 
 			if (rem > the_beat.ticks) {
-				if (i == _map.begin()) {
+				if (i == 0) {
 					/* can't go backwards past zero, so ... */
 					return 0;
 				}
@@ -1415,27 +1396,25 @@ TempoMap::round_to_beat_subdivision (framepos_t fr, int sub_num, RoundMode dir)
 		}
 	}
 
-	return (*i).frame + (the_beat.ticks/BBT_Time::ticks_per_beat) *
-		(*i).tempo->frames_per_beat (_frame_rate);
+	const BBTPoint p (point_at (i));
+
+	return p.frame + (the_beat.ticks/BBT_Time::ticks_per_beat) *
+		p.tempo->frames_per_beat (_frame_rate);
 }
 
 framepos_t
 TempoMap::round_to_type (framepos_t frame, RoundMode dir, BBTPointType type)
 {
-	require_map_to (frame);
-
 	Glib::Threads::RWLock::ReaderLock lm (lock);
-	BBTPointList::const_iterator fi;
+	int64_t fi;
 
 	if (dir > 0) {
-		fi = bbt_after_or_at (frame);
+		fi = beat_after_or_at (frame);
 	} else {
-		fi = bbt_before_or_at (frame);
+		fi = beat_before_or_at (frame);
 	}
 
-	assert (fi != _map.end());
-
-	DEBUG_TRACE (DEBUG::SnapBBT, string_compose ("round from %1 (%3|%4 @ %5) to %6 in direction %2\n", frame, dir, (*fi).bar, (*fi).beat, (*fi).frame,
+	DEBUG_TRACE (DEBUG::SnapBBT, string_compose ("round from %1 (%3|%4 @ %5) to %6 in direction %2\n", frame, dir, point_at (fi).bar, point_at (fi).beat, point_at (fi).frame,
 						     (type == Bar ? "bar" : "beat")));
 
 	switch (type) {
@@ -1443,76 +1422,72 @@ TempoMap::round_to_type (framepos_t frame, RoundMode dir, BBTPointType type)
 		if (dir < 0) {
 			/* find bar previous to 'frame' */
 
-			if (fi == _map.begin()) {
+			if (fi == 0) {
 				return 0;
 			}
 
-			if ((*fi).is_bar() && (*fi).frame == frame) {
+			if (point_at (fi).is_bar() && point_at (fi).frame == frame) {
 				if (dir == RoundDownMaybe) {
 					return frame;
 				}
 				--fi;
 			}
 
-			while (!(*fi).is_bar()) {
-				if (fi == _map.begin()) {
+			while (!point_at (fi).is_bar()) {
+				if (fi == 0) {
 					break;
 				}
 				fi--;
 			}
 			DEBUG_TRACE (DEBUG::SnapBBT, string_compose ("rounded to bar: map iter at %1|%2 %3, return\n",
-								     (*fi).bar, (*fi).beat, (*fi).frame));
-			return (*fi).frame;
+								     point_at (fi).bar, point_at (fi).beat, point_at (fi).frame));
+			return point_at (fi).frame;
 
 		} else if (dir > 0) {
 
 			/* find bar following 'frame' */
 
-			if ((*fi).is_bar() && (*fi).frame == frame) {
+			if (point_at (fi).is_bar() && point_at (fi).frame == frame) {
 				if (dir == RoundUpMaybe) {
 					return frame;
 				}
 				++fi;
 			}
 
-			while (!(*fi).is_bar()) {
+			while (!point_at (fi).is_bar()) {
 				fi++;
-				if (fi == _map.end()) {
-					--fi;
-					break;
-				}
 			}
 
 			DEBUG_TRACE (DEBUG::SnapBBT, string_compose ("rounded to bar: map iter at %1|%2 %3, return\n",
-								     (*fi).bar, (*fi).beat, (*fi).frame));
-			return (*fi).frame;
+								     point_at (fi).bar, point_at (fi).beat, point_at (fi).frame));
+			return point_at (fi).frame;
 
 		} else {
 
 			/* true rounding: find nearest bar */
 
-			BBTPointList::const_iterator prev = fi;
-			BBTPointList::const_iterator next = fi;
+			int64_t prev = fi;
+			int64_t next = fi;
 
-			if ((*fi).frame == frame) {
+			if (point_at (fi).frame == frame) {
 				return frame;
 			}
 
-			while ((*prev).beat != 1) {
-				if (prev == _map.begin()) {
+			while (point_at (prev).beat != 1) {
+				if (prev == 0) {
 					break;
 				}
 				prev--;
 			}
 
-			while ((next != _map.end()) && (*next).beat != 1) {
+			while (point_at (next).beat != 1) {
 				next++;
 			}
 
-			if ((next == _map.end()) || (frame - (*prev).frame) < ((*next).frame - frame)) {
-				return (*prev).frame;
+			if ((frame - point_at (prev).frame) < (point_at (next).frame - frame)) {
+				return point_at (prev).frame;
 			} else {
-				return (*next).frame;
+				return point_at (next).frame;
 			}
 
 		}
@@ -1522,44 +1497,42 @@ TempoMap::round_to_type (framepos_t frame, RoundMode dir, BBTPointType type)
 	case Beat:
 		if (dir < 0) {
 
-			if (fi == _map.begin()) {
+			if (fi == 0) {
 				return 0;
 			}
 
-			if ((*fi).frame > frame || ((*fi).frame == frame && dir == RoundDownAlways)) {
+			if (point_at (fi).frame > frame || (point_at (fi).frame == frame && dir == RoundDownAlways)) {
 				DEBUG_TRACE (DEBUG::SnapBBT, "requested frame is on beat, step back\n");
 				--fi;
 			}
 			DEBUG_TRACE (DEBUG::SnapBBT, string_compose ("rounded to beat: map iter at %1|%2 %3, return\n",
-								     (*fi).bar, (*fi).beat, (*fi).frame));
-			return (*fi).frame;
+								     point_at (fi).bar, point_at (fi).beat, point_at (fi).frame));
+			return point_at (fi).frame;
 		} else if (dir > 0) {
-			if ((*fi).frame < frame || ((*fi).frame == frame && dir == RoundUpAlways)) {
+			if (point_at (fi).frame < frame || (point_at (fi).frame == frame && dir == RoundUpAlways)) {
 				DEBUG_TRACE (DEBUG::SnapBBT, "requested frame is on beat, step forward\n");
 				++fi;
 			}
 			DEBUG_TRACE (DEBUG::SnapBBT, string_compose ("rounded to beat: map iter at %1|%2 %3, return\n",
-								     (*fi).bar, (*fi).beat, (*fi).frame));
-			return (*fi).frame;
+								     point_at (fi).bar, point_at (fi).beat, point_at (fi).frame));
+			return point_at (fi).frame;
 		} else {
 			/* find beat nearest to frame */
-			if ((*fi).frame == frame) {
+			if (point_at (fi).frame == frame) {
 				return frame;
 			}
 
-			BBTPointList::const_iterator prev = fi;
-			BBTPointList::const_iterator next = fi;
-
 			/* fi is already the beat before_or_at frame, and
 			   we've just established that its not at frame, so its
 			   the beat before frame.
 			*/
-			++next;
+			const framepos_t prev = point_at (fi).frame;
+			const framepos_t next = point_at (fi + 1).frame;
 
-			if ((next == _map.end()) || (frame - (*prev).frame) < ((*next).frame - frame)) {
-				return (*prev).frame;
+			if ((frame - prev) < (next - frame)) {
+				return prev;
 			} else {
-				return (*next).frame;
+				return next;
 			}
 		}
 		break;
@@ -1570,19 +1543,22 @@ TempoMap::round_to_type (framepos_t frame, RoundMode dir, BBTPointType type)
 }
 
 void
-TempoMap::get_grid (TempoMap::BBTPointList::const_iterator& begin,
-		    TempoMap::BBTPointList::const_iterator& end,
-		    framepos_t lower, framepos_t upper)
+TempoMap::get_grid (BBTPointList& points, framepos_t lower, framepos_t upper, size_t max_points)
 {
-	{
-		Glib::Threads::RWLock::WriterLock lm (lock);
-		if (_map.empty() || (_map.back().frame < upper)) {
-			recompute_map (false, upper);
+	Glib::Threads::RWLock::ReaderLock lm (lock);
+
+	points.clear ();
+
+	for (int64_t b = beat_after_or_at (lower); max_points == 0 || points.size() < max_points; ++b) {
+
+		const BBTPoint p (point_at (b));
+
+		if (p.frame > upper) {
+			break;
 		}
-	}
 
-	begin = lower_bound (_map.begin(), _map.end(), lower);
-	end = upper_bound (_map.begin(), _map.end(), upper);
+		points.push_back (p);
+	}
 }
 
 const TempoSection&
@@ -1752,7 +1728,7 @@ TempoMap::set_state (const XMLNode& node, int /*version*/)
 			prev = i;
 		}
 
-		recompute_map (true, -1);
+		recompute_map (true);
 	}
 
 	PropertyChanged (PropertyChange ());
@@ -1855,8 +1831,7 @@ TempoMap::insert_time (framepos_t where, framecnt_t amount)
 				// which is correct for our purpose
 			}
 
-			BBTPointList::const_iterator bi = bbt_before_or_at ((*i)->frame());
-			bbt_time ((*i)->frame(), bbt, bi);
+			bbt_time ((*i)->frame(), bbt, beat_before_or_at ((*i)->frame()));
 
 			// cerr << "timestamp @ " << (*i)->frame() << " with " << bbt.bars << "|" << bbt.beats << "|" << bbt.ticks << " => ";
 
@@ -1963,6 +1938,10 @@ TempoMap::remove_time (framepos_t where, framecnt_t amount)
 	return moved;
 }
 
+struct TempoFrameLess {
+	bool operator() (framepos_t pos, const TempoSection* t) const { return pos < t->frame(); }
+};
+
 /** Add some (fractional) beats to a session frame position, and return the result in frames.
  *  pos can be -ve, if required.
  */
@@ -1970,42 +1949,25 @@ framepos_t
 TempoMap::framepos_plus_beats (framepos_t pos, Evoral::Beats beats) const
 {
 	Glib::Threads::RWLock::ReaderLock lm (lock);
-	Metrics::const_iterator next_tempo;
-	const TempoSection* tempo = 0;
-
-	/* Find the starting tempo metric */
-
-	for (next_tempo = metrics.begin(); next_tempo != metrics.end(); ++next_tempo) {
 
-		const TempoSection* t;
-
-		if ((t = dynamic_cast<const TempoSection*>(*next_tempo)) != 0) {
-
-			/* This is a bit of a hack, but pos could be -ve, and if it is,
-			   we consider the initial metric changes (at time 0) to actually
-			   be in effect at pos.
-			*/
-
-			framepos_t f = (*next_tempo)->frame ();
-
-			if (pos < 0 && f == 0) {
-				f = pos;
-			}
+	/* Find the starting tempo: the last one at or before pos.  pos could
+	   be -ve, and if it is, we consider the initial tempo (at time 0) to
+	   actually be in effect at pos.
+	*/
 
-			if (f > pos) {
-				break;
-			}
+	vector<const TempoSection*>::const_iterator next_tempo = upper_bound (_tempos.begin(), _tempos.end(), pos, TempoFrameLess());
 
-			tempo = t;
-		}
+	if (next_tempo == _tempos.begin()) {
+		++next_tempo;
 	}
 
+	const TempoSection* tempo = *(next_tempo - 1);
+
 	/* We now have:
 
 	   tempo       -> the Tempo for "pos"
-	   next_tempo  -> first tempo after "pos", possibly metrics.end()
+	   next_tempo  -> first tempo after "pos", possibly _tempos.end()
 	*/
-	assert(tempo);
 
 	DEBUG_TRACE (DEBUG::TempoMath,
 	             string_compose ("frame %1 plus %2 beats, start with tempo = %3 @ %4\n",
@@ -2014,7 +1976,7 @@ TempoMap::framepos_plus_beats (framepos_t pos, Evoral::Beats beats) const
 	while (!!beats) {
 
 		/* Distance to the end of this section in frames */
-		framecnt_t distance_frames = (next_tempo == metrics.end() ? max_framepos : ((*next_tempo)->frame() - pos));
+		framecnt_t distance_frames = (next_tempo == _tempos.end() ? max_framepos : ((*next_tempo)->frame() - pos));
 
 		/* Distance to the end in beats */
 		Evoral::Beats distance_beats = Evoral::Beats::ticks_at_rate(
@@ -2024,7 +1986,7 @@ TempoMap::framepos_plus_beats (framepos_t pos, Evoral::Beats beats) const
 		Evoral::Beats const delta = min (distance_beats, beats);
 
 		DEBUG_TRACE (DEBUG::TempoMath, string_compose ("\tdistance to %1 = %2 (%3 beats)\n",
-							       (next_tempo == metrics.end() ? max_framepos : (*next_tempo)->frame()),
+							       (next_tempo == _tempos.end() ? max_framepos : (*next_tempo)->frame()),
 							       distance_frames, distance_beats));
 
 		/* Update */
@@ -2035,22 +1997,13 @@ TempoMap::framepos_plus_beats (framepos_t pos, Evoral::Beats beats) const
 
 		/* step forwards to next tempo section */
 
-		if (next_tempo != metrics.end()) {
+		if (next_tempo != _tempos.end()) {
 
-			tempo = dynamic_cast<const TempoSection*>(*next_tempo);
+			tempo = *next_tempo++;
 
 			DEBUG_TRACE (DEBUG::TempoMath, string_compose ("\tnew tempo = %1 @ %2 fpb = %3\n",
 								       *((const Tempo*)tempo), tempo->frame(),
 								       tempo->frames_per_beat (_frame_rate)));
-
-			while (next_tempo != metrics.end ()) {
-
-				++next_tempo;
-
-				if (next_tempo != metrics.end() && dynamic_cast<const TempoSection*>(*next_tempo)) {
-					break;
-				}
-			}
 		}
 	}
 
@@ -2411,69 +2364,6 @@ TempoMap::framewalk_to_beats (framepos_t pos, framecnt_t distance) const
 	return beats;
 }
 
-TempoMap::BBTPointList::const_iterator
-TempoMap::bbt_before_or_at (framepos_t pos)
-{
-	/* CALLER MUST HOLD READ LOCK */
-
-	BBTPointList::const_iterator i;
-
-	if (pos < 0) {
-		/* not really correct, but we should catch pos < 0 at a higher
-		   level
-		*/
-		return _map.begin();
-	}
-
-	i = lower_bound (_map.begin(), _map.end(), pos);
-	assert (i != _map.end());
-	if ((*i).frame > pos) {
-		assert (i != _map.begin());
-		--i;
-	}
-	return i;
-}
-
-struct bbtcmp {
-    bool operator() (const BBT_Time& a, const BBT_Time& b) {
-	    return a < b;
-    }
-};
-
-TempoMap::BBTPointList::const_iterator
-TempoMap::bbt_before_or_at (const BBT_Time& bbt)
-{
-	BBTPointList::const_iterator i;
-	bbtcmp cmp;
-
-	i = lower_bound (_map.begin(), _map.end(), bbt, cmp);
-	assert (i != _map.end());
-	if ((*i).bar > bbt.bars || (*i).beat > bbt.beats) {
-		assert (i != _map.begin());
-		--i;
-	}
-	return i;
-}
-
-TempoMap::BBTPointList::const_iterator
-TempoMap::bbt_after_or_at (framepos_t pos)
-{
-	/* CALLER MUST HOLD READ LOCK */
-
-	BBTPointList::const_iterator i;
-
-	if (_map.back().frame == pos) {
-		i = _map.end();
-		assert (i != _map.begin());
-		--i;
-		return i;
-	}
-
-	i = upper_bound (_map.begin(), _map.end(), pos);
-	assert (i != _map.end());
-	return i;
-}
-
 std::ostream&
 operator<< (std::ostream& o, const Meter& m) {
 	return o << m.divisions_per_bar() << '/' << m.note_divisor();
@@ -162,3 +162,49 @@ AutomationListPropertyTest::undoTest ()
 	write_automation_list_xml (&sheila->get_state(), test_data_filename);
 	check_xml (&sheila->get_state(), test_data_file4, ignore_properties);
 }
+
+/** Check that large lists round-trip through binary event files */
+void
+AutomationListPropertyTest::eventFileTest ()
+{
+	const std::string dir = new_test_output_dir ("automation_event_files");
+
+	AutomationList a (Evoral::Parameter (GainAutomation));
+	for (int i = 0; i < 1000; ++i) {
+		a.fast_simple_add (i * 64.5, sin (i / 10.0));
+	}
+
+	/* states used for undo never refer to event files */
+	XMLNode& undo = a.get_state ();
+	CPPUNIT_ASSERT (undo.child ("events"));
+	CPPUNIT_ASSERT (!undo.child ("events")->property ("file"));
+
+	XMLNode& state = a.state (true, dir);
+	XMLNode* events = state.child ("events");
+	CPPUNIT_ASSERT (events);
+	CPPUNIT_ASSERT (events->property ("file"));
+	CPPUNIT_ASSERT (events->children().empty());
+	CPPUNIT_ASSERT (Glib::file_test (Glib::build_filename (dir, events->property ("file")->value()), Glib::FILE_TEST_EXISTS));
+
+	AutomationList b (state, Evoral::Parameter (GainAutomation), dir);
+	CPPUNIT_ASSERT_EQUAL (a.size(), b.size());
+	for (AutomationList::const_iterator i = a.begin(), j = b.begin(); i != a.end(); ++i, ++j) {
+		CPPUNIT_ASSERT_EQUAL ((*i)->when, (*j)->when);
+		CPPUNIT_ASSERT_EQUAL ((*i)->value, (*j)->value);
+	}
+
+	/* the same points are stored in the same file */
+	XMLNode& again = b.state (true, dir);
+	CPPUNIT_ASSERT_EQUAL (events->property ("file")->value(), again.child ("events")->property ("file")->value());
+
+	/* small lists stay in the XML */
+	AutomationList c (Evoral::Parameter (GainAutomation));
+	c.fast_simple_add (0, 1);
+	XMLNode& small = c.state (true, dir);
+	CPPUNIT_ASSERT (!small.child ("events")->property ("file"));
+
+	delete &undo;
+	delete &state;
+	delete &again;
+	delete &small;
+}
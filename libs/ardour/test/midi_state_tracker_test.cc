@@ -0,0 +1,82 @@
+#include "ardour/midi_buffer.h"
+#include "ardour/midi_state_tracker.h"
+
+#include "midi_state_tracker_test.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION (MidiStateTrackerTest);
+
+using namespace std;
+using namespace ARDOUR;
+
+void
+MidiStateTrackerTest::trackTest ()
+{
+	MidiStateTracker t;
+
+	CPPUNIT_ASSERT (t.empty ());
+
+	t.add (60, 0);
+	t.add (60, 0);
+	t.add (127, 15);
+	t.add (0, 9);
+
+	CPPUNIT_ASSERT_EQUAL (uint16_t (3), t.on ());
+	CPPUNIT_ASSERT (t.active (60, 0));
+	CPPUNIT_ASSERT (t.active (127, 15));
+	CPPUNIT_ASSERT (t.active (0, 9));
+	CPPUNIT_ASSERT (!t.active (60, 1));
+
+	/* a note stays on until every voice of it is off */
+	t.remove (60, 0);
+	CPPUNIT_ASSERT (t.active (60, 0));
+	t.remove (60, 0);
+	CPPUNIT_ASSERT (!t.active (60, 0));
+	CPPUNIT_ASSERT_EQUAL (uint16_t (2), t.on ());
+
+	/* removing a note that is not on is harmless */
+	t.remove (61, 0);
+	CPPUNIT_ASSERT_EQUAL (uint16_t (2), t.on ());
+
+	t.reset ();
+	CPPUNIT_ASSERT (t.empty ());
+	CPPUNIT_ASSERT (!t.active (127, 15));
+	CPPUNIT_ASSERT (!t.active (0, 9));
+}
+
+void
+MidiStateTrackerTest::resolveTest ()
+{
+	MidiStateTracker t;
+	MidiBuffer       buf (1024);
+
+	t.add (64, 3);
+	t.add (64, 3);
+	t.add (31, 3);
+	t.add (32, 3);
+	t.add (5, 0);
+
+	t.resolve_notes (buf, 100);
+
+	CPPUNIT_ASSERT (t.empty ());
+	CPPUNIT_ASSERT (!t.active (64, 3));
+
+	/* one note off per voice, in channel then note order */
+	uint8_t const expected[][2] = { { 0, 5 }, { 3, 31 }, { 3, 32 }, { 3, 64 }, { 3, 64 } };
+	size_t n = 0;
+
+	for (MidiBuffer::iterator i = buf.begin(); i != buf.end(); ++i, ++n) {
+		CPPUNIT_ASSERT (n < sizeof (expected) / sizeof (expected[0]));
+		CPPUNIT_ASSERT_EQUAL (framepos_t (100), (framepos_t) (*i).time ());
+		CPPUNIT_ASSERT_EQUAL (uint32_t (3), (*i).size ());
+		CPPUNIT_ASSERT_EQUAL (int (MIDI_CMD_NOTE_OFF | expected[n][0]), int ((*i).buffer()[0]));
+		CPPUNIT_ASSERT_EQUAL (int (expected[n][1]), int ((*i).buffer()[1]));
+		CPPUNIT_ASSERT_EQUAL (0, int ((*i).buffer()[2]));
+	}
+
+	CPPUNIT_ASSERT_EQUAL (sizeof (expected) / sizeof (expected[0]), n);
+
+	/* a resolved tracker can be reused */
+	t.add (64, 3);
+	CPPUNIT_ASSERT_EQUAL (uint16_t (1), t.on ());
+	CPPUNIT_ASSERT (t.active (64, 3));
+}
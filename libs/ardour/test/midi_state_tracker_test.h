@@ -0,0 +1,14 @@
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class MidiStateTrackerTest : public CppUnit::TestFixture
+{
+	CPPUNIT_TEST_SUITE (MidiStateTrackerTest);
+	CPPUNIT_TEST (trackTest);
+	CPPUNIT_TEST (resolveTest);
+	CPPUNIT_TEST_SUITE_END ();
+
+public:
+	void trackTest ();
+	void resolveTest ();
+};
@@ -0,0 +1,123 @@
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+
+#include <glib.h>
+
+#include "evoral/ControlList.hpp"
+#include "evoral/Parameter.hpp"
+#include "evoral/ParameterDescriptor.hpp"
+
+using namespace std;
+using namespace Evoral;
+
+/* Micro-benchmark for automation lookups: reports the cost of evaluating
+   and searching ControlLists of various lengths, in nanoseconds per call.
+*/
+
+static volatile double sink; /* keeps results alive */
+
+static void
+report (const char* what, size_t points, gint64 before, size_t ops)
+{
+	gint64 const elapsed = std::max ((gint64) 1, g_get_monotonic_time () - before);
+	cout << setw (32) << left << what << setw (10) << right << points
+	     << setw (12) << fixed << setprecision (1) << (elapsed * 1e3) / ops << "\n";
+}
+
+int
+main ()
+{
+	size_t const sizes[] = { 100, 10000, 1000000 };
+	size_t const lookups = 1000000;
+
+	cout << setw (32) << left << "operation" << setw (10) << right << "points" << setw (12) << "ns/op" << "\n";
+
+	for (size_t s = 0; s < sizeof (sizes) / sizeof (sizes[0]); ++s) {
+
+		size_t const n = sizes[s];
+		ControlList cl (Parameter (0), ParameterDescriptor ());
+
+		cl.freeze ();
+		for (size_t i = 0; i < n; ++i) {
+			cl.fast_simple_add (i * 64.0, (i % 127) / 127.0);
+		}
+		cl.thaw ();
+
+		double const len = n * 64.0;
+		srandom (1);
+
+		cl.set_interpolation (ControlList::Linear);
+
+		gint64 before = g_get_monotonic_time ();
+		for (size_t i = 0; i < lookups; ++i) {
+			sink = cl.unlocked_eval (len * (random () / (double) RAND_MAX));
+		}
+		report ("unlocked_eval (random)", n, before, lookups);
+
+		double x = 0;
+		double y;
+		size_t events = 0;
+
+		before = g_get_monotonic_time ();
+		while (cl.rt_safe_earliest_event_linear_unlocked (x, x, y, false) && events < lookups) {
+			sink = y;
+			++events;
+		}
+		report ("earliest_event_linear (seq)", n, before, std::max (events, (size_t) 1));
+
+		float vec[256];
+		size_t const blocks = lookups / 16;
+
+		before = g_get_monotonic_time ();
+		for (size_t i = 0; i < blocks; ++i) {
+			cl.unlocked_eval_vector (len * (random () / (double) RAND_MAX), 1.0, vec, 256);
+			sink = vec[255];
+		}
+		report ("unlocked_eval_vector (256)", n, before, blocks);
+
+		cl.create_curve ();
+
+		before = g_get_monotonic_time ();
+		for (size_t i = 0; i < blocks; ++i) {
+			const double x0 = len * (random () / (double) RAND_MAX);
+			cl.curve ().get_vector (x0, x0 + 255.0, vec, 256);
+			sink = vec[255];
+		}
+		report ("curve get_vector (256)", n, before, blocks);
+
+		cl.set_interpolation (ControlList::Curved);
+
+		before = g_get_monotonic_time ();
+		for (size_t i = 0; i < blocks; ++i) {
+			const double x0 = len * (random () / (double) RAND_MAX);
+			cl.curve ().get_vector (x0, x0 + 255.0, vec, 256);
+			sink = vec[255];
+		}
+		report ("curved get_vector (256)", n, before, blocks);
+
+		cl.set_interpolation (ControlList::Discrete);
+
+		x = 0;
+		events = 0;
+
+		before = g_get_monotonic_time ();
+		while (cl.rt_safe_earliest_event_discrete_unlocked (x, x, y, false) && events < lookups) {
+			sink = y;
+			++events;
+		}
+		report ("earliest_event_discrete (seq)", n, before, std::max (events, (size_t) 1));
+
+		before = g_get_monotonic_time ();
+		for (size_t i = 0; i < lookups; ++i) {
+			double const p = len * (random () / (double) RAND_MAX);
+			if (cl.rt_safe_earliest_event_discrete_unlocked (p, x, y, true)) {
+				sink = y;
+			}
+		}
+		report ("earliest_event_discrete (rand)", n, before, lookups);
+	}
+
+	return 0;
+}
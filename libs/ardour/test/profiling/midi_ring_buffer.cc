@@ -0,0 +1,78 @@
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+
+#include <glib.h>
+
+#include "ardour/midi_buffer.h"
+#include "ardour/midi_ring_buffer.h"
+
+using namespace std;
+using namespace ARDOUR;
+
+/* Micro-benchmark for the MIDI playback path: a dense controller stream is
+   written into a MidiRingBuffer and read back a process cycle at a time
+   into a MidiBuffer, as MidiDiskstream does.  Reports events per second
+   for writing and for reading.
+*/
+
+static void
+report (const char* what, size_t per_cycle, gint64 elapsed, size_t events)
+{
+	elapsed = std::max ((gint64) 1, elapsed);
+	cout << setw (24) << left << what << setw (12) << right << per_cycle
+	     << setw (16) << fixed << setprecision (2) << events / (double) elapsed << "\n";
+}
+
+int
+main ()
+{
+	framecnt_t const cycle = 1024;
+	size_t const per_cycle[] = { 16, 128, 1024 };
+	size_t const events_per_test = 20000000;
+
+	MidiRingBuffer<framepos_t> ring (65536);
+	MidiBuffer                 buf (32768);
+
+	cout << setw (24) << left << "operation" << setw (12) << right << "events/cycle" << setw (16) << "Mevents/s" << "\n";
+
+	for (size_t s = 0; s < sizeof (per_cycle) / sizeof (per_cycle[0]); ++s) {
+
+		size_t const n = per_cycle[s];
+		framepos_t   pos = 0;
+		size_t       written = 0;
+		size_t       read = 0;
+		gint64       write_time = 0;
+		gint64       read_time = 0;
+
+		ring.reset ();
+		ring.reset_tracker ();
+
+		while (written < events_per_test) {
+
+			gint64 before = g_get_monotonic_time ();
+
+			for (size_t i = 0; i < n; ++i) {
+				uint8_t const ev[3] = { (uint8_t) (0xb0 | (i % 16)), (uint8_t) (i % 128), (uint8_t) (written % 128) };
+				ring.write (pos + (i * cycle) / n, (Evoral::EventType) 0, 3, ev);
+			}
+
+			gint64 after = g_get_monotonic_time ();
+			write_time += after - before;
+			written += n;
+
+			buf.silence (cycle);
+
+			before = g_get_monotonic_time ();
+			read += ring.read (buf, pos, pos + cycle);
+			read_time += g_get_monotonic_time () - before;
+
+			pos += cycle;
+		}
+
+		report ("write", n, write_time, written);
+		report ("read into MidiBuffer", n, read_time, read);
+	}
+
+	return 0;
+}
@@ -0,0 +1,84 @@
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+
+#include <glib.h>
+
+#include "ardour/midi_buffer.h"
+#include "ardour/midi_state_tracker.h"
+
+using namespace std;
+using namespace ARDOUR;
+
+/* Micro-benchmark for MidiStateTracker as used at every locate and loop
+   boundary: a number of notes are switched on and then resolved into a
+   MidiBuffer, or the tracker is reset.  Also measures tracking a note
+   on/off stream.  Reports the mean time per operation.
+*/
+
+static void
+report (const char* what, int active, gint64 elapsed, size_t iterations)
+{
+	elapsed = std::max ((gint64) 1, elapsed);
+	cout << setw (24) << left << what << setw (12) << right << active
+	     << setw (16) << fixed << setprecision (3) << (elapsed * 1000.0) / iterations << "\n";
+}
+
+int
+main ()
+{
+	int const    active[] = { 0, 1, 8, 32, 128 };
+	size_t const iterations = 200000;
+
+	MidiStateTracker tracker;
+	MidiBuffer       buf (32768);
+
+	cout << setw (24) << left << "operation" << setw (12) << right << "active notes" << setw (16) << "ns/op" << "\n";
+
+	for (size_t a = 0; a < sizeof (active) / sizeof (active[0]); ++a) {
+
+		int const n = active[a];
+		gint64    resolve_time = 0;
+		gint64    reset_time = 0;
+
+		for (size_t i = 0; i < iterations; ++i) {
+
+			/* spread the notes over channels and pitches, as a
+			   dense multitimbral arrangement would */
+			for (int k = 0; k < n; ++k) {
+				tracker.add ((k * 37 + i) % 128, k % 16);
+			}
+
+			buf.silence (0);
+
+			gint64 before = g_get_monotonic_time ();
+			tracker.resolve_notes (buf, 0);
+			resolve_time += g_get_monotonic_time () - before;
+
+			for (int k = 0; k < n; ++k) {
+				tracker.add ((k * 37 + i) % 128, k % 16);
+			}
+
+			before = g_get_monotonic_time ();
+			tracker.reset ();
+			reset_time += g_get_monotonic_time () - before;
+		}
+
+		report ("resolve into MidiBuffer", n, resolve_time, iterations);
+		report ("reset", n, reset_time, iterations);
+	}
+
+	/* note on/off stream with a handful of overlapping notes */
+	gint64 const before = g_get_monotonic_time ();
+	size_t const events = iterations * 64;
+
+	for (size_t i = 0; i < events; ++i) {
+		uint8_t const ev[3] = { (uint8_t) (((i & 1) ? MIDI_CMD_NOTE_OFF : MIDI_CMD_NOTE_ON) | ((i >> 1) % 16)),
+		                        (uint8_t) ((i >> 1) % 128), 64 };
+		tracker.track (ev);
+	}
+
+	report ("track", tracker.on (), g_get_monotonic_time () - before, events);
+
+	return 0;
+}
@@ -0,0 +1,174 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+#include <glib.h>
+
+#include "pbd/fpu.h"
+#include "ardour/mix.h"
+#include "ardour/runtime_functions.h"
+
+using namespace std;
+using namespace PBD;
+using namespace ARDOUR;
+
+/* Micro-benchmark for the mix kernels: reports the memory throughput of
+   each implementation of each kernel for a range of buffer sizes.  Only
+   the variants that this CPU can run are measured.
+*/
+
+struct KernelSet {
+	string                       name;
+	compute_peak_t               compute_peak;
+	find_peaks_t                 find_peaks;
+	apply_gain_to_buffer_t       apply_gain_to_buffer;
+	mix_buffers_with_gain_t      mix_buffers_with_gain;
+	mix_buffers_no_gain_t        mix_buffers_no_gain;
+	copy_vector_t                copy_vector;
+	apply_gain_ramp_to_buffer_t  apply_gain_ramp_to_buffer;
+	mix_buffers_with_gain_ramp_t mix_buffers_with_gain_ramp;
+	mix_buffers_with_peak_t      mix_buffers_with_peak;
+};
+
+static Sample* dst;
+static Sample* src;
+static volatile float peak_sink; /* keeps results alive */
+
+/* Each test runs one kernel over a buffer of n frames, and returns the
+   number of bytes it moved (loads plus stores).
+*/
+
+static size_t t_compute_peak (KernelSet const & k, pframes_t n) { peak_sink = k.compute_peak (src, n, peak_sink); return n * sizeof (Sample); }
+static size_t t_find_peaks (KernelSet const & k, pframes_t n) { float a = 0, b = 0; k.find_peaks (src, n, &a, &b); peak_sink += a + b; return n * sizeof (Sample); }
+static size_t t_apply_gain (KernelSet const & k, pframes_t n) { k.apply_gain_to_buffer (dst, n, 0.999f); return 2 * n * sizeof (Sample); }
+static size_t t_mix_gain (KernelSet const & k, pframes_t n) { k.mix_buffers_with_gain (dst, src, n, 0.5f); return 3 * n * sizeof (Sample); }
+static size_t t_mix_no_gain (KernelSet const & k, pframes_t n) { k.mix_buffers_no_gain (dst, src, n); return 3 * n * sizeof (Sample); }
+static size_t t_copy (KernelSet const & k, pframes_t n) { k.copy_vector (dst, src, n); return 2 * n * sizeof (Sample); }
+static size_t t_gain_ramp (KernelSet const & k, pframes_t n) { peak_sink += k.apply_gain_ramp_to_buffer (dst, n, 0.0, 1.0, 0.003); return 2 * n * sizeof (Sample); }
+static size_t t_mix_gain_ramp (KernelSet const & k, pframes_t n) { peak_sink += k.mix_buffers_with_gain_ramp (dst, src, n, 1.0, 0.0, 0.003); return 3 * n * sizeof (Sample); }
+static size_t t_mix_peak (KernelSet const & k, pframes_t n) { peak_sink = k.mix_buffers_with_peak (dst, src, n, 0.5f, 0.0f); return 3 * n * sizeof (Sample); }
+
+struct Test {
+	const char* name;
+	size_t (*run) (KernelSet const &, pframes_t);
+};
+
+static Test const tests[] = {
+	{ "compute_peak", t_compute_peak },
+	{ "find_peaks", t_find_peaks },
+	{ "apply_gain_to_buffer", t_apply_gain },
+	{ "mix_buffers_with_gain", t_mix_gain },
+	{ "mix_buffers_no_gain", t_mix_no_gain },
+	{ "copy_vector", t_copy },
+	{ "apply_gain_ramp_to_buffer", t_gain_ramp },
+	{ "mix_buffers_with_gain_ramp", t_mix_gain_ramp },
+	{ "mix_buffers_with_peak", t_mix_peak },
+};
+
+int
+main ()
+{
+	vector<KernelSet> sets;
+
+	KernelSet d = {
+		"default",
+		default_compute_peak, default_find_peaks, default_apply_gain_to_buffer,
+		default_mix_buffers_with_gain, default_mix_buffers_no_gain, default_copy_vector,
+		default_apply_gain_ramp_to_buffer, default_mix_buffers_with_gain_ramp, default_mix_buffers_with_peak
+	};
+	sets.push_back (d);
+
+#if defined (ARCH_X86) && defined (BUILD_SSE_OPTIMIZATIONS)
+	FPU* fpu = FPU::instance ();
+
+	if (fpu->has_sse ()) {
+		KernelSet k = {
+			"sse",
+			x86_sse_compute_peak, x86_sse_find_peaks, x86_sse_apply_gain_to_buffer,
+			x86_sse_mix_buffers_with_gain, x86_sse_mix_buffers_no_gain, default_copy_vector,
+			default_apply_gain_ramp_to_buffer, default_mix_buffers_with_gain_ramp, default_mix_buffers_with_peak
+		};
+		sets.push_back (k);
+	}
+
+	if (fpu->has_avx2 () && fpu->has_fma ()) {
+		KernelSet k = {
+			"avx2",
+			x86_avx2_compute_peak, x86_avx2_find_peaks, x86_avx2_apply_gain_to_buffer,
+			x86_avx2_mix_buffers_with_gain, x86_avx2_mix_buffers_no_gain, x86_avx2_copy_vector,
+			x86_avx2_apply_gain_ramp_to_buffer, x86_avx2_mix_buffers_with_gain_ramp, x86_avx2_mix_buffers_with_peak
+		};
+		sets.push_back (k);
+	}
+
+	if (fpu->has_avx512f ()) {
+		KernelSet k = {
+			"avx512f",
+			x86_avx512f_compute_peak, x86_avx512f_find_peaks, x86_avx512f_apply_gain_to_buffer,
+			x86_avx512f_mix_buffers_with_gain, x86_avx512f_mix_buffers_no_gain, x86_avx512f_copy_vector,
+			x86_avx512f_apply_gain_ramp_to_buffer, x86_avx512f_mix_buffers_with_gain_ramp, x86_avx512f_mix_buffers_with_peak
+		};
+		sets.push_back (k);
+	}
+#endif
+
+	pframes_t const sizes[] = { 64, 256, 1024, 8192 };
+	size_t const bytes_per_test = 256 * 1048576;
+
+	/* the SSE functions expect 16-byte aligned buffers */
+	void* p;
+	if (posix_memalign (&p, 64, 8192 * sizeof (Sample))) {
+		return 1;
+	}
+	dst = (Sample*) p;
+	if (posix_memalign (&p, 64, 8192 * sizeof (Sample))) {
+		return 1;
+	}
+	src = (Sample*) p;
+
+	for (pframes_t i = 0; i < 8192; ++i) {
+		dst[i] = 0.0f;
+		src[i] = (i % 100) / 100.0f - 0.5f;
+	}
+
+	cout << setw (28) << left << "kernel" << setw (10) << "variant";
+	for (size_t s = 0; s < sizeof (sizes) / sizeof (sizes[0]); ++s) {
+		cout << setw (10) << right << sizes[s];
+	}
+	cout << "  (GB/s per buffer size in frames)\n";
+
+	for (size_t t = 0; t < sizeof (tests) / sizeof (tests[0]); ++t) {
+		for (vector<KernelSet>::const_iterator k = sets.begin(); k != sets.end(); ++k) {
+
+			cout << setw (28) << left << tests[t].name << setw (10) << k->name;
+
+			for (size_t s = 0; s < sizeof (sizes) / sizeof (sizes[0]); ++s) {
+
+				/* keep the mixed values bounded */
+				memset (dst, 0, 8192 * sizeof (Sample));
+
+				size_t bytes = 0;
+				gint64 const before = g_get_monotonic_time ();
+
+				while (bytes < bytes_per_test) {
+					bytes += tests[t].run (*k, sizes[s]);
+				}
+
+				gint64 const elapsed = std::max ((gint64) 1, g_get_monotonic_time () - before);
+
+				cout << setw (10) << right << fixed << setprecision (2) << (bytes / 1e3) / elapsed;
+			}
+
+			cout << "\n";
+		}
+	}
+
+	free (dst);
+	free (src);
+
+	return 0;
+}
@@ -0,0 +1,154 @@
+#include <algorithm>
+#include <iostream>
+#include <glibmm/miscutils.h>
+
+#include "pbd/compose.h"
+#include "pbd/failed_constructor.h"
+#include "ardour/ardour.h"
+#include "ardour/audioengine.h"
+#include "ardour/audioplaylist.h"
+#include "ardour/audioregion.h"
+#include "ardour/playlist_factory.h"
+#include "ardour/region_factory.h"
+#include "ardour/session.h"
+#include "ardour/sndfilesource.h"
+#include "ardour/source_factory.h"
+#include "test_util.h"
+
+using namespace std;
+using namespace PBD;
+using namespace ARDOUR;
+
+static const char* localedir = LOCALEDIR;
+
+/* Each region is this long, and starts half-way through the previous one,
+   so that every read sees two overlapping regions.
+*/
+static const framecnt_t region_length = 2048;
+static const framecnt_t read_length = 1024;
+static const int reads_per_test = 20000;
+
+static void
+run (Session* session, boost::shared_ptr<Source> source, int n_regions)
+{
+	boost::shared_ptr<AudioPlaylist> playlist = boost::dynamic_pointer_cast<AudioPlaylist> (
+		PlaylistFactory::create (DataType::AUDIO, *session, string_compose ("bench-%1", n_regions))
+		);
+
+	PropertyList plist;
+	plist.add (Properties::start, 0);
+	plist.add (Properties::length, region_length);
+
+	playlist->freeze ();
+	for (int i = 0; i < n_regions; ++i) {
+		playlist->add_region (RegionFactory::create (source, plist), i * region_length / 2);
+	}
+	playlist->thaw ();
+
+	framecnt_t const extent = (n_regions + 1) * region_length / 2;
+
+	Sample buf[read_length];
+	Sample mbuf[read_length];
+	float gbuf[read_length];
+
+	/* warm up, and let the playlist build any lookup structures it needs */
+	playlist->read (buf, mbuf, gbuf, 0, read_length, 0);
+
+	gint64 const before = g_get_monotonic_time ();
+
+	framepos_t pos = 0;
+	for (int i = 0; i < reads_per_test; ++i) {
+		playlist->read (buf, mbuf, gbuf, pos, read_length, 0);
+		/* stride through the playlist so that we do not just hit the same regions */
+		pos = (pos + 7919 * read_length) % max (extent - read_length, read_length);
+	}
+
+	gint64 const elapsed = g_get_monotonic_time () - before;
+
+	double const reads_per_sec = reads_per_test * 1e6 / elapsed;
+
+	cout << n_regions << " regions: "
+	     << elapsed / double (reads_per_test) << " us per read, "
+	     << reads_per_sec << " reads/s, "
+	     << reads_per_sec * read_length * sizeof (Sample) / 1e6 << " MB/s\n";
+
+	/* Time the region lookup that read() makes, with the index and with
+	   the walk of the whole list that it replaced, as a baseline.
+	*/
+
+	RegionList const all = playlist->region_list().rlist ();
+	size_t found_indexed = 0;
+	size_t found_linear = 0;
+
+	gint64 const before_indexed = g_get_monotonic_time ();
+
+	pos = 0;
+	for (int i = 0; i < reads_per_test; ++i) {
+		found_indexed += playlist->regions_touched (pos, pos + read_length - 1)->size ();
+		pos = (pos + 7919 * read_length) % max (extent - read_length, read_length);
+	}
+
+	gint64 const indexed = g_get_monotonic_time () - before_indexed;
+	gint64 const before_linear = g_get_monotonic_time ();
+
+	pos = 0;
+	for (int i = 0; i < reads_per_test; ++i) {
+		RegionList touched;
+		for (RegionList::const_iterator r = all.begin(); r != all.end(); ++r) {
+			if ((*r)->coverage (pos, pos + read_length - 1) != Evoral::OverlapNone) {
+				touched.push_back (*r);
+			}
+		}
+		found_linear += touched.size ();
+		pos = (pos + 7919 * read_length) % max (extent - read_length, read_length);
+	}
+
+	gint64 const linear = g_get_monotonic_time () - before_linear;
+
+	if (found_indexed != found_linear) {
+		cerr << "index found " << found_indexed << " regions but linear scan found " << found_linear << "\n";
+	}
+
+	cout << n_regions << " regions: lookup "
+	     << indexed / double (reads_per_test) << " us indexed, "
+	     << linear / double (reads_per_test) << " us by linear scan\n";
+
+	playlist->drop_regions ();
+}
+
+int
+main (int argc, char* argv[])
+{
+	ARDOUR::init (false, true, localedir);
+
+	Session* session = 0;
+
+	try {
+		session = load_session ("../libs/ardour/test/profiling/sessions/0tracks", "0tracks");
+	} catch (failed_constructor& e) {
+		cerr << "failed_constructor: " << e.what() << "\n";
+		exit (EXIT_FAILURE);
+	}
+
+	std::string const path = Glib::build_filename (new_test_output_dir ("playlist_read"), "source.wav");
+	boost::shared_ptr<Source> source = SourceFactory::createWritable (DataType::AUDIO, *session, path, false, session->frame_rate ());
+
+	Sample data[region_length];
+	for (int i = 0; i < region_length; ++i) {
+		data[i] = float (i) / region_length;
+	}
+	boost::dynamic_pointer_cast<SndFileSource> (source)->write (data, region_length);
+
+	int const sizes[] = { 10, 1000, 50000 };
+
+	for (size_t i = 0; i < sizeof (sizes) / sizeof (sizes[0]); ++i) {
+		run (session, source, sizes[i]);
+	}
+
+	AudioEngine::instance()->remove_session ();
+	delete session;
+	AudioEngine::instance()->stop ();
+	AudioEngine::destroy ();
+
+	return 0;
+}
@@ -48,3 +48,57 @@ TempoTest::recomputeMapTest ()
 	--i;
 	CPPUNIT_ASSERT_EQUAL (framepos_t (288e3), (*i)->frame ());
 }
+
+void
+TempoTest::gridTest ()
+{
+	int const sampling_rate = 48000;
+
+	TempoMap map (sampling_rate);
+	Meter meterA (4, 4);
+	map.add_meter (meterA, BBT_Time (1, 1, 0));
+
+	/* as above: 120bpm 4/4 up to bar 4, then 240bpm 3/4 */
+
+	Tempo tempoA (120);
+	map.add_tempo (tempoA, BBT_Time (1, 1, 0));
+	Tempo tempoB (240);
+	map.add_tempo (tempoB, BBT_Time (4, 1, 0));
+	Meter meterB (3, 4);
+	map.add_meter (meterB, BBT_Time (4, 1, 0));
+
+	BBT_Time bbt;
+
+	map.bbt_time (288e3, bbt);
+	CPPUNIT_ASSERT_EQUAL (BBT_Time (4, 1, 0), bbt);
+
+	map.bbt_time (288e3 + 18e3, bbt);
+	CPPUNIT_ASSERT_EQUAL (BBT_Time (4, 2, BBT_Time::ticks_per_beat / 2), bbt);
+
+	CPPUNIT_ASSERT_EQUAL (framepos_t (324e3), map.frame_time (BBT_Time (5, 1, 0)));
+
+	/* far beyond the end of any session: the map is computed, not stored */
+
+	framepos_t const far = 288e3 + framepos_t (9996 * 3) * 12e3;
+	CPPUNIT_ASSERT_EQUAL (far, map.frame_time (BBT_Time (10000, 1, 0)));
+
+	map.bbt_time (far + 12e3, bbt);
+	CPPUNIT_ASSERT_EQUAL (BBT_Time (10000, 2, 0), bbt);
+
+	CPPUNIT_ASSERT_EQUAL (far, map.round_to_bar (far + 1, RoundDownMaybe));
+	CPPUNIT_ASSERT_EQUAL (framepos_t (far + 36e3), map.round_to_bar (far + 1, RoundUpMaybe));
+
+	/* the grid either side of the tempo & meter change */
+
+	TempoMap::BBTPointList grid;
+	map.get_grid (grid, 264e3, 300e3);
+
+	CPPUNIT_ASSERT_EQUAL (size_t (3), grid.size ());
+	CPPUNIT_ASSERT_EQUAL (framepos_t (264e3), grid[0].frame);
+	CPPUNIT_ASSERT_EQUAL (uint32_t (3), grid[0].bar);
+	CPPUNIT_ASSERT_EQUAL (uint32_t (4), grid[0].beat);
+	CPPUNIT_ASSERT_EQUAL (framepos_t (288e3), grid[1].frame);
+	CPPUNIT_ASSERT (grid[1].is_bar ());
+	CPPUNIT_ASSERT_EQUAL (framepos_t (300e3), grid[2].frame);
+	CPPUNIT_ASSERT_EQUAL (uint32_t (2), grid[2].beat);
+}
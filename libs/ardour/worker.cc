@@ -20,28 +20,193 @@
 #include <stdlib.h>
 #include <unistd.h>
 
-#include "ardour/worker.h"
-#include "pbd/error.h"
+#include <algorithm>
+#include <deque>
+#include <vector>
 
+#include <glibmm/threads.h>
 #include <glibmm/timer.h>
 
+#include "pbd/error.h"
+#include "pbd/semaphore.h"
+
+#include "ardour/rc_configuration.h"
+#include "ardour/worker.h"
+
 namespace ARDOUR {
 
+/** The threads that run the work of all Workers.
+ *
+ *  The audio thread hands a Worker to the pool by pushing it onto a
+ *  lock-free intrusive list (_incoming) and posting the semaphore, once
+ *  for each push.  Pool threads move the list into a FIFO under a mutex
+ *  that the audio thread never touches, and then service one Worker
+ *  each.  A Worker is only pushed when its _queued flag goes from 0 to
+ *  1, and the flag is only cleared by the thread that has finished
+ *  servicing it, so no Worker is ever on the list twice or doing work
+ *  in two threads at once.
+ */
+class WorkerPool
+{
+public:
+	static WorkerPool* acquire ();
+	static void release ();
+
+	void enqueue (Worker*);
+
+private:
+	WorkerPool (uint32_t n_threads);
+	~WorkerPool ();
+
+	void run ();
+
+	std::vector<Glib::Threads::Thread*> _threads;
+	PBD::Semaphore                      _sem;
+	bool                                _exit;
+
+	/** Workers queued by the audio thread, most recent first */
+	Worker*                             _incoming;
+
+	Glib::Threads::Mutex                _lock;
+	std::deque<Worker*>                 _pending;
+
+	static Glib::Threads::Mutex _instance_lock;
+	static WorkerPool*          _instance;
+	static uint32_t             _users;
+};
+
+Glib::Threads::Mutex WorkerPool::_instance_lock;
+WorkerPool*          WorkerPool::_instance = 0;
+uint32_t             WorkerPool::_users = 0;
+
+WorkerPool*
+WorkerPool::acquire ()
+{
+	Glib::Threads::Mutex::Lock lm (_instance_lock);
+	if (_users++ == 0) {
+		_instance = new WorkerPool (std::max (Config->get_lv2_worker_threads(), (uint32_t) 1));
+	}
+	return _instance;
+}
+
+void
+WorkerPool::release ()
+{
+	Glib::Threads::Mutex::Lock lm (_instance_lock);
+	if (--_users == 0) {
+		delete _instance;
+		_instance = 0;
+	}
+}
+
+WorkerPool::WorkerPool (uint32_t n_threads)
+	: _sem (0)
+	, _exit (false)
+	, _incoming (0)
+{
+	for (uint32_t n = 0; n < n_threads; ++n) {
+		_threads.push_back (Glib::Threads::Thread::create (sigc::mem_fun (*this, &WorkerPool::run)));
+	}
+}
+
+WorkerPool::~WorkerPool ()
+{
+	/* all Workers have gone, so nothing can be queued any more */
+	_exit = true;
+	for (size_t n = 0; n < _threads.size(); ++n) {
+		_sem.post ();
+	}
+	for (std::vector<Glib::Threads::Thread*>::iterator t = _threads.begin(); t != _threads.end(); ++t) {
+		(*t)->join ();
+	}
+}
+
+void
+WorkerPool::enqueue (Worker* w)
+{
+	/* called from the audio thread: lock-free push */
+	Worker* head;
+	do {
+		head = (Worker*) g_atomic_pointer_get (&_incoming);
+		w->_next_queued = head;
+	} while (!g_atomic_pointer_compare_and_exchange (&_incoming, head, w));
+
+	_sem.post ();
+}
+
+void
+WorkerPool::run ()
+{
+	void*  buf      = NULL;
+	size_t buf_size = 0;
+
+	while (true) {
+		_sem.wait ();
+
+		if (_exit) {
+			break;
+		}
+
+		Worker* w = 0;
+
+		{
+			Glib::Threads::Mutex::Lock lm (_lock);
+
+			/* take everything the audio thread has queued, oldest first */
+			Worker* head;
+			do {
+				head = (Worker*) g_atomic_pointer_get (&_incoming);
+			} while (!g_atomic_pointer_compare_and_exchange (&_incoming, head, (Worker*) 0));
+
+			std::deque<Worker*>::iterator ins = _pending.end();
+			for (; head; head = head->_next_queued) {
+				ins = _pending.insert (ins, head);
+			}
+
+			if (_pending.empty()) {
+				continue;
+			}
+
+			w = _pending.front ();
+			_pending.pop_front ();
+		}
+
+		w->run (buf, buf_size);
+	}
+
+	free (buf);
+}
+
 Worker::Worker(Workee* workee, uint32_t ring_size)
 	: _workee(workee)
 	, _requests(new RingBuffer<uint8_t>(ring_size))
 	, _responses(new RingBuffer<uint8_t>(ring_size))
 	, _response((uint8_t*)malloc(ring_size))
-	, _sem(0)
 	, _exit(false)
-	, _thread (Glib::Threads::Thread::create(sigc::mem_fun(*this, &Worker::run)))
+	, _pool(WorkerPool::acquire ())
+	, _queued(0)
+	, _servicing(0)
+	, _next_queued(0)
 {}
 
 Worker::~Worker()
 {
+	/* work that is still queued is dropped, but let a pool thread that is
+	   already servicing us finish before we go away.
+	*/
 	_exit = true;
-	_sem.post();
-	_thread->join();
+	{
+		Glib::Threads::Mutex::Lock lm (_servicing_lock);
+		while (g_atomic_int_get (&_queued) || g_atomic_int_get (&_servicing)) {
+			_idle.wait (_servicing_lock);
+		}
+	}
+
+	WorkerPool::release ();
+
+	delete _requests;
+	delete _responses;
+	free (_response);
 }
 
 bool
@@ -56,14 +221,16 @@ Worker::schedule(uint32_t size, const void* data)
 	if (_requests->write((const uint8_t*)data, size) != size) {
 		return false;
 	}
-	_sem.post();
+	if (g_atomic_int_compare_and_exchange (&_queued, 0, 1)) {
+		_pool->enqueue (this);
+	}
 	return true;
 }
 
 bool
 Worker::respond(uint32_t size, const void* data)
 {
-	if (_requests->write_space() < size + sizeof(size)) {
+	if (_responses->write_space() < size + sizeof(size)) {
 		return false;
 	}
 	if (_responses->write((const uint8_t*)&size, sizeof(size)) != sizeof(size)) {
@@ -117,53 +284,72 @@ Worker::emit_responses()
 }
 
 void
-Worker::run()
+Worker::run(void*& buf, size_t& buf_size)
 {
-	void*  buf      = NULL;
-	size_t buf_size = 0;
+	g_atomic_int_inc (&_servicing);
+
 	while (true) {
-		_sem.wait();
-		if (_exit) {
-			if (buf) free(buf);
-			return;
-		}
+		while (!_exit && _requests->read_space() >= sizeof(uint32_t)) {
+			uint32_t size;
 
-		uint32_t size = _requests->read_space();
-		if (size < sizeof(size)) {
-			PBD::error << "Worker: no work-data on ring buffer" << endmsg;
-			continue;
-		}
-		while (!verify_message_completeness(_requests)) {
-			Glib::usleep(2000);
+			while (!verify_message_completeness(_requests)) {
+				Glib::usleep(2000);
+				if (_exit) {
+					break;
+				}
+			}
 			if (_exit) {
-				if (buf) free(buf);
-				return;
+				break;
+			}
+			if (_requests->read((uint8_t*)&size, sizeof(size)) < sizeof(size)) {
+				PBD::error << "Worker: Error reading size from request ring"
+				           << endmsg;
+				break;
+			}
+
+			if (size > buf_size) {
+				void* b = realloc(buf, size);
+				if (b) {
+					buf      = b;
+					buf_size = size;
+				} else {
+					PBD::error << "Worker: Error allocating memory"
+					           << endmsg;
+					_requests->increment_read_idx(size);
+					continue;
+				}
 			}
-		}
-		if (_requests->read((uint8_t*)&size, sizeof(size)) < sizeof(size)) {
-			PBD::error << "Worker: Error reading size from request ring"
-			           << endmsg;
-			continue;
-		}
 
-		if (size > buf_size) {
-			buf = realloc(buf, size);
-			if (buf) {
-				buf_size = size;
-			} else {
-				PBD::error << "Worker: Error allocating memory"
+			if (_requests->read((uint8_t*)buf, size) < size) {
+				PBD::error << "Worker: Error reading body from request ring"
 				           << endmsg;
-				buf_size = 0; // TODO: This is probably fatal
+				break;  // TODO: This is probably fatal
 			}
+
+			_workee->work(size, buf);
 		}
 
-		if (_requests->read((uint8_t*)buf, size) < size) {
-			PBD::error << "Worker: Error reading body from request ring"
-			           << endmsg;
-			continue;  // TODO: This is probably fatal
+		/* hand ourselves back; if the audio thread scheduled more work
+		   after we looked but before we cleared the flag, it did not queue
+		   us again, so carry on here instead.
+		*/
+		g_atomic_int_set (&_queued, 0);
+
+		if (_exit || _requests->read_space() < sizeof(uint32_t)) {
+			break;
 		}
+		if (!g_atomic_int_compare_and_exchange (&_queued, 0, 1)) {
+			/* the audio thread queued us in the meantime */
+			break;
+		}
+	}
 
-		_workee->work(size, buf);
+	/* another pool thread may already be servicing us, so only the last
+	   one out wakes the destructor, which may run as soon as we unlock.
+	*/
+	Glib::Threads::Mutex::Lock lm (_servicing_lock);
+	if (g_atomic_int_dec_and_test (&_servicing)) {
+		_idle.broadcast ();
 	}
 }
 
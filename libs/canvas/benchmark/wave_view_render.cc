@@ -0,0 +1,179 @@
+#include <iostream>
+#include <cstdlib>
+#include <vector>
+
+#include <glib.h>
+#include <glibmm/timer.h>
+
+#include "pbd/cpus.h"
+#include "pbd/failed_constructor.h"
+
+#include "ardour/ardour.h"
+#include "ardour/audioengine.h"
+#include "ardour/audioregion.h"
+#include "ardour/audio_track.h"
+#include "ardour/playlist.h"
+#include "ardour/session.h"
+
+#include "gtkmm2ext/gtk_ui.h"
+
+#include "canvas/canvas.h"
+#include "canvas/wave_view.h"
+
+using namespace std;
+using namespace ARDOUR;
+using namespace ArdourCanvas;
+
+/* Measures how long it takes for every waveform of a session to be
+ * rendered after a zoom, with different sizes of the WaveView drawing
+ * thread pool.  One WaveView is made for each channel of each region on
+ * each audio track, stacked as the editor would show them, and each is
+ * asked to render the visible part of itself once.  The time is taken
+ * from then until the last of them has its image.
+ */
+
+static const double   canvas_width = 1920;
+static const double   view_height  = 64;
+static const gint64   timeout      = 120 * G_USEC_PER_SEC;
+
+static gint images_ready = 0;
+
+static void
+image_ready ()
+{
+	g_atomic_int_inc (&images_ready);
+}
+
+static double
+time_to_all_waveforms (GtkCanvas& canvas, vector<boost::shared_ptr<AudioRegion> > const & regions, double spp, uint32_t threads)
+{
+	WaveView::set_drawing_thread_count (threads);
+
+	vector<WaveView*> views;
+	PBD::ScopedConnectionList connections;
+	double y = 0;
+
+	for (vector<boost::shared_ptr<AudioRegion> >::const_iterator r = regions.begin(); r != regions.end(); ++r) {
+		for (uint32_t c = 0; c < (*r)->n_channels(); ++c) {
+			WaveView* wv = new WaveView (canvas.root(), *r);
+			wv->set_position (Duple (0, y));
+			wv->set_channel (c);
+			wv->set_height (view_height);
+			wv->set_samples_per_pixel (spp);
+			wv->ImageReady.connect_same_thread (connections, boost::bind (&image_ready));
+			views.push_back (wv);
+			y += view_height;
+		}
+	}
+
+	g_atomic_int_set (&images_ready, 0);
+
+	Cairo::RefPtr<Cairo::ImageSurface> surface = Cairo::ImageSurface::create (Cairo::FORMAT_ARGB32, canvas_width, view_height);
+	Cairo::RefPtr<Cairo::Context> context = Cairo::Context::create (surface);
+
+	const gint64 start = g_get_monotonic_time ();
+
+	y = 0;
+	for (vector<WaveView*>::iterator v = views.begin(); v != views.end(); ++v) {
+		(*v)->render (Rect (0, y, canvas_width, y + view_height), context);
+		y += view_height;
+	}
+
+	while (g_atomic_int_get (&images_ready) < (gint) views.size()) {
+		if (g_get_monotonic_time () - start > timeout) {
+			cerr << "timed out with " << g_atomic_int_get (&images_ready) << " of " << views.size() << " waveforms\n";
+			break;
+		}
+		Glib::usleep (1000);
+	}
+
+	const gint64 stop = g_get_monotonic_time ();
+
+	connections.drop_connections ();
+
+	for (vector<WaveView*>::iterator v = views.begin(); v != views.end(); ++v) {
+		delete *v;
+	}
+
+	return (stop - start) / (double) G_USEC_PER_SEC;
+}
+
+int
+main (int argc, char* argv[])
+{
+	if (argc < 3) {
+		cerr << "Syntax: " << argv[0] << " <dir> <snapshot-name> [samples-per-pixel]\n";
+		exit (EXIT_FAILURE);
+	}
+
+	const double spp = argc > 3 ? atof (argv[3]) : 1024;
+
+	Gtkmm2ext::UI ui ("wave_view_render", &argc, &argv);
+
+	ARDOUR::init (false, true, LOCALEDIR);
+
+	AudioEngine* engine = AudioEngine::create ();
+
+	if (!engine->set_backend ("None (Dummy)", "wave_view_render", "")) {
+		cerr << "Cannot set up the dummy backend\n";
+		exit (EXIT_FAILURE);
+	}
+
+	init_post_engine ();
+
+	if (engine->start ()) {
+		cerr << "Cannot start the dummy backend\n";
+		exit (EXIT_FAILURE);
+	}
+
+	Session* session = 0;
+
+	try {
+		session = new Session (*engine, argv[1], argv[2]);
+		engine->set_session (session);
+	} catch (failed_constructor& e) {
+		cerr << "failed_constructor: " << e.what() << "\n";
+		exit (EXIT_FAILURE);
+	} catch (exception& e) {
+		cerr << "exception: " << e.what() << "\n";
+		exit (EXIT_FAILURE);
+	}
+
+	vector<boost::shared_ptr<AudioRegion> > regions;
+	boost::shared_ptr<RouteList> routes = session->get_routes ();
+
+	for (RouteList::iterator i = routes->begin(); i != routes->end(); ++i) {
+		boost::shared_ptr<AudioTrack> track = boost::dynamic_pointer_cast<AudioTrack> (*i);
+		if (!track) {
+			continue;
+		}
+		RegionList const rl = track->playlist()->region_list().rlist();
+		for (RegionList::const_iterator r = rl.begin(); r != rl.end(); ++r) {
+			boost::shared_ptr<AudioRegion> ar = boost::dynamic_pointer_cast<AudioRegion> (*r);
+			if (ar) {
+				regions.push_back (ar);
+			}
+		}
+	}
+
+	cout << regions.size() << " audio regions at " << spp << " samples per pixel\n";
+
+	GtkCanvas canvas;
+	Gtk::Allocation allocation (0, 0, canvas_width, 1080);
+	canvas.size_allocate (allocation);
+
+	const uint32_t cpus = hardware_concurrency ();
+
+	for (uint32_t threads = 1; threads <= cpus; threads *= 2) {
+		cout << threads << " " << time_to_all_waveforms (canvas, regions, spp, threads) << "\n";
+	}
+
+	WaveView::stop_drawing_thread ();
+
+	engine->remove_session ();
+	delete session;
+	engine->stop ();
+	AudioEngine::destroy ();
+
+	return 0;
+}
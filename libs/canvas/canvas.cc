@@ -27,6 +27,8 @@
  */
 
 #include <list>
+#include <cfloat>
+#include <cmath>
 #include <cassert>
 #include <gtkmm/adjustment.h>
 #include <gtkmm/label.h>
@@ -46,6 +48,7 @@ using namespace std;
 using namespace ArdourCanvas;
 
 uint32_t Canvas::tooltip_timeout_msecs = 750;
+uint32_t GtkCanvas::frame_rate = 60;
 
 /** Construct a new Canvas */
 Canvas::Canvas ()
@@ -179,6 +182,17 @@ Canvas::dump (ostream& o) const
 void
 Canvas::item_shown_or_hidden (Item* item)
 {
+	/* a cached container hears nothing of changes made while it is
+	   hidden, so it must start again when it, or an ancestor, is shown
+	   or hidden.
+	*/
+
+	for (list<Container*>::iterator c = cached_containers.begin(); c != cached_containers.end(); ++c) {
+		if (*c == item || (*c)->is_descendant_of (*item)) {
+			(*c)->drop_cache ();
+		}
+	}
+
 	boost::optional<Rect> bbox = item->bounding_box ();
 	if (bbox) {
 		if (item->item_to_window (*bbox).intersection (visible_area ())) {
@@ -349,11 +363,41 @@ Canvas::item_moved (Item* item, boost::optional<Rect> pre_change_parent_bounding
  *  @param area Area to redraw in the item's coordinates.
  */
 void
-Canvas::queue_draw_item_area (Item* item, Rect area)
+Canvas::queue_draw_item_area (Item const * item, Rect area)
 {
+	if (!cached_containers.empty()) {
+
+		/* tell any cached containers that hold the item (or are the
+		   item) that this part of their image is out of date.
+		*/
+
+		Rect r = area;
+
+		for (Item const * i = item; i; i = i->parent()) {
+			for (list<Container*>::iterator c = cached_containers.begin(); c != cached_containers.end(); ++c) {
+				if (*c == i) {
+					(*c)->damage_cache (r);
+				}
+			}
+			r = i->item_to_parent (r);
+		}
+	}
+
 	request_redraw (item->item_to_window (area));
 }
 
+void
+Canvas::add_cached_container (Container& c)
+{
+	cached_containers.push_back (&c);
+}
+
+void
+Canvas::remove_cached_container (Container& c)
+{
+	cached_containers.remove (&c);
+}
+
 void
 Canvas::set_tooltip_timeout (uint32_t msecs)
 {
@@ -387,6 +431,7 @@ GtkCanvas::GtkCanvas ()
 	, _grabbed_item (0)
 	, _focused_item (0)
 	, _single_exposure (1)
+	, _last_frame_time (0)
 	, current_tooltip_item (0)
 	, tooltip_window (0)
 {
@@ -801,29 +846,58 @@ GtkCanvas::on_expose_event (GdkEventExpose* ev)
 	Cairo::RefPtr<Cairo::Context> draw_context = get_window()->create_cairo_context ();
 #endif
 
-        /* draw background color */
+	/* work out which rectangles to render */
+
+	vector<Rect> areas;
+	GdkRectangle* rects;
+	gint nrects;
+	uint64_t covered = 0;
 
-        draw_context->rectangle (ev->area.x, ev->area.y, ev->area.width, ev->area.height);
-        draw_context->clip_preserve ();
-        set_source_rgba (draw_context, _bg_color);
-        draw_context->fill ();
+	gdk_region_get_rectangles (ev->region, &rects, &nrects);
+	for (gint n = 0; n < nrects; ++n) {
+		areas.push_back (Rect (rects[n].x, rects[n].y, rects[n].x + rects[n].width, rects[n].y + rects[n].height));
+		covered += (uint64_t) rects[n].width * rects[n].height;
+	}
+	g_free (rects);
 
-        /* render canvas */
-		if ( _single_exposure ) {
+	/* With single exposure we render the whole expose area at once,
+	   unless its rectangles cover less than half of it. Coalesced damage
+	   is often a few small areas far apart (a playhead and a meter,
+	   say), and their bounding box would be mostly redrawn for nothing.
+	*/
 
-			render (Rect (ev->area.x, ev->area.y, ev->area.x + ev->area.width, ev->area.y + ev->area.height), draw_context);
+	if (_single_exposure && covered * 2 >= (uint64_t) ev->area.width * ev->area.height) {
+		areas.clear ();
+		areas.push_back (Rect (ev->area.x, ev->area.y, ev->area.x + ev->area.width, ev->area.y + ev->area.height));
+	}
 
-		} else {
-			GdkRectangle* rects;
-			gint nrects;
+	FrameStats stats;
 
-			gdk_region_get_rectangles (ev->region, &rects, &nrects);
-			for (gint n = 0; n < nrects; ++n) {
-				draw_context->set_identity_matrix();  //reset the cairo matrix, just in case someone left it transformed after drawing ( cough )
-				render (Rect (rects[n].x, rects[n].y, rects[n].x + rects[n].width, rects[n].y + rects[n].height), draw_context);
-			}
-			g_free (rects);
-		}
+	for (vector<Rect>::const_iterator a = areas.begin(); a != areas.end(); ++a) {
+
+		draw_context->save ();
+		draw_context->set_identity_matrix();  //reset the cairo matrix, just in case someone left it transformed after drawing ( cough )
+
+		/* draw background color */
+
+		draw_context->rectangle (a->x0, a->y0, a->width(), a->height());
+		draw_context->clip_preserve ();
+		set_source_rgba (draw_context, _bg_color);
+		draw_context->fill ();
+
+		/* render canvas */
+
+		render (*a, draw_context);
+		draw_context->restore ();
+
+		++stats.rects;
+		stats.pixels += (uint64_t) (a->width() * a->height());
+		stats.items += render_count;
+	}
+
+	_last_frame_stats = stats;
+
+	DEBUG_TRACE (PBD::DEBUG::CanvasRender, string_compose ("expose rendered %1 rects, %2 pixels, %3 items\n", stats.rects, stats.pixels, stats.items));
 
 #ifdef OPTIONAL_CAIRO_IMAGE_SURFACE
 	if (getenv("ARDOUR_IMAGE_SURFACE")) {
@@ -1035,6 +1109,10 @@ GtkCanvas::on_leave_notify_event (GdkEventCrossing* ev)
 
 /** Called to request a redraw of our canvas.
  *  @param area Area to redraw, in window coordinates.
+ *
+ *  The area is added to our damage list, which is sent to the window
+ *  system at most once per frame (see set_frame_rate()), so that the many
+ *  requests made while handling one event or timer are drawn together.
  */
 void
 GtkCanvas::request_redraw (Rect const & request)
@@ -1051,7 +1129,119 @@ GtkCanvas::request_redraw (Rect const & request)
 	real_area.y0 = max (0.0, min (h, request.y0));
 	real_area.y1 = max (0.0, min (h, request.y1));
 
-	queue_draw_area (real_area.x0, real_area.y0, real_area.width(), real_area.height());
+	add_damage (real_area);
+
+	if (_damage.empty() || frame_connection.connected()) {
+		return;
+	}
+
+	/* flush just before GDK processes window updates, and no sooner than
+	   one frame after the last flush.
+	*/
+
+	gint64 const now = g_get_monotonic_time ();
+	gint64 const due = frame_rate ? _last_frame_time + (1000000 / frame_rate) : now;
+
+	if (due <= now) {
+		frame_connection = Glib::signal_idle().connect (sigc::mem_fun (*this, &GtkCanvas::frame_due), Glib::PRIORITY_HIGH_IDLE + 10);
+	} else {
+		frame_connection = Glib::signal_timeout().connect (sigc::mem_fun (*this, &GtkCanvas::frame_due), (due - now + 999) / 1000, Glib::PRIORITY_HIGH_IDLE + 10);
+	}
+}
+
+static Distance
+rect_area (Rect const & r)
+{
+	return r.width() * r.height();
+}
+
+/** Add an area to our damage list, merging it with others where that
+ *  does not add to the number of pixels to draw.
+ *  @param area Area to add, in window coordinates.
+ */
+void
+GtkCanvas::add_damage (Rect const & area)
+{
+	/* whole pixels, so that merged rectangles cover exactly what their
+	   parts did.
+	*/
+	Rect r (floor (area.x0), floor (area.y0), ceil (area.x1), ceil (area.y1));
+
+	if (r.width() <= 0 || r.height() <= 0) {
+		return;
+	}
+
+	/* A merged rectangle is no bigger than its parts drawn separately
+	   when they overlap enough, or share an edge. The merged one may now
+	   qualify to merge with rectangles already checked, so start again
+	   after each merge.
+	*/
+
+	vector<Rect>::iterator i = _damage.begin();
+
+	while (i != _damage.end()) {
+		Rect const merged = i->extend (r);
+		if (rect_area (merged) <= rect_area (*i) + rect_area (r)) {
+			r = merged;
+			_damage.erase (i);
+			i = _damage.begin();
+		} else {
+			++i;
+		}
+	}
+
+	_damage.push_back (r);
+
+	if (_damage.size() <= max_damage_rects) {
+		return;
+	}
+
+	/* too many: merge the pair that wastes the fewest pixels */
+
+	size_t best_a = 0;
+	size_t best_b = 1;
+	Distance best_waste = DBL_MAX;
+
+	for (size_t a = 0; a < _damage.size(); ++a) {
+		for (size_t b = a + 1; b < _damage.size(); ++b) {
+			Distance const waste = rect_area (_damage[a].extend (_damage[b])) - rect_area (_damage[a]) - rect_area (_damage[b]);
+			if (waste < best_waste) {
+				best_waste = waste;
+				best_a = a;
+				best_b = b;
+			}
+		}
+	}
+
+	Rect const merged = _damage[best_a].extend (_damage[best_b]);
+	_damage.erase (_damage.begin() + best_b);
+	_damage.erase (_damage.begin() + best_a);
+	add_damage (merged);
+}
+
+/** Send our damage list to the window system */
+void
+GtkCanvas::flush_damage ()
+{
+	for (vector<Rect>::const_iterator i = _damage.begin(); i != _damage.end(); ++i) {
+		queue_draw_area (i->x0, i->y0, i->width(), i->height());
+	}
+
+	_damage.clear ();
+}
+
+bool
+GtkCanvas::frame_due ()
+{
+	_last_frame_time = g_get_monotonic_time ();
+	flush_damage ();
+	return false; /* one-shot */
+}
+
+void
+GtkCanvas::set_frame_rate (uint32_t fps)
+{
+	frame_rate = fps;
 }
 
 /** Called to request that we try to get a particular size for ourselves.
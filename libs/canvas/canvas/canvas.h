@@ -25,6 +25,7 @@
 #define __CANVAS_CANVAS_H__
 
 #include <set>
+#include <vector>
 
 #include <gdkmm/window.h>
 #include <gtkmm/eventbox.h>
@@ -115,6 +116,9 @@ public:
         void scroll_to (Coord x, Coord y);
 	void add_scroller (ScrollGroup& i);
 
+	void add_cached_container (Container&);
+	void remove_cached_container (Container&);
+
         virtual Rect  visible_area () const = 0;
         virtual Coord width () const = 0;
         virtual Coord height () const = 0;
@@ -154,13 +158,20 @@ public:
 	 */
 	static void set_tooltip_timeout (uint32_t msecs);
 
+	void queue_draw_item_area (Item const *, Rect);
+
 protected:
+	/** containers that render from a cached image. Declared before _root
+	 *  so that it outlives the containers, which remove themselves from
+	 *  it as _root is destroyed.
+	 */
+	std::list<Container*> cached_containers;
+
 	Root  _root;
         Color _bg_color;
 
 	static uint32_t tooltip_timeout_msecs;
 
-	void queue_draw_item_area (Item *, Rect);
         virtual void pick_current_item (int state) = 0;
         virtual void pick_current_item (Duple const &, int state) = 0;
 
@@ -194,6 +205,23 @@ public:
 	void start_tooltip_timeout (Item*);
 	void stop_tooltip_timeout ();
 
+	/** Set the maximum rate at which queued redraws are sent to the
+	 *  window system, in frames per second. 0 means that they are sent
+	 *  as soon as the GUI is idle.
+	 */
+	static void set_frame_rate (uint32_t fps);
+
+	/** What was drawn by one expose event */
+	struct FrameStats {
+		FrameStats () : rects (0), pixels (0), items (0) {}
+
+		uint32_t rects;  ///< number of rectangles rendered
+		uint64_t pixels; ///< total area of those rectangles, in pixels
+		uint32_t items;  ///< number of item renders
+	};
+
+	FrameStats const & last_frame_stats () const { return _last_frame_stats; }
+
 protected:
 	void on_size_allocate (Gtk::Allocation&);
 	bool on_scroll_event (GdkEventScroll *);
@@ -231,6 +259,21 @@ private:
 
 	bool _single_exposure;
 
+	/** Areas awaiting redraw, in window coordinates */
+	std::vector<Rect> _damage;
+	/** the most rectangles that _damage is allowed to hold */
+	static const size_t max_damage_rects = 8;
+	void add_damage (Rect const &);
+	void flush_damage ();
+
+	static uint32_t frame_rate;
+	sigc::connection frame_connection;
+	/** time that damage was last flushed, from g_get_monotonic_time() */
+	gint64 _last_frame_time;
+	bool frame_due ();
+
+	FrameStats _last_frame_stats;
+
 	sigc::connection tooltip_timeout_connection;
 	Item* current_tooltip_item;
 	Gtk::Window* tooltip_window;
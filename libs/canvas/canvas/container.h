@@ -20,6 +20,8 @@
 #ifndef __CANVAS_CONTAINER_H__
 #define __CANVAS_CONTAINER_H__
 
+#include <cairomm/surface.h>
+
 #include "canvas/item.h"
 
 namespace ArdourCanvas
@@ -42,6 +44,7 @@ public:
 	Container (Canvas *);
 	Container (Item *);
 	Container (Item *, Duple const & position);
+	~Container ();
 
 	/** The compute_bounding_box() method is likely to be identical
 	 * in all containers (the union of the children's bounding boxes).
@@ -53,6 +56,40 @@ public:
 	 *  (just call Item::render_children()). It can be overridden as necessary.
 	 */
 	void render (Rect const & area, Cairo::RefPtr<Cairo::Context> context) const;
+
+	/** Render our children into an offscreen image, and draw them from
+	 *  that image until something in it changes. This suits containers
+	 *  whose contents rarely change but are often redrawn because of
+	 *  items above or below them (such as a moving playhead). The image
+	 *  covers our visible part of the window. When we scroll or move by
+	 *  whole pixels it is shifted, and only the newly exposed part is
+	 *  rendered; it is rebuilt if we are resized, shown or hidden.
+	 */
+	void set_render_cached (bool);
+	bool render_cached () const { return _render_cached; }
+
+	/** Mark an area of our cached image as out of date.
+	 *  @param area Area in our coordinates.
+	 */
+	void damage_cache (Rect const & area);
+	/** Discard our cached image */
+	void drop_cache ();
+
+private:
+	bool _render_cached;
+	/** cached image of our children, or 0 */
+	mutable Cairo::RefPtr<Cairo::ImageSurface> _cache;
+	/** spare image that _cache is shifted into when we scroll */
+	mutable Cairo::RefPtr<Cairo::ImageSurface> _cache_back;
+	/** area covered by _cache, in window coordinates when it was made */
+	mutable Rect _cache_area;
+	/** window position of our origin when _cache was made */
+	mutable Duple _cache_origin;
+	/** area of _cache that is out of date, in our coordinates */
+	mutable boost::optional<Rect> _cache_damage;
+
+	void scroll_cache (Duple const & origin, Rect const & want) const;
+	void add_cache_damage (Rect const & area) const;
 };
 
 }
@@ -22,11 +22,13 @@
 
 #include <vector>
 #include <boost/multi_array.hpp>
+#include <boost/unordered_map.hpp>
 
 #include "canvas/visibility.h"
 #include "canvas/types.h"
 
 class OptimizingLookupTableTest;
+class DynamicLookupTableTest;
 
 namespace ArdourCanvas {
 
@@ -42,6 +44,16 @@ public:
     virtual std::vector<Item*> items_at_point (Duple const &) const = 0;
     virtual bool has_item_at_point (Duple const & point) const = 0;
 
+    /* Called when a child of our item has been added, removed,
+       changed its bounding box or position, or when the children have
+       been restacked. Return false if the table cannot follow the
+       change, in which case it will be rebuilt from scratch.
+    */
+    virtual bool added (Item *) { return false; }
+    virtual bool removed (Item *) { return false; }
+    virtual bool changed (Item *) { return false; }
+    virtual bool restacked () { return false; }
+
 protected:
 
     Item const & _item;
@@ -55,6 +67,12 @@ public:
     std::vector<Item*> get (Rect const &);
     std::vector<Item*> items_at_point (Duple const &) const;
     bool has_item_at_point (Duple const & point) const;
+
+    /* we look at our item's children afresh every time */
+    bool added (Item *) { return true; }
+    bool removed (Item *) { return true; }
+    bool changed (Item *) { return true; }
+    bool restacked () { return true; }
 };
 
 class LIBCANVAS_API OptimizingLookupTable : public LookupTable
@@ -84,6 +102,84 @@ public:
     bool _added;
 };
 
+/** A lookup table that keeps the bounding boxes of our item's children
+ *  in a balanced tree of bounding boxes (a dynamic bounding volume
+ *  hierarchy), which is updated one child at a time as they change.
+ *  Lookups and updates are O(log n) in the number of children.
+ *
+ *  Changes are only noted as they happen; the affected children are
+ *  re-measured and moved within the tree at the next lookup.
+ */
+class LIBCANVAS_API DynamicLookupTable : public LookupTable
+{
+public:
+    DynamicLookupTable (Item const &);
+
+    std::vector<Item*> get (Rect const &);
+    std::vector<Item*> items_at_point (Duple const &) const;
+    bool has_item_at_point (Duple const & point) const;
+
+    bool added (Item *);
+    bool removed (Item *);
+    bool changed (Item *);
+    bool restacked ();
+
+  private:
+    friend class ::DynamicLookupTableTest;
+
+    struct Node {
+	    /** union of the children's boxes, or the item's bounding box
+	     *  (in our item's coordinates) for a leaf.
+	     */
+	    Rect box;
+	    /** parent node, or the next free node for a free node */
+	    int parent;
+	    int child1;
+	    int child2;
+	    /** 0 for a leaf */
+	    int height;
+	    /** for a leaf, the item and its position in the stack */
+	    Item* item;
+	    uint32_t order;
+
+	    bool is_leaf () const { return child1 == -1; }
+    };
+
+    struct Child {
+	    Child () : leaf (-1), order (0), dirty (true) {}
+
+	    /** leaf node, or -1 if the item has no bounding box */
+	    int leaf;
+	    uint32_t order;
+	    /** true if the item has changed since it was last measured */
+	    bool dirty;
+    };
+
+    typedef boost::unordered_map<Item*, Child> Children;
+
+    /* these are brought up to date by lookups, which may be const */
+    mutable std::vector<Node> _nodes;
+    mutable int _root;
+    mutable int _free_list;
+    mutable Children _children;
+    mutable std::vector<Item*> _dirty;
+    mutable bool _restacked;
+    mutable uint32_t _next_order;
+
+    void mark_dirty (Item *);
+    void update () const;
+    int allocate_node () const;
+    void free_node (int) const;
+    void insert_leaf (int) const;
+    void remove_leaf (int) const;
+    void refit (int) const;
+    int balance (int) const;
+    Coord descent_cost (int, Rect const &) const;
+    void leaves_at (Rect const &, std::vector<int> &) const;
+    void leaves_at (Duple const &, std::vector<int> &) const;
+    std::vector<Item*> stacked (std::vector<int> const &) const;
+};
+
 }
 
 #endif
@@ -18,7 +18,13 @@
 
 */
 
+#include <list>
+#include <queue>
+#include <set>
+#include <vector>
+
 #include <boost/shared_ptr.hpp>
+#include <boost/unordered_map.hpp>
 #include <boost/shared_array.hpp>
 #include <boost/scoped_array.hpp>
 
@@ -45,140 +51,124 @@ class WaveViewTest;
 
 namespace ArdourCanvas {
 
-struct LIBCANVAS_API WaveViewThreadRequest
-{
-  public:
-        enum RequestType {
-	        Quit,
-	        Cancel,
-	        Draw
-        };
-
-	WaveViewThreadRequest  () : stop (0) {}
-
-	bool should_stop () const { return (bool) g_atomic_int_get (const_cast<gint*>(&stop)); }
-	void cancel() { g_atomic_int_set (&stop, 1); }
-
-	RequestType type;
-	framepos_t start;
-	framepos_t end;
-	double     width;
-	double     height;
-	double     samples_per_pixel;
-	uint16_t   channel;
-	double     amplitude;
-	Color      fill_color;
-	boost::weak_ptr<const ARDOUR::Region> region;
-
-	/* resulting image, after request has been satisfied */
-
-	Cairo::RefPtr<Cairo::ImageSurface> image;
-
-  private:
-	gint stop; /* intended for atomic access */
-};
-
-class LIBCANVAS_API WaveView;
-
 class LIBCANVAS_API WaveViewCache
 {
   public:
 	WaveViewCache();
 	~WaveViewCache();
 
-	struct Entry {
-
-		/* these properties define the cache entry as unique.
-
-		   If an image is in use by a WaveView and any of these
-		   properties are modified on the WaveView, the image can no
-		   longer be used (or may no longer be usable for start/end
-		   parameters). It will remain in the cache until flushed for
-		   some reason (typically the cache is full).
-		*/
+	/** The width, in pixels, of every cached image except the last one
+	 * of a source, which may be narrower.
+	 */
+	static const int tile_width = 256;
 
-		int channel;
-		Coord height;
-		float amplitude;
-		Color fill_color;
+	/** Everything that determines the pixels of a tile. Tile @a index
+	 * spans pixels [index * tile_width, (index + 1) * tile_width) of a
+	 * waveform drawn from the very start of @a source, so every region
+	 * using the source can use it.
+	 */
+	struct TileKey {
+		ARDOUR::AudioSource const * source;
+		int64_t index;
 		double samples_per_pixel;
-		framepos_t start;
-		framepos_t end;
-
-		/* the actual image referred to by the cache entry */
+		Coord  height;
+		int    shape;
+		bool   logscaled;
+		float  region_amplitude;
+		double amplitude_above_axis;
+		double gradient_depth;
+		bool   show_zero;
+		Color  fill_color;
+		Color  outline_color;
+		Color  clip_color;
+		Color  zero_color;
+
+		bool operator== (TileKey const & other) const;
+	};
 
-		Cairo::RefPtr<Cairo::ImageSurface> image;
+	struct TileKeyHash {
+		size_t operator() (TileKey const &) const;
+	};
 
-		/* last time the cache entry was used */
-		uint64_t timestamp;
-
-		Entry (int chan, Coord hght, float amp, Color fcl, double spp, framepos_t strt, framepos_t ed,
-		       Cairo::RefPtr<Cairo::ImageSurface> img)
-			: channel (chan)
-			, height (hght)
-			, amplitude (amp)
-			, fill_color (fcl)
-			, samples_per_pixel (spp)
-			, start (strt)
-			, end (ed)
+	struct Tile {
+		Tile (TileKey const & k, boost::shared_ptr<ARDOUR::AudioSource> src, framepos_t e, Cairo::RefPtr<Cairo::ImageSurface> img)
+			: key (k)
+			, source (src)
+			, end (e)
 			, image (img) {}
+
+		TileKey key;
+		/* tiles do not keep their source alive; a tile whose source has
+		   gone is never used again.
+		*/
+		boost::weak_ptr<ARDOUR::AudioSource> source;
+		/* the first source sample after the tile, which is short of a
+		   whole tile at the end of the source.
+		*/
+		framepos_t end;
+		Cairo::RefPtr<Cairo::ImageSurface> image;
 	};
 
 	uint64_t image_cache_threshold () const { return _image_cache_threshold; }
 	void set_image_cache_threshold (uint64_t);
 	void clear_cache ();
 
-	void add (boost::shared_ptr<ARDOUR::AudioSource>, boost::shared_ptr<Entry>);
-	void use (boost::shared_ptr<ARDOUR::AudioSource>, boost::shared_ptr<Entry>);
-
-        void consolidate_image_cache (boost::shared_ptr<ARDOUR::AudioSource>,
-                                      int channel,
-                                      Coord height,
-                                      float amplitude,
-                                      Color fill_color,
-                                      double samples_per_pixel);
-
-        boost::shared_ptr<Entry> lookup_image (boost::shared_ptr<ARDOUR::AudioSource>,
-                                               framepos_t start, framepos_t end,
-                                               int _channel,
-                                               Coord height,
-                                               float amplitude,
-                                               Color fill_color,
-                                               double samples_per_pixel,
-                                               bool& full_image);
+	/* MUST BE CALLED FROM (SINGLE) GUI THREAD */
+
+	void add (boost::shared_ptr<Tile>);
+	boost::shared_ptr<Tile> lookup (TileKey const &);
 
   private:
-        /* an unsorted, unindexd collection of cache entries associated with
-           a particular AudioSource. All cache Entries in the collection
-           share the AudioSource in common, but represent different parameter
-           settings (e.g. height, color, samples per pixel etc.)
-        */
-        typedef std::vector<boost::shared_ptr<Entry> > CacheLine;
-        /* Indexed, non-sortable structure used to lookup images associated
-         * with a particular AudioSource
-         */
-        typedef std::map <boost::shared_ptr<ARDOUR::AudioSource>,CacheLine> ImageCache;
-        ImageCache cache_map;
-
-        /* Linear, sortable structure used when we need to do a timestamp-based
-         * flush of entries from the cache.
-         */
-        typedef std::pair<boost::shared_ptr<ARDOUR::AudioSource>,boost::shared_ptr<Entry> > ListEntry;
-        typedef std::vector<ListEntry> CacheList;
-
-        struct SortByTimestamp {
-	        bool operator() (const WaveViewCache::ListEntry& a, const WaveViewCache::ListEntry& b) {
-		        return a.second->timestamp < b.second->timestamp;
-	        }
+	/* all tiles, most recently used first */
+	typedef std::list<boost::shared_ptr<Tile> > TileList;
+	typedef boost::unordered_map<TileKey, TileList::iterator, TileKeyHash> TileMap;
+
+	TileList tiles;
+	TileMap  tile_map;
+
+	uint64_t image_cache_size;
+	uint64_t _image_cache_threshold;
+
+	void remove (TileMap::iterator);
+	void cache_flush ();
+};
+
+struct LIBCANVAS_API WaveViewThreadRequest
+{
+  public:
+        enum RequestType {
+	        Quit,
+	        Cancel,
+	        Draw
         };
-        friend struct SortByTimestamp;
 
-        uint64_t image_cache_size;
-        uint64_t _image_cache_threshold;
+	WaveViewThreadRequest  () : stop (0), done (0) {}
 
-        uint64_t compute_image_cache_size ();
-        void cache_flush ();
-        bool cache_full ();
+	bool should_stop () const { return (bool) g_atomic_int_get (const_cast<gint*>(&stop)); }
+	void cancel() { g_atomic_int_set (&stop, 1); }
+
+	bool finished () const { return (bool) g_atomic_int_get (const_cast<gint*>(&done)); }
+	void finish () { g_atomic_int_set (&done, 1); }
+
+	RequestType type;
+	/* the tiles to draw, first_tile ... last_tile inclusive; the index
+	   in key is set for each one as it is drawn.
+	*/
+	int64_t    first_tile;
+	int64_t    last_tile;
+	WaveViewCache::TileKey key;
+	uint16_t   channel;
+	boost::weak_ptr<const ARDOUR::Region> region;
+
+	/* resulting tiles, after request has been satisfied. Only
+	   to be used once finished() is true.
+	*/
+
+	std::vector<boost::shared_ptr<WaveViewCache::Tile> > tiles;
+
+  private:
+	gint stop; /* intended for atomic access */
+	gint done; /* intended for atomic access */
 };
 
 class LIBCANVAS_API WaveView : public Item, public sigc::trackable
@@ -208,11 +198,11 @@ public:
 	   when drawing, we will map the zeroth-pixel of the waveview
 	   into a window.
 
-	   The waveview itself contains a set of pre-rendered Cairo::ImageSurfaces
-	   that cache sections of the display. This is filled on-demand and
-	   never cleared until something explicitly marks the cache invalid
-	   (such as a change in samples_per_pixel, the log scaling, rectified or
-	   other view parameters).
+	   The display is made of fixed-width pre-rendered Cairo::ImageSurface
+	   tiles, held in a cache shared by all waveviews. Tiles are rendered
+	   on demand and keyed by the source and every view parameter that
+	   affects their pixels (samples_per_pixel, height, shape, colors
+	   etc.), so changing a parameter just starts using other tiles.
 	*/
 
 	WaveView (Canvas *, boost::shared_ptr<ARDOUR::AudioRegion>);
@@ -275,6 +265,7 @@ public:
 
 	static void start_drawing_thread ();
 	static void stop_drawing_thread ();
+	static void set_drawing_thread_count (uint32_t);
 
 	static void set_image_cache_size (uint64_t);
 
@@ -362,8 +353,8 @@ public:
         void handle_visual_property_change ();
         void handle_clip_level_change ();
 
-        boost::shared_ptr<WaveViewCache::Entry> get_image (framepos_t start, framepos_t end, bool& full_image) const;
-        boost::shared_ptr<WaveViewCache::Entry> get_image_from_cache (framepos_t start, framepos_t end, bool& full_image) const;
+        WaveViewCache::TileKey tile_key () const;
+        boost::shared_ptr<WaveViewCache::Tile> get_tile (WaveViewCache::TileKey const &) const;
 
         struct LineTips {
 	        double top;
@@ -375,37 +366,66 @@ public:
 	        LineTips() : top (0.0), bot (0.0), clip_max (false), clip_min (false) {}
         };
 
-        ArdourCanvas::Coord y_extent (double) const;
-        void compute_tips (ARDOUR::PeakData const & peak, LineTips& tips) const;
-
-        ARDOUR::framecnt_t desired_image_width () const;
+        ArdourCanvas::Coord y_extent (double, ArdourCanvas::Coord height) const;
+        void compute_tips (ARDOUR::PeakData const & peak, LineTips& tips, ArdourCanvas::Coord height) const;
 
         void draw_image (Cairo::RefPtr<Cairo::ImageSurface>&, ARDOUR::PeakData*, int n_peaks, boost::shared_ptr<WaveViewThreadRequest>) const;
-	void draw_absent_image (Cairo::RefPtr<Cairo::ImageSurface>&, ARDOUR::PeakData*, int) const;
+	void draw_absent_image (Cairo::RefPtr<Cairo::ImageSurface>&, ARDOUR::PeakData*, int, ArdourCanvas::Coord height) const;
 
         void cancel_my_render_request () const;
 
-        void queue_get_image (boost::shared_ptr<const ARDOUR::Region> region, framepos_t start, framepos_t end) const;
+        boost::shared_ptr<WaveViewThreadRequest> make_request (int64_t first_tile, int64_t last_tile) const;
+        void queue_get_image (int64_t first_tile, int64_t last_tile, bool urgent) const;
         void generate_image (boost::shared_ptr<WaveViewThreadRequest>, bool in_render_thread) const;
-        boost::shared_ptr<WaveViewCache::Entry> cache_request_result (boost::shared_ptr<WaveViewThreadRequest> req) const;
+        void cache_request_result (boost::shared_ptr<WaveViewThreadRequest> req) const;
 
         void image_ready ();
 
-        mutable boost::shared_ptr<WaveViewCache::Entry> _current_image;
-
 	mutable boost::shared_ptr<WaveViewThreadRequest> current_request;
 
 	static WaveViewCache* images;
 
 	static void drawing_thread ();
+	static void spawn_drawing_threads ();
+
+	/** An entry in the queue of images waiting to be rendered. Requests
+	 * are never removed from the middle of the queue: a cancelled or
+	 * superseded request stays where it is and is dropped by the drawing
+	 * thread that pops it.
+	 */
+	struct DrawingRequest {
+		DrawingRequest (WaveView const * wv, boost::shared_ptr<WaveViewThreadRequest> r, bool u, uint64_t s)
+			: requestor (wv), request (r), urgent (u), serial (s) {}
+
+		WaveView const * requestor;
+		boost::shared_ptr<WaveViewThreadRequest> request;
+		bool     urgent; ///< the view had nothing at all to draw when it asked
+		uint64_t serial; ///< larger for more recent requests
+
+		/* urgent requests first, then the most recent first: older
+		 * requests come from views that have since been scrolled or
+		 * zoomed away from.
+		 */
+		bool operator< (DrawingRequest const & other) const {
+			if (urgent != other.urgent) {
+				return !urgent;
+			}
+			return serial < other.serial;
+		}
+	};
 
         static gint drawing_thread_should_quit;
         static Glib::Threads::Mutex request_queue_lock;
-        static Glib::Threads::Mutex current_image_lock;
         static Glib::Threads::Cond request_cond;
-        static Glib::Threads::Thread* _drawing_thread;
-        typedef std::set<WaveView const *> DrawingRequestQueue;
+        static uint32_t _drawing_thread_count;  ///< requested pool size, 0 for automatic
+        static uint32_t _drawing_threads;       ///< number of drawing threads running
+        static uint64_t _request_serial;
+        typedef std::priority_queue<DrawingRequest> DrawingRequestQueue;
         static DrawingRequestQueue request_queue;
+        /* views whose requests are being drawn right now; a view may have
+           a cancelled request still being drawn alongside its current one.
+        */
+        static std::multiset<WaveView const *> _rendering;
 };
 
 }
@@ -17,30 +17,233 @@
     Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 */
 
+#include <cmath>
+
+#include "canvas/canvas.h"
 #include "canvas/container.h"
 
 using namespace ArdourCanvas;
 
 Container::Container (Canvas* canvas)
 	: Item (canvas)
+	, _render_cached (false)
 {
 }
 
 Container::Container (Item* parent)
 	: Item (parent)
+	, _render_cached (false)
 {
 }
 
 
 Container::Container (Item* parent, Duple const & p)
 	: Item (parent, p)
+	, _render_cached (false)
+{
+}
+
+Container::~Container ()
 {
+	set_render_cached (false);
 }
 
 void
 Container::render (Rect const & area, Cairo::RefPtr<Cairo::Context> context) const
 {
-	Item::render_children (area, context);
+	if (!_render_cached) {
+		Item::render_children (area, context);
+		return;
+	}
+
+	boost::optional<Rect> bbox = bounding_box ();
+
+	if (!bbox) {
+		return;
+	}
+
+	boost::optional<Rect> shown = item_to_window (bbox.get(), false).intersection (_canvas->visible_area ());
+
+	if (!shown) {
+		return;
+	}
+
+	boost::optional<Rect> draw = shown->intersection (area);
+
+	if (!draw || !draw->width() || !draw->height()) {
+		return;
+	}
+
+	/* If we have scrolled or moved, shift the image to match. It is
+	   then only usable if it covers what we are asked to draw. It must
+	   also lie within the window, since changes outside the window are
+	   not reported to us.
+	*/
+
+	Duple const origin = item_to_window (Duple (0, 0), false);
+	Rect const want (floor (shown->x0), floor (shown->y0), ceil (shown->x1), ceil (shown->y1));
+
+	if (_cache && origin != _cache_origin) {
+		scroll_cache (origin, want);
+	}
+
+	if (_cache && (draw->x0 < _cache_area.x0 || draw->y0 < _cache_area.y0 ||
+		       draw->x1 > _cache_area.x1 || draw->y1 > _cache_area.y1 ||
+		       _cache_area.x0 < want.x0 || _cache_area.y0 < want.y0 ||
+		       _cache_area.x1 > want.x1 || _cache_area.y1 > want.y1)) {
+		_cache.clear ();
+	}
+
+	if (!_cache) {
+		_cache_area = want;
+		_cache = Cairo::ImageSurface::create (Cairo::FORMAT_ARGB32, _cache_area.width(), _cache_area.height());
+		_cache_origin = origin;
+		_cache_damage = bbox;
+	}
+
+	if (_cache_damage) {
+
+		/* bring the out of date part of the image up to date. Our
+		 * children render in window coordinates, so shift them into
+		 * the image.
+		 */
+
+		boost::optional<Rect> redo = item_to_window (_cache_damage.get(), false).intersection (_cache_area);
+		_cache_damage = boost::none;
+
+		if (redo) {
+			Rect r (floor (redo->x0), floor (redo->y0), ceil (redo->x1), ceil (redo->y1));
+			Cairo::RefPtr<Cairo::Context> cache_context = Cairo::Context::create (_cache);
+
+			cache_context->translate (-_cache_area.x0, -_cache_area.y0);
+			cache_context->rectangle (r.x0, r.y0, r.width(), r.height());
+			cache_context->clip ();
+			cache_context->set_operator (Cairo::OPERATOR_CLEAR);
+			cache_context->paint ();
+			cache_context->set_operator (Cairo::OPERATOR_OVER);
+
+			Item::render_children (r, cache_context);
+		}
+	}
+
+	context->save ();
+	context->rectangle (draw->x0, draw->y0, draw->width(), draw->height());
+	context->clip ();
+	context->set_source (_cache, _cache_area.x0, _cache_area.y0);
+	context->paint ();
+	context->restore ();
+}
+
+void
+Container::set_render_cached (bool yn)
+{
+	if (yn == _render_cached) {
+		return;
+	}
+
+	_render_cached = yn;
+
+	if (yn) {
+		_canvas->add_cached_container (*this);
+	} else {
+		_canvas->remove_cached_container (*this);
+		drop_cache ();
+	}
+}
+
+/** Move our cached image to follow a scroll or move, so that it shows the
+ *  window area @param want with our origin at @param origin (in window
+ *  coordinates). The part of the old image that is still shown is kept;
+ *  the newly exposed strips are marked out of date. If we moved by a
+ *  fraction of a pixel, nothing can be kept and the image is dropped.
+ */
+void
+Container::scroll_cache (Duple const & origin, Rect const & want) const
+{
+	Duple const delta = origin - _cache_origin;
+
+	if (delta.x != rint (delta.x) || delta.y != rint (delta.y)) {
+		_cache.clear ();
+		return;
+	}
+
+	/* where the old image now lies in the window */
+
+	Rect const moved = _cache_area.translate (delta);
+	boost::optional<Rect> kept = moved.intersection (want);
+
+	if (!kept || !kept->width() || !kept->height()) {
+		_cache.clear ();
+		return;
+	}
+
+	if (!_cache_back || _cache_back->get_width() != want.width() || _cache_back->get_height() != want.height()) {
+		_cache_back = Cairo::ImageSurface::create (Cairo::FORMAT_ARGB32, want.width(), want.height());
+	}
+
+	/* copy rather than shift in place, since cairo does not promise to
+	 * handle a surface overlapping itself.
+	 */
+
+	Cairo::RefPtr<Cairo::Context> back_context = Cairo::Context::create (_cache_back);
+
+	back_context->translate (-want.x0, -want.y0);
+	back_context->rectangle (kept->x0, kept->y0, kept->width(), kept->height());
+	back_context->clip ();
+	back_context->set_operator (Cairo::OPERATOR_SOURCE);
+	back_context->set_source (_cache, moved.x0, moved.y0);
+	back_context->paint ();
+
+	_cache.swap (_cache_back);
+	_cache_area = want;
+	_cache_origin = origin;
+
+	/* the rest of the image is newly exposed; our damage is kept in our
+	 * own coordinates, which the scroll has not changed.
+	 */
+
+	Duple const to_item = -origin;
+
+	if (kept->x0 > want.x0) {
+		add_cache_damage (Rect (want.x0, want.y0, kept->x0, want.y1).translate (to_item));
+	}
+	if (kept->x1 < want.x1) {
+		add_cache_damage (Rect (kept->x1, want.y0, want.x1, want.y1).translate (to_item));
+	}
+	if (kept->y0 > want.y0) {
+		add_cache_damage (Rect (kept->x0, want.y0, kept->x1, kept->y0).translate (to_item));
+	}
+	if (kept->y1 < want.y1) {
+		add_cache_damage (Rect (kept->x0, kept->y1, kept->x1, want.y1).translate (to_item));
+	}
+}
+
+void
+Container::damage_cache (Rect const & area)
+{
+	if (!_cache) {
+		return;
+	}
+
+	add_cache_damage (area);
+}
+
+void
+Container::add_cache_damage (Rect const & area) const
+{
+	if (_cache_damage) {
+		_cache_damage = _cache_damage->extend (area);
+	} else {
+		_cache_damage = area;
+	}
+}
+
+void
+Container::drop_cache ()
+{
+	_cache.clear ();
+	_cache_back.clear ();
+	_cache_damage = boost::none;
 }
 
 void
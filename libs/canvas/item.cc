@@ -271,17 +271,17 @@ Item::set_position (Duple p)
 
 	_position = p;
 
-	/* only update canvas and parent if visible. Otherwise, this
-	   will be done when ::show() is called.
+	/* only update canvas if visible. Otherwise, this will be done
+	   when ::show() is called. The parent is always told, so that its
+	   lookup table knows where we are when we are shown again.
 	*/
 
 	if (visible()) {
 		_canvas->item_moved (this, pre_change_parent_bounding_box);
+	}
 
-
-		if (_parent) {
-			_parent->child_changed ();
-		}
+	if (_parent) {
+		_parent->child_changed (this);
 	}
 }
 
@@ -378,7 +378,7 @@ Item::propagate_show_hide ()
 	/* bounding box may have changed while we were hidden */
 
 	if (_parent) {
-		_parent->child_changed ();
+		_parent->child_changed (this);
 	}
 
 	_canvas->item_shown_or_hidden (this);
@@ -609,7 +609,7 @@ void
 Item::redraw () const
 {
 	if (visible() && _bounding_box && _canvas) {
-		_canvas->request_redraw (item_to_window (_bounding_box.get()));
+		_canvas->queue_draw_item_area (this, _bounding_box.get());
 	}
 }
 
@@ -624,10 +624,14 @@ Item::end_change ()
 {
 	if (visible()) {
 		_canvas->item_changed (this, _pre_change_bounding_box);
+	}
 
-		if (_parent) {
-			_parent->child_changed ();
-		}
+	/* as in ::set_position(), keep our parent's lookup table
+	   up to date even while we are hidden.
+	*/
+
+	if (_parent) {
+		_parent->child_changed (this);
 	}
 }
 
@@ -863,8 +867,18 @@ Item::add (Item* i)
 
 	_items.push_back (i);
 	i->reparent (this);
-	invalidate_lut ();
+	if (_lut && !_lut->added (i)) {
+		invalidate_lut ();
+	}
 	_bounding_box_dirty = true;
+
+	/* our bounding box may have grown, so as in ::remove(), keep our
+	   parent's lookup table up to date.
+	*/
+
+	if (_parent) {
+		_parent->child_changed (this);
+	}
 }
 
 void
@@ -889,7 +903,9 @@ Item::remove (Item* i)
 
 	i->unparent ();
 	_items.remove (i);
-	invalidate_lut ();
+	if (_lut && !_lut->removed (i)) {
+		invalidate_lut ();
+	}
 	_bounding_box_dirty = true;
 
 	end_change ();
@@ -946,7 +962,9 @@ Item::raise_child_to_top (Item* i)
 	_items.remove (i);
 	_items.push_back (i);
 
-	invalidate_lut ();
+	if (_lut && !_lut->restacked ()) {
+		invalidate_lut ();
+	}
         redraw ();
 }
 
@@ -965,7 +983,9 @@ Item::raise_child (Item* i, int levels)
 	}
 
 	_items.insert (j, i);
-	invalidate_lut ();
+	if (_lut && !_lut->restacked ()) {
+		invalidate_lut ();
+	}
         redraw ();
 }
 
@@ -979,7 +999,9 @@ Item::lower_child_to_bottom (Item* i)
 	}
 	_items.remove (i);
 	_items.push_front (i);
-	invalidate_lut ();
+	if (_lut && !_lut->restacked ()) {
+		invalidate_lut ();
+	}
         redraw ();
 }
 
@@ -987,7 +1009,7 @@ void
 Item::ensure_lut () const
 {
 	if (!_lut) {
-		_lut = new DumbLookupTable (*this);
+		_lut = new DynamicLookupTable (*this);
 	}
 }
 
@@ -999,13 +1021,15 @@ Item::invalidate_lut () const
 }
 
 void
-Item::child_changed ()
+Item::child_changed (Item* child)
 {
-	invalidate_lut ();
+	if (_lut && !_lut->changed (child)) {
+		invalidate_lut ();
+	}
 	_bounding_box_dirty = true;
 
 	if (_parent) {
-		_parent->child_changed ();
+		_parent->child_changed (this);
 	}
 }
 
@@ -17,6 +17,8 @@
     Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 */
 
+#include <algorithm>
+
 #include "canvas/item.h"
 #include "canvas/lookup_table.h"
 
@@ -325,3 +327,604 @@ OptimizingLookupTable::get (Rect const & area)
 	return vitems;
 }
 
+
+static inline Coord
+perimeter (Rect const & r)
+{
+	return canvas_safe_add (r.width(), r.height());
+}
+
+static inline bool
+overlaps (Rect const & a, Rect const & b)
+{
+	return a.x0 <= b.x1 && b.x0 <= a.x1 && a.y0 <= b.y1 && b.y0 <= a.y1;
+}
+
+DynamicLookupTable::DynamicLookupTable (Item const & item)
+	: LookupTable (item)
+	, _root (-1)
+	, _free_list (-1)
+	, _restacked (false)
+	, _next_order (0)
+{
+	list<Item*> const & items = _item.items ();
+
+	for (list<Item*>::const_iterator i = items.begin(); i != items.end(); ++i) {
+		added (*i);
+	}
+}
+
+bool
+DynamicLookupTable::added (Item* item)
+{
+	if (_children.find (item) != _children.end()) {
+		/* added twice; start again */
+		removed (item);
+	}
+
+	/* the item may still be under construction, so it is measured
+	 * later, by update().
+	 */
+
+	Child c;
+	c.order = _next_order++;
+	_children[item] = c;
+	mark_dirty (item);
+
+	return true;
+}
+
+bool
+DynamicLookupTable::removed (Item* item)
+{
+	/* the item may be in the middle of deletion, so we must not ask it
+	 * anything.
+	 */
+
+	Children::iterator c = _children.find (item);
+
+	if (c == _children.end()) {
+		return true;
+	}
+
+	if (c->second.leaf != -1) {
+		remove_leaf (c->second.leaf);
+		free_node (c->second.leaf);
+	}
+
+	/* leave any entry in _dirty; update() (or mark_dirty()) will not find it here */
+	_children.erase (c);
+
+	return true;
+}
+
+bool
+DynamicLookupTable::changed (Item* item)
+{
+	Children::iterator c = _children.find (item);
+
+	if (c != _children.end() && !c->second.dirty) {
+		c->second.dirty = true;
+		mark_dirty (item);
+	}
+
+	return true;
+}
+
+bool
+DynamicLookupTable::restacked ()
+{
+	_restacked = true;
+	return true;
+}
+
+/** Note that @a item must be measured again at the next lookup */
+void
+DynamicLookupTable::mark_dirty (Item* item)
+{
+	_dirty.push_back (item);
+
+	/* entries for children that have since been removed (or added again)
+	 * are only dropped by update(), so if there are no lookups for a
+	 * while, rebuild the list from the children that are really dirty.
+	 * That happens at most once per _children.size() additions, so the
+	 * cost is spread over them.
+	 */
+
+	if (_dirty.size() > 2 * _children.size() + 64) {
+		_dirty.clear ();
+		for (Children::const_iterator c = _children.begin(); c != _children.end(); ++c) {
+			if (c->second.dirty) {
+				_dirty.push_back (c->first);
+			}
+		}
+	}
+}
+
+/** Bring the tree up to date with the changes we have been told about */
+void
+DynamicLookupTable::update () const
+{
+	if (_restacked) {
+		list<Item*> const & items = _item.items ();
+		uint32_t n = 0;
+
+		for (list<Item*>::const_iterator i = items.begin(); i != items.end(); ++i, ++n) {
+			Children::iterator c = _children.find (*i);
+			if (c == _children.end()) {
+				continue;
+			}
+			c->second.order = n;
+			if (c->second.leaf != -1) {
+				_nodes[c->second.leaf].order = n;
+			}
+		}
+
+		_next_order = n;
+		_restacked = false;
+	}
+
+	for (vector<Item*>::const_iterator i = _dirty.begin(); i != _dirty.end(); ++i) {
+
+		Children::iterator c = _children.find (*i);
+
+		if (c == _children.end() || !c->second.dirty) {
+			/* removed since, or already measured */
+			continue;
+		}
+
+		c->second.dirty = false;
+
+		boost::optional<Rect> item_bbox = (*i)->bounding_box ();
+
+		if (!item_bbox) {
+			if (c->second.leaf != -1) {
+				remove_leaf (c->second.leaf);
+				free_node (c->second.leaf);
+				c->second.leaf = -1;
+			}
+			continue;
+		}
+
+		Rect const box = (*i)->item_to_parent (item_bbox.get ());
+
+		if (c->second.leaf == -1) {
+			int const leaf = allocate_node ();
+			_nodes[leaf].item = *i;
+			_nodes[leaf].order = c->second.order;
+			_nodes[leaf].box = box;
+			c->second.leaf = leaf;
+			insert_leaf (leaf);
+		} else if (_nodes[c->second.leaf].box != box) {
+			remove_leaf (c->second.leaf);
+			_nodes[c->second.leaf].box = box;
+			insert_leaf (c->second.leaf);
+		}
+	}
+
+	_dirty.clear ();
+}
+
+int
+DynamicLookupTable::allocate_node () const
+{
+	if (_free_list == -1) {
+		_nodes.push_back (Node ());
+		_nodes.back().parent = -1;
+		_free_list = _nodes.size() - 1;
+	}
+
+	int const n = _free_list;
+	Node& node (_nodes[n]);
+
+	_free_list = node.parent;
+
+	node.parent = -1;
+	node.child1 = -1;
+	node.child2 = -1;
+	node.height = 0;
+	node.item = 0;
+	node.order = 0;
+
+	return n;
+}
+
+void
+DynamicLookupTable::free_node (int n) const
+{
+	_nodes[n].parent = _free_list;
+	_nodes[n].item = 0;
+	_free_list = n;
+}
+
+/** @return the cost of pushing a leaf with @param box down into the
+ *  subtree at node @param n, measured as the growth in perimeter.
+ */
+Coord
+DynamicLookupTable::descent_cost (int n, Rect const & box) const
+{
+	Coord cost = perimeter (_nodes[n].box.extend (box));
+
+	if (!_nodes[n].is_leaf()) {
+		cost -= perimeter (_nodes[n].box);
+	}
+
+	return cost;
+}
+
+void
+DynamicLookupTable::insert_leaf (int leaf) const
+{
+	if (_root == -1) {
+		_root = leaf;
+		_nodes[leaf].parent = -1;
+		return;
+	}
+
+	/* find the best sibling for the new leaf: go down the tree for as
+	 * long as that is cheaper than making a new parent here.
+	 */
+
+	Rect const box = _nodes[leaf].box;
+	int index = _root;
+
+	while (!_nodes[index].is_leaf()) {
+
+		Coord const area = perimeter (_nodes[index].box);
+		Coord const combined = perimeter (_nodes[index].box.extend (box));
+
+		/* cost of a new parent for this node and the leaf */
+		Coord const cost = 2 * combined;
+		/* minimum cost of pushing the leaf further down */
+		Coord const inheritance = 2 * (combined - area);
+
+		Coord const cost1 = descent_cost (_nodes[index].child1, box) + inheritance;
+		Coord const cost2 = descent_cost (_nodes[index].child2, box) + inheritance;
+
+		if (cost < cost1 && cost < cost2) {
+			break;
+		}
+
+		index = (cost1 < cost2) ? _nodes[index].child1 : _nodes[index].child2;
+	}
+
+	int const sibling = index;
+	int const old_parent = _nodes[sibling].parent;
+	int const new_parent = allocate_node ();
+
+	_nodes[new_parent].parent = old_parent;
+	_nodes[new_parent].box = _nodes[sibling].box.extend (box);
+	_nodes[new_parent].height = _nodes[sibling].height + 1;
+	_nodes[new_parent].child1 = sibling;
+	_nodes[new_parent].child2 = leaf;
+	_nodes[sibling].parent = new_parent;
+	_nodes[leaf].parent = new_parent;
+
+	if (old_parent == -1) {
+		_root = new_parent;
+	} else if (_nodes[old_parent].child1 == sibling) {
+		_nodes[old_parent].child1 = new_parent;
+	} else {
+		_nodes[old_parent].child2 = new_parent;
+	}
+
+	refit (new_parent);
+}
+
+void
+DynamicLookupTable::remove_leaf (int leaf) const
+{
+	if (leaf == _root) {
+		_root = -1;
+		return;
+	}
+
+	int const parent = _nodes[leaf].parent;
+	int const grand_parent = _nodes[parent].parent;
+	int const sibling = (_nodes[parent].child1 == leaf) ? _nodes[parent].child2 : _nodes[parent].child1;
+
+	/* the sibling takes the place of the parent */
+
+	_nodes[sibling].parent = grand_parent;
+	free_node (parent);
+
+	if (grand_parent == -1) {
+		_root = sibling;
+		return;
+	}
+
+	if (_nodes[grand_parent].child1 == parent) {
+		_nodes[grand_parent].child1 = sibling;
+	} else {
+		_nodes[grand_parent].child2 = sibling;
+	}
+
+	refit (grand_parent);
+}
+
+/** Rebalance and recompute the boxes and heights of node @param index and
+ *  all its ancestors.
+ */
+void
+DynamicLookupTable::refit (int index) const
+{
+	while (index != -1) {
+		index = balance (index);
+
+		Node& node (_nodes[index]);
+		Node const & c1 (_nodes[node.child1]);
+		Node const & c2 (_nodes[node.child2]);
+
+		node.height = 1 + max (c1.height, c2.height);
+		node.box = c1.box.extend (c2.box);
+
+		index = node.parent;
+	}
+}
+
+/** If the subtrees of node @param a differ in height by more than one,
+ *  rotate the taller one up into its place.
+ *  @return the node now at a's position in the tree.
+ */
+int
+DynamicLookupTable::balance (int a) const
+{
+	Node& A (_nodes[a]);
+
+	if (A.is_leaf() || A.height < 2) {
+		return a;
+	}
+
+	int const b = A.child1;
+	int const c = A.child2;
+	Node& B (_nodes[b]);
+	Node& C (_nodes[c]);
+
+	int const imbalance = C.height - B.height;
+
+	if (imbalance > 1) {
+
+		/* rotate C up */
+
+		int const f = C.child1;
+		int const g = C.child2;
+		Node& F (_nodes[f]);
+		Node& G (_nodes[g]);
+
+		C.child1 = a;
+		C.parent = A.parent;
+		A.parent = c;
+
+		if (C.parent == -1) {
+			_root = c;
+		} else if (_nodes[C.parent].child1 == a) {
+			_nodes[C.parent].child1 = c;
+		} else {
+			_nodes[C.parent].child2 = c;
+		}
+
+		if (F.height > G.height) {
+			C.child2 = f;
+			A.child2 = g;
+			G.parent = a;
+			A.box = B.box.extend (G.box);
+			C.box = A.box.extend (F.box);
+			A.height = 1 + max (B.height, G.height);
+			C.height = 1 + max (A.height, F.height);
+		} else {
+			C.child2 = g;
+			A.child2 = f;
+			F.parent = a;
+			A.box = B.box.extend (F.box);
+			C.box = A.box.extend (G.box);
+			A.height = 1 + max (B.height, F.height);
+			C.height = 1 + max (A.height, G.height);
+		}
+
+		return c;
+	}
+
+	if (imbalance < -1) {
+
+		/* rotate B up */
+
+		int const d = B.child1;
+		int const e = B.child2;
+		Node& D (_nodes[d]);
+		Node& E (_nodes[e]);
+
+		B.child1 = a;
+		B.parent = A.parent;
+		A.parent = b;
+
+		if (B.parent == -1) {
+			_root = b;
+		} else if (_nodes[B.parent].child1 == a) {
+			_nodes[B.parent].child1 = b;
+		} else {
+			_nodes[B.parent].child2 = b;
+		}
+
+		if (D.height > E.height) {
+			B.child2 = d;
+			A.child1 = e;
+			E.parent = a;
+			A.box = C.box.extend (E.box);
+			B.box = A.box.extend (D.box);
+			A.height = 1 + max (C.height, E.height);
+			B.height = 1 + max (A.height, D.height);
+		} else {
+			B.child2 = e;
+			A.child1 = d;
+			D.parent = a;
+			A.box = C.box.extend (D.box);
+			B.box = A.box.extend (E.box);
+			A.height = 1 + max (C.height, D.height);
+			B.height = 1 + max (A.height, E.height);
+		}
+
+		return b;
+	}
+
+	return a;
+}
+
+/** Add the leaves whose boxes overlap @param area (in our item's
+ *  coordinates) to @param leaves.
+ */
+void
+DynamicLookupTable::leaves_at (Rect const & area, vector<int>& leaves) const
+{
+	if (_root == -1) {
+		return;
+	}
+
+	vector<int> stack;
+	stack.push_back (_root);
+
+	while (!stack.empty()) {
+		int const n = stack.back ();
+		stack.pop_back ();
+
+		if (!overlaps (_nodes[n].box, area)) {
+			continue;
+		}
+
+		if (_nodes[n].is_leaf()) {
+			leaves.push_back (n);
+		} else {
+			stack.push_back (_nodes[n].child1);
+			stack.push_back (_nodes[n].child2);
+		}
+	}
+}
+
+/** Add the leaves whose boxes contain @param point (in our item's
+ *  coordinates) to @param leaves.
+ */
+void
+DynamicLookupTable::leaves_at (Duple const & point, vector<int>& leaves) const
+{
+	if (_root == -1) {
+		return;
+	}
+
+	vector<int> stack;
+	stack.push_back (_root);
+
+	while (!stack.empty()) {
+		int const n = stack.back ();
+		stack.pop_back ();
+
+		if (!_nodes[n].box.contains (point)) {
+			continue;
+		}
+
+		if (_nodes[n].is_leaf()) {
+			leaves.push_back (n);
+		} else {
+			stack.push_back (_nodes[n].child1);
+			stack.push_back (_nodes[n].child2);
+		}
+	}
+}
+
+/** @return the items of @param leaves, from lowest to highest in the stack */
+vector<Item*>
+DynamicLookupTable::stacked (vector<int> const & leaves) const
+{
+	vector<pair<uint32_t, Item*> > ordered;
+	ordered.reserve (leaves.size());
+
+	for (vector<int>::const_iterator l = leaves.begin(); l != leaves.end(); ++l) {
+		ordered.push_back (make_pair (_nodes[*l].order, _nodes[*l].item));
+	}
+
+	sort (ordered.begin(), ordered.end());
+
+	vector<Item*> vitems;
+	vitems.reserve (ordered.size());
+
+	for (vector<pair<uint32_t, Item*> >::const_iterator o = ordered.begin(); o != ordered.end(); ++o) {
+		vitems.push_back (o->second);
+	}
+
+	return vitems;
+}
+
+/** @param area Area in window coordinates */
+vector<Item*>
+DynamicLookupTable::get (Rect const & area)
+{
+	update ();
+
+	if (_root == -1) {
+		return vector<Item*> ();
+	}
+
+	/* Our children's boxes are in our coordinates, but window
+	 * coordinates are relative to our children's scroll parent, which
+	 * may be us. So convert via one of the children.
+	 */
+
+	Item const * child = _item.items().front();
+	vector<int> leaves;
+
+	leaves_at (child->item_to_parent (child->window_to_item (area)), leaves);
+
+	return stacked (leaves);
+}
+
+vector<Item*>
+DynamicLookupTable::items_at_point (Duple const & point) const
+{
+	/* Point is in window coordinate system */
+
+	update ();
+
+	if (_root == -1) {
+		return vector<Item*> ();
+	}
+
+	Item const * child = _item.items().front();
+	vector<int> leaves;
+
+	leaves_at (child->item_to_parent (child->window_to_item (point)), leaves);
+
+	vector<Item*> candidates = stacked (leaves);
+	vector<Item*> vitems;
+
+	for (vector<Item*>::const_iterator i = candidates.begin(); i != candidates.end(); ++i) {
+		if ((*i)->covers (point)) {
+			vitems.push_back (*i);
+		}
+	}
+
+	return vitems;
+}
+
+bool
+DynamicLookupTable::has_item_at_point (Duple const & point) const
+{
+	/* Point is in window coordinate system */
+
+	update ();
+
+	if (_root == -1) {
+		return false;
+	}
+
+	Item const * child = _item.items().front();
+	vector<int> leaves;
+
+	leaves_at (child->item_to_parent (child->window_to_item (point)), leaves);
+
+	for (vector<int>::const_iterator l = leaves.begin(); l != leaves.end(); ++l) {
+		Item const * item = _nodes[*l].item;
+		if (item->visible() && item->covers (point)) {
+			return true;
+		}
+	}
+
+	return false;
+}
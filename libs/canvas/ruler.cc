@@ -213,14 +213,18 @@ Ruler::render (Rect const & area, Cairo::RefPtr<Cairo::Context> cr) const
 void
 Ruler::set_divide_height (double h)
 {
+	begin_visual_change ();
         _divide_height = h;
+	end_visual_change ();
 }
 
 void
 Ruler::set_divide_colors (Color t, Color b)
 {
+	begin_visual_change ();
         _divider_color_bottom = b;
         _divider_color_top = t;
+	end_visual_change ();
 }
 
 void
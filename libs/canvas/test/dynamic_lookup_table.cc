@@ -0,0 +1,193 @@
+#include <algorithm>
+#include <cstdlib>
+
+#include "canvas/lookup_table.h"
+#include "canvas/types.h"
+#include "canvas/rectangle.h"
+#include "canvas/container.h"
+#include "canvas/canvas.h"
+#include "dynamic_lookup_table.h"
+
+using namespace std;
+using namespace ArdourCanvas;
+
+CPPUNIT_TEST_SUITE_REGISTRATION (DynamicLookupTableTest);
+
+/** A canvas with nowhere to draw, which is all these tests need */
+class TestCanvas : public Canvas
+{
+public:
+	void request_redraw (Rect const &) {}
+	void request_size (Duple) {}
+	void grab (Item *) {}
+	void ungrab () {}
+	void focus (Item *) {}
+	void unfocus (Item *) {}
+
+	Rect visible_area () const { return Rect (0, 0, 1000, 1000); }
+	Coord width () const { return 1000; }
+	Coord height () const { return 1000; }
+
+	bool get_mouse_position (Duple &) const { return false; }
+	void re_enter () {}
+
+protected:
+	void pick_current_item (int) {}
+	void pick_current_item (Duple const &, int) {}
+};
+
+static double
+random_coord (double max)
+{
+	return max * (random () / (double) RAND_MAX);
+}
+
+static Rect
+random_rect ()
+{
+	double const x = random_coord (1000);
+	double const y = random_coord (1000);
+	return Rect (x, y, x + random_coord (50), y + random_coord (50));
+}
+
+/** Make random additions, removals, changes and restacks, and check after
+ *  each lookup that the tree finds the same items, in the same order, as a
+ *  linear search of the children.
+ */
+void
+DynamicLookupTableTest::random_changes ()
+{
+	TestCanvas canvas;
+	Container group (canvas.root ());
+	vector<Rectangle*> all;
+
+	srandom (3);
+
+	for (int i = 0; i < 300; ++i) {
+		Rectangle* r = new Rectangle (&group, random_rect ());
+		r->set_outline_width (0);
+		all.push_back (r);
+	}
+
+	DynamicLookupTable table (group);
+	DumbLookupTable linear (group);
+
+	for (int n = 0; n < 20000; ++n) {
+
+		switch (random () % 6) {
+		case 0:
+			if (!all.empty ()) {
+				int const k = random () % all.size ();
+				table.removed (all[k]);
+				delete all[k];
+				all.erase (all.begin () + k);
+			}
+			break;
+
+		case 1:
+		{
+			Rectangle* r = new Rectangle (&group, random_rect ());
+			r->set_outline_width (0);
+			all.push_back (r);
+			table.added (r);
+			break;
+		}
+
+		case 2:
+			if (!all.empty ()) {
+				Rectangle* r = all[random () % all.size ()];
+				r->set (random_rect ());
+				if (random () % 5 == 0) {
+					if (r->visible ()) {
+						r->hide ();
+					} else {
+						r->show ();
+					}
+				}
+				table.changed (r);
+			}
+			break;
+
+		case 3:
+			if (!all.empty ()) {
+				Rectangle* r = all[random () % all.size ()];
+				if (random () % 2) {
+					r->raise_to_top ();
+				} else {
+					r->lower_to_bottom ();
+				}
+				table.restacked ();
+			}
+			break;
+
+		case 4:
+			if (!all.empty ()) {
+				Rect area = random_rect ();
+				area.x1 += 100;
+				CPPUNIT_ASSERT (table.get (area) == linear.get (area));
+			}
+			break;
+
+		case 5:
+			if (!all.empty ()) {
+				Duple const point (random_coord (1000), random_coord (1000));
+				CPPUNIT_ASSERT (table.items_at_point (point) == linear.items_at_point (point));
+				CPPUNIT_ASSERT (table.has_item_at_point (point) == linear.has_item_at_point (point));
+			}
+			break;
+		}
+	}
+
+	for (vector<Rectangle*>::iterator i = all.begin(); i != all.end(); ++i) {
+		delete *i;
+	}
+}
+
+/** Check that an item added to a child is found from the child's parent,
+ *  whose lookup table must learn that the child has grown.
+ */
+void
+DynamicLookupTableTest::add_to_child ()
+{
+	TestCanvas canvas;
+	Container group (canvas.root ());
+
+	vector<Item const *> items;
+	canvas.root()->add_items_at_point (Duple (5, 5), items);
+	CPPUNIT_ASSERT (find (items.begin (), items.end (), &group) == items.end ());
+
+	Rectangle r (&group, Rect (0, 0, 10, 10));
+
+	items.clear ();
+	canvas.root()->add_items_at_point (Duple (5, 5), items);
+	CPPUNIT_ASSERT (find (items.begin (), items.end (), &group) != items.end ());
+	CPPUNIT_ASSERT (find (items.begin (), items.end (), &r) != items.end ());
+}
+
+/** Check that adding and removing children without any lookups does not
+ *  make the list of children to re-measure grow without limit.
+ */
+void
+DynamicLookupTableTest::dirty_is_bounded ()
+{
+	TestCanvas canvas;
+	Container group (canvas.root ());
+	Rectangle keep (&group, Rect (0, 0, 10, 10));
+
+	DynamicLookupTable table (group);
+
+	for (int n = 0; n < 10000; ++n) {
+		Rectangle* r = new Rectangle (&group, random_rect ());
+		table.added (r);
+		table.changed (&keep);
+		table.removed (r);
+		delete r;
+	}
+
+	/* a couple of entries per child, plus some slack, rather than 20000 */
+	CPPUNIT_ASSERT (table._dirty.size () < 100);
+
+	/* and the tree is still right afterwards */
+	CPPUNIT_ASSERT (table.has_item_at_point (Duple (5, 5)));
+	CPPUNIT_ASSERT (table.items_at_point (Duple (5, 5)).size () == 1);
+}
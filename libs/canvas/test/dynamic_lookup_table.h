@@ -0,0 +1,16 @@
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class DynamicLookupTableTest : public CppUnit::TestFixture
+{
+	CPPUNIT_TEST_SUITE (DynamicLookupTableTest);
+	CPPUNIT_TEST (random_changes);
+	CPPUNIT_TEST (add_to_child);
+	CPPUNIT_TEST (dirty_is_bounded);
+	CPPUNIT_TEST_SUITE_END ();
+
+public:
+	void random_changes ();
+	void add_to_child ();
+	void dirty_is_bounded ();
+};
@@ -21,6 +21,8 @@
 #include <cmath>
 #include <cairomm/cairomm.h>
 
+#include <boost/functional/hash.hpp>
+
 #include <glibmm/threads.h>
 
 #include "gtkmm2ext/utils.h"
@@ -29,6 +31,7 @@
 #include "pbd/base_ui.h"
 #include "pbd/compose.h"
 #include "pbd/convert.h"
+#include "pbd/cpus.h"
 #include "pbd/signals.h"
 #include "pbd/stacktrace.h"
 
@@ -45,8 +48,6 @@
 #include "canvas/utils.h"
 #include "canvas/wave_view.h"
 
-#include "evoral/Range.hpp"
-
 #include <gdkmm/general.h>
 
 #include "gtkmm2ext/gui_thread.h"
@@ -65,10 +66,12 @@ double WaveView::_clip_level = 0.98853;
 WaveViewCache* WaveView::images = 0;
 gint WaveView::drawing_thread_should_quit = 0;
 Glib::Threads::Mutex WaveView::request_queue_lock;
-Glib::Threads::Mutex WaveView::current_image_lock;
 Glib::Threads::Cond WaveView::request_cond;
-Glib::Threads::Thread* WaveView::_drawing_thread = 0;
+uint32_t WaveView::_drawing_thread_count = 0;
+uint32_t WaveView::_drawing_threads = 0;
+uint64_t WaveView::_request_serial = 0;
 WaveView::DrawingRequestQueue WaveView::request_queue;
+std::multiset<WaveView const *> WaveView::_rendering;
 
 PBD::Signal0<void> WaveView::VisualPropertiesChanged;
 PBD::Signal0<void> WaveView::ClipLevelChanged;
@@ -142,8 +145,15 @@ WaveView::WaveView (Item* parent, boost::shared_ptr<ARDOUR::AudioRegion> region)
 WaveView::~WaveView ()
 {
 	invalidate_image_cache ();
-	if (images ) {
-		images->clear_cache ();
+
+	/* a drawing thread may be using us to draw a request right now; wait
+	 * for it to finish, since it does not hold a reference to us.
+	 */
+
+	Glib::Threads::Mutex::Lock lm (request_queue_lock);
+
+	while (_rendering.find (this) != _rendering.end()) {
+		request_cond.wait (request_queue_lock);
 	}
 }
 
@@ -255,6 +265,9 @@ WaveView::set_clip_level (double dB)
 	const double clip_level = dB_to_coefficient (dB);
 	if (clip_level != _clip_level) {
 		_clip_level = clip_level;
+		if (images) {
+			images->clear_cache ();
+		}
 		ClipLevelChanged ();
 	}
 }
@@ -264,14 +277,12 @@ WaveView::invalidate_image_cache ()
 {
         DEBUG_TRACE (DEBUG::WaveView, string_compose ("%1 invalidates image cache and cancels current request\n", this));
 	cancel_my_render_request ();
-	Glib::Threads::Mutex::Lock lci (current_image_lock);
-	_current_image.reset ();
 }
 
 void
-WaveView::compute_tips (PeakData const & peak, WaveView::LineTips& tips) const
+WaveView::compute_tips (PeakData const & peak, WaveView::LineTips& tips, Coord height) const
 {
-	const double effective_height  = _height;
+	const double effective_height  = height;
 
 	/* remember: canvas (and cairo) coordinate space puts the origin at the upper left.
 
@@ -324,29 +335,28 @@ WaveView::compute_tips (PeakData const & peak, WaveView::LineTips& tips) const
 
 
 Coord
-WaveView::y_extent (double s) const
+WaveView::y_extent (double s, Coord height) const
 {
-	assert (_shape == Rectified);
-	return floor ((1.0 - s) * _height);
+	return floor ((1.0 - s) * height);
 }
 
 void
-WaveView::draw_absent_image (Cairo::RefPtr<Cairo::ImageSurface>& image, PeakData* _peaks, int n_peaks) const
+WaveView::draw_absent_image (Cairo::RefPtr<Cairo::ImageSurface>& image, PeakData* _peaks, int n_peaks, Coord height) const
 {
-	Cairo::RefPtr<Cairo::ImageSurface> stripe = Cairo::ImageSurface::create (Cairo::FORMAT_A8, n_peaks, _height);
+	Cairo::RefPtr<Cairo::ImageSurface> stripe = Cairo::ImageSurface::create (Cairo::FORMAT_A8, n_peaks, height);
 
 	Cairo::RefPtr<Cairo::Context> stripe_context = Cairo::Context::create (stripe);
 	stripe_context->set_antialias (Cairo::ANTIALIAS_NONE);
 
 	uint32_t stripe_separation = 150;
-	double start = - floor (_height / stripe_separation) * stripe_separation;
+	double start = - floor (height / stripe_separation) * stripe_separation;
 	int stripe_x = 0;
 
 	while (start < n_peaks) {
 
 		stripe_context->move_to (start, 0);
-		stripe_x = start + _height;
-		stripe_context->line_to (stripe_x, _height);
+		stripe_x = start + height;
+		stripe_context->line_to (stripe_x, height);
 		start += stripe_separation;
 	}
 
@@ -375,13 +385,19 @@ struct ImageSet {
 void
 WaveView::draw_image (Cairo::RefPtr<Cairo::ImageSurface>& image, PeakData* _peaks, int n_peaks, boost::shared_ptr<WaveViewThreadRequest> req) const
 {
+	/* draw with the parameters that the request was made with, which
+	 * its tiles are cached under; ours may have changed since.
+	 */
+
+	const WaveViewCache::TileKey& key (req->key);
+	const Coord height = key.height;
 
 	ImageSet images;
 
-	images.wave = Cairo::ImageSurface::create (Cairo::FORMAT_A8, n_peaks, _height);
-	images.outline = Cairo::ImageSurface::create (Cairo::FORMAT_A8, n_peaks, _height);
-	images.clip = Cairo::ImageSurface::create (Cairo::FORMAT_A8, n_peaks, _height);
-	images.zero = Cairo::ImageSurface::create (Cairo::FORMAT_A8, n_peaks, _height);
+	images.wave = Cairo::ImageSurface::create (Cairo::FORMAT_A8, n_peaks, height);
+	images.outline = Cairo::ImageSurface::create (Cairo::FORMAT_A8, n_peaks, height);
+	images.clip = Cairo::ImageSurface::create (Cairo::FORMAT_A8, n_peaks, height);
+	images.zero = Cairo::ImageSurface::create (Cairo::FORMAT_A8, n_peaks, height);
 
 	Cairo::RefPtr<Cairo::Context> wave_context = Cairo::Context::create (images.wave);
 	Cairo::RefPtr<Cairo::Context> outline_context = Cairo::Context::create (images.outline);
@@ -404,22 +420,22 @@ WaveView::draw_image (Cairo::RefPtr<Cairo::ImageSurface>& image, PeakData* _peak
 	   has been scaled by scale_amplitude() already.
 	*/
 
-	const double clip_level = _clip_level * _region_amplitude;
+	const double clip_level = _clip_level * key.region_amplitude;
 
-	if (_shape == WaveView::Rectified) {
+	if (key.shape == WaveView::Rectified) {
 
 		/* each peak is a line from the bottom of the waveview
 		 * to a point determined by max (_peaks[i].max,
 		 * _peaks[i].min)
 		 */
 
-		if (_logscaled) {
+		if (key.logscaled) {
 			for (int i = 0; i < n_peaks; ++i) {
 
-				tips[i].bot = height() - 1.0;
+				tips[i].bot = height - 1.0;
 				const double p = alt_log_meter (fast_coefficient_to_dB (max (fabs (_peaks[i].max), fabs (_peaks[i].min))));
-				tips[i].top = y_extent (p);
-				tips[i].spread = p * _height;
+				tips[i].top = y_extent (p, height);
+				tips[i].spread = p * height;
 
 				if (_peaks[i].max >= clip_level) {
 					tips[i].clip_max = true;
@@ -433,10 +449,10 @@ WaveView::draw_image (Cairo::RefPtr<Cairo::ImageSurface>& image, PeakData* _peak
 		} else {
 			for (int i = 0; i < n_peaks; ++i) {
 
-				tips[i].bot = height() - 1.0;
+				tips[i].bot = height - 1.0;
 				const double p = max(fabs (_peaks[i].max), fabs (_peaks[i].min));
-				tips[i].top = y_extent (p);
-				tips[i].spread = p * _height;
+				tips[i].top = y_extent (p, height);
+				tips[i].spread = p * height;
 				if (p >= clip_level) {
 					tips[i].clip_max = true;
 				}
@@ -446,7 +462,7 @@ WaveView::draw_image (Cairo::RefPtr<Cairo::ImageSurface>& image, PeakData* _peak
 
 	} else {
 
-		if (_logscaled) {
+		if (key.logscaled) {
 			for (int i = 0; i < n_peaks; ++i) {
 				PeakData p;
 				p.max = _peaks[i].max;
@@ -475,7 +491,7 @@ WaveView::draw_image (Cairo::RefPtr<Cairo::ImageSurface>& image, PeakData* _peak
 					p.min = 0.0;
 				}
 
-				compute_tips (p, tips[i]);
+				compute_tips (p, tips[i], height);
 				tips[i].spread = tips[i].bot - tips[i].top;
 			}
 
@@ -488,7 +504,7 @@ WaveView::draw_image (Cairo::RefPtr<Cairo::ImageSurface>& image, PeakData* _peak
 					tips[i].clip_min = true;
 				}
 
-				compute_tips (_peaks[i], tips[i]);
+				compute_tips (_peaks[i], tips[i], height);
 				tips[i].spread = tips[i].bot - tips[i].top;
 			}
 
@@ -524,7 +540,7 @@ WaveView::draw_image (Cairo::RefPtr<Cairo::ImageSurface>& image, PeakData* _peak
 	 * or 5% of the height of the waveview item.
 	 */
 
-	const double clip_height = min (7.0, ceil (_height * 0.05));
+	const double clip_height = min (7.0, ceil (height * 0.05));
 
 	/* There are 3 possible components to draw at each x-axis position: the
 	   waveform "line", the zero line and an outline/clip indicator.  We
@@ -551,7 +567,7 @@ WaveView::draw_image (Cairo::RefPtr<Cairo::ImageSurface>& image, PeakData* _peak
 	   always draw the clip/outline indicators.
 	*/
 
-	if (_shape == WaveView::Rectified) {
+	if (key.shape == WaveView::Rectified) {
 
 		for (int i = 0; i < n_peaks; ++i) {
 
@@ -580,7 +596,7 @@ WaveView::draw_image (Cairo::RefPtr<Cairo::ImageSurface>& image, PeakData* _peak
 		outline_context->stroke ();
 
 	} else {
-		const int height_zero = floor( _height * .5);
+		const int height_zero = floor( height * .5);
 
 		for (int i = 0; i < n_peaks; ++i) {
 
@@ -609,7 +625,7 @@ WaveView::draw_image (Cairo::RefPtr<Cairo::ImageSurface>& image, PeakData* _peak
 			/* zero line, show only if there is enough spread
 			or the waveform line does not cross zero line */
 
-			if (show_zero_line() && ((tips[i].spread >= 5.0) || (tips[i].top > height_zero ) || (tips[i].bot < height_zero)) ) {
+			if (key.show_zero && ((tips[i].spread >= 5.0) || (tips[i].top > height_zero ) || (tips[i].bot < height_zero)) ) {
 				zero_context->move_to (i, height_zero);
 				zero_context->rel_line_to (1.0, 0);
 			}
@@ -683,15 +699,15 @@ WaveView::draw_image (Cairo::RefPtr<Cairo::ImageSurface>& image, PeakData* _peak
 
 	/* Here we set a source colour and use the various components as a mask. */
 
-	if (gradient_depth() != 0.0) {
+	if (key.gradient_depth != 0.0) {
 
-		Cairo::RefPtr<Cairo::LinearGradient> gradient (Cairo::LinearGradient::create (0, 0, 0, _height));
+		Cairo::RefPtr<Cairo::LinearGradient> gradient (Cairo::LinearGradient::create (0, 0, 0, height));
 
 		double stops[3];
 
 		double r, g, b, a;
 
-		if (_shape == Rectified) {
+		if (key.shape == Rectified) {
 			stops[0] = 0.1;
 			stops[1] = 0.3;
 			stops[2] = 0.9;
@@ -701,13 +717,13 @@ WaveView::draw_image (Cairo::RefPtr<Cairo::ImageSurface>& image, PeakData* _peak
 			stops[2] = 0.9;
 		}
 
-		color_to_rgba (_fill_color, r, g, b, a);
+		color_to_rgba (key.fill_color, r, g, b, a);
 		gradient->add_color_stop_rgba (stops[1], r, g, b, a);
 		/* generate a new color for the middle of the gradient */
 		double h, s, v;
-		color_to_hsv (_fill_color, h, s, v);
+		color_to_hsv (key.fill_color, h, s, v);
 		/* change v towards white */
-		v *= 1.0 - gradient_depth();
+		v *= 1.0 - key.gradient_depth;
 		Color center = hsva_to_color (h, s, v, a);
 		color_to_rgba (center, r, g, b, a);
 
@@ -716,7 +732,7 @@ WaveView::draw_image (Cairo::RefPtr<Cairo::ImageSurface>& image, PeakData* _peak
 
 		context->set_source (gradient);
 	} else {
-		set_source_rgba (context, _fill_color);
+		set_source_rgba (context, key.fill_color);
 	}
 
 	if (req->should_stop()) {
@@ -726,253 +742,161 @@ WaveView::draw_image (Cairo::RefPtr<Cairo::ImageSurface>& image, PeakData* _peak
 	context->mask (images.wave, 0, 0);
 	context->fill ();
 
-	set_source_rgba (context, _outline_color);
+	set_source_rgba (context, key.outline_color);
 	context->mask (images.outline, 0, 0);
 	context->fill ();
 
-	set_source_rgba (context, _clip_color);
+	set_source_rgba (context, key.clip_color);
 	context->mask (images.clip, 0, 0);
 	context->fill ();
 
-	set_source_rgba (context, _zero_color);
+	set_source_rgba (context, key.zero_color);
 	context->mask (images.zero, 0, 0);
 	context->fill ();
 }
 
-boost::shared_ptr<WaveViewCache::Entry>
-WaveView::cache_request_result (boost::shared_ptr<WaveViewThreadRequest> req) const
+/** The first source sample of tile @param index at @param samples_per_pixel */
+static inline framepos_t
+tile_start (int64_t index, double samples_per_pixel)
 {
-	if (!req->image) {
-		cerr << "asked to cache null image!!!\n";
-		return boost::shared_ptr<WaveViewCache::Entry> ();
-	}
-
-	boost::shared_ptr<WaveViewCache::Entry> ret (new WaveViewCache::Entry (req->channel,
-	                                                                       req->height,
-	                                                                       req->amplitude,
-	                                                                       req->fill_color,
-	                                                                       req->samples_per_pixel,
-	                                                                       req->start,
-	                                                                       req->end,
-	                                                                       req->image));
-	images->add (_region->audio_source (_channel), ret);
-
-	/* consolidate cache first (removes fully-contained
-	 * duplicate images)
-	 */
-
-	images->consolidate_image_cache (_region->audio_source (_channel),
-	                                 req->channel, req->height, req->amplitude,
-	                                 req->fill_color, req->samples_per_pixel);
-
-	return ret;
+	return llrint (index * WaveViewCache::tile_width * samples_per_pixel);
 }
 
-boost::shared_ptr<WaveViewCache::Entry>
-WaveView::get_image (framepos_t start, framepos_t end, bool& full_image) const
+WaveViewCache::TileKey
+WaveView::tile_key () const
 {
-	boost::shared_ptr<WaveViewCache::Entry> ret;
-
-	full_image = true;
-
-	/* this is called from a ::render() call, when we need an image to
-	   draw with.
-	*/
-
-	DEBUG_TRACE (DEBUG::WaveView, string_compose ("%1 needs image from %2 .. %3\n", name, start, end));
-
+	WaveViewCache::TileKey key;
+
+	key.source = _region->audio_source (_channel).get();
+	key.index = 0;
+	key.samples_per_pixel = _samples_per_pixel;
+	key.height = _height;
+	key.shape = _shape;
+	key.logscaled = _logscaled;
+	key.region_amplitude = _region_amplitude;
+	key.amplitude_above_axis = _amplitude_above_axis;
+	key.gradient_depth = _gradient_depth;
+	key.show_zero = _show_zero;
+	key.fill_color = _fill_color;
+	key.outline_color = _outline_color;
+	key.clip_color = _clip_color;
+	key.zero_color = _zero_color;
+
+	return key;
+}
 
-	{
-		Glib::Threads::Mutex::Lock lmq (request_queue_lock);
+/** Return the cached tile for @param key, if there is one that is still
+ * up to date.
+ */
+boost::shared_ptr<WaveViewCache::Tile>
+WaveView::get_tile (WaveViewCache::TileKey const & key) const
+{
+	boost::shared_ptr<WaveViewCache::Tile> tile = images->lookup (key);
 
-		/* if there's a draw request outstanding, check to see if we
-		 * have an image there. if so, use it (and put it in the cache
-		 * while we're here.
+	if (tile && tile->end < tile_start (key.index + 1, key.samples_per_pixel)) {
+		/* the last tile of its source: no use if the source has
+		 * grown since (e.g. while recording).
 		 */
-
-                DEBUG_TRACE (DEBUG::WaveView, string_compose ("%1 CR %2 stop? %3 image %4\n", this, current_request,
-                                                              (current_request ? current_request->should_stop() : false),
-                                                              (current_request ? current_request->image : 0)));
-
-		if (current_request && !current_request->should_stop() && current_request->image) {
-
-			/* put the image into the cache so that other
-			 * WaveViews can use it if it is useful
-			 */
-
-			if (current_request->start <= start && current_request->end >= end) {
-
-				ret.reset (new WaveViewCache::Entry (current_request->channel,
-				                                     current_request->height,
-				                                     current_request->amplitude,
-				                                     current_request->fill_color,
-				                                     current_request->samples_per_pixel,
-				                                     current_request->start,
-				                                     current_request->end,
-				                                     current_request->image));
-
-				cache_request_result (current_request);
-				DEBUG_TRACE (DEBUG::WaveView, string_compose ("%1: got image from completed request, spans %2..%3\n",
-				                                              name, current_request->start, current_request->end));
-			}
-
-			/* drop our handle on the current request */
-			current_request.reset ();
-		}
-	}
-
-	if (!ret) {
-
-		/* no current image draw request, so look in the cache */
-
-		ret = get_image_from_cache (start, end, full_image);
-		DEBUG_TRACE (DEBUG::WaveView, string_compose ("%1: lookup from cache gave %2 (full %3)\n",
-		                                              name, ret, full_image));
-
-	}
-
-
-
-	if (!ret || !full_image) {
-
-		if ((rendered && get_image_in_thread) || always_get_image_in_thread) {
-
-			DEBUG_TRACE (DEBUG::WaveView, string_compose ("%1: generating image in caller thread\n", name));
-
-			boost::shared_ptr<WaveViewThreadRequest> req (new WaveViewThreadRequest);
-
-			req->type = WaveViewThreadRequest::Draw;
-			req->start = start;
-			req->end = end;
-			req->samples_per_pixel = _samples_per_pixel;
-			req->region = _region; /* weak ptr, to avoid storing a reference in the request queue */
-			req->channel = _channel;
-			req->height = _height;
-			req->fill_color = _fill_color;
-			req->amplitude = _region_amplitude * _amplitude_above_axis;
-                        req->width = desired_image_width ();
-
-			/* draw image in this (the GUI thread) */
-
-			generate_image (req, false);
-
-			/* cache the result */
-
-			ret = cache_request_result (req);
-
-			/* reset this so that future missing images are
-			 * generated in a a worker thread.
-			 */
-
-			get_image_in_thread = false;
-
-		} else {
-			queue_get_image (_region, start, end);
+		if (_region->audio_source (_channel)->readable_length() > tile->end) {
+			return boost::shared_ptr<WaveViewCache::Tile> ();
 		}
 	}
 
-	if (ret) {
-		DEBUG_TRACE (DEBUG::WaveView, string_compose ("%1 got an image from %2 .. %3 (full ? %4)\n", name, ret->start, ret->end, full_image));
-	} else {
-		DEBUG_TRACE (DEBUG::WaveView, string_compose ("%1 no useful image available\n", name));
-	}
-
-	return ret;
-}
-
-boost::shared_ptr<WaveViewCache::Entry>
-WaveView::get_image_from_cache (framepos_t start, framepos_t end, bool& full) const
-{
-	if (!images) {
-		return boost::shared_ptr<WaveViewCache::Entry>();
-	}
-
-	return images->lookup_image (_region->audio_source (_channel), start, end, _channel,
-	                             _height, _region_amplitude * _amplitude_above_axis, _fill_color, _samples_per_pixel, full);
+	return tile;
 }
 
-framecnt_t
-WaveView::desired_image_width () const
+void
+WaveView::cache_request_result (boost::shared_ptr<WaveViewThreadRequest> req) const
 {
-        /* compute how wide the image should be, in samples.
-         *
-         * We want at least 1 canvas width's worth, but if that
-         * represents less than 1/10th of a second, use 1/10th of
-         * a second instead.
-         */
-
-        framecnt_t canvas_width_samples = _canvas->visible_area().width() * _samples_per_pixel;
-        const framecnt_t one_tenth_of_second = _region->session().frame_rate() / 10;
+	/* put the tiles into the cache, so that other WaveViews can use them
+	 * if they are useful.
+	 */
 
-        if (canvas_width_samples > one_tenth_of_second) {
-                return  canvas_width_samples;
-        }
+	for (vector<boost::shared_ptr<WaveViewCache::Tile> >::const_iterator t = req->tiles.begin(); t != req->tiles.end(); ++t) {
+		images->add (*t);
+	}
 
-        return one_tenth_of_second;
+	DEBUG_TRACE (DEBUG::WaveView, string_compose ("%1: cached %2 tiles from request, spans %3..%4\n",
+	                                              name, req->tiles.size(), req->first_tile, req->last_tile));
 }
 
-void
-WaveView::queue_get_image (boost::shared_ptr<const ARDOUR::Region> region, framepos_t start, framepos_t end) const
+boost::shared_ptr<WaveViewThreadRequest>
+WaveView::make_request (int64_t first_tile, int64_t last_tile) const
 {
 	boost::shared_ptr<WaveViewThreadRequest> req (new WaveViewThreadRequest);
 
 	req->type = WaveViewThreadRequest::Draw;
-	req->start = start;
-	req->end = end;
-	req->samples_per_pixel = _samples_per_pixel;
-	req->region = _region; /* weak ptr, to avoid storing a reference in the request queue */
+	req->first_tile = first_tile;
+	req->last_tile = last_tile;
+	req->key = tile_key ();
 	req->channel = _channel;
-	req->height = _height;
-	req->fill_color = _fill_color;
-	req->amplitude = _region_amplitude * _amplitude_above_axis;
-        req->width = desired_image_width ();
+	req->region = _region; /* weak ptr, to avoid storing a reference in the request queue */
 
-	if (current_request) {
-		/* this will stop rendering in progress (which might otherwise
-		   be long lived) for any current request.
-		*/
-		current_request->cancel ();
-	}
+	return req;
+}
 
-	start_drawing_thread ();
+void
+WaveView::queue_get_image (int64_t first_tile, int64_t last_tile, bool urgent) const
+{
+	boost::shared_ptr<WaveViewThreadRequest> req = make_request (first_tile, last_tile);
 
 	/* swap requests (protected by lock) */
 
 	{
 		Glib::Threads::Mutex::Lock lm (request_queue_lock);
+
+		if (current_request && !current_request->should_stop() && !current_request->finished()
+		    && current_request->first_tile <= first_tile && current_request->last_tile >= last_tile) {
+			/* already on its way. Any change of view parameters
+			 * would have cancelled it.
+			 */
+			return;
+		}
+
+		spawn_drawing_threads ();
+
+		if (current_request) {
+			/* this will stop rendering in progress (which might otherwise
+			   be long lived) for any current request, or make the drawing
+			   threads drop it if it is still queued.
+			*/
+			current_request->cancel ();
+		}
+
 		current_request = req;
 
                 DEBUG_TRACE (DEBUG::WaveView, string_compose ("%1 now has current request %2\n", this, req));
 
-                if (request_queue.insert (this).second) {
-                        /* this waveview was not already in the request queue, make sure we wake
-                           the rendering thread in case it is asleep.
-                        */
-                        request_cond.signal ();
-                }
+                request_queue.push (DrawingRequest (this, req, urgent, ++_request_serial));
+                request_cond.signal ();
 	}
 }
 
 void
 WaveView::generate_image (boost::shared_ptr<WaveViewThreadRequest> req, bool in_render_thread) const
 {
-	if (!req->should_stop()) {
+	boost::shared_ptr<ARDOUR::AudioSource> source = _region->audio_source (req->channel);
 
-		/* sample position is canonical here, and we want to generate
-		 * an image that spans about 3x the canvas width. We get to that
-                 * width by using an image sample count of the screen width added
-                 * on each side of the desired image center.
-		 */
+	/* we can request data from anywhere in the Source, between 0 and its length
+	 */
 
-		const framepos_t center = req->start + ((req->end - req->start) / 2);
-		const framecnt_t image_samples = req->width;
+	const framecnt_t source_length = source->readable_length ();
+	const double spp = req->key.samples_per_pixel;
 
-		/* we can request data from anywhere in the Source, between 0 and its length
-		 */
+	for (int64_t t = req->first_tile; t <= req->last_tile; ++t) {
 
-		framepos_t sample_start = max (_region_start, (center - image_samples));
-		framepos_t sample_end = min (center + image_samples, region_end());
-		const int n_peaks = llrintf ((sample_end - sample_start)/ (req->samples_per_pixel));
+		if (req->should_stop()) {
+			break;
+		}
+
+		const framepos_t sample_start = tile_start (t, spp);
+		const framepos_t sample_end = min (tile_start (t + 1, spp), source_length);
+
+		if (sample_end <= sample_start) {
+			break;
+		}
+
+		const int n_peaks = min ((int) ceil ((sample_end - sample_start) / spp), (int) WaveViewCache::tile_width);
 
 		boost::scoped_array<ARDOUR::PeakData> peaks (new PeakData[n_peaks]);
 
@@ -984,12 +908,9 @@ WaveView::generate_image (boost::shared_ptr<WaveViewThreadRequest> req, bool in_
 		framecnt_t peaks_read = _region->read_peaks (peaks.get(), n_peaks,
 		                                             sample_start, sample_end - sample_start,
 		                                             req->channel,
-		                                             req->samples_per_pixel);
+		                                             spp);
 
-		req->image = Cairo::ImageSurface::create (Cairo::FORMAT_ARGB32, n_peaks, req->height);
-		/* make sure we record the sample positions that were actually used */
-		req->start = sample_start;
-		req->end = sample_end;
+		Cairo::RefPtr<Cairo::ImageSurface> image = Cairo::ImageSurface::create (Cairo::FORMAT_ARGB32, n_peaks, req->key.height);
 
 		if (peaks_read > 0) {
 
@@ -999,41 +920,30 @@ WaveView::generate_image (boost::shared_ptr<WaveViewThreadRequest> req, bool in_
 			 * rendering.
 			 */
 
-			if (_amplitude_above_axis != 1.0) {
+			if (req->key.amplitude_above_axis != 1.0) {
 				for (framecnt_t i = 0; i < n_peaks; ++i) {
-					peaks[i].max *= _amplitude_above_axis;
-					peaks[i].min *= _amplitude_above_axis;
+					peaks[i].max *= req->key.amplitude_above_axis;
+					peaks[i].min *= req->key.amplitude_above_axis;
 				}
 			}
 
-			draw_image (req->image, peaks.get(), n_peaks, req);
+			draw_image (image, peaks.get(), n_peaks, req);
 		} else {
-			draw_absent_image (req->image, peaks.get(), n_peaks);
+			draw_absent_image (image, peaks.get(), n_peaks, req->key.height);
 		}
-	} else {
-		cerr << "Request stopped before image generation\n";
+
+		WaveViewCache::TileKey key (req->key);
+		key.index = t;
+
+		req->tiles.push_back (boost::shared_ptr<WaveViewCache::Tile> (new WaveViewCache::Tile (key, source, sample_end, image)));
 	}
 
+	req->finish ();
+
 	if (in_render_thread && !req->should_stop()) {
-                DEBUG_TRACE (DEBUG::WaveView, string_compose ("done with request for %1 at %2 CR %3 req %4 range %5 .. %6\n", this, g_get_monotonic_time(), current_request, req, req->start, req->end));
+                DEBUG_TRACE (DEBUG::WaveView, string_compose ("done with request for %1 at %2 CR %3 req %4 tiles %5 .. %6\n", this, g_get_monotonic_time(), current_request, req, req->first_tile, req->last_tile));
 		const_cast<WaveView*>(this)->ImageReady (); /* emit signal */
 	}
-
-	return;
-}
-
-/** Given a waveform that starts at window x-coordinate @param wave_origin
- * and the first pixel that we will actually draw @param draw_start, return
- * the offset into an image of the entire waveform that we will need to use.
- *
- * Note: most of our cached images are NOT of the entire waveform, this is just
- * computationally useful when determining which the sample range span for
- * the image we need.
- */
-static inline double
-window_to_image (double wave_origin, double image_start)
-{
-	return image_start - wave_origin;
 }
 
 void
@@ -1067,8 +977,6 @@ WaveView::render (Rect const & area, Cairo::RefPtr<Cairo::Context> context) cons
 
 	Rect self = item_to_window (Rect (0.0, 0.0, region_length() / _samples_per_pixel, _height));
 
-	// cerr << name << " RENDER " << area << " self = " << self << endl;
-
 	/* Now lets get the intersection with the area we've been asked to draw */
 
 	boost::optional<Rect> d = self.intersection (area);
@@ -1088,152 +996,123 @@ WaveView::render (Rect const & area, Cairo::RefPtr<Cairo::Context> context) cons
 	 * draw "between" pixels at the start and/or end.
 	 */
 
-	double draw_start = floor (draw.x0);
+	const double draw_start = floor (draw.x0);
 	const double draw_end = floor (draw.x1);
 
-	// cerr << "Need to draw " << draw_start << " .. " << draw_end << " vs. " << area << " and self = " << self << endl;
+	if (draw_end <= draw_start) {
+		return;
+	}
 
-	/* image coordnates: pixels where x=0 is the start of this waveview,
-	 * wherever it may be positioned. thus image_start=N means "an image
-	 * that begins N pixels after the start of region that this waveview is
-	 * representing.
+	/* tiles are laid out from the first sample of the source, which is
+	 * _region_start samples before the start of this waveview. Round
+	 * that origin to an exact pixel in device space to avoid blurring;
+	 * every tile is then a whole number of pixels from it.
 	 */
 
-	const framepos_t image_start = window_to_image (self.x0, draw_start);
-	const framepos_t image_end = window_to_image (self.x0, draw_end);
+	double origin_x = self.x0 - (_region_start / _samples_per_pixel);
+	double origin_y = self.y0;
+	context->user_to_device (origin_x, origin_y);
+	origin_x = round (origin_x);
+	origin_y = round (origin_y);
+	context->device_to_user (origin_x, origin_y);
 
-	// cerr << "Image/WV space: " << image_start << " .. " << image_end << endl;
+	const int64_t first_tile = max ((int64_t) 0, (int64_t) floor ((draw_start - origin_x) / WaveViewCache::tile_width));
+	const int64_t last_tile = (int64_t) floor ((draw_end - 1.0 - origin_x) / WaveViewCache::tile_width);
 
-	/* sample coordinates - note, these are not subject to rounding error
-	 *
-	 * "sample_start = N" means "the first sample we need to represent is N
-	 * samples after the first sample of the region"
-	 */
+	{
+		Glib::Threads::Mutex::Lock lmq (request_queue_lock);
 
-	framepos_t sample_start = _region_start + (image_start * _samples_per_pixel);
-	framepos_t sample_end   = _region_start + (image_end * _samples_per_pixel);
+		/* if there's a draw request that has finished, put its tiles
+		 * in the cache where we (and other WaveViews) will find them.
+		 */
 
-	// cerr << "Sample space: " << sample_start << " .. " << sample_end << " @ " << _samples_per_pixel << " rs = " << _region_start << endl;
+		if (current_request && current_request->finished()) {
+			if (!current_request->should_stop()) {
+				cache_request_result (current_request);
+			}
+			/* drop our handle on the current request */
+			current_request.reset ();
+		}
+	}
 
-	/* sample_start and sample_end are bounded by the region
-	 * limits. sample_start, because of the was just computed, must already
-	 * be greater than or equal to the _region_start value.
-	 */
+	WaveViewCache::TileKey key = tile_key ();
+	vector<boost::shared_ptr<WaveViewCache::Tile> > tiles;
+	int64_t first_missing = last_tile + 1;
+	int64_t last_missing = first_tile - 1;
 
-	sample_end = min (region_end(), sample_end);
+	for (int64_t t = first_tile; t <= last_tile; ++t) {
+		key.index = t;
+		boost::shared_ptr<WaveViewCache::Tile> tile = get_tile (key);
+		if (tile) {
+			tiles.push_back (tile);
+		} else {
+			first_missing = min (first_missing, t);
+			last_missing = t;
+		}
+	}
 
-	// cerr << debug_name() << " will need image spanning " << sample_start << " .. " << sample_end << " region spans " << _region_start << " .. " << region_end() << endl;
+	if (first_missing <= last_missing) {
 
-	double image_origin_in_self_coordinates;
-	boost::shared_ptr<WaveViewCache::Entry> image_to_draw;
+		if ((rendered && get_image_in_thread) || always_get_image_in_thread) {
 
-	Glib::Threads::Mutex::Lock lci (current_image_lock);
-	if (_current_image) {
+			DEBUG_TRACE (DEBUG::WaveView, string_compose ("%1: generating tiles %2 .. %3 in caller thread\n", name, first_missing, last_missing));
 
-		/* check it covers the right sample range */
+			boost::shared_ptr<WaveViewThreadRequest> req = make_request (first_missing, last_missing);
 
-		if (_current_image->start > sample_start || _current_image->end < sample_end) {
-			/* doesn't cover the area we need ... reset */
-			_current_image.reset ();
-		} else {
-			/* timestamp our continuing use of this image/cache entry */
-			images->use (_region->audio_source (_channel), _current_image);
-			image_to_draw = _current_image;
-		}
-	}
+			/* draw image in this (the GUI thread) */
 
-	if (!image_to_draw) {
+			generate_image (req, false);
 
-		/* look it up */
+			/* cache the result */
 
-		bool full_image;
-		image_to_draw = get_image (sample_start, sample_end, full_image);
+			cache_request_result (req);
+			tiles.insert (tiles.end(), req->tiles.begin(), req->tiles.end());
 
-		DEBUG_TRACE (DEBUG::WaveView, string_compose ("%1 image to draw = %2 (full? %3)\n", name, image_to_draw, full_image));
+			/* reset this so that future missing images are
+			 * generated in a a worker thread.
+			 */
 
-		if (!image_to_draw) {
-			/* image not currently available. A redraw will be scheduled
-			   when it is ready.
-			*/
-			return;
-		}
+			get_image_in_thread = false;
 
-		if (full_image) {
-			/* found an image that covers our entire sample range,
-			 * so keep a reference to it.
+		} else {
+			/* a view with no tiles at all shows an empty
+			 * region, so it goes ahead of views that can at
+			 * least draw part of their waveform meanwhile.
 			 */
-			_current_image = image_to_draw;
+			queue_get_image (first_missing, last_missing, tiles.empty());
 		}
 	}
 
-	/* compute the first pixel of the image that should be used when we
-	 * render the specified range.
-	 */
-
-	image_origin_in_self_coordinates = (image_to_draw->start - _region_start) / _samples_per_pixel;
-
-	if (_start_shift && (sample_start == _region_start) && (self.x0 == draw.x0)) {
-		/* we are going to draw the first pixel for this region, but
-		   we may not want this to overlap a border around the
-		   waveform. If so, _start_shift will be set.
+	if (tiles.empty()) {
+		/* image not currently available. A redraw will be scheduled
+		   when it is ready.
 		*/
-		//cerr << name.substr (23) << " ss = " << sample_start << " rs = " << _region_start << " sf = " << _start_shift << " ds = " << draw_start << " self = " << self << " draw = " << draw << endl;
-		//draw_start += _start_shift;
-		//image_origin_in_self_coordinates += _start_shift;
+		return;
 	}
 
-	/* the image may only be a best-effort ... it may not span the entire
-	 * range requested, though it is guaranteed to cover the start. So
-	 * determine how many pixels we can actually draw.
-	 */
-
-	double draw_width;
+	for (vector<boost::shared_ptr<WaveViewCache::Tile> >::const_iterator t = tiles.begin(); t != tiles.end(); ++t) {
 
-	if (image_to_draw != _current_image) {
-		lci.release ();
+		Cairo::RefPtr<Cairo::ImageSurface> image ((*t)->image);
 
-		/* the image is guaranteed to start at or before
-		 * draw_start. But if it starts before draw_start, that reduces
-		 * the maximum available width we can render with.
-		 *
-		 * so .. clamp the draw width to the smaller of what we need to
-		 * draw or the available width of the image.
+		/* the coordinates specify where in "user coordinates" (i.e. what we
+		 * generally call "canvas coordinates" in this code) the image origin
+		 * will appear. So specifying (10,10) will put the upper left corner of
+		 * the image at (10,10) in user space.
 		 */
 
-		draw_width = min ((double) image_to_draw->image->get_width() - (draw_start - image_to_draw->start),
-		                  (draw_end - draw_start));
+		const double x = origin_x + ((*t)->key.index * WaveViewCache::tile_width);
+		const double x0 = max (draw_start, x);
+		const double x1 = min (draw_end, x + image->get_width());
 
+		if (x1 <= x0) {
+			continue;
+		}
 
-		DEBUG_TRACE (DEBUG::WaveView, string_compose ("%1 draw just %2 of %3 (iwidth %4 off %5 img @ %6 rs @ %7)\n", name, draw_width, (draw_end - draw_start),
-		                                              image_to_draw->image->get_width(), image_origin_in_self_coordinates,
-		                                              image_to_draw->start, _region_start));
-	} else {
-		draw_width = draw_end - draw_start;
-		DEBUG_TRACE (DEBUG::WaveView, string_compose ("use current image, span entire render width %1..%2\n", draw_start, draw_end));
+		context->rectangle (x0, draw.y0, x1 - x0, draw.height());
+		context->set_source (image, x, origin_y);
+		context->fill ();
 	}
 
-	context->rectangle (draw_start, draw.y0, draw_width, draw.height());
-
-	/* round image origin position to an exact pixel in device space to
-	 * avoid blurring
-	 */
-
-	double x  = self.x0 + image_origin_in_self_coordinates;
-	double y  = self.y0;
-	context->user_to_device (x, y);
-	x = round (x);
-	y = round (y);
-	context->device_to_user (x, y);
-
-	/* the coordinates specify where in "user coordinates" (i.e. what we
-	 * generally call "canvas coordinates" in this code) the image origin
-	 * will appear. So specifying (10,10) will put the upper left corner of
-	 * the image at (10,10) in user space.
-	 */
-
-	context->set_source (image_to_draw->image, x, y);
-	context->fill ();
-
 	/* image obtained, some of it painted to display: we are rendered.
 	   Future calls to get_image_in_thread are now meaningful.
 	*/
@@ -1442,6 +1321,9 @@ WaveView::set_global_show_waveform_clipping (bool yn)
 {
 	if (_global_show_waveform_clipping != yn) {
 		_global_show_waveform_clipping = yn;
+		if (images) {
+			images->clear_cache ();
+		}
 		ClipLevelChanged ();
 	}
 }
@@ -1461,25 +1343,22 @@ WaveView::set_start_shift (double pixels)
 void
 WaveView::cancel_my_render_request () const
 {
-	if (!images) {
-		return;
-	}
+	Glib::Threads::Mutex::Lock lm (request_queue_lock);
 
 	/* try to stop any current rendering of the request, or prevent it from
-	 * ever starting up.
+	 * ever starting up. A request that is still queued is left there: the
+	 * drawing thread that pops it will see that it was cancelled and drop
+	 * it, which is cheaper than searching the queue for it here.
 	 */
 
 	if (current_request) {
 		current_request->cancel ();
 	}
 
-	Glib::Threads::Mutex::Lock lm (request_queue_lock);
-
-	/* now remove it from the queue and reset our request pointer so that
-	   have no outstanding request (that we know about)
+	/* now reset our request pointer so that we have no outstanding request
+	   (that we know about)
 	*/
 
-	request_queue.erase (this);
 	current_request.reset ();
         DEBUG_TRACE (DEBUG::WaveView, string_compose ("%1 now has no request %2\n", this));
 
@@ -1497,21 +1376,71 @@ WaveView::set_image_cache_size (uint64_t sz)
 
 /*-------------------------------------------------*/
 
+/** The number of drawing threads wanted for a pool size of @param n,
+ * where 0 means one less than the number of processors, leaving one
+ * for the GUI thread.
+ */
+static uint32_t
+drawing_threads_wanted (uint32_t n)
+{
+	if (n) {
+		return n;
+	}
+
+	const uint32_t cpus = hardware_concurrency ();
+
+	return cpus > 2 ? cpus - 1 : 1;
+}
+
 void
 WaveView::start_drawing_thread ()
 {
-	if (!_drawing_thread) {
-		_drawing_thread = Glib::Threads::Thread::create (sigc::ptr_fun (WaveView::drawing_thread));
-	}
+	Glib::Threads::Mutex::Lock lm (request_queue_lock);
+	spawn_drawing_threads ();
 }
 
 void
 WaveView::stop_drawing_thread ()
 {
-	if (_drawing_thread) {
-		Glib::Threads::Mutex::Lock lm (request_queue_lock);
+	Glib::Threads::Mutex::Lock lm (request_queue_lock);
+	if (_drawing_threads) {
 		g_atomic_int_set (&drawing_thread_should_quit, 1);
-		request_cond.signal ();
+		request_cond.broadcast ();
+	}
+}
+
+/** Set the number of threads used to render waveform images; 0 uses one
+ * less than the number of processors. A running pool grows immediately;
+ * surplus threads exit once they have finished their current image.
+ */
+void
+WaveView::set_drawing_thread_count (uint32_t n)
+{
+	Glib::Threads::Mutex::Lock lm (request_queue_lock);
+
+	_drawing_thread_count = n;
+
+	if (_drawing_threads) {
+		spawn_drawing_threads ();
+		request_cond.broadcast ();
+	}
+}
+
+/** Start drawing threads until the pool has the wanted size.
+ * Must be called with request_queue_lock held.
+ */
+void
+WaveView::spawn_drawing_threads ()
+{
+	if (g_atomic_int_get (&drawing_thread_should_quit)) {
+		return;
+	}
+
+	const uint32_t wanted = drawing_threads_wanted (_drawing_thread_count);
+
+	while (_drawing_threads < wanted) {
+		Glib::Threads::Thread::create (sigc::ptr_fun (WaveView::drawing_thread));
+		++_drawing_threads;
 	}
 }
 
@@ -1520,11 +1449,9 @@ WaveView::drawing_thread ()
 {
 	using namespace Glib::Threads;
 
-	WaveView const * requestor;
 	Mutex::Lock lm (request_queue_lock);
-	bool run = true;
 
-	while (run) {
+	while (true) {
 
 		/* remember that we hold the lock at this point, no matter what */
 
@@ -1532,50 +1459,61 @@ WaveView::drawing_thread ()
 			break;
 		}
 
-		if (request_queue.empty()) {
-			request_cond.wait (request_queue_lock);
+		if (_drawing_threads > drawing_threads_wanted (_drawing_thread_count)) {
+			/* the pool has been made smaller */
+			break;
 		}
 
 		if (request_queue.empty()) {
-			assert (g_atomic_int_get (&drawing_thread_should_quit));
-			continue; // or break;
+			request_cond.wait (request_queue_lock);
+			continue;
 		}
 
-		/* remove the request from the queue (remember: the "request"
-		 * is just a pointer to a WaveView object)
-		 */
-
-		requestor = *(request_queue.begin());
-		request_queue.erase (request_queue.begin());
-
-                DEBUG_TRACE (DEBUG::WaveView, string_compose ("start request for %1 at %2\n", requestor, g_get_monotonic_time()));
+		/* take the most important request from the queue */
 
-		boost::shared_ptr<WaveViewThreadRequest> req = requestor->current_request;
+		boost::shared_ptr<WaveViewThreadRequest> req = request_queue.top().request;
+		WaveView const * requestor = request_queue.top().requestor;
+		request_queue.pop ();
 
-		if (!req) {
+		if (req->should_stop()) {
+			/* cancelled or superseded since it was queued */
 			continue;
 		}
 
+                DEBUG_TRACE (DEBUG::WaveView, string_compose ("start request for %1 at %2\n", requestor, g_get_monotonic_time()));
+
 		/* Generate an image. Unlock the request queue lock
 		 * while we do this, so that other things can happen
-		 * as we do rendering.
+		 * as we do rendering. The requestor cannot be deleted
+		 * while it is in _rendering.
 		 */
 
+		std::multiset<WaveView const *>::iterator rendering = _rendering.insert (requestor);
+
 		request_queue_lock.unlock (); /* some RAII would be good here */
 
 		try {
 			requestor->generate_image (req, true);
 		} catch (...) {
-			req->image.clear(); /* just in case it was set before the exception, whatever it was */
+			/* drop whatever was drawn before the exception, and mark
+			 * the request as done so that the view can ask again
+			 * rather than waiting for it forever.
+			 */
+			req->tiles.clear ();
+			req->cancel ();
+			req->finish ();
 		}
 
 		request_queue_lock.lock ();
 
+		_rendering.erase (rendering);
+		request_cond.broadcast (); /* wake any ~WaveView waiting for us */
+
 		req.reset (); /* drop/delete request as appropriate */
 	}
 
 	/* thread is vanishing */
-	_drawing_thread = 0;
+	--_drawing_threads;
 }
 
 /*-------------------------------------------------*/
@@ -1590,275 +1528,128 @@ WaveViewCache::~WaveViewCache ()
 {
 }
 
-
-boost::shared_ptr<WaveViewCache::Entry>
-WaveViewCache::lookup_image (boost::shared_ptr<ARDOUR::AudioSource> src,
-                             framepos_t start, framepos_t end,
-                             int channel,
-                             Coord height,
-                             float amplitude,
-                             Color fill_color,
-                             double samples_per_pixel,
-                             bool& full_coverage)
+bool
+WaveViewCache::TileKey::operator== (TileKey const & other) const
 {
-	ImageCache::iterator x;
-
-	if ((x = cache_map.find (src)) == cache_map.end ()) {
-		/* nothing in the cache for this audio source at all */
-		return boost::shared_ptr<WaveViewCache::Entry> ();
-	}
-
-	CacheLine& caches = x->second;
-	boost::shared_ptr<Entry> best_partial;
-	framecnt_t max_coverage = 0;
-
-	/* Find a suitable ImageSurface, if it exists.
-	*/
-
-	for (CacheLine::iterator c = caches.begin(); c != caches.end(); ++c) {
-
-		boost::shared_ptr<Entry> e (*c);
-
-		if (channel != e->channel
-		    || height != e->height
-		    || amplitude != e->amplitude
-		    || samples_per_pixel != e->samples_per_pixel
-		    || fill_color != e->fill_color) {
-			continue;
-		}
-
-                switch (Evoral::coverage (start, end, e->start, e->end)) {
-                case Evoral::OverlapExternal:  /* required range is inside image range */
-			DEBUG_TRACE (DEBUG::WaveView, string_compose ("found image spanning %1..%2 covers %3..%4\n",
-			                                              e->start, e->end, start, end));
-			use (src, e);
-                        full_coverage = true;
-                        return e;
-
-                case Evoral::OverlapStart: /* required range start is covered by image range */
-                        if ((e->end - start) > max_coverage) {
-                                best_partial = e;
-                                max_coverage = e->end - start;
-                        }
-                        break;
-
-                case Evoral::OverlapNone:
-                case Evoral::OverlapEnd:
-                case Evoral::OverlapInternal:
-                        break;
-		}
-	}
-
-	if (best_partial) {
-		DEBUG_TRACE (DEBUG::WaveView, string_compose ("found PARTIAL image spanning %1..%2 partially covers %3..%4\n",
-		                                              best_partial->start, best_partial->end, start, end));
-		use (src, best_partial);
-		full_coverage = false;
-		return best_partial;
-	}
+	return source == other.source
+		&& index == other.index
+		&& samples_per_pixel == other.samples_per_pixel
+		&& height == other.height
+		&& shape == other.shape
+		&& logscaled == other.logscaled
+		&& region_amplitude == other.region_amplitude
+		&& amplitude_above_axis == other.amplitude_above_axis
+		&& gradient_depth == other.gradient_depth
+		&& show_zero == other.show_zero
+		&& fill_color == other.fill_color
+		&& outline_color == other.outline_color
+		&& clip_color == other.clip_color
+		&& zero_color == other.zero_color;
+}
 
-	return boost::shared_ptr<Entry> ();
+size_t
+WaveViewCache::TileKeyHash::operator() (TileKey const & key) const
+{
+	size_t seed = 0;
+
+	boost::hash_combine (seed, key.source);
+	boost::hash_combine (seed, key.index);
+	boost::hash_combine (seed, key.samples_per_pixel);
+	boost::hash_combine (seed, key.height);
+	boost::hash_combine (seed, key.shape);
+	boost::hash_combine (seed, key.logscaled);
+	boost::hash_combine (seed, key.region_amplitude);
+	boost::hash_combine (seed, key.amplitude_above_axis);
+	boost::hash_combine (seed, key.gradient_depth);
+	boost::hash_combine (seed, key.show_zero);
+	boost::hash_combine (seed, key.fill_color);
+	boost::hash_combine (seed, key.outline_color);
+	boost::hash_combine (seed, key.clip_color);
+	boost::hash_combine (seed, key.zero_color);
+
+	return seed;
 }
 
-void
-WaveViewCache::consolidate_image_cache (boost::shared_ptr<ARDOUR::AudioSource> src,
-                                        int channel,
-                                        Coord height,
-                                        float amplitude,
-                                        Color fill_color,
-                                        double samples_per_pixel)
+static inline uint64_t
+tile_size (boost::shared_ptr<WaveViewCache::Tile> tile)
 {
-	list <uint32_t> deletion_list;
-	uint32_t other_entries = 0;
-	ImageCache::iterator x;
+	return tile->image->get_height() * tile->image->get_width() * 4; /* 4 = bytes per FORMAT_ARGB32 pixel */
+}
 
-	/* MUST BE CALLED FROM (SINGLE) GUI THREAD */
+boost::shared_ptr<WaveViewCache::Tile>
+WaveViewCache::lookup (TileKey const & key)
+{
+	TileMap::iterator x = tile_map.find (key);
 
-	if ((x = cache_map.find (src)) == cache_map.end ()) {
-		return;
+	if (x == tile_map.end()) {
+		return boost::shared_ptr<Tile> ();
 	}
 
-	CacheLine& caches  = x->second;
-
-	for (CacheLine::iterator c1 = caches.begin(); c1 != caches.end(); ) {
-
-		CacheLine::iterator nxt = c1;
-		++nxt;
-
-		boost::shared_ptr<Entry> e1 (*c1);
-
-		if (channel != e1->channel
-		    || height != e1->height
-		    || amplitude != e1->amplitude
-		    || samples_per_pixel != e1->samples_per_pixel
-		    || fill_color != e1->fill_color) {
-
-			/* doesn't match current properties, ignore and move on
-			 * to the next one.
-			 */
-
-			other_entries++;
-			c1 = nxt;
-			continue;
-		}
-
-		/* c1 now points to a cached image entry that matches current
-		 * properties. Check all subsequent cached imaged entries to
-		 * see if there are others that also match but represent
-		 * subsets of the range covered by this one.
+	if ((*x->second)->source.expired()) {
+		/* the source has gone, and another may since have been
+		 * allocated at the same address.
 		 */
-
-		for (CacheLine::iterator c2 = c1; c2 != caches.end(); ) {
-
-			CacheLine::iterator nxt2 = c2;
-			++nxt2;
-
-			boost::shared_ptr<Entry> e2 (*c2);
-
-			if (e1 == e2 || channel != e2->channel
-			    || height != e2->height
-			    || amplitude != e2->amplitude
-			    || samples_per_pixel != e2->samples_per_pixel
-			    || fill_color != e2->fill_color) {
-
-				/* properties do not match, ignore for the
-				 * purposes of consolidation.
-				 */
-				c2 = nxt2;
-				continue;
-			}
-
-			if (e2->start >= e1->start && e2->end <= e1->end) {
-				/* c2 is fully contained by c1, so delete it */
-				caches.erase (c2);
-
-				/* and re-start the whole iteration */
-				nxt = caches.begin ();
-				break;
-			}
-
-			c2 = nxt2;
-		}
-
-		c1 = nxt;
+		remove (x);
+		return boost::shared_ptr<Tile> ();
 	}
-}
 
-void
-WaveViewCache::use (boost::shared_ptr<ARDOUR::AudioSource> src, boost::shared_ptr<Entry> ce)
-{
-	ce->timestamp = g_get_monotonic_time ();
+	/* most recently used goes to the front */
+	tiles.splice (tiles.begin(), tiles, x->second);
+
+	return tiles.front();
 }
 
 void
-WaveViewCache::add (boost::shared_ptr<ARDOUR::AudioSource> src, boost::shared_ptr<Entry> ce)
+WaveViewCache::add (boost::shared_ptr<Tile> tile)
 {
-	/* MUST BE CALLED FROM (SINGLE) GUI THREAD */
-
-	Cairo::RefPtr<Cairo::ImageSurface> img (ce->image);
+	TileMap::iterator x = tile_map.find (tile->key);
 
-	image_cache_size += img->get_height() * img->get_width () * 4; /* 4 = bytes per FORMAT_ARGB32 pixel */
-
-	if (cache_full()) {
-		cache_flush ();
+	if (x != tile_map.end()) {
+		/* replaces an out of date tile */
+		remove (x);
 	}
 
-	ce->timestamp = g_get_monotonic_time ();
+	tiles.push_front (tile);
+	tile_map.insert (make_pair (tile->key, tiles.begin()));
+	image_cache_size += tile_size (tile);
 
-	cache_map[src].push_back (ce);
+	cache_flush ();
 }
 
-uint64_t
-WaveViewCache::compute_image_cache_size()
+void
+WaveViewCache::remove (TileMap::iterator x)
 {
-	uint64_t total = 0;
-	for (ImageCache::iterator s = cache_map.begin(); s != cache_map.end(); ++s) {
-		CacheLine& per_source_cache (s->second);
-		for (CacheLine::iterator c = per_source_cache.begin(); c != per_source_cache.end(); ++c) {
-			Cairo::RefPtr<Cairo::ImageSurface> img ((*c)->image);
-			total += img->get_height() * img->get_width() * 4; /* 4 = bytes per FORMAT_ARGB32 pixel */
-		}
+	const uint64_t size = tile_size (*x->second);
+
+	if (image_cache_size > size) {
+		image_cache_size -= size;
+	} else {
+		image_cache_size = 0;
 	}
-	return total;
-}
 
-bool
-WaveViewCache::cache_full()
-{
-	return image_cache_size > _image_cache_threshold;
+	tiles.erase (x->second);
+	tile_map.erase (x);
 }
 
 void
 WaveViewCache::cache_flush ()
 {
-	/* Build a sortable list of all cache entries */
-
-	CacheList cache_list;
+	/* remove least recently used tiles until the cache is small enough */
 
-	for (ImageCache::const_iterator cm = cache_map.begin(); cm != cache_map.end(); ++cm) {
-		for (CacheLine::const_iterator cl = cm->second.begin(); cl != cm->second.end(); ++cl) {
-			cache_list.push_back (make_pair (cm->first, *cl));
-		}
+	while (image_cache_size > _image_cache_threshold && !tiles.empty()) {
+		remove (tile_map.find (tiles.back()->key));
 	}
 
-	/* sort list in LRU order */
-	SortByTimestamp sorter;
-	sort (cache_list.begin(), cache_list.end(), sorter);
-
-	while (image_cache_size > _image_cache_threshold && !cache_map.empty() && !cache_list.empty()) {
-
-		ListEntry& le (cache_list.front());
-
-		ImageCache::iterator x;
-
-		if ((x = cache_map.find (le.first)) != cache_map.end ()) {
-
-			CacheLine& cl  = x->second;
-
-			for (CacheLine::iterator c = cl.begin(); c != cl.end(); ++c) {
-
-				if (*c == le.second) {
-
-					DEBUG_TRACE (DEBUG::WaveView, string_compose ("Removing cache line entry for %1\n", x->first->name()));
-
-					/* Remove this entry from this cache line */
-					cl.erase (c);
-
-					if (cl.empty()) {
-						/* remove cache line from main cache: no more entries */
-						cache_map.erase (x);
-					}
-
-					break;
-				}
-			}
-
-			Cairo::RefPtr<Cairo::ImageSurface> img (le.second->image);
-			uint64_t size = img->get_height() * img->get_width() * 4; /* 4 = bytes per FORMAT_ARGB32 pixel */
-
-			if (image_cache_size > size) {
-				image_cache_size -= size;
-			} else {
-				image_cache_size = 0;
-			}
-			DEBUG_TRACE (DEBUG::WaveView, string_compose ("cache shrunk to %1\n", image_cache_size));
-		}
-
-		/* Remove from the linear list, even if we didn't find it in
-		 * the actual cache_mao
-		 */
-		cache_list.erase (cache_list.begin());
-	}
+	DEBUG_TRACE (DEBUG::WaveView, string_compose ("cache size now %1 in %2 tiles\n", image_cache_size, tiles.size()));
 }
 
 void
 WaveViewCache::clear_cache ()
 {
 	DEBUG_TRACE (DEBUG::WaveView, "clear cache\n");
-	const uint64_t image_cache_threshold = _image_cache_threshold;
-	_image_cache_threshold = 0;
-	cache_flush ();
-	_image_cache_threshold = image_cache_threshold;
+	tile_map.clear ();
+	tiles.clear ();
+	image_cache_size = 0;
 }
 
 void
@@ -21,11 +21,13 @@
 
 #include <cassert>
 #include <list>
+#include <vector>
 #include <stdint.h>
 
 #include <boost/pool/pool.hpp>
 #include <boost/pool/pool_alloc.hpp>
 
+#include <glib.h>
 #include <glibmm/threads.h>
 
 #include "pbd/signals.h"
@@ -204,6 +206,27 @@ public:
 		}
 	}
 
+	/** Evaluate the list at @a veclen points, @a dx apart, from @a start.
+	 *  Gives the same values as unlocked_eval() would at each point, but
+	 *  walks the event list only once.
+	 */
+	void unlocked_eval_vector (double start, double dx, float* vec, uint32_t veclen) const;
+
+	/** As unlocked_eval_vector(), but never waits for the lock.
+	 *  @return false, leaving @a vec untouched, if the lock was not taken.
+	 */
+	bool rt_safe_eval_vector (double start, double dx, float* vec, uint32_t veclen) const {
+
+		Glib::Threads::RWLock::ReaderLock lm (_lock, Glib::Threads::TRY_LOCK);
+
+		if (!lm.locked()) {
+			return false;
+		}
+
+		unlocked_eval_vector (start, dx, vec, veclen);
+		return true;
+	}
+
 	static inline bool time_comparator (const ControlEvent* a, const ControlEvent* b) {
 		return a->when < b->when;
 	}
@@ -248,7 +271,12 @@ public:
 	Curve&       curve()       { assert(_curve); return *_curve; }
 	const Curve& curve() const { assert(_curve); return *_curve; }
 
-	void mark_dirty () const;
+	/** Note that the list has changed.  Must be called with the list's lock
+	 *  held.  Unless @a rebuild_points is false, the contiguous copy of the
+	 *  points used for lookups (see Points) is rebuilt here, so it should be
+	 *  false for callers that are about to add many more points.
+	 */
+	void mark_dirty (bool rebuild_points = true) const;
 
 	enum InterpolationStyle {
 		Discrete,
@@ -283,6 +311,29 @@ protected:
 
 	void build_search_cache_if_necessary (double start) const;
 
+	/** Contiguous copies of the events' times and values, and of their
+	 *  positions in the list (plus end()), so that lookups are binary
+	 *  searches over arrays rather than walks along the list.  The list
+	 *  itself stays the store that is edited, since its iterators must
+	 *  survive edits.
+	 *
+	 *  The copies are only used with _points_lock held; readers only ever
+	 *  try to take it, and fall back to the list if they cannot or if the
+	 *  copies are not valid.  They are rebuilt on the writer side, by
+	 *  mark_dirty() and at the end of a freeze or a write pass, and are
+	 *  only invalidated while either of those is going on.
+	 */
+	struct Points {
+		std::vector<double>         when;
+		std::vector<double>         value;
+		std::vector<const_iterator> iter;
+	};
+
+	void maybe_rebuild_points () const;
+	bool points_valid () const { return g_atomic_int_get (&_points_valid); }
+	void invalidate_points () const { g_atomic_int_set (&_points_valid, 0); }
+	double points_eval (double x) const;
+
 	boost::shared_ptr<ControlList> cut_copy_clear (double, double, int op);
 	bool erase_range_internal (double start, double end, EventList &);
 
@@ -297,6 +348,10 @@ protected:
 	mutable LookupCache   _lookup_cache;
 	mutable SearchCache   _search_cache;
 
+	mutable Points               _points;
+	mutable gint                 _points_valid;
+	mutable Glib::Threads::Mutex _points_lock;
+
 	mutable Glib::Threads::RWLock _lock;
 
 	Parameter             _parameter;
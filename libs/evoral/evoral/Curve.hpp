@@ -20,6 +20,7 @@
 #define EVORAL_CURVE_HPP
 
 #include <inttypes.h>
+#include <vector>
 #include <boost/utility.hpp>
 
 #include "evoral/visibility.h"
@@ -42,12 +43,19 @@ public:
 
 private:
 	double unlocked_eval (double where);
-	double multipoint_eval (double x);
 
 	void _get_vector (double x0, double x1, float *arg, int32_t veclen);
+	void eval_block (double x0, double dx, float *vec, int32_t veclen);
 
 	mutable bool       _dirty;
 	const ControlList& _list;
+
+	/* copies of the list's points, and the spline coefficients for the
+	   segment ending at each point, as made by solve()
+	*/
+	std::vector<double> _x;
+	std::vector<double> _y;
+	std::vector<double> _coeff;
 };
 
 } // namespace Evoral
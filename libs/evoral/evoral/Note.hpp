@@ -28,6 +28,8 @@
 
 namespace Evoral {
 
+template<typename Time> class Sequence;
+
 /** An abstract (protocol agnostic) note.
  *
  * Currently a note is defined as (on event, length, off event).
@@ -104,6 +106,16 @@ public:
 	inline const Event<Time>& off_event() const { return _off_event; }
 
 private:
+	template<typename> friend class Sequence;
+
+	/** A note with a time but no MIDI data, which costs no allocations;
+	 *  Sequence uses it as the key to search its time-ordered sets.
+	 */
+	Note(Time time, bool /*time_only*/)
+		: _on_event (0, time)
+		, _off_event (0, time)
+	{}
+
 	// Event buffers are self-contained
 	MIDIEvent<Time> _on_event;
 	MIDIEvent<Time> _off_event;
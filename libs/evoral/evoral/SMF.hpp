@@ -32,10 +32,15 @@ typedef smf_track_struct smf_track_t;
 
 namespace Evoral {
 
+class SMFStream;
+
 #define THROW_FILE_ERROR throw(FileError)
 
 /** Standard Midi File.
  * Currently only tempo-based time of a given PPQN is supported.
+ *
+ * A file opened with open() is read with an SMFStream, straight from a
+ * mapping of the file.  It is only loaded into libsmf once it is written to.
  */
 class LIBEVORAL_API SMF {
 public:
@@ -49,7 +54,7 @@ public:
 		std::string _file_name;
 	};
 
-	SMF() : _smf(0), _smf_track(0), _empty(true) {};
+	SMF() : _smf(0), _smf_track(0), _stream(0), _empty(true) {};
 	virtual ~SMF();
 
 	static bool test(const std::string& path);
@@ -78,6 +83,7 @@ public:
 private:
 	smf_t*       _smf;
 	smf_track_t* _smf_track;
+	SMFStream*   _stream; ///< reader for a file opened with open(), or 0
 	bool         _empty; ///< true iff file contains(non-empty) events
 	mutable Glib::Threads::Mutex _smf_lock;
 };
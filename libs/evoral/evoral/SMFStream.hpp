@@ -0,0 +1,81 @@
+/* This file is part of Evoral.
+ * Copyright (C) 2015 Paul Davis
+ *
+ * Evoral is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * Evoral is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef EVORAL_SMF_STREAM_HPP
+#define EVORAL_SMF_STREAM_HPP
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include <glib.h>
+
+#include "evoral/visibility.h"
+#include "evoral/types.hpp"
+
+namespace Evoral {
+
+/** Streaming reader for a Standard MIDI File.
+ *
+ * The file is memory-mapped and only the chunk headers are looked at when it
+ * is opened.  Events are decoded straight from the mapping one at a time as
+ * read_event() is called, so nothing is allocated per event and the pages of
+ * tracks that are never read are never touched.
+ *
+ * Like SMF, only tempo-based time of a given PPQN is supported.
+ */
+class LIBEVORAL_API SMFStream {
+public:
+	SMFStream ();
+	~SMFStream ();
+
+	static bool test (const std::string& path);
+
+	bool open (const std::string& path);
+	void close ();
+	bool is_open () const { return _map != 0; }
+
+	uint16_t num_tracks () const { return _tracks.size(); }
+	uint16_t ppqn ()       const { return _ppqn; }
+
+	bool seek_to_track (int track);
+	void seek_to_start ();
+	bool track_is_empty () const;
+
+	int read_event (uint32_t* delta_t, uint32_t* size, uint8_t** buf, event_id_t* note_id);
+
+private:
+	struct Chunk {
+		Chunk (const uint8_t* b, const uint8_t* e) : begin (b), end (e) {}
+		const uint8_t* begin;
+		const uint8_t* end;
+	};
+
+	bool parse (const uint8_t* data, size_t length);
+	bool read_vlq (uint32_t* value);
+
+	GMappedFile*       _map;
+	uint16_t           _ppqn;
+	std::vector<Chunk> _tracks;
+	const Chunk*       _track;
+	const uint8_t*     _pos;
+	uint8_t            _running_status;
+};
+
+} /* namespace Evoral */
+
+#endif /* EVORAL_SMF_STREAM_HPP */
@@ -25,6 +25,7 @@
 #include <list>
 #include <utility>
 #include <boost/shared_ptr.hpp>
+#include <boost/unordered_map.hpp>
 #include <glibmm/threads.h>
 
 #include "evoral/visibility.h"
@@ -120,16 +121,19 @@ public:
 		return a->time() < b->time();
 	}
 
+	/* The comparators take the stored pointer type by reference: converting
+	   to a pointer-to-const would copy, and so reference count, both
+	   arguments on every comparison.
+	*/
+
 	struct NoteNumberComparator {
-		inline bool operator()(const boost::shared_ptr< const Note<Time> > a,
-		                       const boost::shared_ptr< const Note<Time> > b) const {
+		inline bool operator()(const NotePtr& a, const NotePtr& b) const {
 			return a->note() < b->note();
 		}
 	};
 
 	struct EarlierNoteComparator {
-		inline bool operator()(const boost::shared_ptr< const Note<Time> > a,
-		                       const boost::shared_ptr< const Note<Time> > b) const {
+		inline bool operator()(const NotePtr& a, const NotePtr& b) const {
 			return a->time() < b->time();
 		}
 	};
@@ -146,8 +150,7 @@ public:
 
 	struct LaterNoteEndComparator {
 		typedef const Note<Time>* value_type;
-		inline bool operator()(const boost::shared_ptr< const Note<Time> > a,
-		                       const boost::shared_ptr< const Note<Time> > b) const {
+		inline bool operator()(const NotePtr& a, const NotePtr& b) const {
 			return a->end_time().to_double() > b->end_time().to_double();
 		}
 	};
@@ -171,6 +174,14 @@ public:
 
 	void get_notes (Notes&, NoteOperator, uint8_t val, int chan_mask = 0) const;
 
+	/** Find a note by ID through a hash index kept alongside _notes, rather
+	 *  than scanning them; the notes themselves stay in the multisets above.
+	 */
+	NotePtr note_by_id (event_id_t) const;
+
+	static NotePtr new_note (uint8_t chan, Time time, Time len, uint8_t note, uint8_t vel);
+	static NotePtr new_note (const Note<Time>& copy);
+
 	void remove_overlapping_notes ();
 	void trim_overlapping_notes ();
 	void remove_duplicate_notes ();
@@ -191,7 +202,7 @@ public:
 	typedef boost::shared_ptr<const Event<Time> > constSysExPtr;
 
 	struct EarlierSysExComparator {
-		inline bool operator() (constSysExPtr a, constSysExPtr b) const {
+		inline bool operator() (const SysExPtr& a, const SysExPtr& b) const {
 			return a->time() < b->time();
 		}
 	};
@@ -204,7 +215,7 @@ public:
 	typedef boost::shared_ptr<const PatchChange<Time> > constPatchChangePtr;
 
 	struct EarlierPatchChangeComparator {
-		inline bool operator() (constPatchChangePtr a, constPatchChangePtr b) const {
+		inline bool operator() (const PatchChangePtr& a, const PatchChangePtr& b) const {
 			return a->time() < b->time();
 		}
 	};
@@ -334,6 +345,8 @@ protected:
 private:
 	friend class const_iterator;
 
+	typedef boost::unordered_multimap<event_id_t, NotePtr> NoteIDs;
+
 	bool overlaps_unlocked (const NotePtr& ev, const NotePtr& ignore_this_note) const;
 	bool contains_unlocked (const NotePtr& ev) const;
 
@@ -346,10 +359,15 @@ private:
 	void get_notes_by_pitch (Notes&, NoteOperator, uint8_t val, int chan_mask = 0) const;
 	void get_notes_by_velocity (Notes&, NoteOperator, uint8_t val, int chan_mask = 0) const;
 
+	void index_note_unlocked (const NotePtr&);
+	void erase_note_unlocked (typename Notes::iterator);
+	void update_note_range_unlocked ();
+
 	const TypeMap& _type_map;
 
 	Notes        _notes;       // notes indexed by time
 	Pitches      _pitches[16]; // notes indexed by channel+pitch
+	NoteIDs      _note_ids;    // notes indexed by ID, for undo/redo lookups
 	SysExes      _sysexes;
 	PatchChanges _patch_changes;
 
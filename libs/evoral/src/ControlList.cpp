@@ -27,6 +27,7 @@
 #define isnan_local std::isnan
 #endif
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <iostream>
@@ -51,7 +52,8 @@ inline bool event_time_less_than (ControlEvent* a, ControlEvent* b)
 }
 
 ControlList::ControlList (const Parameter& id, const ParameterDescriptor& desc)
-	: _parameter(id)
+	: _points_valid(0)
+	, _parameter(id)
 	, _desc(desc)
 	, _curve(0)
 {
@@ -75,7 +77,8 @@ ControlList::ControlList (const Parameter& id, const ParameterDescriptor& desc)
 }
 
 ControlList::ControlList (const ControlList& other)
-	: _parameter(other._parameter)
+	: _points_valid(0)
+	, _parameter(other._parameter)
 	, _desc(other._desc)
 	, _interpolation(other._interpolation)
 	, _curve(0)
@@ -101,7 +104,8 @@ ControlList::ControlList (const ControlList& other)
 }
 
 ControlList::ControlList (const ControlList& other, double start, double end)
-	: _parameter(other._parameter)
+	: _points_valid(0)
+	, _parameter(other._parameter)
 	, _desc(other._desc)
 	, _interpolation(other._interpolation)
 	, _curve(0)
@@ -115,6 +119,7 @@ ControlList::ControlList (const ControlList& other, double start, double end)
 	_lookup_cache.range.second = _events.end();
 	_search_cache.first = _events.end();
 	_sort_pending = false;
+	_in_write_pass = false;
 
 	/* now grab the relevant points, and shift them back if necessary */
 
@@ -125,7 +130,6 @@ ControlList::ControlList (const ControlList& other, double start, double end)
 	}
 
 	new_write_pass = false;
-	_in_write_pass = false;
 	did_write_during_pass = false;
 	insert_position = -1;
 	most_recent_insert_iterator = _events.end();
@@ -332,7 +336,8 @@ ControlList::fast_simple_add (double when, double value)
 	/* to be used only for loading pre-sorted data from saved state */
 	_events.insert (_events.end(), new ControlEvent (when, value));
 
-	mark_dirty ();
+	/* more points are probably on their way, so don't copy them all each time */
+	mark_dirty (false);
 }
 
 void
@@ -378,6 +383,11 @@ ControlList::write_pass_finished (double /*when*/, double thinning_factor)
 	}
 	new_write_pass = true;
 	_in_write_pass = false;
+
+	{
+		Glib::Threads::RWLock::ReaderLock lm (_lock);
+		maybe_rebuild_points ();
+	}
 }
 
 void
@@ -390,6 +400,11 @@ ControlList::set_in_write_pass (bool yn, bool add_point, double when)
 	if (yn && add_point) {
 		add_guard_point (when);
 	}
+
+	if (!yn) {
+		Glib::Threads::RWLock::ReaderLock lm (_lock);
+		maybe_rebuild_points ();
+	}
 }
 
 void
@@ -440,6 +455,8 @@ ControlList::add_guard_point (double when)
 		++most_recent_insert_iterator;
 	}
 
+	invalidate_points ();
+
 	/* don't do this again till the next write pass */
 
 	new_write_pass = false;
@@ -918,11 +935,15 @@ ControlList::thaw ()
 			unlocked_invalidate_insert_iterator ();
 			_sort_pending = false;
 		}
+
+		if (!points_valid ()) {
+			maybe_rebuild_points ();
+		}
 	}
 }
 
 void
-ControlList::mark_dirty () const
+ControlList::mark_dirty (bool rebuild_points) const
 {
 	_lookup_cache.left = -1;
 	_lookup_cache.range.first = _events.end();
@@ -930,6 +951,12 @@ ControlList::mark_dirty () const
 	_search_cache.left = -1;
 	_search_cache.first = _events.end();
 
+	if (rebuild_points) {
+		maybe_rebuild_points ();
+	} else {
+		invalidate_points ();
+	}
+
 	if (_curve) {
 		_curve->mark_dirty();
 	}
@@ -1198,6 +1225,117 @@ ControlList::unlocked_eval (double x) const
 	return _default_value;
 }
 
+void
+ControlList::unlocked_eval_vector (double start, double dx, float* vec, uint32_t veclen) const
+{
+	if (_events.empty()) {
+		std::fill (vec, vec + veclen, (float) _default_value);
+		return;
+	}
+
+	const double first = _events.front()->when;
+	const double last  = _events.back()->when;
+
+	Glib::Threads::Mutex::Lock pl (_points_lock, Glib::Threads::TRY_LOCK);
+
+	if (pl.locked() && points_valid ()) {
+
+		const double* when  = &_points.when[0];
+		const double* value = &_points.value[0];
+		const size_t  n_points = _points.when.size();
+
+		uint32_t n = 0;
+
+		while (n < veclen && start + n * dx <= first) {
+			vec[n++] = value[0];
+		}
+
+		/* i is the first point after the sample at n; fill the run of
+		   samples before it with a loop that the compiler can vectorize.
+		*/
+		size_t i = std::upper_bound (when, when + n_points, start + n * dx) - when;
+
+		while (n < veclen) {
+
+			if (i >= n_points) {
+				/* at or after the last point */
+				for (; n < veclen; ++n) {
+					vec[n] = value[n_points - 1];
+				}
+				break;
+			}
+
+			uint32_t end = n;
+			if (dx > 0) {
+				/* estimate, then correct for rounding */
+				const double e = ceil ((when[i] - start) / dx);
+				end = (e >= veclen) ? veclen : ((e <= n) ? n : (uint32_t) e);
+				while (end > n && start + (end - 1) * dx >= when[i]) {
+					--end;
+				}
+				while (end < veclen && start + end * dx < when[i]) {
+					++end;
+				}
+			} else {
+				end = veclen;
+			}
+
+			const double lval = value[i - 1];
+			const double vdelta = value[i] - value[i - 1];
+
+			if (_interpolation == Discrete || vdelta == 0.0) {
+				for (; n < end; ++n) {
+					vec[n] = lval;
+				}
+			} else {
+				const double lx = when[i - 1];
+				const double trange = when[i] - when[i - 1];
+				for (; n < end; ++n) {
+					vec[n] = lval + (((start + n * dx) - lx) / trange) * vdelta;
+				}
+			}
+
+			++i;
+		}
+
+		return;
+	}
+
+	/* i is the first point at or after x, which only ever moves forwards */
+	const_iterator i = _events.begin();
+
+	for (uint32_t n = 0; n < veclen; ++n) {
+		const double x = start + n * dx;
+
+		if (x <= first) {
+			vec[n] = _events.front()->value;
+			continue;
+		} else if (x >= last) {
+			vec[n] = _events.back()->value;
+			continue;
+		}
+
+		while ((*i)->when < x) {
+			++i;
+		}
+
+		if ((*i)->when == x) {
+			vec[n] = (*i)->value;
+			continue;
+		}
+
+		const_iterator l = i;
+		--l;
+
+		if (_interpolation == Discrete) {
+			vec[n] = (*l)->value;
+		} else {
+			const double fraction = (x - (*l)->when) / ((*i)->when - (*l)->when);
+			vec[n] = (*l)->value + (fraction * ((*i)->value - (*l)->value));
+		}
+	}
+}
+
 double
 ControlList::multipoint_eval (double x) const
 {
@@ -1205,6 +1343,14 @@ ControlList::multipoint_eval (double x) const
 	double uval, lval;
 	double fraction;
 
+	{
+		Glib::Threads::Mutex::Lock pl (_points_lock, Glib::Threads::TRY_LOCK);
+
+		if (pl.locked() && points_valid ()) {
+			return points_eval (x);
+		}
+	}
+
 	/* "Stepped" lookup (no interpolation) */
 	/* FIXME: no cache.  significant? */
 	if (_interpolation == Discrete) {
@@ -1272,6 +1418,68 @@ ControlList::multipoint_eval (double x) const
 	return (*range.first)->value;
 }
 
+/** Copy the list into _points, unless it is about to change again (or is
+ *  not sorted) because of a freeze or a write pass, in which case just
+ *  mark _points as invalid.  Must be called with the list's lock held (for
+ *  reading at least), and never from a realtime thread, since it may wait
+ *  for _points_lock and allocate.
+ */
+void
+ControlList::maybe_rebuild_points () const
+{
+	if (_frozen || _sort_pending || _in_write_pass) {
+		invalidate_points ();
+		return;
+	}
+
+	Glib::Threads::Mutex::Lock pl (_points_lock);
+
+	const size_t n = _events.size ();
+
+	_points.when.resize (n);
+	_points.value.resize (n);
+	_points.iter.resize (n + 1);
+
+	size_t k = 0;
+	for (const_iterator i = _events.begin(); i != _events.end(); ++i, ++k) {
+		_points.when[k]  = (*i)->when;
+		_points.value[k] = (*i)->value;
+		_points.iter[k]  = i;
+	}
+	_points.iter[n] = _events.end();
+
+	g_atomic_int_set (&_points_valid, 1);
+}
+
+/** multipoint_eval() using _points: x lies within the list, which has at
+ *  least three points.
+ */
+double
+ControlList::points_eval (double x) const
+{
+	const std::vector<double>& when (_points.when);
+	const std::vector<double>& value (_points.value);
+	const size_t i = std::lower_bound (when.begin(), when.end(), x) - when.begin();
+
+	if (i == when.size()) {
+		/* we're after the last point */
+		return value.back();
+	}
+
+	if (i == 0 || when[i] == x) {
+		/* before the first point, or x is a control point in the data */
+		return value[i];
+	}
+
+	if (_interpolation == Discrete) {
+		return value[i - 1];
+	}
+
+	/* linear interpolation betweeen the two points on either side of x */
+	const double fraction = (x - when[i - 1]) / (when[i] - when[i - 1]);
+	return value[i - 1] + (fraction * (value[i] - value[i - 1]));
+}
+
 void
 ControlList::build_search_cache_if_necessary (double start) const
 {
@@ -1283,9 +1491,16 @@ ControlList::build_search_cache_if_necessary (double start) const
 	} else if ((_search_cache.left < 0) || (_search_cache.left > start)) {
 		/* Marked dirty (left < 0), or we're too far forward, re-search. */
 
-		const ControlEvent start_point (start, 0);
+		Glib::Threads::Mutex::Lock pl (_points_lock, Glib::Threads::TRY_LOCK);
+
+		if (pl.locked() && points_valid ()) {
+			const size_t i = std::lower_bound (_points.when.begin(), _points.when.end(), start) - _points.when.begin();
+			_search_cache.first = _points.iter[i];
+		} else {
+			const ControlEvent start_point (start, 0);
+			_search_cache.first = lower_bound (_events.begin(), _events.end(), &start_point, time_comparator);
+		}
 
-		_search_cache.first = lower_bound (_events.begin(), _events.end(), &start_point, time_comparator);
 		_search_cache.left = start;
 	}
 
@@ -16,6 +16,7 @@
  * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
  */
 
+#include <algorithm>
 #include <iostream>
 #include <float.h>
 #include <cmath>
@@ -60,6 +61,8 @@ Curve::solve ()
 		vector<double> x(npoints);
 		vector<double> y(npoints);
 		uint32_t i;
+
+		_coeff.assign (4 * npoints, 0.0);
 		ControlList::EventList::const_iterator xx;
 
 		for (i = 0, xx = _list.events().begin(); xx != _list.events().end(); ++xx, ++i) {
@@ -160,9 +163,13 @@ Curve::solve ()
 			(*xx)->coeff[2] = c;
 			(*xx)->coeff[3] = d;
 
+			std::copy ((*xx)->coeff, (*xx)->coeff + 4, &_coeff[4 * i]);
+
 			fplast = fpi;
 		}
 
+		_x.swap (x);
+		_y.swap (y);
 	}
 
 	_dirty = false;
@@ -191,7 +198,7 @@ Curve::get_vector (double x0, double x1, float *vec, int32_t veclen)
 void
 Curve::_get_vector (double x0, double x1, float *vec, int32_t veclen)
 {
-	double rx, lx, hx, max_x, min_x;
+	double lx, hx, max_x, min_x;
 	int32_t i;
 	int32_t original_veclen;
 	int32_t npoints;
@@ -316,103 +323,114 @@ Curve::_get_vector (double x0, double x1, float *vec, int32_t veclen)
 		solve ();
 	}
 
-	rx = lx;
-
 	double dx = 0;
 	if (veclen > 1) {
 		dx = (hx - lx) / (veclen - 1);
 	}
 
-	for (i = 0; i < veclen; ++i, rx += dx) {
-		vec[i] = multipoint_eval (rx);
-	}
+	eval_block (lx, dx, vec, veclen);
 }
 
-double
-Curve::unlocked_eval (double x)
+/** @return the index of the first of the samples x0 + n * dx (k <= n < veclen)
+ *  that is at or after @a limit, or veclen if there is none.
+ */
+static inline int32_t
+run_end (double x0, double dx, int32_t k, int32_t veclen, double limit)
 {
-	// I don't see the point of this...
-
-	if (_dirty) {
-		solve ();
+	if (dx <= 0) {
+		return (x0 < limit) ? veclen : k;
 	}
 
-	return _list.unlocked_eval (x);
-}
+	/* estimate, then correct for rounding */
+	const double e = ceil ((limit - x0) / dx);
+	int32_t end = (e >= veclen) ? veclen : ((e <= k) ? k : (int32_t) e);
 
-double
-Curve::multipoint_eval (double x)
-{
-	pair<ControlList::EventList::const_iterator,ControlList::EventList::const_iterator> range;
-
-	ControlList::LookupCache& lookup_cache = _list.lookup_cache();
-
-	if ((lookup_cache.left < 0) ||
-	    ((lookup_cache.left > x) ||
-	     (lookup_cache.range.first == _list.events().end()) ||
-	     ((*lookup_cache.range.second)->when < x))) {
-
-		ControlEvent cp (x, 0.0);
-
-		lookup_cache.range = equal_range (_list.events().begin(), _list.events().end(), &cp, ControlList::time_comparator);
+	while (end > k && x0 + (end - 1) * dx >= limit) {
+		--end;
+	}
+	while (end < veclen && x0 + end * dx < limit) {
+		++end;
 	}
 
-	range = lookup_cache.range;
-
-	/* EITHER
-
-	   a) x is an existing control point, so first == existing point, second == next point
-
-	   OR
-
-	   b) x is between control points, so range is empty (first == second, points to where
-	       to insert x)
-
-	*/
-
-	if (range.first == range.second) {
+	return end;
+}
 
-		/* x does not exist within the list as a control point */
+/** Fill @a vec with the values of the curve at x0, x0 + dx, ...; x0 must be
+ *  at or after the first point, and the list must have more than 2 points.
+ *
+ *  Rather than looking up the segment for each sample, this finds the run
+ *  of samples that fall within each segment and fills it with a loop that
+ *  has no branches, which the compiler can vectorize.
+ */
+void
+Curve::eval_block (double x0, double dx, float *vec, int32_t veclen)
+{
+	const double* x = &_x[0];
+	const double* y = &_y[0];
+	const int32_t npoints = _x.size();
+	const bool curved = (_list.interpolation() == ControlList::Curved);
+
+	/* j is the last point at or before the sample at k */
+	int32_t j = max ((int32_t) (upper_bound (x, x + npoints, x0) - x) - 1, 0);
+	int32_t k = 0;
+
+	while (k < veclen) {
+
+		if (j >= npoints - 1) {
+			/* at or after the last point */
+			const float v = y[npoints - 1];
+			for (int32_t n = k; n < veclen; ++n) {
+				vec[n] = v;
+			}
+			return;
+		}
 
-		lookup_cache.left = x;
+		const int32_t end = run_end (x0, dx, k, veclen, x[j+1]);
+		const double vdelta = y[j+1] - y[j];
 
-		if (range.first == _list.events().begin()) {
-			/* we're before the first point */
-			// return default_value;
-			return _list.events().front()->value;
+		if (vdelta == 0.0) {
+			const float v = y[j];
+			for (int32_t n = k; n < end; ++n) {
+				vec[n] = v;
+			}
+		} else if (curved) {
+			const double c0 = _coeff[4 * (j+1)];
+			const double c1 = _coeff[4 * (j+1) + 1];
+			const double c2 = _coeff[4 * (j+1) + 2];
+			const double c3 = _coeff[4 * (j+1) + 3];
+			for (int32_t n = k; n < end; ++n) {
+				const double rx = x0 + n * dx;
+				vec[n] = c0 + rx * (c1 + rx * (c2 + rx * c3));
+			}
+		} else {
+			const double before = y[j];
+			const double xbefore = x[j];
+			const double trange = x[j+1] - x[j];
+			for (int32_t n = k; n < end; ++n) {
+				vec[n] = before + (vdelta * (((x0 + n * dx) - xbefore) / trange));
+			}
 		}
 
-		if (range.second == _list.events().end()) {
-			/* we're after the last point */
-			return _list.events().back()->value;
+		if (end > k && x0 + k * dx == x[j]) {
+			/* the run starts on a control point */
+			vec[k] = y[j];
 		}
 
-		ControlEvent* after = (*range.second);
-		range.second--;
-		ControlEvent* before = (*range.second);
-
-		double vdelta = after->value - before->value;
-
-		if (vdelta == 0.0) {
-			return before->value;
-		}
+		k = end;
+		++j;
+	}
+}
 
-		double tdelta = x - before->when;
-		double trange = after->when - before->when;
+double
+Curve::unlocked_eval (double x)
+{
+	// I don't see the point of this...
 
-		if (_list.interpolation() == ControlList::Curved && after->coeff) {
-				ControlEvent* ev = after;
-				double x2 = x * x;
-				return ev->coeff[0] + (ev->coeff[1] * x) + (ev->coeff[2] * x2) + (ev->coeff[3] * x2 * x);
-		} else {
-			return before->value + (vdelta * (tdelta / trange));
-		}
+	if (_dirty) {
+		solve ();
 	}
 
-	/* x is a control point in the data */
-	/* invalidate the cached range because its not usable */
-	lookup_cache.left = -1;
-	return (*range.first)->value;
+	return _list.unlocked_eval (x);
 }
 
 } // namespace Evoral
@@ -25,6 +25,7 @@
 #include "libsmf/smf.h"
 #include "evoral/Event.hpp"
 #include "evoral/SMF.hpp"
+#include "evoral/SMFStream.hpp"
 #include "evoral/midi_util.h"
 
 #ifdef COMPILER_MSVC
@@ -44,6 +45,9 @@ uint16_t
 SMF::num_tracks() const
 {
 	Glib::Threads::Mutex::Lock lm (_smf_lock);
+	if (_stream) {
+		return _stream->num_tracks();
+	}
 	return _smf ? _smf->number_of_tracks : 0;
 }
 
@@ -51,6 +55,9 @@ uint16_t
 SMF::ppqn() const
 {
 	Glib::Threads::Mutex::Lock lm (_smf_lock);
+	if (_stream) {
+		return _stream->ppqn();
+	}
 	return _smf->ppqn;
 }
 
@@ -61,6 +68,9 @@ int
 SMF::seek_to_track(int track)
 {
 	Glib::Threads::Mutex::Lock lm (_smf_lock);
+	if (_stream) {
+		return _stream->seek_to_track(track) ? 0 : -1;
+	}
 	_smf_track = smf_get_track_by_number(_smf, track);
 	if (_smf_track != NULL) {
 		_smf_track->next_event_number = (_smf_track->number_of_events == 0) ? 0 : 1;
@@ -78,21 +88,13 @@ SMF::seek_to_track(int track)
 bool
 SMF::test(const std::string& path)
 {
-	FILE* f = fopen(path.c_str(), "r");
-	if (f == 0) {
-		return false;
-	}
-
-	smf_t* test_smf = smf_load(f);
-	fclose(f);
-
-	const bool success = (test_smf != NULL);
-	smf_delete(test_smf);
-
-	return success;
+	return SMFStream::test(path);
 }
 
 /** Attempt to open the SMF file for reading and/or writing.
+ *
+ * The file is not parsed here; events are decoded from a mapping of it as
+ * they are read.
  *
  * \return  0 on success
  *         -1 if the file can not be opened or created
@@ -106,29 +108,26 @@ SMF::open(const std::string& path, int track) THROW_FILE_ERROR
 	assert(track >= 1);
 	if (_smf) {
 		smf_delete(_smf);
+		_smf = 0;
+		_smf_track = 0;
 	}
 
-	FILE* f = fopen(path.c_str(), "r");
-	if (f == 0) {
-		return -1;
-	} else if ((_smf = smf_load(f)) == 0) {
-		fclose(f);
+	if (!_stream) {
+		_stream = new SMFStream;
+	}
+
+	if (!_stream->open(path)) {
+		delete _stream;
+		_stream = 0;
 		return -1;
-	} else if ((_smf_track = smf_get_track_by_number(_smf, track)) == 0) {
-		fclose(f);
+	} else if (!_stream->seek_to_track(track)) {
+		delete _stream;
+		_stream = 0;
 		return -2;
 	}
 
-	//cerr << "Track " << track << " # events: " << _smf_track->number_of_events << endl;
-	if (_smf_track->number_of_events == 0) {
-		_smf_track->next_event_number = 0;
-		_empty = true;
-	} else {
-		_smf_track->next_event_number = 1;
-		_empty = false;
-	}
+	_empty = _stream->track_is_empty();
 
-	fclose(f);
 	return 0;
 }
 
@@ -149,6 +148,9 @@ SMF::create(const std::string& path, int track, uint16_t ppqn) THROW_FILE_ERROR
 		smf_delete(_smf);
 	}
 
+	delete _stream;
+	_stream = 0;
+
 	_smf = smf_new();
 
 	if (_smf == NULL) {
@@ -203,13 +205,18 @@ SMF::close() THROW_FILE_ERROR
 		_smf = 0;
 		_smf_track = 0;
 	}
+
+	delete _stream;
+	_stream = 0;
 }
 
 void
 SMF::seek_to_start() const
 {
 	Glib::Threads::Mutex::Lock lm (_smf_lock);
-	if (_smf_track) {
+	if (_stream) {
+		_stream->seek_to_start();
+	} else if (_smf_track) {
 		_smf_track->next_event_number = std::min(_smf_track->number_of_events, (size_t)1);
 	} else {
 		cerr << "WARNING: SMF seek_to_start() with no track" << endl;
@@ -239,13 +246,20 @@ SMF::read_event(uint32_t* delta_t, uint32_t* size, uint8_t** buf, event_id_t* no
 	Glib::Threads::Mutex::Lock lm (_smf_lock);
 
 	smf_event_t* event;
+	int          event_size;
 
 	assert(delta_t);
 	assert(size);
 	assert(buf);
 	assert(note_id);
 
-	if ((event = smf_track_get_next_event(_smf_track)) != NULL) {
+	if (_stream) {
+
+		if ((event_size = _stream->read_event(delta_t, size, buf, note_id)) <= 0) {
+			return event_size; /* meta-event or end of track */
+		}
+
+	} else if ((event = smf_track_get_next_event(_smf_track)) != NULL) {
 
 		*delta_t = event->delta_time_pulses;
 
@@ -274,7 +288,7 @@ SMF::read_event(uint32_t* delta_t, uint32_t* size, uint8_t** buf, event_id_t* no
 			return 0; /* this is a meta-event */
 		}
 
-		int event_size = event->midi_buffer_length;
+		event_size = event->midi_buffer_length;
 		assert(event_size > 0);
 
 		// Make sure we have enough scratch buffer
@@ -283,27 +297,29 @@ SMF::read_event(uint32_t* delta_t, uint32_t* size, uint8_t** buf, event_id_t* no
 		}
 		memcpy(*buf, event->midi_buffer, size_t(event_size));
 		*size = event_size;
-		if (((*buf)[0] & 0xF0) == 0x90 && (*buf)[2] == 0) {
-			/* normalize note on with velocity 0 to proper note off */
-			(*buf)[0] = 0x80 | ((*buf)[0] & 0x0F);  /* note off */
-			(*buf)[2] = 0x40;  /* default velocity */
-		}
 
-		if (!midi_event_is_valid(*buf, *size)) {
-			cerr << "WARNING: SMF ignoring illegal MIDI event" << endl;
-			*size = 0;
-			return -1;
-		}
+	} else {
+		return -1;
+	}
 
-		/* printf("SMF::read_event @ %u: ", *delta_t);
-		   for (size_t i = 0; i < *size; ++i) {
-		   printf("%X ", (*buf)[i]);
-		   } printf("\n") */
+	if (((*buf)[0] & 0xF0) == 0x90 && (*buf)[2] == 0) {
+		/* normalize note on with velocity 0 to proper note off */
+		(*buf)[0] = 0x80 | ((*buf)[0] & 0x0F);  /* note off */
+		(*buf)[2] = 0x40;  /* default velocity */
+	}
 
-		return event_size;
-	} else {
+	if (!midi_event_is_valid(*buf, *size)) {
+		cerr << "WARNING: SMF ignoring illegal MIDI event" << endl;
+		*size = 0;
 		return -1;
 	}
+
+	/* printf("SMF::read_event @ %u: ", *delta_t);
+	   for (size_t i = 0; i < *size; ++i) {
+	   printf("%X ", (*buf)[i]);
+	   } printf("\n") */
+
+	return event_size;
 }
 
 void
@@ -386,8 +402,20 @@ SMF::begin_write()
 {
 	Glib::Threads::Mutex::Lock lm (_smf_lock);
 
-	assert(_smf_track);
-	smf_track_delete(_smf_track);
+	if (_stream) {
+		/* Opened for reading only so far: start an in-memory copy to
+		   write to, and drop the mapping before end_write() rewrites
+		   the file underneath it.
+		*/
+		_smf = smf_new();
+		assert(_smf);
+		smf_set_ppqn(_smf, _stream->ppqn());
+		delete _stream;
+		_stream = 0;
+	} else {
+		assert(_smf_track);
+		smf_track_delete(_smf_track);
+	}
 
 	_smf_track = smf_track_new();
 	assert(_smf_track);
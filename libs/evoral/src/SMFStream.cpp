@@ -0,0 +1,341 @@
+/* This file is part of Evoral.
+ * Copyright (C) 2015 Paul Davis
+ *
+ * Evoral is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * Evoral is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include "evoral/SMFStream.hpp"
+#include "evoral/midi_util.h"
+
+using namespace std;
+
+namespace Evoral {
+
+static inline uint32_t
+read_be32 (const uint8_t* p)
+{
+	return (uint32_t (p[0]) << 24) | (uint32_t (p[1]) << 16) | (uint32_t (p[2]) << 8) | uint32_t (p[3]);
+}
+
+static inline uint16_t
+read_be16 (const uint8_t* p)
+{
+	return (uint16_t (p[0]) << 8) | uint16_t (p[1]);
+}
+
+/** Decode a variable length quantity from [*pos, end), advancing *pos past it.
+ * \return false if the quantity runs past \a end or is longer than 4 bytes.
+ */
+static bool
+decode_vlq (const uint8_t** pos, const uint8_t* end, uint32_t* value)
+{
+	const uint8_t* p = *pos;
+	uint32_t       v = 0;
+
+	for (int n = 0; n < 4; ++n) {
+		if (p == end) {
+			return false;
+		}
+		const uint8_t c = *p++;
+		v = (v << 7) | (c & 0x7f);
+		if (!(c & 0x80)) {
+			*pos   = p;
+			*value = v;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+SMFStream::SMFStream ()
+	: _map (0)
+	, _ppqn (0)
+	, _track (0)
+	, _pos (0)
+	, _running_status (0)
+{
+}
+
+SMFStream::~SMFStream ()
+{
+	close ();
+}
+
+/** Check that \a path looks like a Standard MIDI File that open() would accept.
+ *
+ * Only the header and the chunk layout are checked, no events are decoded.
+ */
+bool
+SMFStream::test (const std::string& path)
+{
+	SMFStream s;
+	return s.open (path);
+}
+
+/** Map the file at \a path and index its track chunks.
+ *
+ * \return true on success, false if the file can not be mapped or is not an
+ * SMF that we can read (SMPTE time, format 2 or no tracks).
+ */
+bool
+SMFStream::open (const std::string& path)
+{
+	close ();
+
+	if ((_map = g_mapped_file_new (path.c_str(), FALSE, NULL)) == 0) {
+		return false;
+	}
+
+	if (!parse ((const uint8_t*) g_mapped_file_get_contents (_map), g_mapped_file_get_length (_map))) {
+		close ();
+		return false;
+	}
+
+	seek_to_track (1);
+	return true;
+}
+
+void
+SMFStream::close ()
+{
+	if (_map) {
+		g_mapped_file_unref (_map);
+		_map = 0;
+	}
+
+	_tracks.clear ();
+	_track          = 0;
+	_pos            = 0;
+	_running_status = 0;
+	_ppqn           = 0;
+}
+
+bool
+SMFStream::parse (const uint8_t* data, size_t length)
+{
+	if (!data || length < 14 || memcmp (data, "MThd", 4)) {
+		return false;
+	}
+
+	const uint32_t header_length = read_be32 (data + 4);
+	if (header_length < 6 || header_length > length - 8) {
+		return false;
+	}
+
+	const uint16_t format     = read_be16 (data + 8);
+	const uint16_t num_tracks = read_be16 (data + 10);
+	const uint16_t division   = read_be16 (data + 12);
+
+	if (format > 1 || num_tracks == 0 || division == 0 || (division & 0x8000)) {
+		/* format 2 and SMPTE based time are not supported, as with libsmf */
+		return false;
+	}
+
+	_ppqn = division;
+
+	const uint8_t*       p   = data + 8 + header_length;
+	const uint8_t* const end = data + length;
+
+	while (_tracks.size() < num_tracks && end - p >= 8) {
+		const uint32_t chunk_length = read_be32 (p + 4);
+		const uint8_t* chunk_end;
+
+		if (chunk_length > size_t (end - p - 8)) {
+			cerr << "WARNING: SMF chunk runs past end of file, truncating" << endl;
+			chunk_end = end;
+		} else {
+			chunk_end = p + 8 + chunk_length;
+		}
+
+		if (!memcmp (p, "MTrk", 4)) {
+			_tracks.push_back (Chunk (p + 8, chunk_end));
+		}
+
+		p = chunk_end;
+	}
+
+	if (_tracks.size() != num_tracks) {
+		cerr << "WARNING: SMF header declared " << num_tracks << " tracks, but only "
+		     << _tracks.size() << " found" << endl;
+	}
+
+	return !_tracks.empty();
+}
+
+/** Seek to the start of the specified track (1-based indexing)
+ * \return true if the track exists
+ */
+bool
+SMFStream::seek_to_track (int track)
+{
+	if (track < 1 || track > (int) _tracks.size()) {
+		return false;
+	}
+
+	_track = &_tracks[track - 1];
+	seek_to_start ();
+	return true;
+}
+
+void
+SMFStream::seek_to_start ()
+{
+	if (_track) {
+		_pos            = _track->begin;
+		_running_status = 0;
+	}
+}
+
+/** \return true iff the current track has no events before its End Of Track. */
+bool
+SMFStream::track_is_empty () const
+{
+	if (!_track) {
+		return true;
+	}
+
+	const uint8_t* p = _track->begin;
+	uint32_t       delta;
+
+	if (!decode_vlq (&p, _track->end, &delta) || _track->end - p < 2) {
+		return true;
+	}
+
+	return p[0] == 0xff && p[1] == 0x2f;
+}
+
+bool
+SMFStream::read_vlq (uint32_t* value)
+{
+	return decode_vlq (&_pos, _track->end, value);
+}
+
+/** Decode the next event of the current track.
+ *
+ * The arguments and return value follow SMF::read_event(): \a buf is
+ * reallocated if *size is too small for the event, meta-events (including
+ * End Of Track, whose delta time still counts) return 0 and set \a note_id if
+ * they carry an Evoral Note ID, and -1 is returned once the track is
+ * exhausted.  SysEx escapes (0xF7) are skipped like meta-events.  A corrupt
+ * event ends the track.
+ */
+int
+SMFStream::read_event (uint32_t* delta_t, uint32_t* size, uint8_t** buf, event_id_t* note_id)
+{
+	assert (delta_t);
+	assert (size);
+	assert (buf);
+	assert (note_id);
+
+	if (!_track || _pos >= _track->end) {
+		return -1;
+	}
+
+	const uint8_t* const end = _track->end;
+
+	if (!read_vlq (delta_t) || _pos == end) {
+		_pos = end;
+		return -1;
+	}
+
+	uint8_t status = *_pos;
+
+	if (status & 0x80) {
+		++_pos;
+	} else if (_running_status) {
+		status = _running_status;
+	} else {
+		cerr << "WARNING: SMF data byte without running status, ignoring rest of track" << endl;
+		_pos = end;
+		return -1;
+	}
+
+	if (status == 0xff || status == 0xf7) {
+		uint8_t  type = 0;
+		uint32_t len;
+
+		if (status == 0xff) {
+			if (_pos == end) {
+				return -1;
+			}
+			type = *_pos++;
+		}
+
+		if (!read_vlq (&len) || len > uint32_t (end - _pos)) {
+			_pos = end;
+			return -1;
+		}
+
+		const uint8_t* data = _pos;
+		_pos += len;
+		*note_id = -1;
+
+		if (status == 0xff && type == 0x2f) {
+			/* End Of Track: anything after it is not part of the track */
+			_pos = end;
+		} else if (status == 0xff && type == 0x7f && len > 2 && data[0] == 0x99 && data[1] == 0x1) {
+			/* Sequencer-specific, Evoral Note ID */
+			const uint8_t* p = data + 2;
+			uint32_t       id;
+			if (decode_vlq (&p, data + len, &id)) {
+				*note_id = id;
+			}
+		}
+
+		return 0;
+	}
+
+	uint32_t       event_size;
+	const uint8_t* data;
+
+	if (status == 0xf0) {
+		uint32_t len;
+		if (!read_vlq (&len) || len > uint32_t (end - _pos)) {
+			_pos = end;
+			return -1;
+		}
+		event_size = len + 1;
+		data       = _pos;
+	} else {
+		const int s = midi_event_size (status);
+		if (s < 1 || uint32_t (s - 1) > uint32_t (end - _pos)) {
+			_pos = end;
+			return -1;
+		}
+		event_size = s;
+		data       = _pos;
+		if (status < 0xf0) {
+			_running_status = status;
+		}
+	}
+
+	if (*size < event_size) {
+		*buf = (uint8_t*) realloc (*buf, event_size);
+	}
+
+	(*buf)[0] = status;
+	memcpy (*buf + 1, data, event_size - 1);
+	*size = event_size;
+	_pos  = data + event_size - 1;
+
+	return event_size;
+}
+
+} // namespace Evoral
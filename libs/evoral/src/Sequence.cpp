@@ -24,6 +24,8 @@
 #include <stdint.h>
 #include <cstdio>
 
+#include <boost/make_shared.hpp>
+
 #if __clang__
 #include "evoral/Note.hpp"
 #endif
@@ -95,12 +97,13 @@ Sequence<Time>::const_iterator::const_iterator(const Sequence<Time>&
 
 	_lock = seq.read_lock();
 
-	// Add currently active notes, if given
+	// Add currently active notes, if given.  Notes which begin at t will be
+	// found below, but notes which end at t still need their note off.
 	if (active_notes) {
 		for (typename std::set<WeakNotePtr>::const_iterator i = active_notes->begin();
 		     i != active_notes->end(); ++i) {
 			NotePtr note = i->lock();
-			if (note && note->time() <= t && note->end_time() > t) {
+			if (note && note->time() < t && note->end_time() >= t) {
 				_active_notes.push(note);
 			}
 		}
@@ -110,23 +113,10 @@ Sequence<Time>::const_iterator::const_iterator(const Sequence<Time>&
 	_note_iter = seq.note_lower_bound(t);
 
 	// Find first sysex event at or after t
-	for (typename Sequence<Time>::SysExes::const_iterator i = seq.sysexes().begin();
-	     i != seq.sysexes().end(); ++i) {
-		if ((*i)->time() >= t) {
-			_sysex_iter = i;
-			break;
-		}
-	}
-	assert(_sysex_iter == seq.sysexes().end() || (*_sysex_iter)->time() >= t);
+	_sysex_iter = seq.sysex_lower_bound(t);
 
 	// Find first patch event at or after t
-	for (typename Sequence<Time>::PatchChanges::const_iterator i = seq.patch_changes().begin(); i != seq.patch_changes().end(); ++i) {
-		if ((*i)->time() >= t) {
-			_patch_change_iter = i;
-			break;
-		}
-	}
-	assert (_patch_change_iter == seq.patch_changes().end() || (*_patch_change_iter)->time() >= t);
+	_patch_change_iter = seq.patch_change_lower_bound(t);
 
 	// Find first control event after t
 	_control_iters.reserve(seq._controls.size());
@@ -490,8 +480,7 @@ Sequence<Time>::Sequence(const Sequence<Time>& other)
 	, _highest_note(other._highest_note)
 {
 	for (typename Notes::const_iterator i = other._notes.begin(); i != other._notes.end(); ++i) {
-		NotePtr n (new Note<Time> (**i));
-		_notes.insert (n);
+		index_note_unlocked (new_note (**i));
 	}
 
 	for (typename SysExes::const_iterator i = other._sysexes.begin(); i != other._sysexes.end(); ++i) {
@@ -598,6 +587,10 @@ Sequence<Time>::clear()
 {
 	WriteLock lock(write_lock());
 	_notes.clear();
+	for (int i = 0; i < 16; ++i) {
+		_pitches[i].clear();
+	}
+	_note_ids.clear();
 	for (Controls::iterator li = _controls.begin(); li != _controls.end(); ++li)
 		li->second->list()->clear();
 }
@@ -649,13 +642,13 @@ Sequence<Time>::end_write (StuckNoteOption option, Time when)
 				break;
 			case DeleteStuckNotes:
 				cerr << "WARNING: Stuck note lost: " << (*n)->note() << endl;
-				_notes.erase(n);
+				erase_note_unlocked (n);
 				break;
 			case ResolveStuckNotes:
 				if (when <= (*n)->time()) {
 					cerr << "WARNING: Stuck note resolution - end time @ "
 					     << when << " is before note on: " << (**n) << endl;
-					_notes.erase (*n);
+					erase_note_unlocked (n);
 				} else {
 					(*n)->set_length (when - (*n)->time());
 					cerr << "WARNING: resolved note-on with no note-off to generate " << (**n) << endl;
@@ -693,6 +686,18 @@ Sequence<Time>::add_note_unlocked(const NotePtr note, void* arg)
 		note->set_id (Evoral::next_event_id());
 	}
 
+	index_note_unlocked (note);
+
+	_edited = true;
+
+	return true;
+}
+
+/** Add \a note to the time, pitch and ID indices. */
+template<typename Time>
+void
+Sequence<Time>::index_note_unlocked (const NotePtr& note)
+{
 	if (note->note() < _lowest_note)
 		_lowest_note = note->note();
 	if (note->note() > _highest_note)
@@ -700,146 +705,119 @@ Sequence<Time>::add_note_unlocked(const NotePtr note, void* arg)
 
 	_notes.insert (note);
 	_pitches[note->channel()].insert (note);
-
-	_edited = true;
-
-	return true;
+	_note_ids.insert (std::make_pair (note->id(), note));
 }
 
+/** Remove the note at \a i from the time, pitch and ID indices. */
 template<typename Time>
 void
-Sequence<Time>::remove_note_unlocked(const constNotePtr note)
+Sequence<Time>::erase_note_unlocked (typename Notes::iterator i)
 {
-	bool erased = false;
-	bool id_matched = false;
+	const NotePtr note = *i;
 
-	DEBUG_TRACE (DEBUG::Sequence, string_compose ("%1 remove note #%2 %3 @ %4\n", this, note->id(), (int)note->note(), note->time()));
+	DEBUG_TRACE (DEBUG::Sequence, string_compose ("%1\terasing note #%2 %3 @ %4\n", this, note->id(), (int)note->note(), note->time()));
 
-	/* first try searching for the note using the time index, which is
-	 * faster since the container is "indexed" by time. (technically, this
-	 * means that lower_bound() can do a binary search rather than linear)
-	 *
-	 * this may not work, for reasons explained below.
-	 */
-
-	typename Sequence<Time>::Notes::iterator i;
-
-	for (i = note_lower_bound(note->time()); i != _notes.end() && (*i)->time() == note->time(); ++i) {
-
-		if (*i == note) {
+	_notes.erase (i);
 
-			DEBUG_TRACE (DEBUG::Sequence, string_compose ("%1\terasing note #%2 %3 @ %4\n", this, (*i)->id(), (int)(*i)->note(), (*i)->time()));
-			_notes.erase (i);
-
-			if (note->note() == _lowest_note || note->note() == _highest_note) {
+	/* The pitch index is ordered by note number only, so the note itself
+	 * is a fine search key.  Fall back to a linear search in case the note
+	 * number was changed while the note was in the sequence.
+	 */
 
-				_lowest_note = 127;
-				_highest_note = 0;
+	Pitches& p (pitches (note->channel()));
+	typename Pitches::iterator j;
 
-				for (typename Sequence<Time>::Notes::iterator ii = _notes.begin(); ii != _notes.end(); ++ii) {
-					if ((*ii)->note() < _lowest_note)
-						_lowest_note = (*ii)->note();
-					if ((*ii)->note() > _highest_note)
-						_highest_note = (*ii)->note();
-				}
-			}
-
-			erased = true;
+	for (j = p.lower_bound (note); j != p.end() && (*j)->note() == note->note(); ++j) {
+		if (*j == note) {
 			break;
 		}
 	}
 
-	DEBUG_TRACE (DEBUG::Sequence, string_compose ("%1\ttime-based lookup did not find note #%2 %3 @ %4\n", this, note->id(), (int)note->note(), note->time()));
-
-	if (!erased) {
-
-		/* if the note's time property was changed in tandem with some
-		 * other property as the next operation after it was added to
-		 * the sequence, then at the point where we call this to undo
-		 * the add, the note we are targetting currently has a
-		 * different time property than the one we we passed via
-		 * the argument.
-		 *
-		 * in this scenario, we have no choice other than to linear
-		 * search the list of notes and find the note by ID.
-		 */
-
-		for (i = _notes.begin(); i != _notes.end(); ++i) {
-
-			if ((*i)->id() == note->id()) {
-
-				DEBUG_TRACE (DEBUG::Sequence, string_compose ("%1\tID-based pass, erasing note #%2 %3 @ %4\n", this, (*i)->id(), (int)(*i)->note(), (*i)->time()));
-				_notes.erase (i);
-
-				if (note->note() == _lowest_note || note->note() == _highest_note) {
+	if (j == p.end() || *j != note) {
+		for (j = p.begin(); j != p.end() && *j != note; ++j) {}
+	}
 
-					_lowest_note = 127;
-					_highest_note = 0;
+	if (j != p.end()) {
+		p.erase (j);
+	} else {
+		warning << string_compose ("erased note %1 not found in pitches for channel %2", *note, (int) note->channel()) << endmsg;
+	}
 
-					for (typename Sequence<Time>::Notes::iterator ii = _notes.begin(); ii != _notes.end(); ++ii) {
-						if ((*ii)->note() < _lowest_note)
-							_lowest_note = (*ii)->note();
-						if ((*ii)->note() > _highest_note)
-							_highest_note = (*ii)->note();
-					}
-				}
+	std::pair<typename NoteIDs::iterator, typename NoteIDs::iterator> ids = _note_ids.equal_range (note->id());
 
-				erased = true;
-				id_matched = true;
-				break;
-			}
+	for (typename NoteIDs::iterator k = ids.first; k != ids.second; ++k) {
+		if (k->second == note) {
+			_note_ids.erase (k);
+			break;
 		}
 	}
 
-	if (erased) {
-
-		Pitches& p (pitches (note->channel()));
-
-		typename Pitches::iterator j;
-
-		/* if we had to ID-match above, we can't expect to find it in
-		 * pitches via note comparison either. so do another linear
-		 * search to locate it. otherwise, we can use the note index
-		 * to potentially speed things up.
-		 */
-
-		if (id_matched) {
+	if (note->note() == _lowest_note || note->note() == _highest_note) {
+		update_note_range_unlocked ();
+	}
+}
 
-			for (j = p.begin(); j != p.end(); ++j) {
-				if ((*j)->id() == note->id()) {
-					p.erase (j);
-					break;
-				}
-			}
+/** Recompute the lowest and highest note from the ends of the pitch indices. */
+template<typename Time>
+void
+Sequence<Time>::update_note_range_unlocked ()
+{
+	_lowest_note = 127;
+	_highest_note = 0;
 
-		} else {
+	for (int c = 0; c < 16; ++c) {
+		if (!_pitches[c].empty()) {
+			_lowest_note = std::min (_lowest_note, (*_pitches[c].begin())->note());
+			_highest_note = std::max (_highest_note, (*_pitches[c].rbegin())->note());
+		}
+	}
+}
 
-			/* Now find the same note in the "pitches" list (which indexes
-			 * notes by channel+time. We care only about its note number
-			 * so the search_note has all other properties unset.
-			 */
+template<typename Time>
+void
+Sequence<Time>::remove_note_unlocked(const constNotePtr note)
+{
+	DEBUG_TRACE (DEBUG::Sequence, string_compose ("%1 remove note #%2 %3 @ %4\n", this, note->id(), (int)note->note(), note->time()));
 
-			NotePtr search_note (new Note<Time>(0, Time(), Time(), note->note(), 0));
+	/* first try searching for the note using the time index, which is
+	 * faster since the container is "indexed" by time. (technically, this
+	 * means that lower_bound() can do a binary search rather than linear)
+	 *
+	 * this may not work, for reasons explained below.
+	 */
 
-			for (j = p.lower_bound (search_note); j != p.end() && (*j)->note() == note->note(); ++j) {
+	typename Sequence<Time>::Notes::iterator i;
 
-				if ((*j) == note) {
-					DEBUG_TRACE (DEBUG::Sequence, string_compose ("%1\terasing pitch %2 @ %3\n", this, (int)(*j)->note(), (*j)->time()));
-					p.erase (j);
-					break;
-				}
-			}
+	for (i = note_lower_bound(note->time()); i != _notes.end() && (*i)->time() == note->time(); ++i) {
+		if (*i == note) {
+			erase_note_unlocked (i);
+			_edited = true;
+			return;
 		}
+	}
 
-		if (j == p.end()) {
-			warning << string_compose ("erased note %1 not found in pitches for channel %2", *note, (int) note->channel()) << endmsg;
-		}
+	DEBUG_TRACE (DEBUG::Sequence, string_compose ("%1\ttime-based lookup did not find note #%2 %3 @ %4\n", this, note->id(), (int)note->note(), note->time()));
 
-		_edited = true;
+	/* if the note's time property was changed in tandem with some
+	 * other property as the next operation after it was added to
+	 * the sequence, then at the point where we call this to undo
+	 * the add, the note we are targetting currently has a
+	 * different time property than the one we we passed via
+	 * the argument.
+	 *
+	 * in this scenario, we have no choice other than to linear
+	 * search the list of notes and find the note by ID.
+	 */
 
-	} else {
-		cerr << "Unable to find note to erase matching " << *note.get() << endmsg;
+	for (i = _notes.begin(); i != _notes.end(); ++i) {
+		if ((*i)->id() == note->id()) {
+			erase_note_unlocked (i);
+			_edited = true;
+			return;
+		}
 	}
+
+	cerr << "Unable to find note to erase matching " << *note.get() << endmsg;
 }
 
 template<typename Time>
@@ -970,7 +948,7 @@ Sequence<Time>::append_note_on_unlocked (const MIDIEvent<Time>& ev, event_id_t e
 		return;
 	}
 
-	NotePtr note(new Note<Time>(ev.channel(), ev.time(), Time(), ev.note(), ev.velocity()));
+	NotePtr note = new_note (ev.channel(), ev.time(), Time(), ev.note(), ev.velocity());
 	note->set_id (evid);
 
 	add_note_unlocked (note);
@@ -1112,9 +1090,8 @@ bool
 Sequence<Time>::contains_unlocked (const NotePtr& note) const
 {
 	const Pitches& p (pitches (note->channel()));
-	NotePtr search_note(new Note<Time>(0, Time(), Time(), note->note()));
 
-	for (typename Pitches::const_iterator i = p.lower_bound (search_note);
+	for (typename Pitches::const_iterator i = p.lower_bound (note);
 	     i != p.end() && (*i)->note() == note->note(); ++i) {
 
 		if (**i == *note) {
@@ -1141,9 +1118,8 @@ Sequence<Time>::overlaps_unlocked (const NotePtr& note, const NotePtr& without)
 	Time ea  = note->end_time();
 
 	const Pitches& p (pitches (note->channel()));
-	NotePtr search_note(new Note<Time>(0, Time(), Time(), note->note()));
 
-	for (typename Pitches::const_iterator i = p.lower_bound (search_note);
+	for (typename Pitches::const_iterator i = p.lower_bound (note);
 	     i != p.end() && (*i)->note() == note->note(); ++i) {
 
 		if (without && (**i) == *without) {
@@ -1168,7 +1144,47 @@ template<typename Time>
 void
 Sequence<Time>::set_notes (const typename Sequence<Time>::Notes& n)
 {
-	_notes = n;
+	_notes.clear ();
+	for (int i = 0; i < 16; ++i) {
+		_pitches[i].clear ();
+	}
+	_note_ids.clear ();
+
+	for (typename Notes::const_iterator i = n.begin(); i != n.end(); ++i) {
+		index_note_unlocked (*i);
+	}
+}
+
+/** Return the note with ID \a id, or a null pointer if there is none. */
+template<typename Time>
+typename Sequence<Time>::NotePtr
+Sequence<Time>::note_by_id (event_id_t id) const
+{
+	typename NoteIDs::const_iterator i = _note_ids.find (id);
+
+	if (i == _note_ids.end()) {
+		return NotePtr();
+	}
+
+	return i->second;
+}
+
+/** Make a new note.  The note and its reference count share one
+ *  allocation, rather than the two that constructing a NotePtr from a
+ *  new Note takes.
+ */
+template<typename Time>
+typename Sequence<Time>::NotePtr
+Sequence<Time>::new_note (uint8_t chan, Time time, Time len, uint8_t note, uint8_t vel)
+{
+	return boost::make_shared<Note<Time> > (chan, time, len, note, vel);
+}
+
+template<typename Time>
+typename Sequence<Time>::NotePtr
+Sequence<Time>::new_note (const Note<Time>& copy)
+{
+	return boost::make_shared<Note<Time> > (copy);
 }
 
 // CONST iterator implementations (x3)
@@ -1178,7 +1194,8 @@ template<typename Time>
 typename Sequence<Time>::Notes::const_iterator
 Sequence<Time>::note_lower_bound (Time t) const
 {
-	NotePtr search_note(new Note<Time>(0, t, Time(), 0, 0));
+	Note<Time> key (t, true);
+	const NotePtr search_note (NotePtr(), &key); /* aliases key without owning it, so no allocation */
 	typename Sequence<Time>::Notes::const_iterator i = _notes.lower_bound(search_note);
 	assert(i == _notes.end() || (*i)->time() >= t);
 	return i;
@@ -1213,7 +1230,8 @@ template<typename Time>
 typename Sequence<Time>::Notes::iterator
 Sequence<Time>::note_lower_bound (Time t)
 {
-	NotePtr search_note(new Note<Time>(0, t, Time(), 0, 0));
+	Note<Time> key (t, true);
+	const NotePtr search_note (NotePtr(), &key); /* aliases key without owning it, so no allocation */
 	typename Sequence<Time>::Notes::iterator i = _notes.lower_bound(search_note);
 	assert(i == _notes.end() || (*i)->time() >= t);
 	return i;
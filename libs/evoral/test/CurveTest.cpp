@@ -245,6 +245,102 @@ CurveTest::ctrlListEval ()
 	CPPUNIT_ASSERT_EQUAL(9.0, cl->unlocked_eval(999.));
 }
 
+void
+CurveTest::ctrlListEvalVector ()
+{
+	boost::shared_ptr<Evoral::ControlList> cl = TestCtrlList();
+	float vec[64];
+
+	/* an empty list gives its default value */
+	cl->unlocked_eval_vector (0.0, 10.0, vec, 64);
+	for (uint32_t i = 0; i < 64; ++i) {
+		CPPUNIT_ASSERT_DOUBLES_EQUAL (cl->default_value(), vec[i], 1e-6);
+	}
+
+	cl->fast_simple_add (  0.0 , 2.0);
+	cl->fast_simple_add (100.0 , 4.0);
+	cl->fast_simple_add (200.0 , 0.0);
+	cl->fast_simple_add (200.0 , 1.0);
+	cl->fast_simple_add (300.0 , 8.0);
+	cl->fast_simple_add (400.0 , 9.0);
+
+	/* points before, on, between and after the control points */
+	cl->set_interpolation (ControlList::Discrete);
+	cl->unlocked_eval_vector (-35.0, 7.5, vec, 64);
+	for (uint32_t i = 0; i < 64; ++i) {
+		CPPUNIT_ASSERT_DOUBLES_EQUAL (cl->unlocked_eval (-35.0 + i * 7.5), vec[i], 1e-6);
+	}
+
+	cl->set_interpolation (ControlList::Linear);
+	cl->unlocked_eval_vector (-35.0, 7.5, vec, 64);
+	for (uint32_t i = 0; i < 64; ++i) {
+		CPPUNIT_ASSERT_DOUBLES_EQUAL (cl->unlocked_eval (-35.0 + i * 7.5), vec[i], 1e-5);
+	}
+
+	bool ok = cl->rt_safe_eval_vector (300.0, 1.0, vec, 1);
+	CPPUNIT_ASSERT (ok);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL (8.0, vec[0], 1e-6);
+}
+
+void
+CurveTest::manyPointVector ()
+{
+	float vec[1024];
+
+	boost::shared_ptr<Evoral::ControlList> cl = TestCtrlList();
+
+	cl->create_curve ();
+	cl->set_interpolation (ControlList::Linear);
+
+	/* segments of varying length, some flat, some shorter than a sample */
+	double x = 0;
+	for (int i = 0; i < 64; ++i) {
+		cl->fast_simple_add (x, (i % 5 == 0) ? 1.0 : (i * 37 % 11));
+		x += (i % 7 == 0) ? 0.25 : (i * 13 % 29) + 1;
+	}
+
+	cl->curve ().get_vector (3.0, 900.0, vec, 1024);
+
+	const double dx = (900.0 - 3.0) / 1023;
+	for (int i = 0; i < 1024; ++i) {
+		char msg[64];
+		snprintf (msg, 64, "at i=%d", i);
+		CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE (msg, cl->unlocked_eval (3.0 + i * dx), vec[i], 1e-4);
+	}
+}
+
+void
+CurveTest::ctrlListEvalAfterEdit ()
+{
+	boost::shared_ptr<Evoral::ControlList> cl = TestCtrlList();
+	double x, y;
+
+	/* the copy of the points used for lookups is built at thaw() */
+	cl->freeze ();
+	for (int i = 0; i < 1000; ++i) {
+		cl->fast_simple_add (i * 10.0, i);
+	}
+	cl->thaw ();
+
+	cl->set_interpolation (ControlList::Linear);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL (50.5, cl->unlocked_eval (505.0), 1e-9);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL (999.0, cl->unlocked_eval (20000.0), 1e-9);
+
+	cl->set_interpolation (ControlList::Discrete);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL (50.0, cl->unlocked_eval (505.0), 1e-9);
+	CPPUNIT_ASSERT (cl->rt_safe_earliest_event_discrete_unlocked (505.0, x, y, false));
+	CPPUNIT_ASSERT_DOUBLES_EQUAL (510.0, x, 1e-9);
+
+	/* lookups must see edits */
+	cl->erase_range (495.0, 515.0);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL (49.0, cl->unlocked_eval (505.0), 1e-9);
+	CPPUNIT_ASSERT (cl->rt_safe_earliest_event_discrete_unlocked (505.0, x, y, false));
+	CPPUNIT_ASSERT_DOUBLES_EQUAL (520.0, x, 1e-9);
+
+	cl->set_interpolation (ControlList::Linear);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL (50.5, cl->unlocked_eval (505.0), 1e-9);
+}
+
 void
 CurveTest::constrainedCubic ()
 {
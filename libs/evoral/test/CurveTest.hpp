@@ -11,6 +11,9 @@ class CurveTest : public CppUnit::TestFixture
 	CPPUNIT_TEST (threePointDiscete);
 	CPPUNIT_TEST (constrainedCubic);
 	CPPUNIT_TEST (ctrlListEval);
+	CPPUNIT_TEST (ctrlListEvalVector);
+	CPPUNIT_TEST (ctrlListEvalAfterEdit);
+	CPPUNIT_TEST (manyPointVector);
 	CPPUNIT_TEST_SUITE_END ();
 
 public:
@@ -19,6 +22,9 @@ public:
 	void threePointDiscete ();
 	void constrainedCubic ();
 	void ctrlListEval ();
+	void ctrlListEvalVector ();
+	void ctrlListEvalAfterEdit ();
+	void manyPointVector ();
 
 private:
 	boost::shared_ptr<Evoral::ControlList> TestCtrlList() {
@@ -1,5 +1,8 @@
 #include "SMFTest.hpp"
 
+#include <cstdlib>
+#include <cstring>
+
 #include <glibmm/fileutils.h>
 #include <glibmm/miscutils.h>
 
@@ -68,3 +71,66 @@ SMFTest::takeFiveTest ()
 	                Evoral::Beats::ticks_at_rate(time, smf.ppqn()));
 	CPPUNIT_ASSERT(!seq->empty());
 }
+
+void
+SMFTest::writeReadBackTest ()
+{
+	TestSMF smf;
+
+	string output_dir_path = PBD::tmp_writable_directory (PACKAGE, "writeReadBackTest");
+	string new_file_path = Glib::build_filename (output_dir_path, "ReadBack.mid");
+	CPPUNIT_ASSERT_EQUAL (0, smf.create (new_file_path));
+
+	const uint8_t note_on[]  = { 0x90, 60, 100 };
+	const uint8_t note_off[] = { 0x80, 60, 64 };
+	const uint8_t sysex[]    = { 0xF0, 0x7E, 0x7F, 0x09, 0x01, 0xF7 };
+
+	smf.begin_write ();
+	smf.append_event_delta (0, sizeof (note_on), note_on, 7);
+	smf.append_event_delta (100, sizeof (note_off), note_off, 7);
+	smf.append_event_delta (20, sizeof (sysex), sysex, -1);
+	smf.end_write (new_file_path);
+	smf.close ();
+
+	CPPUNIT_ASSERT (SMF::test (new_file_path));
+	CPPUNIT_ASSERT_EQUAL (0, smf.open (new_file_path));
+	CPPUNIT_ASSERT (!smf.is_empty ());
+	CPPUNIT_ASSERT_EQUAL (uint16_t (1), smf.num_tracks ());
+	CPPUNIT_ASSERT_EQUAL (uint16_t (19200), smf.ppqn ());
+
+	uint32_t   delta_t = 0;
+	uint32_t   size    = 0;
+	uint8_t*   buf     = NULL;
+	event_id_t id      = -1;
+	int        ret;
+
+	/* note on, preceded by its ID */
+	CPPUNIT_ASSERT_EQUAL (0, smf.SMF::read_event (&delta_t, &size, &buf, &id));
+	CPPUNIT_ASSERT_EQUAL (event_id_t (7), id);
+	CPPUNIT_ASSERT_EQUAL (3, smf.SMF::read_event (&delta_t, &size, &buf, &id));
+	CPPUNIT_ASSERT (!memcmp (buf, note_on, sizeof (note_on)));
+
+	/* note off, preceded by its ID */
+	CPPUNIT_ASSERT_EQUAL (0, smf.SMF::read_event (&delta_t, &size, &buf, &id));
+	CPPUNIT_ASSERT_EQUAL (event_id_t (7), id);
+	CPPUNIT_ASSERT_EQUAL (3, smf.SMF::read_event (&delta_t, &size, &buf, &id));
+	CPPUNIT_ASSERT_EQUAL (uint32_t (100), delta_t);
+	CPPUNIT_ASSERT (!memcmp (buf, note_off, sizeof (note_off)));
+
+	/* sysex, without an ID */
+	CPPUNIT_ASSERT_EQUAL (int (sizeof (sysex)), smf.SMF::read_event (&delta_t, &size, &buf, &id));
+	CPPUNIT_ASSERT_EQUAL (uint32_t (20), delta_t);
+	CPPUNIT_ASSERT (!memcmp (buf, sysex, sizeof (sysex)));
+
+	/* only End Of Track is left */
+	while ((ret = smf.SMF::read_event (&delta_t, &size, &buf, &id)) == 0) {}
+	CPPUNIT_ASSERT_EQUAL (-1, ret);
+
+	/* seeking back replays the same events */
+	smf.seek_to_start ();
+	CPPUNIT_ASSERT_EQUAL (0, smf.SMF::read_event (&delta_t, &size, &buf, &id));
+	CPPUNIT_ASSERT_EQUAL (3, smf.SMF::read_event (&delta_t, &size, &buf, &id));
+	CPPUNIT_ASSERT (!memcmp (buf, note_on, sizeof (note_on)));
+
+	free (buf);
+}
@@ -90,6 +90,41 @@ SequenceTest::iteratorSeekTest ()
 	CPPUNIT_ASSERT_EQUAL(num_notes, size_t(6));
 }
 
+void
+SequenceTest::iteratorSeekActiveNotesTest ()
+{
+	size_t num_on  = 0;
+	size_t num_off = 0;
+
+	seq->clear();
+
+	std::set<Sequence<Time>::WeakNotePtr> active;
+	for (Notes::const_iterator i = test_notes.begin(); i != test_notes.end(); ++i) {
+		seq->notes().insert(*i);
+		active.insert(*i);
+	}
+
+	/* the note ending at the seek point must still get its note off, and
+	   the note starting there must only be played once */
+	Sequence<Time>::const_iterator i = seq->begin(Evoral::Beats(600), false, std::set<Evoral::Parameter>(), &active);
+
+	CPPUNIT_ASSERT(i != seq->end());
+	CPPUNIT_ASSERT(((const MIDIEvent<Time>&)*i).is_note_off());
+	CPPUNIT_ASSERT_EQUAL(Time(600), i->time());
+	CPPUNIT_ASSERT_EQUAL(uint8_t(64 + 5), ((const MIDIEvent<Time>&)*i).note());
+
+	for (; i != seq->end(); ++i) {
+		if (((const MIDIEvent<Time>&)*i).is_note_on()) {
+			++num_on;
+		} else {
+			++num_off;
+		}
+	}
+
+	CPPUNIT_ASSERT_EQUAL(size_t(6), num_on);
+	CPPUNIT_ASSERT_EQUAL(size_t(7), num_off);
+}
+
 void
 SequenceTest::controlInterpolationTest ()
 {
@@ -154,3 +189,47 @@ SequenceTest::controlInterpolationTest ()
 		last_value = i->second;
 	}
 }
+
+void
+SequenceTest::noteIndexTest ()
+{
+	seq->clear();
+
+	for (Notes::const_iterator i = test_notes.begin(); i != test_notes.end(); ++i) {
+		boost::shared_ptr<Note<Time> > n = MySequence<Time>::new_note (**i);
+		n->set_id (1000 + (*i)->note());
+		CPPUNIT_ASSERT(seq->add_note_unlocked (n));
+	}
+
+	CPPUNIT_ASSERT_EQUAL(size_t(12), seq->notes().size());
+	CPPUNIT_ASSERT_EQUAL(uint8_t(64), seq->lowest_note());
+	CPPUNIT_ASSERT_EQUAL(uint8_t(75), seq->highest_note());
+
+	// Lookup by ID
+	boost::shared_ptr<Note<Time> > n = seq->note_by_id (1000 + 70);
+	CPPUNIT_ASSERT(n);
+	CPPUNIT_ASSERT_EQUAL(uint8_t(70), n->note());
+	CPPUNIT_ASSERT(!seq->note_by_id (999));
+
+	// Removal keeps every index consistent
+	seq->remove_note_unlocked (n);
+	CPPUNIT_ASSERT_EQUAL(size_t(11), seq->notes().size());
+	CPPUNIT_ASSERT(!seq->note_by_id (1000 + 70));
+	CPPUNIT_ASSERT(!seq->contains (n));
+
+	// Removing the outermost pitches updates the note range
+	seq->remove_note_unlocked (seq->note_by_id (1000 + 64));
+	seq->remove_note_unlocked (seq->note_by_id (1000 + 75));
+	CPPUNIT_ASSERT_EQUAL(size_t(9), seq->notes().size());
+	CPPUNIT_ASSERT_EQUAL(uint8_t(65), seq->lowest_note());
+	CPPUNIT_ASSERT_EQUAL(uint8_t(74), seq->highest_note());
+
+	// A copy has its own indices
+	MySequence<Time> copy (*seq);
+	CPPUNIT_ASSERT_EQUAL(size_t(9), copy.notes().size());
+	CPPUNIT_ASSERT(copy.note_by_id (1000 + 65));
+	CPPUNIT_ASSERT(copy.note_by_id (1000 + 65) != seq->note_by_id (1000 + 65));
+
+	seq->clear();
+	CPPUNIT_ASSERT(!seq->note_by_id (1000 + 65));
+}
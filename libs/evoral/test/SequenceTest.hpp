@@ -111,7 +111,9 @@ class SequenceTest : public CppUnit::TestFixture
 	CPPUNIT_TEST (createTest);
 	CPPUNIT_TEST (preserveEventOrderingTest);
 	CPPUNIT_TEST (iteratorSeekTest);
+	CPPUNIT_TEST (iteratorSeekActiveNotesTest);
 	CPPUNIT_TEST (controlInterpolationTest);
+	CPPUNIT_TEST (noteIndexTest);
 	CPPUNIT_TEST_SUITE_END ();
 
 public:
@@ -140,7 +142,9 @@ public:
 	void createTest ();
 	void preserveEventOrderingTest ();
 	void iteratorSeekTest ();
+	void iteratorSeekActiveNotesTest ();
 	void controlInterpolationTest ();
+	void noteIndexTest ();
 
 private:
 	DummyTypeMap*       type_map;
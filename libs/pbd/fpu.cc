@@ -76,6 +76,39 @@ __cpuid(int regs[4], int cpuid_leaf)
         regs[3] = edx;
 }
 
+/* leaf 7 (extended features) also needs a sub-leaf in %ecx */
+static void
+__cpuidex(int regs[4], int cpuid_leaf, int cpuid_subleaf)
+{
+        int eax, ebx, ecx, edx;
+        asm volatile (
+#if defined(__i386__)
+	        "pushl %%ebx;\n\t"
+#endif
+	        "movl %4, %%eax;\n\t"
+	        "movl %5, %%ecx;\n\t"
+	        "cpuid;\n\t"
+	        "movl %%eax, %0;\n\t"
+	        "movl %%ebx, %1;\n\t"
+	        "movl %%ecx, %2;\n\t"
+	        "movl %%edx, %3;\n\t"
+#if defined(__i386__)
+	        "popl %%ebx;\n\t"
+#endif
+	        :"=m" (eax), "=m" (ebx), "=m" (ecx), "=m" (edx)
+	        :"r" (cpuid_leaf), "r" (cpuid_subleaf)
+	        :"%eax",
+#if !defined(__i386__)
+	         "%ebx",
+#endif
+	         "%ecx", "%edx");
+
+        regs[0] = eax;
+        regs[1] = ebx;
+        regs[2] = ecx;
+        regs[3] = edx;
+}
+
 #endif /* !PLATFORM_WINDOWS */
 
 #ifndef COMPILER_MSVC
@@ -182,6 +215,33 @@ FPU::FPU ()
 		    ((_xgetbv (_XCR_XFEATURE_ENABLED_MASK) & 0x6) == 0x6)) { /* OS really supports XSAVE */
 			info << _("AVX-capable processor") << endmsg;
 			_flags = Flags (_flags | (HasAVX) );
+
+			if (cpu_info[2] & (1<<12)) {
+				_flags = Flags (_flags | HasFMA);
+			}
+
+			if (num_ids >= 7) {
+
+				uint64_t const xcr0 = _xgetbv (_XCR_XFEATURE_ENABLED_MASK);
+
+				__cpuidex (cpu_info, 7, 0);
+
+				if (cpu_info[1] & (1<<5)) {
+					info << _("AVX2-capable processor") << endmsg;
+					_flags = Flags (_flags | HasAVX2);
+				}
+
+				/* AVX-512 also needs the OS to save the opmask and upper ZMM state */
+
+				if ((cpu_info[1] & (1<<16)) && ((xcr0 & 0xe6) == 0xe6)) {
+					info << _("AVX-512F-capable processor") << endmsg;
+					_flags = Flags (_flags | HasAVX512F);
+				}
+
+				/* restore leaf 1, which the checks below rely on */
+
+				__cpuid (cpu_info, 1);
+			}
 		}
 
 		if (cpu_info[3] & (1<<25)) {
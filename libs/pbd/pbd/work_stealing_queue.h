@@ -0,0 +1,153 @@
+/*
+    Copyright (C) 2015 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#ifndef __pbd_work_stealing_queue_h__
+#define __pbd_work_stealing_queue_h__
+
+#include <glib.h>
+
+#include "pbd/libpbd_visibility.h"
+
+namespace PBD {
+
+/** A fixed-size, lock-free work-stealing deque (after Chase & Lev, 2005).
+ *
+ *  One thread owns the queue and may push() and pop() at the bottom end;
+ *  any number of other threads may steal() from the top end.  The
+ *  capacity is fixed at construction time (rounded up to a power of two)
+ *  so that no memory is ever allocated from a realtime thread; push()
+ *  returns false if the queue is full.
+ *
+ *  The glib atomic operations used here are full memory barriers, which
+ *  gives us the sequential consistency that the algorithm relies on.
+ *  Indices are allowed to wrap; all comparisons are made on the
+ *  (unsigned) difference between them.
+ */
+template<class T>
+class /*LIBPBD_API*/ WorkStealingQueue
+{
+  public:
+	WorkStealingQueue (guint sz) {
+		guint power_of_two;
+		for (power_of_two = 1; 1U<<power_of_two < sz; power_of_two++) {}
+		size = 1<<power_of_two;
+		size_mask = size - 1;
+		buf = new gpointer[size];
+		reset ();
+	}
+
+	~WorkStealingQueue () {
+		delete [] buf;
+	}
+
+	void reset () {
+		/* !!! NOT THREAD SAFE !!! */
+		g_atomic_int_set (&top, 0);
+		g_atomic_int_set (&bottom, 0);
+	}
+
+	guint capacity () const { return size; }
+
+	/** Add an item at the bottom of the queue.  Must only be called by the owner. */
+	bool push (T* item) {
+		guint const b = (guint) g_atomic_int_get (&bottom);
+		guint const t = (guint) g_atomic_int_get (&top);
+
+		if (b - t >= size) {
+			return false;
+		}
+
+		g_atomic_pointer_set (&buf[b & size_mask], item);
+		g_atomic_int_set (&bottom, (gint) (b + 1));
+		return true;
+	}
+
+	/** Remove the most recently pushed item.  Must only be called by the owner.
+	 *  @return the item, or 0 if the queue was empty (or its last item was stolen).
+	 */
+	T* pop () {
+		guint const b = (guint) g_atomic_int_get (&bottom) - 1;
+		g_atomic_int_set (&bottom, (gint) b);
+		guint const t = (guint) g_atomic_int_get (&top);
+
+		if ((gint) (b - t) < 0) {
+			/* empty */
+			g_atomic_int_set (&bottom, (gint) (b + 1));
+			return 0;
+		}
+
+		T* item = (T*) g_atomic_pointer_get (&buf[b & size_mask]);
+
+		if (b == t) {
+			/* last item: race any thief for it */
+			if (!g_atomic_int_compare_and_exchange (&top, (gint) t, (gint) (t + 1))) {
+				item = 0;
+			}
+			g_atomic_int_set (&bottom, (gint) (b + 1));
+		}
+
+		return item;
+	}
+
+	/** Remove the oldest item.  May be called by any thread.
+	 *  @return the item, or 0 if the queue was empty or we lost a race.
+	 */
+	T* steal () {
+		guint const t = (guint) g_atomic_int_get (&top);
+		guint const b = (guint) g_atomic_int_get (&bottom);
+
+		if ((gint) (b - t) <= 0) {
+			return 0;
+		}
+
+		T* item = (T*) g_atomic_pointer_get (&buf[t & size_mask]);
+
+		if (!g_atomic_int_compare_and_exchange (&top, (gint) t, (gint) (t + 1))) {
+			return 0;
+		}
+
+		return item;
+	}
+
+	/** @return true if the queue appeared empty at the time of the call */
+	bool empty () const {
+		guint const t = (guint) g_atomic_int_get (const_cast<gint*> (&top));
+		guint const b = (guint) g_atomic_int_get (const_cast<gint*> (&bottom));
+		return (gint) (b - t) <= 0;
+	}
+
+  private:
+	gpointer* buf;
+	guint     size;
+	guint     size_mask;
+
+	/* keep the thieves' end and the owner's end on separate cache lines */
+	char pad0[64];
+	mutable gint top;
+	char pad1[64];
+	mutable gint bottom;
+	char pad2[64];
+
+	WorkStealingQueue (WorkStealingQueue const &);
+	WorkStealingQueue& operator= (WorkStealingQueue const &);
+};
+
+} /* namespace PBD */
+
+#endif /* __pbd_work_stealing_queue_h__ */
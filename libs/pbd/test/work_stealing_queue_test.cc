@@ -0,0 +1,131 @@
+#include <vector>
+
+#include "glibmm/threads.h"
+#include "sigc++/bind.h"
+
+#include "pbd/work_stealing_queue.h"
+
+#include "work_stealing_queue_test.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION (WorkStealingQueueTest);
+
+using namespace std;
+using namespace PBD;
+
+void
+WorkStealingQueueTest::testOwner ()
+{
+	WorkStealingQueue<int> q (4);
+	int items[5];
+
+	CPPUNIT_ASSERT_EQUAL (4U, q.capacity ());
+	CPPUNIT_ASSERT (q.empty ());
+	CPPUNIT_ASSERT (q.pop () == 0);
+
+	for (int i = 0; i < 4; ++i) {
+		CPPUNIT_ASSERT (q.push (&items[i]));
+	}
+
+	/* full */
+	CPPUNIT_ASSERT (!q.push (&items[4]));
+
+	/* the owner sees the most recent item first */
+	for (int i = 3; i >= 0; --i) {
+		CPPUNIT_ASSERT (q.pop () == &items[i]);
+	}
+
+	CPPUNIT_ASSERT (q.empty ());
+	CPPUNIT_ASSERT (q.pop () == 0);
+}
+
+void
+WorkStealingQueueTest::testSteal ()
+{
+	WorkStealingQueue<int> q (4);
+	int items[3];
+
+	/* run the indices round the buffer a few times */
+	for (int n = 0; n < 10; ++n) {
+		for (int i = 0; i < 3; ++i) {
+			CPPUNIT_ASSERT (q.push (&items[i]));
+		}
+
+		/* thieves see the oldest item first */
+		CPPUNIT_ASSERT (q.steal () == &items[0]);
+		CPPUNIT_ASSERT (q.pop () == &items[2]);
+		CPPUNIT_ASSERT (q.steal () == &items[1]);
+		CPPUNIT_ASSERT (q.steal () == 0);
+		CPPUNIT_ASSERT (q.pop () == 0);
+	}
+}
+
+static const int n_items = 100000;
+
+static void
+thief (WorkStealingQueue<int>* q, vector<int>* taken, volatile gint* done)
+{
+	while (!g_atomic_int_get (done)) {
+		int* i = q->steal ();
+		if (i) {
+			taken->push_back (*i);
+		}
+	}
+
+	int* i;
+	while ((i = q->steal ()) != 0) {
+		taken->push_back (*i);
+	}
+}
+
+void
+WorkStealingQueueTest::testConcurrent ()
+{
+	WorkStealingQueue<int> q (256);
+	vector<int> items (n_items);
+	vector<int> taken[3];
+	volatile gint done = 0;
+
+	for (int i = 0; i < n_items; ++i) {
+		items[i] = i;
+	}
+
+	Glib::Threads::Thread* a = Glib::Threads::Thread::create (sigc::bind (sigc::ptr_fun (thief), &q, &taken[1], &done));
+	Glib::Threads::Thread* b = Glib::Threads::Thread::create (sigc::bind (sigc::ptr_fun (thief), &q, &taken[2], &done));
+
+	/* the owner pushes everything, popping some items back as it goes */
+	for (int i = 0; i < n_items; ++i) {
+		while (!q.push (&items[i])) {
+			int* p = q.pop ();
+			if (p) {
+				taken[0].push_back (*p);
+			}
+		}
+		if ((i % 3) == 0) {
+			int* p = q.pop ();
+			if (p) {
+				taken[0].push_back (*p);
+			}
+		}
+	}
+
+	g_atomic_int_set (&done, 1);
+	a->join ();
+	b->join ();
+
+	int* p;
+	while ((p = q.pop ()) != 0) {
+		taken[0].push_back (*p);
+	}
+
+	/* every item must have been taken exactly once */
+	vector<int> count (n_items, 0);
+	for (int t = 0; t < 3; ++t) {
+		for (vector<int>::iterator i = taken[t].begin(); i != taken[t].end(); ++i) {
+			count[*i]++;
+		}
+	}
+
+	for (int i = 0; i < n_items; ++i) {
+		CPPUNIT_ASSERT_EQUAL (1, count[i]);
+	}
+}